@@ -0,0 +1,505 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "bench.h"
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+
+
+// the options every suite shares, set from the command line by main()
+static bool gGPU    = false;
+static int  gWarmup = 3;
+
+static char gDevice[256] = "cpu";
+
+
+// a printed result, for the report
+struct benchRecord
+{
+	std::string suite;
+	std::string group;
+	std::string name;
+	std::string units;
+
+	double median;
+	double min;
+	double mean;
+	double throughput;
+	double bandwidth;
+	size_t samples;
+};
+
+static std::vector<benchRecord> gRecords;
+
+static std::string gSuite;
+static std::string gGroup;
+
+
+// constructor
+benchSuite::benchSuite( const char* suiteName, const char* suiteDescription, benchFunction suiteFunc )
+{
+	name        = suiteName;
+	description = suiteDescription;
+	func        = suiteFunc;
+
+	List().push_back(this);
+}
+
+
+// List
+std::vector<benchSuite*>& benchSuite::List()
+{
+	static std::vector<benchSuite*> suites;	// function-local so registration doesn't depend on static init order
+	return suites;
+}
+
+
+// benchGPU
+bool benchGPU()
+{
+	return gGPU;
+}
+
+
+// the device buffers from benchAlloc(), by their host copy
+struct benchBuffer
+{
+	void*  gpu;
+	size_t size;
+};
+
+static std::map<void*, benchBuffer> gBuffers;
+
+
+// benchAlloc
+bool benchAlloc( void** cpu, void** gpu, size_t size )
+{
+	*cpu = malloc(size);
+	*gpu = *cpu;
+
+	if( !*cpu )
+	{
+		printf("[bench]  failed to allocate %zu bytes\n", size);
+		return false;
+	}
+
+	if( !gGPU )
+		return true;
+
+	if( CUDA_FAILED(cudaMalloc(gpu, size)) )
+	{
+		free(*cpu);
+
+		*cpu = NULL;
+		*gpu = NULL;
+
+		return false;
+	}
+
+	benchBuffer buffer;
+
+	buffer.gpu  = *gpu;
+	buffer.size = size;
+
+	gBuffers[*cpu] = buffer;
+	return true;
+}
+
+
+// benchUpload
+bool benchUpload( void* cpu )
+{
+	std::map<void*, benchBuffer>::iterator buffer = gBuffers.find(cpu);
+
+	if( buffer == gBuffers.end() )
+		return !gGPU;	// the CPU versions use the host memory directly
+
+	return CUDA_SUCCESS(cudaMemcpy(buffer->second.gpu, cpu, buffer->second.size, cudaMemcpyHostToDevice));
+}
+
+
+// benchDownload
+bool benchDownload( void* cpu )
+{
+	std::map<void*, benchBuffer>::iterator buffer = gBuffers.find(cpu);
+
+	if( buffer == gBuffers.end() )
+		return !gGPU;
+
+	return CUDA_SUCCESS(cudaMemcpy(cpu, buffer->second.gpu, buffer->second.size, cudaMemcpyDeviceToHost));
+}
+
+
+// benchFree
+void benchFree( void* cpu )
+{
+	if( !cpu )
+		return;
+
+	std::map<void*, benchBuffer>::iterator buffer = gBuffers.find(cpu);
+
+	if( buffer != gBuffers.end() )
+	{
+		CUDA(cudaFree(buffer->second.gpu));
+		gBuffers.erase(buffer);
+	}
+
+	free(cpu);
+}
+
+
+// constructor
+benchResult::benchResult( const char* name, double items, const char* units )
+{
+	mName  = name;
+	mUnits = units;
+	mItems = items;
+	mBytes = 0.0;
+	mBegin = 0.0;
+
+	mEvents[0] = NULL;
+	mEvents[1] = NULL;
+}
+
+
+// destructor
+benchResult::~benchResult()
+{
+	for( int n=0; n < 2; n++ )
+	{
+		if( mEvents[n] != NULL )
+			CUDA(cudaEventDestroy(mEvents[n]));
+	}
+}
+
+
+// BeginKernel
+void benchResult::BeginKernel( cudaStream_t stream )
+{
+	if( !gGPU )
+	{
+		Begin();
+		return;
+	}
+
+	if( !mEvents[0] && (CUDA_FAILED(cudaEventCreate(&mEvents[0])) || CUDA_FAILED(cudaEventCreate(&mEvents[1]))) )
+		return;
+
+	CUDA(cudaEventRecord(mEvents[0], stream));
+}
+
+
+// EndKernel
+void benchResult::EndKernel( cudaStream_t stream )
+{
+	if( !gGPU )
+	{
+		End();
+		return;
+	}
+
+	if( !mEvents[1] )
+		return;
+
+	CUDA(cudaEventRecord(mEvents[1], stream));
+	CUDA(cudaEventSynchronize(mEvents[1]));
+
+	float ms = 0.0f;
+
+	if( CUDA_SUCCESS(cudaEventElapsedTime(&ms, mEvents[0], mEvents[1])) )
+		mSamples.push_back(ms);
+}
+
+
+// Median
+double benchResult::Median() const
+{
+	if( mSamples.size() == 0 )
+		return 0.0;
+
+	std::vector<double> sorted = mSamples;
+	std::sort(sorted.begin(), sorted.end());
+	return sorted[sorted.size() / 2];
+}
+
+
+// Min
+double benchResult::Min() const
+{
+	if( mSamples.size() == 0 )
+		return 0.0;
+
+	return *std::min_element(mSamples.begin(), mSamples.end());
+}
+
+
+// Mean
+double benchResult::Mean() const
+{
+	if( mSamples.size() == 0 )
+		return 0.0;
+
+	double sum = 0.0;
+
+	for( size_t n=0; n < mSamples.size(); n++ )
+		sum += mSamples[n];
+
+	return sum / mSamples.size();
+}
+
+
+// PrintHeader
+void benchResult::PrintHeader( const char* title )
+{
+	printf("\n%s\n", title);
+	printf("  %-40s %10s %10s %10s %14s %11s\n", "benchmark", "median ms", "min ms", "mean ms", "throughput", "bandwidth");
+
+	gGroup = title;
+}
+
+
+// Print
+void benchResult::Print() const
+{
+	const double median = Median();
+
+	// items per ms / 1000 is millions per second, bytes per ms / 1e6 is GB/s
+	const double throughput = (mItems > 0.0 && median > 0.0) ? mItems / (median * 1000.0) : 0.0;
+	const double bandwidth  = (mBytes > 0.0 && median > 0.0) ? mBytes / (median * 1000000.0) : 0.0;
+
+	char throughputStr[64] = "";
+	char bandwidthStr[64]  = "";
+
+	if( throughput > 0.0 )
+		sprintf(throughputStr, "%9.1f %s/s", throughput, mUnits);
+
+	if( bandwidth > 0.0 )
+		sprintf(bandwidthStr, "%6.2f GB/s", bandwidth);
+
+	printf("  %-40s %10.3f %10.3f %10.3f %14s %11s\n", mName, median, Min(), Mean(), throughputStr, bandwidthStr);
+
+	benchRecord record;
+
+	record.suite      = gSuite;
+	record.group      = gGroup;
+	record.name       = mName;
+	record.units      = mUnits;
+	record.median     = median;
+	record.min        = Min();
+	record.mean       = Mean();
+	record.throughput = throughput;
+	record.bandwidth  = bandwidth;
+	record.samples    = mSamples.size();
+
+	gRecords.push_back(record);
+}
+
+
+// benchIterations
+int benchIterations( commandLine& cmdLine, int defaultIterations )
+{
+	const int iterations = cmdLine.GetInt("iterations");
+	return (iterations > 0) ? iterations : defaultIterations;
+}
+
+
+// benchWarmup
+int benchWarmup()
+{
+	return gWarmup;
+}
+
+
+// benchResolutions
+std::vector<int2> benchResolutions( commandLine& cmdLine )
+{
+	std::vector<int2> resolutions;
+
+	const int width  = cmdLine.GetInt("width");
+	const int height = cmdLine.GetInt("height");
+
+	if( width > 0 && height > 0 )
+	{
+		resolutions.push_back(make_int2(width, height));
+		return resolutions;
+	}
+
+	resolutions.push_back(make_int2(640, 480));
+	resolutions.push_back(make_int2(1280, 720));
+	resolutions.push_back(make_int2(1920, 1080));
+
+	return resolutions;
+}
+
+
+// quoteString (for the report -- the names only need quotes and backslashes escaped)
+static std::string quoteString( const std::string& str )
+{
+	std::string out = "\"";
+
+	for( size_t n=0; n < str.size(); n++ )
+	{
+		if( str[n] == '"' || str[n] == '\\' )
+			out += '\\';
+
+		out += str[n];
+	}
+
+	return out + "\"";
+}
+
+
+// writeReport (JSON, or CSV if the filename ends in .csv)
+static bool writeReport( const char* filename, int iterations, int failed )
+{
+	FILE* file = fopen(filename, "w");
+
+	if( !file )
+	{
+		printf("[bench]  failed to open '%s' for writing the report\n", filename);
+		return false;
+	}
+
+	const size_t length = strlen(filename);
+
+	if( length > 4 && strcasecmp(filename + length - 4, ".csv") == 0 )
+	{
+		fprintf(file, "suite,group,benchmark,median_ms,min_ms,mean_ms,throughput,units,bandwidth_gbs,samples,device\n");
+
+		for( size_t n=0; n < gRecords.size(); n++ )
+		{
+			const benchRecord& r = gRecords[n];
+
+			fprintf(file, "%s,%s,%s,%f,%f,%f,%f,%s/s,%f,%zu,%s\n", quoteString(r.suite).c_str(), quoteString(r.group).c_str(), quoteString(r.name).c_str(),
+				   r.median, r.min, r.mean, r.throughput, r.units.c_str(), r.bandwidth, r.samples, quoteString(gDevice).c_str());
+		}
+	}
+	else
+	{
+		fprintf(file, "{\n  \"device\": %s,\n  \"gpu\": %s,\n  \"iterations\": %i,\n  \"warmup\": %i,\n  \"failed\": %i,\n  \"results\": [\n",
+			   quoteString(gDevice).c_str(), gGPU ? "true" : "false", iterations, gWarmup, failed);
+
+		for( size_t n=0; n < gRecords.size(); n++ )
+		{
+			const benchRecord& r = gRecords[n];
+
+			fprintf(file, "    { \"suite\": %s, \"group\": %s, \"benchmark\": %s, \"median_ms\": %f, \"min_ms\": %f, \"mean_ms\": %f, "
+				   "\"throughput\": %f, \"units\": \"%s/s\", \"bandwidth_gbs\": %f, \"samples\": %zu }%s\n",
+				   quoteString(r.suite).c_str(), quoteString(r.group).c_str(), quoteString(r.name).c_str(),
+				   r.median, r.min, r.mean, r.throughput, r.units.c_str(), r.bandwidth, r.samples, (n + 1 < gRecords.size()) ? "," : "");
+		}
+
+		fprintf(file, "  ]\n}\n");
+	}
+
+	fclose(file);
+	printf("[bench]  wrote %zu results to '%s'\n", gRecords.size(), filename);
+	return true;
+}
+
+
+// main entry point
+int main( int argc, char** argv )
+{
+	commandLine cmdLine(argc, argv);
+
+	std::vector<benchSuite*>& suites = benchSuite::List();
+
+	if( cmdLine.GetFlag("help") || cmdLine.GetFlag("list") )
+	{
+		printf("usage:  jetson-inference-bench [suite ...] [--iterations=N] [--warmup=N] [--width=W --height=H]\n");
+		printf("                               [--report=<file.json|file.csv>] [--cpu]\n\n");
+		printf("available suites:\n");
+
+		for( size_t n=0; n < suites.size(); n++ )
+			printf("   %-12s %s\n", suites[n]->name, suites[n]->description);
+
+		printf("\nrunning with no suite names runs all of them.  --cpu runs the CPU reference versions\n");
+		printf("of the kernels, which is also the default when there's no CUDA device.\n");
+		return 0;
+	}
+
+	// select the suites named on the command line (or all of them)
+	std::vector<benchSuite*> selected;
+
+	for( int i=1; i < argc; i++ )
+	{
+		if( argv[i][0] == '-' )
+			continue;
+
+		bool found = false;
+
+		for( size_t n=0; n < suites.size(); n++ )
+		{
+			if( strcasecmp(argv[i], suites[n]->name) == 0 )
+			{
+				selected.push_back(suites[n]);
+				found = true;
+			}
+		}
+
+		if( !found )
+		{
+			printf("jetson-inference-bench:  unknown suite '%s' (run with --list to see the available suites)\n", argv[i]);
+			return 1;
+		}
+	}
+
+	if( selected.size() == 0 )
+		selected = suites;
+
+	// run the kernels on the GPU if there is one
+#ifndef CPU_ONLY
+	int numDevices = 0;
+
+	if( !cmdLine.GetFlag("cpu") && cudaGetDeviceCount(&numDevices) == cudaSuccess && numDevices > 0 )
+	{
+		cudaDeviceProp properties;
+
+		if( CUDA_SUCCESS(cudaGetDeviceProperties(&properties, 0)) )
+		{
+			snprintf(gDevice, sizeof(gDevice), "%s", properties.name);
+			gGPU = true;
+		}
+	}
+
+	cudaGetLastError();	// clear the error from a missing device
+#endif
+
+	if( gGPU )
+		printf("[bench]  running the kernels on %s\n", gDevice);
+	else
+		printf("[bench]  running the CPU reference versions of the kernels\n");
+
+	if( cmdLine.GetString("warmup") != NULL )
+		gWarmup = std::max(cmdLine.GetInt("warmup"), 0);
+
+	int failed = 0;
+
+	for( size_t n=0; n < selected.size(); n++ )
+	{
+		printf("\n[bench]  running suite '%s' -- %s\n", selected[n]->name, selected[n]->description);
+
+		gSuite = selected[n]->name;
+
+		if( !selected[n]->func(cmdLine) )
+		{
+			printf("[bench]  suite '%s' FAILED\n", selected[n]->name);
+			failed++;
+		}
+	}
+
+	printf("\n[bench]  %zu suites run, %i failed\n", selected.size(), failed);
+
+	const char* report = cmdLine.GetString("report");
+
+	if( report != NULL && !writeReport(report, benchIterations(cmdLine), failed) )
+		return 1;
+
+	return (failed > 0) ? 1 : 0;
+}
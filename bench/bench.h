@@ -0,0 +1,198 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __JETSON_INFERENCE_BENCH_H_
+#define __JETSON_INFERENCE_BENCH_H_
+
+
+#include "commandLine.h"
+#include "cudaUtility.h"
+
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+
+
+/**
+ * Benchmark entry point, returns false if the suite failed to run or its results didn't validate.
+ */
+typedef bool (*benchFunction)( commandLine& cmdLine );
+
+
+/**
+ * A named group of benchmarks that can be selected from the jetson-inference-bench command line.
+ * Suites register themselves at startup with the BENCH_SUITE() macro.
+ */
+struct benchSuite
+{
+	benchSuite( const char* name, const char* description, benchFunction func );
+
+	const char*   name;
+	const char*   description;
+	benchFunction func;
+
+	static std::vector<benchSuite*>& List();
+};
+
+
+/**
+ * Register a benchmark suite with jetson-inference-bench.
+ */
+#define BENCH_SUITE(name, description, func)		static benchSuite __benchSuite_##func(name, description, func)
+
+
+/**
+ * Get the current time in milliseconds from a monotonic clock.
+ */
+inline double benchTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+
+/**
+ * True if the kernels are being run on a GPU, or false if they're being run with their
+ * CPU reference versions (CPU_ONLY builds, no CUDA device present, or --cpu).
+ */
+bool benchGPU();
+
+
+/**
+ * Call the CUDA version of a kernel (i.e. cudaResizeRGBA), or its CPU reference version
+ * from cpuKernels.h (cpuResizeRGBA) when benchGPU() is false.
+ */
+#define BENCH_KERNEL(name, ...)	(benchGPU() ? cuda##name(__VA_ARGS__) : cpu##name(__VA_ARGS__))
+
+
+/**
+ * Allocate a host buffer, and a device buffer for the kernels (from cudaMalloc(), so they're timed
+ * against device memory rather than zero-copy).  For the CPU versions both are the same host memory.
+ * Inputs are filled in on the host and copied over with benchUpload(), and outputs are copied
+ * back with benchDownload() to validate them (neither is timed).
+ */
+bool benchAlloc( void** cpu, void** gpu, size_t size );
+
+/**
+ * Copy a buffer from benchAlloc() to the device, by its host pointer (does nothing for the CPU versions).
+ */
+bool benchUpload( void* cpu );
+
+/**
+ * Copy a buffer from benchAlloc() back from the device, by its host pointer (does nothing for the CPU versions).
+ */
+bool benchDownload( void* cpu );
+
+/**
+ * Free memory from benchAlloc().
+ */
+void benchFree( void* cpu );
+
+
+/**
+ * Collects the timing of repeated runs of one benchmark, and prints the statistics.
+ * Printed results are also kept for the report written with --report=<file>.
+ */
+class benchResult
+{
+public:
+	/**
+	 * @param name label printed in the results table
+	 * @param items number of items (i.e. pixels) processed per run, used to report throughput
+	 * @param units label for the throughput units (per second)
+	 */
+	benchResult( const char* name, double items=0.0, const char* units="Mpix" );
+
+	/**
+	 * Destructor
+	 */
+	~benchResult();
+
+	/**
+	 * Time host code with the CPU clock.
+	 */
+	inline void Begin()			{ mBegin = benchTime(); }
+	inline void End()			{ mSamples.push_back(benchTime() - mBegin); }
+
+	/**
+	 * Time kernels with CUDA events recorded on the stream (End() waits for them to complete).
+	 * When the CPU versions are being run, these use the CPU clock instead.
+	 */
+	void BeginKernel( cudaStream_t stream=NULL );
+	void EndKernel( cudaStream_t stream=NULL );
+
+	/**
+	 * Run func (returning false on error) --warmup times untimed, then iterations
+	 * times timed with BeginKernel() / EndKernel().
+	 * @returns false if any of the runs failed
+	 */
+	template<typename T> bool Run( int iterations, T func, cudaStream_t stream=NULL );
+
+	/**
+	 * Set the number of bytes read and written per run, to report the achieved bandwidth.
+	 */
+	inline void SetBytes( double bytes )	{ mBytes = bytes; }
+
+	double Median() const;
+	double Min() const;
+	double Mean() const;
+
+	void Print() const;
+
+	/**
+	 * Print a header line for a table of results.
+	 */
+	static void PrintHeader( const char* title );
+
+protected:
+	const char* mName;
+	const char* mUnits;
+	double      mItems;
+	double      mBytes;
+	double      mBegin;
+
+	cudaEvent_t mEvents[2];
+
+	std::vector<double> mSamples;
+};
+
+
+/**
+ * Retrieve the number of iterations that benchmarks should run (--iterations=N, default 20).
+ */
+int benchIterations( commandLine& cmdLine, int defaultIterations=20 );
+
+/**
+ * Retrieve the number of untimed runs before each benchmark (--warmup=N, default 3).
+ */
+int benchWarmup();
+
+/**
+ * Retrieve the image sizes to run at, either --width=W --height=H, or by default
+ * 640x480, 1280x720 and 1920x1080.
+ */
+std::vector<int2> benchResolutions( commandLine& cmdLine );
+
+
+// Run
+template<typename T> bool benchResult::Run( int iterations, T func, cudaStream_t stream )
+{
+	bool passed = true;
+
+	for( int n=0; n < benchWarmup(); n++ )
+		passed &= func();
+
+	for( int n=0; n < iterations; n++ )
+	{
+		BeginKernel(stream);
+		passed &= func();
+		EndKernel(stream);
+	}
+
+	return passed;
+}
+
+
+#endif
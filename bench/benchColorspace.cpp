@@ -0,0 +1,164 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "bench.h"
+
+#include "cudaColorspace.h"
+#include "cpuKernels.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+// maxDifference (in 8-bit levels, or pixel intensity for RGBA32F)
+static float maxDifference( const void* a, const void* b, imageFormat format, size_t size )
+{
+	float diff = 0.0f;
+
+	if( format == FORMAT_RGBA32F )
+	{
+		for( size_t n=0; n < size / sizeof(float); n++ )
+			diff = fmaxf(diff, fabsf(((const float*)a)[n] - ((const float*)b)[n]));
+	}
+	else
+	{
+		for( size_t n=0; n < size; n++ )
+			diff = fmaxf(diff, abs(((const uint8_t*)a)[n] - ((const uint8_t*)b)[n]));
+	}
+
+	return diff;
+}
+
+
+// benchColorspaceResolution
+static bool benchColorspaceResolution( commandLine& cmdLine, int width, int height )
+{
+	const int iterations = benchIterations(cmdLine);
+
+	width &= ~1;	// for the 4:2:2 formats
+
+	// the camera formats into what the networks and display take, and RGBA back into what encoders take
+	struct colorCase
+	{
+		imageFormat input;
+		imageFormat output;
+	};
+
+	const colorCase cases[] = {
+		{ FORMAT_NV12, FORMAT_RGBA32F }, { FORMAT_NV12, FORMAT_RGBA8 },
+		{ FORMAT_I420, FORMAT_RGBA32F }, { FORMAT_I420, FORMAT_RGBA8 },
+		{ FORMAT_YUYV, FORMAT_RGBA32F }, { FORMAT_YUYV, FORMAT_RGBA8 },
+		{ FORMAT_UYVY, FORMAT_RGBA32F }, { FORMAT_UYVY, FORMAT_RGBA8 },
+		{ FORMAT_RGB8, FORMAT_RGBA32F }, { FORMAT_BGR8, FORMAT_RGBA8 },
+		{ FORMAT_RGBA8, FORMAT_I420 },   { FORMAT_RGBA8, FORMAT_NV12 },
+		{ FORMAT_RGBA32F, FORMAT_BGR8 }
+	};
+
+	const size_t maxSize = imageFormatSize(FORMAT_RGBA32F, width, height);
+
+	uint8_t* inputCPU  = NULL;
+	uint8_t* inputGPU  = NULL;
+	uint8_t* outputCPU = NULL;
+	uint8_t* outputGPU = NULL;
+	uint8_t* reference = (uint8_t*)malloc(maxSize);
+
+	if( !reference || !benchAlloc((void**)&inputCPU, (void**)&inputGPU, maxSize) ||
+	    !benchAlloc((void**)&outputCPU, (void**)&outputGPU, maxSize) )
+		return false;
+
+	char title[256];
+	sprintf(title, "color conversion %ix%i", width, height);
+	benchResult::PrintHeader(title);
+
+	const colorConversion cc = colorConversionInit(COLORSPACE_BT601);
+
+	bool passed = true;
+
+	for( size_t c=0; c < sizeof(cases) / sizeof(colorCase); c++ )
+	{
+		const imageFormat inputFormat  = cases[c].input;
+		const imageFormat outputFormat = cases[c].output;
+
+		const size_t inputSize  = imageFormatSize(inputFormat, width, height);
+		const size_t outputSize = imageFormatSize(outputFormat, width, height);
+
+		// random 8-bit values, or 0-255 intensities for float
+		srand(c);
+
+		if( inputFormat == FORMAT_RGBA32F )
+		{
+			for( size_t n=0; n < inputSize / sizeof(float); n++ )
+				((float*)inputCPU)[n] = rand() % 256;
+		}
+		else
+		{
+			for( size_t n=0; n < inputSize; n++ )
+				inputCPU[n] = rand() % 256;
+		}
+
+		if( !benchUpload(inputCPU) )
+			return false;
+
+		// the planes that cudaConvertColor() would set up, so the CPU version can be run in its place
+		colorPlanes inputPlanes;
+		colorPlanes outputPlanes;
+
+		colorPlanesInit(inputGPU, inputFormat, width, height, &inputPlanes);
+		colorPlanesInit(outputGPU, outputFormat, width, height, &outputPlanes);
+
+		char name[64];
+		sprintf(name, "%s -> %s", imageFormatToStr(inputFormat), imageFormatToStr(outputFormat));
+
+		benchResult result(name, width * height);
+		result.SetBytes(inputSize + outputSize);
+
+		passed &= result.Run(iterations, [&]()
+		{
+			return CUDA_SUCCESS(BENCH_KERNEL(ConvertColorPlanes, inputPlanes, inputFormat, outputPlanes, outputFormat, width, height, cc, NULL));
+		});
+
+		result.Print();
+
+		if( !benchDownload(outputCPU) )
+			return false;
+
+		// validate against the general CPU version
+		colorPlanes referencePlanes;
+
+		colorPlanesInit(inputCPU, inputFormat, width, height, &inputPlanes);
+		colorPlanesInit(reference, outputFormat, width, height, &referencePlanes);
+
+		cpuConvertColorPlanes(inputPlanes, inputFormat, referencePlanes, outputFormat, width, height, cc);
+
+		const float diff = maxDifference(outputCPU, reference, outputFormat, outputSize);
+
+		if( diff > 1.0f )
+		{
+			printf("[bench]  %s differs from the CPU version by %f\n", name, diff);
+			passed = false;
+		}
+	}
+
+	benchFree(inputCPU);
+	benchFree(outputCPU);
+	free(reference);
+
+	return passed;
+}
+
+
+// benchColorspace
+static bool benchColorspace( commandLine& cmdLine )
+{
+	const std::vector<int2> resolutions = benchResolutions(cmdLine);
+
+	bool passed = true;
+
+	for( size_t n=0; n < resolutions.size(); n++ )
+		passed &= benchColorspaceResolution(cmdLine, resolutions[n].x, resolutions[n].y);
+
+	return passed;
+}
+
+BENCH_SUITE("colorspace", "YUV/RGB color conversion bandwidth per format", benchColorspace);
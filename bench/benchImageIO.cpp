@@ -0,0 +1,347 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "bench.h"
+
+#include "imageIO.h"
+#include "threadPool.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string>
+
+#ifdef HAS_QT
+#include <QImage>
+
+#define REFERENCE_NAME "QImage"
+
+
+// the original per-pixel QImage loading loop, kept as the reference to compare against
+static bool loadReference( const char* filename, float4* output, int width, int height )
+{
+	QImage qImg;
+
+	if( !qImg.load(filename) || qImg.width() != width || qImg.height() != height )
+		return false;
+
+	for( int y=0; y < height; y++ )
+	{
+		for( int x=0; x < width; x++ )
+		{
+			const QRgb rgb = qImg.pixel(x,y);
+			output[y*width+x] = make_float4(float(qRed(rgb)), float(qGreen(rgb)), float(qBlue(rgb)), float(qAlpha(rgb)));
+		}
+	}
+
+	return true;
+}
+
+
+// the original per-pixel QImage saving loop
+static bool saveReference( const char* filename, const float4* input, int width, int height )
+{
+	QImage img(width, height, QImage::Format_RGB32);
+
+	for( int y=0; y < height; y++ )
+	{
+		for( int x=0; x < width; x++ )
+		{
+			const float4 px = input[y * width + x];
+			img.setPixel(x, y, qRgb(px.x, px.y, px.z));
+		}
+	}
+
+	return img.save(filename);
+}
+#else
+#define REFERENCE_NAME "scalar"
+
+// without Qt, the reference is the direct decoder followed by a per-pixel conversion loop
+static bool loadReference( const char* filename, float4* output, int width, int height )
+{
+	uint8_t* pixels = NULL;
+
+	int imgWidth  = 0;
+	int imgHeight = 0;
+
+	if( !decodeImage(filename, &pixels, &imgWidth, &imgHeight) )
+		return false;
+
+	if( imgWidth != width || imgHeight != height )
+	{
+		free(pixels);
+		return false;
+	}
+
+	for( int n=0; n < width * height; n++ )
+		output[n] = make_float4(pixels[n*4+0], pixels[n*4+1], pixels[n*4+2], pixels[n*4+3]);
+
+	free(pixels);
+	return true;
+}
+
+
+// the per-pixel conversion loop followed by the direct encoder
+static bool saveReference( const char* filename, const float4* input, int width, int height )
+{
+	uint8_t* rgb = (uint8_t*)malloc(width * height * 3);
+
+	if( !rgb )
+		return false;
+
+	for( int n=0; n < width * height; n++ )
+	{
+		rgb[n*3+0] = input[n].x;
+		rgb[n*3+1] = input[n].y;
+		rgb[n*3+2] = input[n].z;
+	}
+
+	const bool result = encodeImage(filename, rgb, width, height, 3);
+	free(rgb);
+	return result;
+}
+#endif
+
+
+// the fast path used by loadImageRGBA(), decoding into a caller-provided buffer
+static bool loadFast( const char* filename, float4* output, int width, int height )
+{
+	uint8_t* pixels = NULL;
+
+	int imgWidth  = 0;
+	int imgHeight = 0;
+
+	if( !decodeImage(filename, &pixels, &imgWidth, &imgHeight) )
+		return false;
+
+	if( imgWidth != width || imgHeight != height )
+	{
+		free(pixels);
+		return false;
+	}
+
+	imageParallelRows(height, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+			convertRowRGBA8ToFloat4(pixels + y * width * 4, output + y * width, width);
+	});
+
+	free(pixels);
+	return true;
+}
+
+
+// the fast path used by saveImageRGBA()
+static bool saveFast( const char* filename, const float4* input, uint8_t* rgb, int width, int height )
+{
+	imageParallelRows(height, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+			convertRowFloat4ToRGB8(input + y * width, rgb + y * width * 3, width, 1.0f);
+	});
+
+	return encodeImage(filename, rgb, width, height, 3);
+}
+
+
+// maxDifference
+static float maxDifference( const float4* a, const float4* b, int count )
+{
+	float diff = 0.0f;
+
+	for( int n=0; n < count; n++ )
+	{
+		diff = fmaxf(diff, fabsf(a[n].x - b[n].x));
+		diff = fmaxf(diff, fabsf(a[n].y - b[n].y));
+		diff = fmaxf(diff, fabsf(a[n].z - b[n].z));
+		diff = fmaxf(diff, fabsf(a[n].w - b[n].w));
+	}
+
+	return diff;
+}
+
+
+// benchImageIO
+static bool benchImageIO( commandLine& cmdLine )
+{
+	const int iterations = benchIterations(cmdLine, 10);
+
+	int width   = cmdLine.GetInt("width");
+	int height  = cmdLine.GetInt("height");
+	int threads = cmdLine.GetInt("threads");
+
+	if( width <= 0 )	width = 1920;
+	if( height <= 0 )	height = 1080;
+	if( threads <= 0 )	threads = threadPool::GetNumCores();
+
+	const int pixels = width * height;
+
+
+	// generate a synthetic test image, with enough detail that the encoders don't shortcut it
+	uint8_t* rgba = (uint8_t*)malloc(pixels * 4);
+
+	for( int y=0; y < height; y++ )
+	{
+		for( int x=0; x < width; x++ )
+		{
+			uint8_t* px = rgba + (y * width + x) * 4;
+
+			px[0] = (x * 255) / width;
+			px[1] = (y * 255) / height;
+			px[2] = ((x ^ y) * 7) & 0xFF;
+			px[3] = 255;
+		}
+	}
+
+	const std::string pngPath = "/tmp/jetson-inference-bench.png";
+	const std::string jpgPath = "/tmp/jetson-inference-bench.jpg";
+
+	if( !encodeImage(pngPath.c_str(), rgba, width, height, 4) || !encodeImage(jpgPath.c_str(), rgba, width, height, 4) )
+	{
+		printf("[bench]  failed to write test images to /tmp\n");
+		free(rgba);
+		return false;
+	}
+
+	float4*  reference = (float4*)malloc(pixels * sizeof(float4));
+	float4*  output    = (float4*)malloc(pixels * sizeof(float4));
+	uint8_t* rgb       = (uint8_t*)malloc(pixels * 3);
+
+	bool passed = true;
+
+	const char* formats[] = { "png", "jpg" };
+	const std::string paths[] = { pngPath, jpgPath };
+
+	for( int f=0; f < 2; f++ )
+	{
+		char title[256];
+		sprintf(title, "load %ix%i %s", width, height, formats[f]);
+		benchResult::PrintHeader(title);
+
+		const char* path = paths[f].c_str();
+
+		benchResult refResult(REFERENCE_NAME " per-pixel loop", pixels);
+		benchResult fastResult("decodeImage + SIMD rows (1 thread)", pixels);
+
+		char parallelName[64];
+		sprintf(parallelName, "decodeImage + SIMD rows (%i threads)", threads);
+		benchResult parallelResult(parallelName, pixels);
+
+		for( int n=0; n < iterations; n++ )
+		{
+			refResult.Begin();
+			passed &= loadReference(path, reference, width, height);
+			refResult.End();
+
+			setImageThreads(1);
+			fastResult.Begin();
+			passed &= loadFast(path, output, width, height);
+			fastResult.End();
+
+			setImageThreads(threads);
+			parallelResult.Begin();
+			passed &= loadFast(path, output, width, height);
+			parallelResult.End();
+		}
+
+		refResult.Print();
+		fastResult.Print();
+		parallelResult.Print();
+
+		// PNG is lossless so the decoders must agree exactly, JPEG decoders may round differently
+		const float diff = maxDifference(reference, output, pixels);
+		printf("  max difference vs " REFERENCE_NAME ":  %.1f\n", diff);
+
+		if( f == 0 && diff > 0.0f )
+		{
+			printf("[bench]  %s decode doesn't match the " REFERENCE_NAME " reference\n", formats[f]);
+			passed = false;
+		}
+	}
+
+
+	// the encode path (loadReference left the reference buffer filled with the last decode)
+	for( int f=0; f < 2; f++ )
+	{
+		char title[256];
+		sprintf(title, "save %ix%i %s", width, height, formats[f]);
+		benchResult::PrintHeader(title);
+
+		const std::string refPath   = "/tmp/jetson-inference-bench-ref." + std::string(formats[f]);
+		const std::string fastPath = "/tmp/jetson-inference-bench-fast." + std::string(formats[f]);
+
+		benchResult refResult(REFERENCE_NAME " per-pixel loop", pixels);
+		benchResult fastResult("SIMD rows + encodeImage (1 thread)", pixels);
+
+		char parallelName[64];
+		sprintf(parallelName, "SIMD rows + encodeImage (%i threads)", threads);
+		benchResult parallelResult(parallelName, pixels);
+
+		for( int n=0; n < iterations; n++ )
+		{
+			refResult.Begin();
+			passed &= saveReference(refPath.c_str(), reference, width, height);
+			refResult.End();
+
+			setImageThreads(1);
+			fastResult.Begin();
+			passed &= saveFast(fastPath.c_str(), reference, rgb, width, height);
+			fastResult.End();
+
+			setImageThreads(threads);
+			parallelResult.Begin();
+			passed &= saveFast(fastPath.c_str(), reference, rgb, width, height);
+			parallelResult.End();
+		}
+
+		refResult.Print();
+		fastResult.Print();
+		parallelResult.Print();
+	}
+
+
+	// the row conversion on its own, without decode
+	benchResult::PrintHeader("convert RGBA8 -> planar float");
+
+	float* planar = (float*)malloc(pixels * sizeof(float) * 3);
+
+	benchResult scalarResult("scalar loop", pixels);
+	benchResult simdResult("convertRowRGBA8ToPlanar", pixels);
+
+	for( int n=0; n < iterations; n++ )
+	{
+		scalarResult.Begin();
+
+		for( int i=0; i < pixels; i++ )
+		{
+			planar[pixels * 0 + i] = rgba[i*4+0];
+			planar[pixels * 1 + i] = rgba[i*4+1];
+			planar[pixels * 2 + i] = rgba[i*4+2];
+		}
+
+		scalarResult.End();
+
+		simdResult.Begin();
+
+		for( int y=0; y < height; y++ )
+			convertRowRGBA8ToPlanar(rgba + y * width * 4, planar + y * width, planar + pixels + y * width, planar + pixels * 2 + y * width, width, make_float3(0,0,0));
+
+		simdResult.End();
+	}
+
+	scalarResult.Print();
+	simdResult.Print();
+
+	setImageThreads(1);
+
+	free(planar);
+	free(rgba);
+	free(rgb);
+	free(reference);
+	free(output);
+
+	return passed;
+}
+
+BENCH_SUITE("imageio", "image decode/encode (" REFERENCE_NAME " per-pixel loops vs. direct decode and SIMD rows)", benchImageIO);
@@ -0,0 +1,146 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "bench.h"
+
+#include "cudaNormalize.h"
+#include "cpuKernels.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+
+// maxDifference
+static float maxDifference( const float* a, const float* b, size_t count )
+{
+	float diff = 0.0f;
+
+	for( size_t n=0; n < count; n++ )
+		diff = fmaxf(diff, fabsf(a[n] - b[n]));
+
+	return diff;
+}
+
+
+// maxDifference (8-bit)
+static float maxDifference( const uint8_t* a, const uint8_t* b, size_t count )
+{
+	int diff = 0;
+
+	for( size_t n=0; n < count; n++ )
+		diff = std::max(diff, abs(a[n] - b[n]));
+
+	return diff;
+}
+
+
+// benchNormalizeResolution
+static bool benchNormalizeResolution( commandLine& cmdLine, int width, int height )
+{
+	const int iterations = benchIterations(cmdLine);
+	const int pixels     = width * height;
+
+	float4* inputCPU  = NULL;
+	float4* inputGPU  = NULL;
+	float4* outputCPU = NULL;
+	float4* outputGPU = NULL;
+	uchar4* packedCPU = NULL;
+	uchar4* packedGPU = NULL;
+
+	float4* reference = (float4*)malloc(pixels * sizeof(float4));
+
+	if( !reference || !benchAlloc((void**)&inputCPU, (void**)&inputGPU, pixels * sizeof(float4)) ||
+	    !benchAlloc((void**)&outputCPU, (void**)&outputGPU, pixels * sizeof(float4)) ||
+	    !benchAlloc((void**)&packedCPU, (void**)&packedGPU, pixels * sizeof(uchar4)) )
+		return false;
+
+	srand(0);
+
+	for( int n=0; n < pixels; n++ )
+		inputCPU[n] = make_float4(rand() % 256, rand() % 256, rand() % 256, 255);
+
+	if( !benchUpload(inputCPU) )
+		return false;
+
+	char title[256];
+	sprintf(title, "normalize %ix%i", width, height);
+	benchResult::PrintHeader(title);
+
+	bool passed = true;
+
+	// 0-255 into the 0-1 range the networks take
+	const float2 inputRange  = make_float2(0.0f, 255.0f);
+	const float2 outputRange = make_float2(0.0f, 1.0f);
+
+	benchResult normalizeResult("cudaNormalizeRGBA (0-255 -> 0-1)", pixels);
+	normalizeResult.SetBytes(pixels * sizeof(float4) * 2);
+
+	passed &= normalizeResult.Run(iterations, [&]()
+	{
+		return CUDA_SUCCESS(BENCH_KERNEL(NormalizeRGBA, inputGPU, inputRange, outputGPU, outputRange, width, height));
+	});
+
+	normalizeResult.Print();
+
+	if( !benchDownload(outputCPU) )
+		return false;
+
+	cpuNormalizeRGBA(inputCPU, inputRange, reference, outputRange, width, height);
+
+	const float normalizeDiff = maxDifference((float*)outputCPU, (float*)reference, pixels * 4);
+
+	if( normalizeDiff > 0.0001f )
+	{
+		printf("[bench]  cudaNormalizeRGBA differs from the CPU version by %f\n", normalizeDiff);
+		passed = false;
+	}
+
+	// float4 packed down to RGBA8 for display
+	benchResult packedResult("cudaNormalizeToRGBA8", pixels);
+	packedResult.SetBytes(pixels * (sizeof(float4) + sizeof(uchar4)));
+
+	passed &= packedResult.Run(iterations, [&]()
+	{
+		return CUDA_SUCCESS(BENCH_KERNEL(NormalizeToRGBA8, inputGPU, inputRange, packedGPU, width, height));
+	});
+
+	packedResult.Print();
+
+	if( !benchDownload(packedCPU) )
+		return false;
+
+	cpuNormalizeToRGBA8(inputCPU, inputRange, (uchar4*)reference, width, height);
+
+	const float packedDiff = maxDifference((uint8_t*)packedCPU, (uint8_t*)reference, pixels * 4);
+
+	if( packedDiff > 1.0f )
+	{
+		printf("[bench]  cudaNormalizeToRGBA8 differs from the CPU version by %f\n", packedDiff);
+		passed = false;
+	}
+
+	benchFree(inputCPU);
+	benchFree(outputCPU);
+	benchFree(packedCPU);
+	free(reference);
+
+	return passed;
+}
+
+
+// benchNormalize
+static bool benchNormalize( commandLine& cmdLine )
+{
+	const std::vector<int2> resolutions = benchResolutions(cmdLine);
+
+	bool passed = true;
+
+	for( size_t n=0; n < resolutions.size(); n++ )
+		passed &= benchNormalizeResolution(cmdLine, resolutions[n].x, resolutions[n].y);
+
+	return passed;
+}
+
+BENCH_SUITE("normalize", "float4 range normalization, and packing to RGBA8", benchNormalize);
@@ -0,0 +1,317 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "bench.h"
+
+#include "cudaOverlay.h"
+#include "cudaFont.h"
+#include "cpuKernels.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// cudaOverlay and cudaFont allocate mapped memory, so without a GPU they're only available in CPU_ONLY builds
+static bool hasRenderers()
+{
+#ifdef CPU_ONLY
+	return true;
+#else
+	return benchGPU();
+#endif
+}
+
+
+// maxDifference
+static float maxDifference( const float4* a, const float4* b, size_t count )
+{
+	float diff = 0.0f;
+
+	for( size_t n=0; n < count; n++ )
+	{
+		diff = fmaxf(diff, fabsf(a[n].x - b[n].x));
+		diff = fmaxf(diff, fabsf(a[n].y - b[n].y));
+		diff = fmaxf(diff, fabsf(a[n].z - b[n].z));
+		diff = fmaxf(diff, fabsf(a[n].w - b[n].w));
+	}
+
+	return diff;
+}
+
+
+// randomBoxes (detection-sized boxes, left/top/right/bottom)
+static void randomBoxes( float4* boxes, int numBoxes, int width, int height )
+{
+	srand(numBoxes);
+
+	for( int n=0; n < numBoxes; n++ )
+	{
+		const int w = 32 + rand() % (width / 4);
+		const int h = 32 + rand() % (height / 3);
+		const int x = rand() % (width - w);
+		const int y = rand() % (height - h);
+
+		boxes[n] = make_float4(x, y, x + w, y + h);
+	}
+}
+
+
+// benchOverlayResolution
+static bool benchOverlayResolution( commandLine& cmdLine, int width, int height )
+{
+	const int iterations = benchIterations(cmdLine);
+	const int pixels     = width * height;
+	const int maxBoxes   = 64;
+
+	float4* imageCPU  = NULL;
+	float4* imageGPU  = NULL;
+	float4* outputCPU = NULL;
+	float4* outputGPU = NULL;
+	float4* boxesCPU  = NULL;
+	float4* boxesGPU  = NULL;
+
+	float4* reference = (float4*)malloc(pixels * sizeof(float4));
+
+	if( !reference || !benchAlloc((void**)&imageCPU, (void**)&imageGPU, pixels * sizeof(float4)) ||
+	    !benchAlloc((void**)&outputCPU, (void**)&outputGPU, pixels * sizeof(float4)) ||
+	    !benchAlloc((void**)&boxesCPU, (void**)&boxesGPU, maxBoxes * sizeof(float4)) )
+		return false;
+
+	for( int y=0; y < height; y++ )
+		for( int x=0; x < width; x++ )
+			imageCPU[y * width + x] = make_float4((x * 255) / width, (y * 255) / height, 128, 255);
+
+	if( !benchUpload(imageCPU) )
+		return false;
+
+	cudaOverlay* overlay = hasRenderers() ? cudaOverlay::Create() : NULL;
+
+	if( hasRenderers() && !overlay )
+		return false;
+
+	const float4 color = make_float4(0.0f, 255.0f, 175.0f, 100.0f);
+
+	bool passed = true;
+
+	for( int numBoxes=8; numBoxes <= maxBoxes; numBoxes *= 8 )
+	{
+		randomBoxes(boxesCPU, numBoxes, width, height);
+
+		if( !benchUpload(boxesCPU) )
+			return false;
+
+		char title[256];
+		sprintf(title, "overlay %ix%i, %i boxes", width, height, numBoxes);
+		benchResult::PrintHeader(title);
+
+		// every pixel tested against every box
+		benchResult legacyResult("cudaRectOutlineOverlay", pixels);
+		legacyResult.SetBytes(pixels * sizeof(float4) * 2);
+
+		passed &= legacyResult.Run(iterations, [&]()
+		{
+			return CUDA_SUCCESS(BENCH_KERNEL(RectOutlineOverlay, imageGPU, outputGPU, width, height, boxesGPU, numBoxes, color));
+		});
+
+		legacyResult.Print();
+
+		if( !benchDownload(outputCPU) )
+			return false;
+
+		cpuRectOutlineOverlay(imageCPU, reference, width, height, boxesCPU, numBoxes, color);
+
+		float diff = maxDifference(outputCPU, reference, pixels);
+
+		if( diff > 0.01f )
+		{
+			printf("[bench]  cudaRectOutlineOverlay differs from the CPU version by %f\n", diff);
+			passed = false;
+		}
+
+		if( !overlay )
+		{
+			printf("[bench]  cudaOverlay needs a GPU in this build, skipping it\n");
+			continue;
+		}
+
+		// only the tiles that are drawn in (the binning on the CPU is part of the time)
+		benchResult fillResult("cudaOverlay (filled)", pixels);
+
+		passed &= fillResult.Run(iterations, [&]()
+		{
+			overlay->AddBoxes((float*)boxesCPU, numBoxes, color);
+			return overlay->Render(outputGPU, outputGPU, width, height);
+		});
+
+		fillResult.Print();
+
+		benchResult outlineResult("cudaOverlay (outlined)", pixels);
+
+		passed &= outlineResult.Run(iterations, [&]()
+		{
+			overlay->AddBoxes((float*)boxesCPU, numBoxes, color, 2.0f);
+			return overlay->Render(outputGPU, outputGPU, width, height);
+		});
+
+		outlineResult.Print();
+
+		// filled boxes of one color blend the same as cudaRectOutlineOverlay
+		overlay->AddBoxes((float*)boxesCPU, numBoxes, color);
+
+		if( !overlay->Render(imageGPU, outputGPU, width, height) )
+			passed = false;
+
+		if( !benchDownload(outputCPU) )
+			return false;
+
+		diff = maxDifference(outputCPU, reference, pixels);
+
+		if( diff > 0.01f )
+		{
+			printf("[bench]  cudaOverlay differs from the CPU version by %f\n", diff);
+			passed = false;
+		}
+	}
+
+	delete overlay;
+
+	benchFree(imageCPU);
+	benchFree(outputCPU);
+	benchFree(boxesCPU);
+	free(reference);
+
+	return passed;
+}
+
+
+// benchOverlay
+static bool benchOverlay( commandLine& cmdLine )
+{
+	const std::vector<int2> resolutions = benchResolutions(cmdLine);
+
+	bool passed = true;
+
+	for( size_t n=0; n < resolutions.size(); n++ )
+		passed &= benchOverlayResolution(cmdLine, resolutions[n].x, resolutions[n].y);
+
+	return passed;
+}
+
+BENCH_SUITE("overlay", "bounding box rendering, brute force vs. tiled", benchOverlay);
+
+
+// benchFontResolution
+static bool benchFontResolution( commandLine& cmdLine, cudaFont* font, int width, int height )
+{
+	const int iterations = benchIterations(cmdLine);
+	const int pixels     = width * height;
+	const int numLabels  = 32;
+
+	float4* imageCPU = NULL;
+	float4* imageGPU = NULL;
+
+	if( !benchAlloc((void**)&imageCPU, (void**)&imageGPU, pixels * sizeof(float4)) )
+		return false;
+
+	memset(imageCPU, 0, pixels * sizeof(float4));
+
+	if( !benchUpload(imageCPU) )
+		return false;
+
+	// a label like the ones detectnet-console draws for each detection (the throughput is thousands of labels per second)
+	const char*  label      = "person 97.5%";
+	const int2   extents    = font->GetTextExtents(label);
+	const float4 color      = make_float4(255.0f, 255.0f, 255.0f, 255.0f);
+	const float4 background = make_float4(0.0f, 0.0f, 0.0f, 120.0f);
+
+	std::vector< std::pair< std::string, int2 > > labels;
+
+	srand(0);
+
+	for( int n=0; n < numLabels; n++ )
+		labels.push_back(std::pair<std::string, int2>(label, make_int2(rand() % (width - extents.x), rand() % (height - extents.y))));
+
+	char title[256];
+	sprintf(title, "font %ix%i, %i labels", width, height, numLabels);
+	benchResult::PrintHeader(title);
+
+	bool passed = true;
+
+	// one launch per label
+	benchResult perLabelResult("cudaFont::RenderOverlay per label", numLabels * 1000.0, "Klabel");
+
+	passed &= perLabelResult.Run(iterations, [&]()
+	{
+		bool success = true;
+
+		for( int n=0; n < numLabels; n++ )
+			success &= font->RenderOverlay(imageGPU, imageGPU, width, height, labels[n].first.c_str(), labels[n].second.x, labels[n].second.y, color);
+
+		return success;
+	});
+
+	perLabelResult.Print();
+
+	// every label queued, then one launch
+	benchResult queuedResult("cudaFont::AddText + RenderText", numLabels * 1000.0, "Klabel");
+
+	passed &= queuedResult.Run(iterations, [&]()
+	{
+		for( int n=0; n < numLabels; n++ )
+			font->AddText(labels[n].first.c_str(), labels[n].second.x, labels[n].second.y, color);
+
+		return font->RenderText(imageGPU, imageGPU, width, height);
+	});
+
+	queuedResult.Print();
+
+	benchResult backgroundResult("cudaFont::RenderText (backgrounds)", numLabels * 1000.0, "Klabel");
+
+	passed &= backgroundResult.Run(iterations, [&]()
+	{
+		for( int n=0; n < numLabels; n++ )
+			font->AddText(labels[n].first.c_str(), labels[n].second.x, labels[n].second.y, color, 1.0f, background);
+
+		return font->RenderText(imageGPU, imageGPU, width, height);
+	});
+
+	backgroundResult.Print();
+
+	benchFree(imageCPU);
+	return passed;
+}
+
+
+// benchFont
+static bool benchFont( commandLine& cmdLine )
+{
+	if( !hasRenderers() )
+	{
+		printf("[bench]  cudaFont needs a GPU in this build, skipping it\n");
+		return true;
+	}
+
+	const char* fontPath = cmdLine.GetString("font");
+
+	cudaFont* font = cudaFont::Create(fontPath != NULL ? fontPath : "fontmapA.png");
+
+	if( !font )
+	{
+		printf("[bench]  failed to load the font map (run from the bin directory, or pass --font=<file>)\n");
+		return false;
+	}
+
+	const std::vector<int2> resolutions = benchResolutions(cmdLine);
+
+	bool passed = true;
+
+	for( size_t n=0; n < resolutions.size(); n++ )
+		passed &= benchFontResolution(cmdLine, font, resolutions[n].x, resolutions[n].y);
+
+	delete font;
+	return passed;
+}
+
+BENCH_SUITE("font", "text labels drawn one launch at a time vs. queued into one launch", benchFont);
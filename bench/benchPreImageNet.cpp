@@ -0,0 +1,179 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "bench.h"
+
+#include "cpuKernels.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+// from imageNet.cu
+cudaError_t cudaPreImageNet( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight );
+cudaError_t cudaPreImageNetMean( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value );
+cudaError_t cudaPreImageNetMean( void* input, imageFormat format, size_t inputPitch, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value );
+
+
+// maxDifference
+static float maxDifference( const float* a, const float* b, size_t count )
+{
+	float diff = 0.0f;
+
+	for( size_t n=0; n < count; n++ )
+		diff = fmaxf(diff, fabsf(a[n] - b[n]));
+
+	return diff;
+}
+
+
+// benchPreImageNetResolution
+static bool benchPreImageNetResolution( commandLine& cmdLine, int width, int height )
+{
+	const int iterations = benchIterations(cmdLine);
+
+	int networkSize = cmdLine.GetInt("network-size");
+
+	if( networkSize <= 0 )
+		networkSize = 224;
+
+	const int inputPixels  = width * height;
+	const int outputPixels = networkSize * networkSize;
+	const int outputSize   = outputPixels * 3;	// band-sequential BGR
+
+	float4*  inputCPU  = NULL;
+	float4*  inputGPU  = NULL;
+	uint8_t* packedCPU = NULL;
+	uint8_t* packedGPU = NULL;
+	float*   outputCPU = NULL;
+	float*   outputGPU = NULL;
+
+	float* reference = (float*)malloc(outputSize * sizeof(float));
+
+	if( !reference || !benchAlloc((void**)&inputCPU, (void**)&inputGPU, inputPixels * sizeof(float4)) ||
+	    !benchAlloc((void**)&packedCPU, (void**)&packedGPU, inputPixels * 3) ||
+	    !benchAlloc((void**)&outputCPU, (void**)&outputGPU, outputSize * sizeof(float)) )
+		return false;
+
+	srand(0);
+
+	for( int n=0; n < inputPixels; n++ )
+	{
+		inputCPU[n] = make_float4(rand() % 256, rand() % 256, rand() % 256, 255);
+
+		packedCPU[n * 3 + 0] = inputCPU[n].x;
+		packedCPU[n * 3 + 1] = inputCPU[n].y;
+		packedCPU[n * 3 + 2] = inputCPU[n].z;
+	}
+
+	if( !benchUpload(inputCPU) || !benchUpload(packedCPU) )
+		return false;
+
+	char title[256];
+	sprintf(title, "network pre-processing %ix%i -> %ix%i", width, height, networkSize, networkSize);
+	benchResult::PrintHeader(title);
+
+	const float3 mean = make_float3(104.0069879317889f, 116.66876761696767f, 122.6789143406786f);
+
+	// the kernels sample one input pixel for each output pixel
+	const size_t floatBytes  = outputPixels * (sizeof(float4) + sizeof(float) * 3);
+	const size_t packedBytes = outputPixels * (3 + sizeof(float) * 3);
+
+	bool passed = true;
+
+	// cudaPreImageNet
+	benchResult plainResult("cudaPreImageNet (RGBA32F)", outputPixels);
+	plainResult.SetBytes(floatBytes);
+
+	passed &= plainResult.Run(iterations, [&]()
+	{
+		return CUDA_SUCCESS(BENCH_KERNEL(PreImageNet, inputGPU, width, height, outputGPU, networkSize, networkSize));
+	});
+
+	plainResult.Print();
+
+	if( !benchDownload(outputCPU) )
+		return false;
+
+	cpuPreImageNet(inputCPU, width, height, reference, networkSize, networkSize);
+
+	float diff = maxDifference(outputCPU, reference, outputSize);
+
+	if( diff > 0.01f )
+	{
+		printf("[bench]  cudaPreImageNet differs from the CPU version by %f\n", diff);
+		passed = false;
+	}
+
+	// cudaPreImageNetMean
+	benchResult meanResult("cudaPreImageNetMean (RGBA32F)", outputPixels);
+	meanResult.SetBytes(floatBytes);
+
+	passed &= meanResult.Run(iterations, [&]()
+	{
+		return CUDA_SUCCESS(BENCH_KERNEL(PreImageNetMean, inputGPU, width, height, outputGPU, networkSize, networkSize, mean));
+	});
+
+	meanResult.Print();
+
+	if( !benchDownload(outputCPU) )
+		return false;
+
+	cpuPreImageNetMean(inputCPU, width, height, reference, networkSize, networkSize, mean);
+
+	diff = maxDifference(outputCPU, reference, outputSize);
+
+	if( diff > 0.01f )
+	{
+		printf("[bench]  cudaPreImageNetMean differs from the CPU version by %f\n", diff);
+		passed = false;
+	}
+
+	// cudaPreImageNetMean, straight from 8-bit camera frames
+	benchResult packedResult("cudaPreImageNetMean (RGB8)", outputPixels);
+	packedResult.SetBytes(packedBytes);
+
+	passed &= packedResult.Run(iterations, [&]()
+	{
+		return CUDA_SUCCESS(BENCH_KERNEL(PreImageNetMean, packedGPU, FORMAT_RGB8, width * 3, width, height, outputGPU, networkSize, networkSize, mean));
+	});
+
+	packedResult.Print();
+
+	if( !benchDownload(outputCPU) )
+		return false;
+
+	cpuPreImageNetMean(packedCPU, FORMAT_RGB8, width * 3, width, height, reference, networkSize, networkSize, mean);
+
+	diff = maxDifference(outputCPU, reference, outputSize);
+
+	if( diff > 0.01f )
+	{
+		printf("[bench]  cudaPreImageNetMean (RGB8) differs from the CPU version by %f\n", diff);
+		passed = false;
+	}
+
+	benchFree(inputCPU);
+	benchFree(packedCPU);
+	benchFree(outputCPU);
+	free(reference);
+
+	return passed;
+}
+
+
+// benchPreImageNet
+static bool benchPreImageNet( commandLine& cmdLine )
+{
+	const std::vector<int2> resolutions = benchResolutions(cmdLine);
+
+	bool passed = true;
+
+	for( size_t n=0; n < resolutions.size(); n++ )
+		passed &= benchPreImageNetResolution(cmdLine, resolutions[n].x, resolutions[n].y);
+
+	return passed;
+}
+
+BENCH_SUITE("preimagenet", "resizing frames into band-sequential BGR network inputs, with mean subtraction", benchPreImageNet);
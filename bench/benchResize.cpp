@@ -0,0 +1,246 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "bench.h"
+
+#include "cudaResize.h"
+#include "cpuKernels.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+
+// maxDifference
+static float maxDifference( const float4* a, size_t pitchA, const float4* b, size_t pitchB, int width, int height )
+{
+	float diff = 0.0f;
+
+	for( int y=0; y < height; y++ )
+	{
+		const float4* rowA = resizeRow(a, pitchA, y);
+		const float4* rowB = resizeRow(b, pitchB, y);
+
+		for( int x=0; x < width; x++ )
+		{
+			diff = fmaxf(diff, fabsf(rowA[x].x - rowB[x].x));
+			diff = fmaxf(diff, fabsf(rowA[x].y - rowB[x].y));
+			diff = fmaxf(diff, fabsf(rowA[x].z - rowB[x].z));
+			diff = fmaxf(diff, fabsf(rowA[x].w - rowB[x].w));
+		}
+	}
+
+	return diff;
+}
+
+
+// benchResizeResolution
+static bool benchResizeResolution( commandLine& cmdLine, int width, int height )
+{
+	const int iterations = benchIterations(cmdLine);
+
+	// the input rows are padded, to exercise the pitch
+	const size_t inputPitch = width * sizeof(float4) + 256;
+
+	float4* inputCPU = NULL;
+	float4* inputGPU = NULL;
+
+	if( !benchAlloc((void**)&inputCPU, (void**)&inputGPU, inputPitch * height) )
+		return false;
+
+	for( int y=0; y < height; y++ )
+	{
+		float4* row = resizeRow(inputCPU, inputPitch, y);
+
+		for( int x=0; x < width; x++ )
+			row[x] = make_float4((x * 255) / width, (y * 255) / height, ((x ^ y) * 7) & 0xFF, 255);
+	}
+
+	if( !benchUpload(inputCPU) )
+		return false;
+
+	// many small crops (like every detection in a frame) are resized at the end
+	int numCrops = cmdLine.GetInt("crops");
+
+	if( numCrops <= 0 )
+		numCrops = 64;
+
+	const int cropWidth  = 64;
+	const int cropHeight = 128;
+
+	// outputs from the kernels, and from the CPU versions to validate them against
+	const int maxOutput = std::max(width * height, numCrops * cropWidth * cropHeight);
+
+	float4* outputCPU = NULL;
+	float4* outputGPU = NULL;
+	float4* reference = (float4*)malloc(maxOutput * sizeof(float4));
+
+	if( !reference || !benchAlloc((void**)&outputCPU, (void**)&outputGPU, maxOutput * sizeof(float4)) )
+		return false;
+
+	bool passed = true;
+
+	const char* filterNames[] = { "nearest", "linear", "area" };
+
+	// the whole image scaled down, a crop scaled down (like a detection into a network), a crop scaled up,
+	// and a tall crop scaled down vertically but up horizontally (like a standing person into a square network)
+	struct resizeCase
+	{
+		const char* name;
+		int4 roi;
+		int  outputWidth;
+		int  outputHeight;
+	};
+
+	const resizeCase cases[] = {
+		{ "full image -> 1/3", make_int4(0, 0, width, height), width / 3, height / 3 },
+		{ "crop -> 224x224", make_int4(width / 4, height / 5, width / 3, height / 2), 224, 224 },
+		{ "crop -> 2x", make_int4(width / 2, height / 2, width / 8, height / 8), width / 4, height / 4 },
+		{ "tall crop -> 224x224", make_int4(width / 2, 0, std::min(100, width / 2), height), 224, 224 }
+	};
+
+	for( int c=0; c < 4; c++ )
+	{
+		const resizeCase& rc = cases[c];
+
+		char title[256];
+		sprintf(title, "resize %ix%i %s  (%ix%i from %ix%i)", width, height, rc.name, rc.outputWidth, rc.outputHeight, rc.roi.z, rc.roi.w);
+		benchResult::PrintHeader(title);
+
+		const size_t outputPitch = rc.outputWidth * sizeof(float4);
+		const int    pixels      = rc.outputWidth * rc.outputHeight;
+
+		for( int f=RESIZE_NEAREST; f <= RESIZE_AREA; f++ )
+		{
+			char name[64];
+			sprintf(name, "cudaResizeRGBA (%s)", filterNames[f]);
+			benchResult result(name, pixels);
+			result.SetBytes(pixels * sizeof(float4) * 2);	// each output pixel is written, and about one input pixel read for it
+
+			passed &= result.Run(iterations, [&]()
+			{
+				return CUDA_SUCCESS(BENCH_KERNEL(ResizeRGBA, inputGPU, inputPitch, width, height, outputGPU, outputPitch, rc.outputWidth, rc.outputHeight, (resizeFilter)f, &rc.roi));
+			});
+
+			result.Print();
+
+			if( !benchDownload(outputCPU) )
+				return false;
+
+			cpuResizeRGBA(inputCPU, inputPitch, width, height, reference, outputPitch, rc.outputWidth, rc.outputHeight, (resizeFilter)f, &rc.roi);
+
+			const float diff = maxDifference(outputCPU, outputPitch, reference, outputPitch, rc.outputWidth, rc.outputHeight);
+
+			if( diff > 0.01f )
+			{
+				printf("[bench]  %s differs from the CPU version by %f\n", name, diff);
+				passed = false;
+			}
+		}
+	}
+
+
+	// the crops, one launch vs. one launch per crop
+	resizeROI* roisCPU = NULL;
+	resizeROI* roisGPU = NULL;
+
+	if( !benchAlloc((void**)&roisCPU, (void**)&roisGPU, numCrops * sizeof(resizeROI)) )
+		return false;
+
+	srand(0);
+
+	for( int n=0; n < numCrops; n++ )
+	{
+		resizeROI& r = roisCPU[n];
+
+		r.roi.z = 32 + rand() % (width / 4);
+		r.roi.w = 64 + rand() % (height / 3);
+		r.roi.x = rand() % (width - r.roi.z);
+		r.roi.y = rand() % (height - r.roi.w);
+
+		r.input        = inputGPU;
+		r.inputPitch   = inputPitch;
+		r.output       = outputGPU + n * cropWidth * cropHeight;
+		r.outputPitch  = cropWidth * sizeof(float4);
+		r.outputWidth  = cropWidth;
+		r.outputHeight = cropHeight;
+	}
+
+	if( !benchUpload(roisCPU) )
+		return false;
+
+	char title[256];
+	sprintf(title, "resize %ix%i %i crops -> %ix%i (linear)", width, height, numCrops, cropWidth, cropHeight);
+	benchResult::PrintHeader(title);
+
+	const int cropPixels = numCrops * cropWidth * cropHeight;
+
+	benchResult singleResult("cudaResizeRGBA per crop", cropPixels);
+	benchResult batchResult("cudaResizeBatchRGBA", cropPixels);
+
+	singleResult.SetBytes(cropPixels * sizeof(float4) * 2);
+	batchResult.SetBytes(cropPixels * sizeof(float4) * 2);
+
+	passed &= singleResult.Run(iterations, [&]()
+	{
+		bool success = true;
+
+		for( int i=0; i < numCrops; i++ )
+		{
+			const resizeROI& r = roisCPU[i];
+			success &= CUDA_SUCCESS(BENCH_KERNEL(ResizeRGBA, r.input, r.inputPitch, width, height, r.output, r.outputPitch, r.outputWidth, r.outputHeight, RESIZE_LINEAR, &r.roi));
+		}
+
+		return success;
+	});
+
+	passed &= batchResult.Run(iterations, [&]()
+	{
+		return CUDA_SUCCESS(BENCH_KERNEL(ResizeBatchRGBA, roisGPU, numCrops, cropWidth, cropHeight, RESIZE_LINEAR));
+	});
+
+	singleResult.Print();
+	batchResult.Print();
+
+	if( !benchDownload(outputCPU) )
+		return false;
+
+	// the batch has to match the crops resized one at a time
+	for( int i=0; i < numCrops; i++ )
+	{
+		const resizeROI& r = roisCPU[i];
+		cpuResizeRGBA(inputCPU, inputPitch, width, height, reference + i * cropWidth * cropHeight, r.outputPitch, cropWidth, cropHeight, RESIZE_LINEAR, &r.roi);
+	}
+
+	const float batchDiff = maxDifference(outputCPU, cropWidth * sizeof(float4), reference, cropWidth * sizeof(float4), cropWidth, cropHeight * numCrops);
+
+	if( batchDiff > 0.01f )
+	{
+		printf("[bench]  cudaResizeBatchRGBA differs from the CPU version by %f\n", batchDiff);
+		passed = false;
+	}
+
+	benchFree(roisCPU);
+	benchFree(outputCPU);
+	benchFree(inputCPU);
+	free(reference);
+
+	return passed;
+}
+
+
+// benchResize
+static bool benchResize( commandLine& cmdLine )
+{
+	const std::vector<int2> resolutions = benchResolutions(cmdLine);
+
+	bool passed = true;
+
+	for( size_t n=0; n < resolutions.size(); n++ )
+		passed &= benchResizeResolution(cmdLine, resolutions[n].x, resolutions[n].y);
+
+	return passed;
+}
+
+BENCH_SUITE("resize", "nearest/bilinear/area resize with pitch and ROIs, and batched crops", benchResize);
@@ -4,7 +4,7 @@
  
 #include "detectNet.h"
 
-#include "cudaMappedMemory.h"
+#include "cudaAllocator.h"
 #include "cudaOverlay.h"
 #include "cudaResize.h"
 
@@ -23,13 +23,27 @@ detectNet::detectNet() : tensorNet()
 	
 	mClassColors[0] = NULL;	// cpu ptr
 	mClassColors[1] = NULL; // gpu ptr
+
+	mOverlay = NULL;
 }
 
 
 // destructor
 detectNet::~detectNet()
 {
-	
+	if( mClassColors[0] != NULL )
+	{
+		cudaAllocator::Get(MEM_MAPPED)->Free(mClassColors[0]);
+
+		mClassColors[0] = NULL;
+		mClassColors[1] = NULL;
+	}
+
+	if( mOverlay != NULL )
+	{
+		delete mOverlay;
+		mOverlay = NULL;
+	}
 }
 
 
@@ -57,7 +71,7 @@ detectNet* detectNet::Create( const char* prototxt, const char* model, const cha
 	output_blobs.push_back(coverage_blob);
 	output_blobs.push_back(bbox_blob);
 	
-	if( !net->LoadNetwork(prototxt, model, mean_binary, input_blob, output_blobs) )
+	if( !net->LoadNetwork(prototxt, model, mean_binary, input_blob, output_blobs, maxBatchSize) )
 	{
 		printf("detectNet -- failed to initialize.\n");
 		return NULL;
@@ -65,7 +79,7 @@ detectNet* detectNet::Create( const char* prototxt, const char* model, const cha
 	
 	const uint32_t numClasses = net->GetNumClasses();
 	
-	if( !cudaAllocMapped((void**)&net->mClassColors[0], (void**)&net->mClassColors[1], numClasses * sizeof(float4)) )
+	if( !cudaAllocator::Get(MEM_MAPPED)->Alloc((void**)&net->mClassColors[0], (void**)&net->mClassColors[1], numClasses * sizeof(float4)) )
 		return NULL;
 	
 	for( uint32_t n=0; n < numClasses; n++ )
@@ -179,6 +193,9 @@ detectNet* detectNet::Create( int argc, char** argv )
 	
 	
 cudaError_t cudaPreImageNetMean( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value );
+cudaError_t cudaPreImageNetMean( void* input, imageFormat format, size_t inputPitch, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value );
+
+#define DETECTNET_MEAN_PIXEL make_float3(104.0069879317889f, 116.66876761696767f, 122.6789143406786f)
 
 
 
@@ -235,35 +252,98 @@ bool detectNet::Detect( float* rgba, uint32_t width, uint32_t height, float* bou
 		return false;
 	}
 
-	
-	// downsample and convert to band-sequential BGR
-	if( CUDA_FAILED(cudaPreImageNetMean((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight,
-								  make_float3(104.0069879317889f, 116.66876761696767f, 122.6789143406786f))) )
+	return Detect(&rgba, &width, &height, 1, &boundingBoxes, numBoxes, confidence != NULL ? &confidence : NULL);
+}
+
+
+// Detect
+bool detectNet::Detect( float** rgba, const uint32_t* width, const uint32_t* height, uint32_t batchSize, float** boundingBoxes, int* numBoxes, float** confidence )
+{
+	if( !rgba || !width || !height || !boundingBoxes || !numBoxes || batchSize == 0 || batchSize > mMaxBatchSize )
 	{
-		printf("detectNet::Classify() -- cudaPreImageNetMean failed\n");
+		printf("detectNet::Detect( 0x%p, %u ) -> invalid parameters\n", rgba, batchSize);
 		return false;
 	}
-	
+
+	// downsample and convert to band-sequential BGR, one network input plane per image
+	const size_t inputStride = mWidth * mHeight * 3;
+
+	for( uint32_t b=0; b < batchSize; b++ )
+	{
+		if( !rgba[b] || width[b] == 0 || height[b] == 0 || !boundingBoxes[b] || numBoxes[b] < 1 )
+		{
+			printf("detectNet::Detect( 0x%p, %u, %u ) -> invalid image %u in batch\n", rgba[b], width[b], height[b], b);
+			return false;
+		}
+
+		if( CUDA_FAILED(cudaPreImageNetMean((float4*)rgba[b], width[b], height[b], mInputCUDA + b * inputStride, mWidth, mHeight, DETECTNET_MEAN_PIXEL)) )
+		{
+			printf("detectNet::Detect() -- cudaPreImageNetMean failed\n");
+			return false;
+		}
+	}
+
+	return processBatch(batchSize, width, height, boundingBoxes, numBoxes, confidence);
+}
+
+
+// Detect
+bool detectNet::Detect( void* image, imageFormat format, uint32_t width, uint32_t height, size_t pitch, float* boundingBoxes, int* numBoxes, float* confidence )
+{
+	if( !image || width == 0 || height == 0 || imageFormatChannels(format) == 0 || !boundingBoxes || !numBoxes || *numBoxes < 1 )
+	{
+		printf("detectNet::Detect( 0x%p, %s, %u, %u ) -> invalid parameters\n", image, imageFormatToStr(format), width, height);
+		return false;
+	}
+
+	// convert, downsample and subtract the mean in one pass
+	if( CUDA_FAILED(cudaPreImageNetMean(image, format, pitch, width, height, mInputCUDA, mWidth, mHeight, DETECTNET_MEAN_PIXEL)) )
+	{
+		printf("detectNet::Detect() -- cudaPreImageNetMean (%s) failed\n", imageFormatToStr(format));
+		return false;
+	}
+
+	return processBatch(1, &width, &height, &boundingBoxes, numBoxes, confidence != NULL ? &confidence : NULL);
+}
+
+
+// processBatch
+bool detectNet::processBatch( uint32_t batchSize, const uint32_t* width, const uint32_t* height, float** boundingBoxes, int* numBoxes, float** confidence )
+{
 	// process with GIE
 	void* inferenceBuffers[] = { mInputCUDA, mOutputs[OUTPUT_CVG].CUDA, mOutputs[OUTPUT_BBOX].CUDA };
 	
-	if( !mContext->execute(1, inferenceBuffers) )
+	if( !executeNetwork(batchSize, inferenceBuffers) )
 	{
-		printf(LOG_GIE "detectNet::Classify() -- failed to execute tensorRT context\n");
-		*numBoxes = 0;
+		printf(LOG_GIE "detectNet::Detect() -- failed to execute tensorRT context\n");
+
+		for( uint32_t b=0; b < batchSize; b++ )
+			numBoxes[b] = 0;
+
 		return false;
 	}
 	
 	PROFILER_REPORT();
 
-	// cluster detection bboxes
-	float* net_cvg   = mOutputs[OUTPUT_CVG].CPU;
-	float* net_rects = mOutputs[OUTPUT_BBOX].CPU;
-	
+	// cluster the detections of each image
+	for( uint32_t b=0; b < batchSize; b++ )
+		clusterDetections(b, width[b], height[b], boundingBoxes[b], &numBoxes[b], confidence != NULL ? confidence[b] : NULL);
+
+	return true;
+}
+
+
+// clusterDetections
+void detectNet::clusterDetections( uint32_t batchIndex, uint32_t width, uint32_t height, float* boundingBoxes, int* numBoxes, float* confidence )
+{
 	const int ow  = mOutputs[OUTPUT_BBOX].dims.w;		// number of columns in bbox grid in X dimension
 	const int oh  = mOutputs[OUTPUT_BBOX].dims.h;		// number of rows in bbox grid in Y dimension
 	const int owh = ow * oh;							// total number of bbox in grid
 	const int cls = GetNumClasses();					// number of object classes in coverage map
+
+	// the outputs of each image in the batch follow one another
+	const float* net_cvg   = mOutputs[OUTPUT_CVG].CPU + batchIndex * (cls * owh);
+	const float* net_rects = mOutputs[OUTPUT_BBOX].CPU + batchIndex * (mOutputs[OUTPUT_BBOX].dims.c * owh);
 	
 	const float cell_width  = /*width*/ mInputDims.w / ow;
 	const float cell_height = /*height*/ mInputDims.h / oh;
@@ -344,7 +424,6 @@ bool detectNet::Detect( float* rgba, uint32_t width, uint32_t height, float* bou
 #else
 	*numBoxes = 0;
 #endif
-	return true;
 }
 
 
@@ -354,17 +433,48 @@ bool detectNet::DrawBoxes( float* input, float* output, uint32_t width, uint32_t
 	if( !input || !output || width == 0 || height == 0 || !boundingBoxes || numBoxes < 1 || classIndex < 0 || classIndex >= GetNumClasses() )
 		return false;
 	
-	const float4 color = make_float4( mClassColors[0][classIndex*4+0], 
-									  mClassColors[0][classIndex*4+1],
-									  mClassColors[0][classIndex*4+2],
-									  mClassColors[0][classIndex*4+3] );
+	if( !mOverlay && !(mOverlay = cudaOverlay::Create()) )
+		return false;
+
+	mOverlay->AddBoxes(boundingBoxes, numBoxes, getClassColor(classIndex));
 	
-	printf("draw boxes  %i  %i   %f %f %f %f\n", numBoxes, classIndex, color.x, color.y, color.z, color.w);
+	return mOverlay->Render((float4*)input, (float4*)output, width, height);
+}
+
+
+// DrawBoxes
+bool detectNet::DrawBoxes( float* input, float* output, uint32_t width, uint32_t height, const float* boundingBoxes, const float* confidence, int numBoxes, float thickness )
+{
+	if( !input || !output || width == 0 || height == 0 || !boundingBoxes || !confidence || numBoxes < 1 )
+		return false;
 	
-	if( CUDA_FAILED(cudaRectOutlineOverlay((float4*)input, (float4*)output, width, height, (float4*)boundingBoxes, numBoxes, color)) )
+	if( !mOverlay && !(mOverlay = cudaOverlay::Create()) )
 		return false;
+
+	const int numClasses = GetNumClasses();
+
+	for( int n=0; n < numBoxes; n++ )
+	{
+		const int    classIndex = confidence[n * 2 + 1];
+		const float* bb         = boundingBoxes + n * 4;
+
+		if( classIndex < 0 || classIndex >= numClasses )
+			continue;
+
+		mOverlay->AddBox(make_float4(bb[0], bb[1], bb[2], bb[3]), getClassColor(classIndex), thickness);
+	}
 	
-	return true;
+	return mOverlay->Render((float4*)input, (float4*)output, width, height);
+}
+
+
+// getClassColor
+float4 detectNet::getClassColor( int classIndex ) const
+{
+	return make_float4( mClassColors[0][classIndex*4+0], 
+					mClassColors[0][classIndex*4+1],
+					mClassColors[0][classIndex*4+2],
+					mClassColors[0][classIndex*4+3] );
 }
 	
 
@@ -7,6 +7,10 @@
 
 
 #include "tensorNet.h"
+#include "imageFormat.h"
+
+
+class cudaOverlay;
 
 
 /**
@@ -96,13 +100,50 @@ public:
 	 * @returns True if the image was processed without error, false if an error was encountered.
 	 */
 	bool Detect( float* rgba, uint32_t width, uint32_t height, float* boundingBoxes, int* numBoxes, float* confidence=NULL );
+
+	/**
+	 * Detect object locations in a batch of RGBA images (e.g. one from each camera) with one pass through the network.
+	 * @param rgba array of float4 RGBA input images in CUDA device memory.
+	 * @param width array containing the width of each input image in pixels.
+	 * @param height array containing the height of each input image in pixels.
+	 * @param batchSize number of images in the batch (up to GetMaxBatchSize())
+	 * @param boundingBoxes array with the bounding box array of each image.
+	 * @param numBoxes array with the maximum number of boxes for each image, set to the number detected upon return.
+	 * @param confidence optional array with a float2 (confidence, class) array for each image (entries may be NULL).
+	 * @returns True if the batch was processed without error, false if an error was encountered.
+	 */
+	bool Detect( float** rgba, const uint32_t* width, const uint32_t* height, uint32_t batchSize, 
+			   float** boundingBoxes, int* numBoxes, float** confidence=NULL );
+
+	/**
+	 * Detect object locations in a packed 8-bit image, such as the BGR data of an OpenCV cv::Mat.
+	 * The image is converted, resized and mean-subtracted into the network input by one kernel,
+	 * so it doesn't need to be converted to float4 RGBA beforehand.
+	 * @param image packed 8-bit input image in CUDA device (or mapped) memory.
+	 * @param format layout of the pixels (e.g. FORMAT_BGR8 for cv::Mat)
+	 * @param pitch size in bytes of each row of the image, or 0 if the rows are tightly packed.
+	 * @returns True if the image was processed without error, false if an error was encountered.
+	 * @see Detect() for the other parameters.
+	 */
+	bool Detect( void* image, imageFormat format, uint32_t width, uint32_t height, size_t pitch,
+			   float* boundingBoxes, int* numBoxes, float* confidence=NULL );
 	
 	/**
-	 * Draw bounding boxes in the RGBA image.
+	 * Draw bounding boxes in the RGBA image, filled with the color of one class.
 	 * @param input float4 RGBA input image in CUDA device memory.
 	 * @param output float4 RGBA output image in CUDA device memory.
+	 * @param boundingBoxes boxes in CPU-accessible (i.e. mapped) memory, as output by Detect().
 	 */
 	bool DrawBoxes( float* input, float* output, uint32_t width, uint32_t height, const float* boundingBoxes, int numBoxes, int classIndex=0 );
+
+	/**
+	 * Draw bounding boxes in the RGBA image, each in the color of its class, with one kernel launch.
+	 * @param boundingBoxes boxes in CPU-accessible (i.e. mapped) memory, as output by Detect().
+	 * @param confidence the (confidence, class) pair of each box, as output by Detect().
+	 * @param thickness width of the outlines in pixels, or 0 to fill the boxes.
+	 * @see DrawBoxes() for the other parameters.
+	 */
+	bool DrawBoxes( float* input, float* output, uint32_t width, uint32_t height, const float* boundingBoxes, const float* confidence, int numBoxes, float thickness=0.0f );
 	
 	/**
 	 * Retrieve the minimum threshold for detection.
@@ -136,9 +177,20 @@ protected:
 
 	// constructor
 	detectNet();
+
+	// run the network over the batch in mInputCUDA and cluster the output of each image
+	bool processBatch( uint32_t batchSize, const uint32_t* width, const uint32_t* height, float** boundingBoxes, int* numBoxes, float** confidence );
+
+	// cluster the network output for one image in the batch into bounding boxes
+	void clusterDetections( uint32_t batchIndex, uint32_t width, uint32_t height, float* boundingBoxes, int* numBoxes, float* confidence );
+	
+	// retrieve the color of a class as a float4
+	float4 getClassColor( int classIndex ) const;
 	
 	float  mCoverageThreshold;
 	float* mClassColors[2];
+
+	cudaOverlay* mOverlay;
 };
 
 
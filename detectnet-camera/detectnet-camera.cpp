@@ -4,16 +4,21 @@
 
 #include "glDisplay.h"
 #include "glTexture.h"
+#include "gstEncoder.h"
+#include "commandLine.h"
 
 #include <stdio.h>
 #include <signal.h>
 #include <unistd.h>
 
 #include "cudaMappedMemory.h"
-#include "cudaNormalize.h"
+#include "cudaRGB.h"
 #include "cudaFont.h"
 
 #include "detectNet.h"
+#include "framePipeline.h"
+
+#include <vector>
 
 #include "opencv2/imgproc.hpp"
 #include "opencv2/core.hpp"
@@ -36,7 +41,6 @@ void sig_handler(int signo)
 int main( int argc, char** argv )
 {
 	Mat frame;
-	Mat rgbaFrame,rgbaFrameF;
 
 	printf("detectnet-camera\n  args (%i):  ", argc);
 
@@ -48,6 +52,13 @@ int main( int argc, char** argv )
 	if( signal(SIGINT, sig_handler) == SIG_ERR )
 		printf("\ncan't catch SIGINT\n");
 
+	// --output=<file or rtp://host:port> encodes the annotated frames (e.g. when there's no display),
+	// as H.264 unless --mjpeg is given.  The stream to capture is the last argument.
+	commandLine cmdLine(argc, argv);
+
+	const char* output = cmdLine.GetString("output");
+	const gstEncoder::Codec codec = cmdLine.GetFlag("mjpeg") ? gstEncoder::CODEC_MJPEG : gstEncoder::CODEC_H264;
+
 	VideoCapture capture(argv[argc-1]);
 
 	if (!capture.isOpened()) {
@@ -82,45 +93,66 @@ int main( int argc, char** argv )
 
 
 	/*
-	 * allocate memory for output bounding boxes and class confidence
+	 * per-frame buffers for the image, output bounding boxes and the (confidence, class)
+	 * pair of each box, one for each slot of the pipeline
 	 */
 	const uint32_t maxBoxes = net->GetMaxBoundingBoxes();		printf("maximum bounding boxes:  %u\n", maxBoxes);
-	const uint32_t classes  = net->GetNumClasses();
-	
-	float* imgCPU  = NULL;
-	float* imgCUDA = NULL;
-	float* bbCPU    = NULL;
-	float* bbCUDA   = NULL;
-	float* confCPU  = NULL;
-	float* confCUDA = NULL;
-	
-	if( !cudaAllocMapped((void**)&bbCPU, (void**)&bbCUDA, maxBoxes * sizeof(float4)) ||
-		!cudaAllocMapped((void**)&imgCPU, (void**)&imgCUDA, frame.cols * frame.rows * sizeof(float4)) ||
-	    !cudaAllocMapped((void**)&confCPU, (void**)&confCUDA, maxBoxes * classes * sizeof(float)) )
+	
+	const uint32_t imgWidth  = frame.cols;
+	const uint32_t imgHeight = frame.rows;
+	
+	struct frameSlot
 	{
-		printf("detectnet-console:  failed to alloc output memory\n");
-		return 0;
-	}
+		Mat      frame;		// wraps imgCPU unless the backend returned its own buffer
+		Mat      mapped;		// BGR frame in mapped memory, read directly by detectNet
+		uint8_t* imgCPU;
+		uint8_t* imgCUDA;
+		float* bbCPU;
+		float* bbCUDA;
+		float* confCPU;
+		float* confCUDA;
+		int    numBoundingBoxes;
+	};
+	
+	std::vector<frameSlot> slots;
 	
 
 	/*
 	 * create openGL window
 	 */
-	 glDisplay* display = NULL; glDisplay::Create();
-	 glTexture* texture = NULL;
+	glDisplay* display = glDisplay::Create();
+	glTexture* texture = NULL;
 	
 	if( !display ) {
 		printf("\ndetectnet-camera:  failed to create openGL display\n");
 	}
 	else
 	{
-		texture = glTexture::Create(frame.cols, frame.rows, GL_RGBA32F_ARB/*GL_RGBA8*/);
+		texture = glTexture::Create(imgWidth, imgHeight, GL_RGBA8);
 
 		if( !texture )
 			printf("detectnet-camera:  failed to create openGL texture\n");
 	}
 	
 	
+	/*
+	 * create video encoder
+	 */
+	gstEncoder* encoder = NULL;
+
+	if( output != NULL )
+	{
+		encoder = gstEncoder::Create(codec, output, imgWidth, imgHeight);
+
+		if( !encoder || !encoder->Open() )
+		{
+			printf("detectnet-camera:  failed to create video encoder for %s\n", output);
+			delete encoder;
+			encoder = NULL;
+		}
+	}
+	
+	
 	/*
 	 * create font
 	 */
@@ -128,81 +160,104 @@ int main( int argc, char** argv )
 	
 	
 	/*
-	 * processing loop
+	 * capture stage:  read the next frame into mapped memory
 	 */
-	float confidence = 0.0f;
-	
-	while( !signal_recieved )
+	auto captureFrame = [&]( uint32_t slot, frameStamp* stamp ) -> bool
 	{
+		frameSlot& s = slots[slot];
 		
-		// get the latest frame
-		if (!capture.read(frame)) 
+		s.frame = s.mapped;
+
+		if( !capture.read(s.frame) )
+		{
 			printf("\ndetectnet-camera:  failed to capture frame\n");
-		cv::cvtColor(frame, rgbaFrame, CV_BGR2RGBA, 4);
-		rgbaFrame.convertTo(rgbaFrameF,CV_32F);
+			signal_recieved = true;	// end of the stream
+			return false;
+		}
+		
+		if( s.frame.data != s.mapped.data )
+			s.frame.copyTo(s.mapped);
 
-		// convert to RGBA
-		float* imgRGBA = rgbaFrameF.ptr<float>();
+		s.frame = s.mapped;
+		return true;
+	};
+	
+	
+	/*
+	 * inference stage:  detect objects with detectNet
+	 */
+	auto detect = [&]( uint32_t slot, const frameStamp& stamp ) -> bool
+	{
+		frameSlot& s = slots[slot];
+		s.numBoundingBoxes = maxBoxes;
+		
+		if( !net->Detect(s.imgCUDA, FORMAT_BGR8, imgWidth, imgHeight, s.mapped.step, s.bbCPU, &s.numBoundingBoxes, s.confCPU) )
+		{
+			printf("detectnet-camera:  failed to detect objects\n");
+			return false;
+		}
 		
-		// classify image with detectNet
-		int numBoundingBoxes = maxBoxes;
+		return true;
+	};
+	
+	
+	/*
+	 * presentation stage:  print and draw the bounding boxes
+	 */
+	auto present = [&]( uint32_t slot, const frameStamp& stamp ) -> bool
+	{
+		frameSlot& s = slots[slot];
+		const int numBoundingBoxes = s.numBoundingBoxes;
 		
-		for (int j=0;j<rgbaFrameF.rows*rgbaFrameF.cols*4;j++){
-			imgCPU[j] = imgRGBA[j];
-		} 
-		waitKey(30);
+		printf("%i bounding boxes detected\n", numBoundingBoxes);
 
-		printf("\n\n imgRGBA %d, imgCPU %d, width %d, height %d, bbCPU %d \n\n",imgRGBA,imgCPU,rgbaFrameF.cols,rgbaFrameF.rows,bbCPU);
-		if(net->Detect((float*)imgCPU, frame.cols, frame.rows, bbCPU, &numBoundingBoxes, confCPU))
+		int lastClass = 0;
+		int lastStart = 0;
+		
+		for( int n=0; n < numBoundingBoxes; n++ )
 		{
-			printf("%i bounding boxes detected\n", numBoundingBoxes);
-
-	
-			int lastClass = 0;
-			int lastStart = 0;
+			const int nc = s.confCPU[n*2+1];
+			float* bb = s.bbCPU + (n * 4);
+			
+			printf("bounding box %i   (%f, %f)  (%f, %f)  w=%f  h=%f\n", n, bb[0], bb[1], bb[2], bb[3], bb[2] - bb[0], bb[3] - bb[1]); 
 			
-			for( int n=0; n < numBoundingBoxes; n++ )
+			if( nc != lastClass || n == (numBoundingBoxes - 1) )
 			{
-				const int nc = confCPU[n*2+1];
-				float* bb = bbCPU + (n * 4);
-				
-				printf("bounding box %i   (%f, %f)  (%f, %f)  w=%f  h=%f\n", n, bb[0], bb[1], bb[2], bb[3], bb[2] - bb[0], bb[3] - bb[1]); 
-				
-				if( nc != lastClass || n == (numBoundingBoxes - 1) )
-				{
-					Scalar color = Scalar( 255, 0, 0 );
-					rectangle(frame,Point(bb[0],bb[1]),Point(bb[2],bb[3]),color);
-					// if( !net->DrawBoxes((float*)imgCPU, (float*)imgRGBA, frame.cols, frame.rows, 
-					// 	                        bbCUDA + (lastStart * 4), (n - lastStart) + 1, lastClass) )
-					// 	printf("detectnet-console:  failed to draw boxes\n");
-						
-					lastClass = nc;
-					lastStart = n;
-
-					CUDA(cudaDeviceSynchronize());
-				}
+				Scalar color = Scalar( 255, 0, 0 );
+				rectangle(s.frame,Point(bb[0],bb[1]),Point(bb[2],bb[3]),color);
+				// if( !net->DrawBoxes((float*)imgCPU, (float*)imgRGBA, frame.cols, frame.rows, 
+				// 	                        bbCUDA + (lastStart * 4), (n - lastStart) + 1, lastClass) )
+				// 	printf("detectnet-console:  failed to draw boxes\n");
+					
+				lastClass = nc;
+				lastStart = n;
 			}
+		}
 
-			if (numBoundingBoxes > 0) {
-				imwrite("original.jpg",frame);
-			}
-		
-			/*if( font != NULL )
-			{
-				char str[256];
-				sprintf(str, "%05.2f%% %s", confidence * 100.0f, net->GetClassDesc(img_class));
-				
-				font->RenderOverlay((float4*)imgRGBA, (float4*)imgRGBA, camera->GetWidth(), camera->GetHeight(),
-								    str, 10, 10, make_float4(255.0f, 255.0f, 255.0f, 255.0f));
-			}*/
+		if (numBoundingBoxes > 0) {
+			imwrite("original.jpg",s.frame);
+		}
+
+		// encode the frame with the boxes drawn (dropped if the encoder is behind), it's
+		// converted before Encode() returns so the slot can go straight back to capture
+		if( encoder != NULL )
+			encoder->Encode(s.imgCUDA, FORMAT_BGR8, s.mapped.step);
+	
+		/*if( font != NULL )
+		{
+			char str[256];
+			sprintf(str, "%05.2f%% %s", confidence * 100.0f, net->GetClassDesc(img_class));
 			
-			if( display != NULL )
-			{
-				char str[256];
-				sprintf(str, "TensorRT build %x | %s | %04.1f FPS", NV_GIE_VERSION, net->HasFP16() ? "FP16" : "FP32", display->GetFPS());
-				//sprintf(str, "GIE build %x | %s | %04.1f FPS | %05.2f%% %s", NV_GIE_VERSION, net->GetNetworkName(), display->GetFPS(), confidence * 100.0f, net->GetClassDesc(img_class));
-				display->SetTitle(str);	
-			}	
+			font->RenderOverlay((float4*)imgRGBA, (float4*)imgRGBA, camera->GetWidth(), camera->GetHeight(),
+							    str, 10, 10, make_float4(255.0f, 255.0f, 255.0f, 255.0f));
+		}*/
+		
+		if( display != NULL )
+		{
+			char str[256];
+			sprintf(str, "TensorRT build %x | %s | %04.1f FPS", NV_GIE_VERSION, net->HasFP16() ? "FP16" : "FP32", display->GetFPS());
+			//sprintf(str, "GIE build %x | %s | %04.1f FPS | %05.2f%% %s", NV_GIE_VERSION, net->GetNetworkName(), display->GetFPS(), confidence * 100.0f, net->GetClassDesc(img_class));
+			display->SetTitle(str);	
 		}	
 
 
@@ -214,17 +269,12 @@ int main( int argc, char** argv )
 
 			if( texture != NULL )
 			{
-				// rescale image pixel intensities for display
-				CUDA(cudaNormalizeRGBA((float4*)imgCPU, make_float2(0.0f, 255.0f), 
-								   (float4*)imgCPU, make_float2(0.0f, 1.0f), 
-		 						   frame.cols, frame.rows));
-
-				// map from CUDA to openGL using GL interop
+				// convert the BGR frame (with the boxes drawn) to RGBA8, straight into the texture's PBO (via GL interop)
 				void* tex_map = texture->MapCUDA();
 
 				if( tex_map != NULL )
 				{
-					cudaMemcpy(tex_map, imgCPU, texture->GetSize(), cudaMemcpyDeviceToDevice);
+					CUDA(cudaPackedToRGBA8(s.imgCUDA, FORMAT_BGR8, s.mapped.step, (uchar4*)tex_map, imgWidth, imgHeight));
 					texture->Unmap();
 				}
 
@@ -234,12 +284,64 @@ int main( int argc, char** argv )
 
 			display->EndRender();
 		}
+		
+		return true;
+	};
+	
+	
+	/*
+	 * run capture and inference on their own threads, and present from this one (which owns the GL context)
+	 */
+	framePipeline* pipeline = framePipeline::Create(captureFrame, detect, present);
+	
+	if( !pipeline )
+	{
+		printf("detectnet-camera:  failed to create pipeline\n");
+		return 0;
+	}
+	
+	slots.resize(pipeline->GetNumSlots());
+	
+	for( uint32_t n=0; n < slots.size(); n++ )
+	{
+		frameSlot& s = slots[n];
+		s.numBoundingBoxes = 0;
+		
+		if( !cudaAllocMapped((void**)&s.bbCPU, (void**)&s.bbCUDA, maxBoxes * sizeof(float4)) ||
+			!cudaAllocMapped((void**)&s.imgCPU, (void**)&s.imgCUDA, imgWidth * imgHeight * 3) ||
+		    !cudaAllocMapped((void**)&s.confCPU, (void**)&s.confCUDA, maxBoxes * 2 * sizeof(float)) )
+		{
+			printf("detectnet-camera:  failed to alloc output memory\n");
+			return 0;
+		}
+
+		s.mapped = Mat(imgHeight, imgWidth, CV_8UC3, s.imgCPU);
 	}
 	
+	pipeline->Start();
+	
+	while( !signal_recieved )
+		pipeline->Present(1000);
+	
+	pipeline->Stop();
+	
+	printf("\ndetectnet-camera:  %llu frames captured, %llu detected, %llu presented (%llu dropped before inference, %llu before presenting)\n",
+		  (unsigned long long)pipeline->GetFrames(framePipeline::CAPTURE), (unsigned long long)pipeline->GetFrames(framePipeline::INFERENCE),
+		  (unsigned long long)pipeline->GetFrames(framePipeline::PRESENT), (unsigned long long)pipeline->GetDropped(framePipeline::INFERENCE),
+		  (unsigned long long)pipeline->GetDropped(framePipeline::PRESENT));
+	
+	delete pipeline;
+	
 	printf("\ndetectnet-camera:  un-initializing video device\n");
 	
 	capture.release();
 
+	if( encoder != NULL )
+	{
+		delete encoder;
+		encoder = NULL;
+	}
+
 	if( display != NULL )
 	{
 		delete display;
@@ -93,26 +93,17 @@ int main( int argc, char** argv )
 	{
 		printf("%i bounding boxes detected\n", numBoundingBoxes);
 		
-		int lastClass = 0;
-		int lastStart = 0;
-		
 		for( int n=0; n < numBoundingBoxes; n++ )
 		{
-			const int nc = confCPU[n*2+1];
 			float* bb = bbCPU + (n * 4);
 			
 			printf("bounding box %i   (%f, %f)  (%f, %f)  w=%f  h=%f\n", n, bb[0], bb[1], bb[2], bb[3], bb[2] - bb[0], bb[3] - bb[1]); 
-			
-			if( nc != lastClass || n == (numBoundingBoxes - 1) )
-			{
-				if( !net->DrawBoxes(imgCUDA, imgCUDA, imgWidth, imgHeight, bbCUDA + (lastStart * 4), (n - lastStart) + 1, lastClass) )
-					printf("detectnet-console:  failed to draw boxes\n");
-					
-				lastClass = nc;
-				lastStart = n;
-			}
 		}
 		
+		// draw every box in the color of its class
+		if( numBoundingBoxes > 0 && !net->DrawBoxes(imgCUDA, imgCUDA, imgWidth, imgHeight, bbCPU, confCPU, numBoundingBoxes) )
+			printf("detectnet-console:  failed to draw boxes\n");
+		
 		CUDA(cudaThreadSynchronize());
 		
 		// save image to disk
@@ -127,7 +118,7 @@ int main( int argc, char** argv )
 	//printf("detectnet-console:  '%s' -> %2.5f%% class #%i (%s)\n", imgFilename, confidence * 100.0f, img_class, "pedestrian");
 	
 	printf("\nshutting down...\n");
-	CUDA(cudaFreeHost(imgCPU));
+	cudaFreeMappedPool(imgCPU);
 	delete net;
 	return 0;
 }
@@ -3,17 +3,23 @@
  */
 
 #include "detectNet.h"
+#include "detectionLog.h"
+#include "jobServer.h"
 
+#include "commandLine.h"
 #include "cudaMappedMemory.h"
 
 #include <signal.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/time.h>
 #include <unistd.h>
 
+#include <string>
+#include <vector>
+
 #include "opencv2/core.hpp"
 #include "opencv2/highgui.hpp"
-#include "opencv2/imgproc.hpp"
 
 using namespace cv;
 
@@ -23,8 +29,19 @@ using namespace cv;
 #define OUTPUT_FILE_NAME "/dev/shm/detect.out"
 #define THUMBNAIL_FILE_NAME "/dev/shm/detect.jpg"
 
-#define FRAME_COLS 1024
-#define FRAME_ROWS 768
+#define DEFAULT_WORKERS 2
+#define DEFAULT_STRIDE 50
+#define DEFAULT_DENSE_WINDOW 4 // in strides
+
+// the source column of detectionLog files
+#define LOG_SOURCE_PED 0
+#define LOG_SOURCE_FACE 1
+
+// hardware decoder pipeline for Jetson, OpenCV runs it through its gstreamer
+// backend (the location is substituted already quoted, see quotePipelineValue)
+#define HW_DECODE_PIPELINE                                                     \
+  "filesrc location=%s ! qtdemux ! h264parse ! omxh264dec ! nvvidconv ! "      \
+  "video/x-raw, format=BGRx ! videoconvert ! video/x-raw, format=BGR ! appsink"
 
 uint64_t current_timestamp() {
   struct timeval te;
@@ -41,150 +58,481 @@ void sig_handler(int signo) {
   }
 }
 
-// main entry point
-int main(int argc, char **argv) {
-  if (signal(SIGINT, sig_handler) == SIG_ERR)
-    printf("\ncan't catch SIGINT\n");
+// how clips are decoded and sampled
+//
+// every Nth frame (stride) is analysed until something is detected, then every
+// denseStride frames for the denseWindow frames after the last detection.  when
+// seeking, the gap before the first detection is also analysed densely, going
+// back to it before reporting the detection (so results stay in frame order)
+struct decodeOptions {
+  int stride;      // analyse every Nth frame
+  int denseStride; // analyse every Nth frame around detections (0 to disable)
+  int denseWindow; // number of frames after a detection to analyse densely
+  bool seek;       // seek over the skipped frames instead of grabbing them
+  bool hwDecode;   // decode with the hardware decoder (falls back to software)
+};
 
-  // create detectNet
-  detectNet *pednet = detectNet::Create(detectNet::PEDNET, 0.8f, 2);
+// the networks and buffers used to process one clip at a time
+struct detector {
+  detectNet *pednet;
+  detectNet *facenet;
+
+  uint32_t maxPedBoxes;
+  uint32_t maxFaceBoxes;
 
-  detectNet *facenet = detectNet::Create(detectNet::FACENET, 0.5f, 2);
+  // BGR frames are retrieved straight into this mapped buffer, which the
+  // networks read from without converting it to float RGBA first (and resize
+  // to their input dimensions, so clips can be any resolution)
+  uint8_t *imgCPU;
+  uint8_t *imgCUDA;
+  size_t imgSize;
 
-  if ((!pednet) || (!facenet)) {
-    printf("detectnet-console:   failed to initialize detectNet\n");
-    return 0;
+  float *bbCPU;
+  float *bbCUDA;
+  float *confCPU;
+  float *confCUDA;
+
+  float *bbFaceCPU;
+  float *bbFaceCUDA;
+  float *confFaceCPU;
+  float *confFaceCUDA;
+};
+
+bool createDetector(detector *d) {
+  memset(d, 0, sizeof(detector));
+
+  // create detectNet
+  d->pednet = detectNet::Create(detectNet::PEDNET, 0.8f, 2);
+  d->facenet = detectNet::Create(detectNet::FACENET, 0.5f, 2);
+
+  if ((!d->pednet) || (!d->facenet)) {
+    printf("detectnet-daemon:   failed to initialize detectNet\n");
+    return false;
   }
 
-  //   pednet->EnableProfiler();
-  //   facenet->EnableProfiler();
+  //   d->pednet->EnableProfiler();
+  //   d->facenet->EnableProfiler();
 
   // alloc memory for bounding box & confidence value output arrays
-  const uint32_t maxPedBoxes = pednet->GetMaxBoundingBoxes();
-  const uint32_t maxFaceBoxes = facenet->GetMaxBoundingBoxes();
-
-  const uint32_t classes = pednet->GetNumClasses();
-  const uint32_t FaceClasses = facenet->GetNumClasses();
-
-  float *imgCPU = NULL;
-  float *imgCUDA = NULL;
-
-  float *bbCPU = NULL;
-  float *bbCUDA = NULL;
-  float *confCPU = NULL;
-  float *confCUDA = NULL;
-
-  float *bbFaceCPU = NULL;
-  float *bbFaceCUDA = NULL;
-  float *confFaceCPU = NULL;
-  float *confFaceCUDA = NULL;
-
-  if (!cudaAllocMapped((void **)&bbCPU, (void **)&bbCUDA,
-                       maxPedBoxes * sizeof(float4)) ||
-      !cudaAllocMapped((void **)&confCPU, (void **)&confCUDA,
-                       maxPedBoxes * classes * sizeof(float)) ||
-      !cudaAllocMapped((void **)&bbFaceCPU, (void **)&bbFaceCUDA,
-                       maxFaceBoxes * sizeof(float4)) ||
-      !cudaAllocMapped((void **)&imgCPU, (void **)&imgCUDA,
-                       FRAME_COLS * FRAME_ROWS * sizeof(float) * 4) ||
-      !cudaAllocMapped((void **)&confFaceCPU, (void **)&confFaceCUDA,
-                       maxFaceBoxes * FaceClasses * sizeof(float))) {
-    printf("detectnet-console:  failed to alloc output memory\n");
-    return 0;
+  d->maxPedBoxes = d->pednet->GetMaxBoundingBoxes();
+  d->maxFaceBoxes = d->facenet->GetMaxBoundingBoxes();
+
+  // Detect() writes a (confidence, class) pair per box, whatever the number of
+  // classes, and detectionLog::Add() reads both
+  if (!cudaAllocMapped((void **)&d->bbCPU, (void **)&d->bbCUDA,
+                       d->maxPedBoxes * sizeof(float4)) ||
+      !cudaAllocMapped((void **)&d->confCPU, (void **)&d->confCUDA,
+                       d->maxPedBoxes * 2 * sizeof(float)) ||
+      !cudaAllocMapped((void **)&d->bbFaceCPU, (void **)&d->bbFaceCUDA,
+                       d->maxFaceBoxes * sizeof(float4)) ||
+      !cudaAllocMapped((void **)&d->confFaceCPU, (void **)&d->confFaceCUDA,
+                       d->maxFaceBoxes * 2 * sizeof(float))) {
+    printf("detectnet-daemon:  failed to alloc output memory\n");
+    return false;
+  }
+
+  return true;
+}
+
+// make sure the frame buffer can hold a width x height BGR image
+bool reserveFrame(detector *d, int width, int height) {
+  const size_t size = (size_t)width * height * 3;
+
+  if (size <= d->imgSize)
+    return true;
+
+  if (d->imgCPU != NULL)
+    CUDA(cudaFreeHost(d->imgCPU));
+
+  d->imgSize = 0;
+
+  if (!cudaAllocMapped((void **)&d->imgCPU, (void **)&d->imgCUDA, size)) {
+    printf("detectnet-daemon:  failed to alloc %dx%d frame\n", width, height);
+    d->imgCPU = NULL;
+    return false;
+  }
+
+  d->imgSize = size;
+  return true;
+}
+
+void destroyDetector(detector *d) {
+  if (d->imgCPU != NULL)
+    CUDA(cudaFreeHost(d->imgCPU));
+
+  CUDA(cudaFreeHost(d->bbCPU));
+  CUDA(cudaFreeHost(d->confCPU));
+  CUDA(cudaFreeHost(d->bbFaceCPU));
+  CUDA(cudaFreeHost(d->confFaceCPU));
+  delete d->pednet;
+  delete d->facenet;
+}
+
+// quote a property value for a gst-launch pipeline description, so a path
+// from a client can't end the value and add elements or properties (returns
+// false for control characters, which the pipeline parser can't take)
+bool quotePipelineValue(const char *value, std::string *quoted) {
+  *quoted = "\"";
+
+  for (const char *c = value; *c != '\0'; c++) {
+    if ((unsigned char)*c < 0x20 || *c == 0x7F)
+      return false;
+
+    if (*c == '"' || *c == '\\')
+      *quoted += '\\';
+
+    *quoted += *c;
+  }
+
+  *quoted += '"';
+  return true;
+}
+
+// open a clip, with the hardware decoder if requested
+bool openVideo(VideoCapture &cap, const char *video,
+               const decodeOptions &opt) {
+  std::string location;
+
+  if (opt.hwDecode && !quotePipelineValue(video, &location)) {
+    printf("detectnet-daemon:  '%s' can't be passed to the hardware decoder, "
+           "falling back to software\n",
+           video);
+  } else if (opt.hwDecode) {
+    char pipeline[1024];
+    const int length = snprintf(pipeline, sizeof(pipeline), HW_DECODE_PIPELINE,
+                                location.c_str());
+
+    if (length > 0 && length < (int)sizeof(pipeline) && cap.open(pipeline))
+      return true;
+
+    printf("detectnet-daemon:  hardware decoder unavailable for '%s', "
+           "falling back to software\n",
+           video);
+  }
+
+  return cap.open(video);
+}
+
+// format the detections in a frame as a line of text for emit
+bool emitDetections(detector *d, int frame, int numPedBoundingBoxes,
+                    int numFaceBoundingBoxes, const jobServer::EmitFunc &emit) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%d,ped,%d,face,%d", frame,
+           numPedBoundingBoxes, numFaceBoundingBoxes);
+
+  std::string line = buffer;
+  int n;
+  float *bb;
+
+  for (n = 0; n < numPedBoundingBoxes; n++) {
+    bb = d->bbCPU + (n * 4);
+    snprintf(buffer, sizeof(buffer), ",%d,%d,%d,%d", (int)bb[0], (int)bb[1],
+             (int)bb[2], (int)bb[3]);
+    line += buffer;
+  }
+  for (n = 0; n < numFaceBoundingBoxes; n++) {
+    bb = d->bbFaceCPU + (n * 4);
+    snprintf(buffer, sizeof(buffer), ",%d,%d,%d,%d", (int)bb[0], (int)bb[1],
+             (int)bb[2], (int)bb[3]);
+    line += buffer;
   }
 
+  return emit(line.c_str());
+}
+
+// run the detectors over a clip, writing the results to the log if there is
+// one, otherwise passing each line of results to emit (thumbnail and log are
+// optional, emit returns false to stop early)
+bool processVideo(detector *d, const char *video, const char *thumbnail,
+                  const decodeOptions &opt, const jobServer::EmitFunc &emit,
+                  detectionLog *log, std::string *error) {
+  // wraps the mapped buffer, so retrieve() decodes into memory the GPU can
+  // read (it's sized from the first frame, which gets copied)
+  Mat mapped;
+  Mat frame;
+
   bool result;
+  bool firstDetection = true;
+  bool seek = opt.seek;
 
-  Mat frame, rgbaFrame, rgbaFrameF;
+  VideoCapture cap;
 
-  FILE *fd = NULL;
-  while (!signal_recieved) {
-    if (0 == access(START_FILE_NAME, 0)) {
-      bool firstDetection = true;
-      remove(START_FILE_NAME);
-      fd = fopen(TEMP_FILE_NAME, "w");
-      VideoCapture cap(VIDEO_FILE_NAME);
-      int frameCounter = 0;
-      while (cap.read(frame)) {
-        frameCounter++;
-        if ((frameCounter % 50) != 1) {
-          if (frameCounter == 2) {
-            imwrite(THUMBNAIL_FILE_NAME, frame);
-          }
-          continue;
-        }
-        if ((frame.cols != FRAME_COLS) || (frame.rows != FRAME_ROWS)) {
-          printf("Wrong frame size (%d,%d) \n", frame.cols, frame.rows);
+  if (!openVideo(cap, video, opt)) {
+    *error = "failed to open video";
+    return false;
+  }
+
+  // grab() advances without converting the frame to BGR or copying it out,
+  // only the frames that are analysed (or thumbnailed) are retrieved
+  int frameCounter = 0;
+  int nextFrame = 1;    // the next frame to analyse
+  int lastAnalysed = 0; // the last frame that was analysed
+  int denseUntil = 0;   // frames before this are analysed densely
+
+  while (cap.grab()) {
+    frameCounter++;
+
+    const bool analyse = (frameCounter >= nextFrame);
+    const bool thumb = (frameCounter == 2 && thumbnail != NULL);
+
+    if (!analyse && !thumb)
+      continue;
+
+    frame = mapped;
+
+    if (!cap.retrieve(frame))
+      break;
+
+    if (thumb)
+      imwrite(thumbnail, frame);
+
+    if (!analyse)
+      continue;
+
+    // the backend may hand back its own buffer instead of filling ours (or
+    // the resolution changed), in which case the frame is copied over
+    if (frame.data != mapped.data) {
+      if (frame.cols != mapped.cols || frame.rows != mapped.rows) {
+        if (!reserveFrame(d, frame.cols, frame.rows)) {
+          *error = "failed to alloc frame";
           return false;
         }
 
-        cvtColor(frame, rgbaFrame, CV_BGR2RGBA, 4);
-        rgbaFrame.convertTo(rgbaFrameF, CV_32F);
-        float *imgRGBA = rgbaFrameF.ptr<float>();
-        for (int j = 0; j < FRAME_COLS * FRAME_ROWS * 4; j++) {
-          imgCPU[j] = imgRGBA[j];
-        }
+        mapped = Mat(frame.rows, frame.cols, CV_8UC3, d->imgCPU);
+      }
+
+      frame.copyTo(mapped);
+    }
+
+    int numPedBoundingBoxes = d->maxPedBoxes;
+    int numFaceBoundingBoxes = d->maxFaceBoxes;
+
+    result = d->pednet->Detect(d->imgCUDA, FORMAT_BGR8, mapped.cols,
+                               mapped.rows, mapped.step, d->bbCPU,
+                               &numPedBoundingBoxes, d->confCPU);
+    if (!result) {
+      printf("detectnet-daemon:  failed to classify '%s'\n", video);
+      numPedBoundingBoxes = 0;
+    }
 
-        int numPedBoundingBoxes = maxPedBoxes;
-        int numFaceBoundingBoxes = maxFaceBoxes;
+    const bool dense = (opt.denseStride > 0);
 
-        result = pednet->Detect(imgCUDA, FRAME_COLS, FRAME_ROWS, bbCPU,
-                                &numPedBoundingBoxes, confCPU);
+    // the first detection after a sparse stretch:  go back over the frames
+    // skipped before it, it gets analysed again when the dense pass reaches it
+    if (dense && seek && numPedBoundingBoxes != 0 && lastAnalysed > 0 &&
+        frameCounter - lastAnalysed > opt.denseStride) {
+      const int from = lastAnalysed + opt.denseStride;
+
+      if (cap.set(CAP_PROP_POS_FRAMES, from - 1)) {
+        denseUntil = frameCounter + 1; // up to and including this frame
+        frameCounter = from - 1;
+        nextFrame = from;
+        continue;
+      }
+
+      seek = false; // not seekable, keep grabbing
+    }
+
+    lastAnalysed = frameCounter;
+
+    // analyse densely for a while after each detection
+    if (numPedBoundingBoxes != 0)
+      denseUntil = frameCounter + opt.denseWindow;
+
+    if (dense && frameCounter < denseUntil)
+      nextFrame = frameCounter + opt.denseStride;
+    else
+      nextFrame = frameCounter + opt.stride;
+
+    if (numPedBoundingBoxes != 0) {
+      if (firstDetection) {
+        firstDetection = false;
+        if (thumbnail != NULL) {
+          imwrite(thumbnail, frame);
+        }
+        result = d->facenet->Detect(d->imgCUDA, FORMAT_BGR8, mapped.cols,
+                                    mapped.rows, mapped.step, d->bbFaceCPU,
+                                    &numFaceBoundingBoxes, d->confFaceCPU);
         if (!result) {
-          printf("detectnet-console:  failed to classify '%s'\n",
-                 VIDEO_FILE_NAME);
-          numPedBoundingBoxes = 0;
+          printf("detectnet-daemon:  failed to classify '%s'\n", video);
+          numFaceBoundingBoxes = 0;
         }
+      } else {
+        numFaceBoundingBoxes = 0;
+      }
 
-        if (numPedBoundingBoxes != 0) {
-          if (firstDetection) {
-            firstDetection = false;
-            imwrite(THUMBNAIL_FILE_NAME, frame);
-            result = facenet->Detect(imgCUDA, FRAME_COLS, FRAME_ROWS, bbFaceCPU,
-                                     &numFaceBoundingBoxes, confFaceCPU);
-            if (!result) {
-              printf("detectnet-console:  failed to classify '%s'\n",
-                     VIDEO_FILE_NAME);
-              numFaceBoundingBoxes = 0;
-            }
-          } else {
-            numFaceBoundingBoxes = 0;
-          }
+      if (log != NULL) {
+        if (!log->Add(frameCounter, LOG_SOURCE_PED, d->bbCPU, d->confCPU,
+                      numPedBoundingBoxes) ||
+            !log->Add(frameCounter, LOG_SOURCE_FACE, d->bbFaceCPU,
+                      d->confFaceCPU, numFaceBoundingBoxes)) {
+          *error = "failed to write log";
+          return false;
+        }
+      } else if (!emitDetections(d, frameCounter, numPedBoundingBoxes,
+                                 numFaceBoundingBoxes, emit)) {
+        *error = "client disconnected";
+        return false;
+      }
+    }
 
-          fprintf(fd, "%d,ped,%d,face,%d", frameCounter, numPedBoundingBoxes,
-                  numFaceBoundingBoxes);
-          int n;
-          int nc;
-          float *bb;
-
-          for (n = 0; n < numPedBoundingBoxes; n++) {
-            nc = confCPU[n * 2 + 1];
-            bb = bbCPU + (n * 4);
-            fprintf(fd, ",%d,%d,%d,%d", (int)bb[0], (int)bb[1], (int)bb[2],
-                    (int)bb[3]);
-          }
-          for (n = 0; n < numFaceBoundingBoxes; n++) {
-            nc = confFaceCPU[n * 2 + 1];
-            bb = bbFaceCPU + (n * 4);
-            fprintf(fd, ",%d,%d,%d,%d", (int)bb[0], (int)bb[1], (int)bb[2],
-                    (int)bb[3]);
-          }
-          fprintf(fd, "\n");
+    // skip ahead to the next frame to analyse, so the decoder starts from the
+    // keyframe before it instead of decoding every frame in between
+    // (after frame 2, which the thumbnail comes from)
+    if (seek && frameCounter >= 2 && nextFrame > frameCounter + 1) {
+      if (cap.set(CAP_PROP_POS_FRAMES, nextFrame - 1))
+        frameCounter = nextFrame - 1;
+      else
+        seek = false; // not seekable, keep grabbing
+    }
+  }
+
+  return true;
+}
+
+// original interface:  poll /dev/shm for one clip at a time
+// (with binary set, the output is a detectionLog instead of text)
+int runLegacy(detector *d, const decodeOptions &opt, bool binary) {
+  while (!signal_recieved) {
+    if (0 == access(START_FILE_NAME, 0)) {
+      remove(START_FILE_NAME);
+      std::string error;
+
+      if (binary) {
+        detectionLog *log = detectionLog::Create(TEMP_FILE_NAME);
+
+        if (log != NULL) {
+          processVideo(d, VIDEO_FILE_NAME, THUMBNAIL_FILE_NAME, opt,
+                       jobServer::EmitFunc(), log, &error);
+          delete log;
+        }
+      } else {
+        FILE *fd = fopen(TEMP_FILE_NAME, "w");
+
+        if (fd != NULL) {
+          processVideo(d, VIDEO_FILE_NAME, THUMBNAIL_FILE_NAME, opt,
+                       [fd](const char *line) {
+                         fprintf(fd, "%s\n", line);
+                         return true;
+                       },
+                       NULL, &error);
+          fclose(fd);
         }
       }
+
       remove(VIDEO_FILE_NAME);
-      if (fd != NULL) {
-        fclose(fd);
-      }
       rename(TEMP_FILE_NAME, OUTPUT_FILE_NAME);
     } else {
       sleep(1);
     }
   }
 
+  return 0;
+}
+
+// main entry point
+int main(int argc, char **argv) {
+  commandLine cmdLine(argc, argv);
+
+  if (signal(SIGINT, sig_handler) == SIG_ERR)
+    printf("\ncan't catch SIGINT\n");
+
+  // --legacy keeps the /dev/shm file interface with a single worker,
+  // --binary writes its output as a detectionLog
+  const bool legacy = cmdLine.GetFlag("legacy");
+  const bool binary = cmdLine.GetFlag("binary");
+  const char *socketPath = cmdLine.GetString("socket");
+  int numWorkers = cmdLine.GetInt("workers");
+
+  if (!socketPath)
+    socketPath = JOB_SERVER_DEFAULT_SOCKET;
+
+  // --stride=N analyses every Nth frame, --seek jumps over the others and
+  // --hw-decode uses the hardware decoder.  --dense-stride=N analyses every
+  // Nth frame for --dense-window=N frames after a detection instead
+  decodeOptions opt;
+  opt.stride = cmdLine.GetInt("stride");
+  opt.denseStride = cmdLine.GetInt("dense-stride");
+  opt.denseWindow = cmdLine.GetInt("dense-window");
+  opt.seek = cmdLine.GetFlag("seek");
+  opt.hwDecode = cmdLine.GetFlag("hw-decode");
+
+  if (opt.stride < 1)
+    opt.stride = DEFAULT_STRIDE;
+
+  if (opt.denseStride < 1 || opt.denseStride >= opt.stride)
+    opt.denseStride = 0;
+
+  if (opt.denseWindow < 1)
+    opt.denseWindow = opt.stride * DEFAULT_DENSE_WINDOW;
+
+  if (numWorkers < 1 || legacy)
+    numWorkers = legacy ? 1 : DEFAULT_WORKERS;
+
+  // each worker has its own networks, so that clips are processed concurrently
+  std::vector<detector> detectors(numWorkers);
+
+  for (int n = 0; n < numWorkers; n++) {
+    if (!createDetector(&detectors[n]))
+      return 0;
+  }
+
+  if (legacy) {
+    runLegacy(&detectors[0], opt, binary);
+  } else {
+    jobServer *server = jobServer::Create(
+        socketPath, numWorkers,
+        [&detectors, &opt](uint32_t worker, const jobServer::job &job,
+                     const jobServer::EmitFunc &emit, std::string *error) {
+          detectionLog *log = NULL;
+
+          if (job.log.size() > 0) {
+            log = detectionLog::Create(job.log.c_str());
+
+            if (!log) {
+              *error = "failed to create " + job.log;
+              return false;
+            }
+          }
+
+          bool result = processVideo(
+              &detectors[worker], job.video.c_str(),
+              job.thumbnail.size() > 0 ? job.thumbnail.c_str() : NULL, opt,
+              emit, log, error);
+
+          if (log != NULL) {
+            if (result && !log->Flush()) {
+              *error = "failed to write " + job.log;
+              result = false;
+            }
+
+            delete log;
+          }
+
+          return result;
+        });
+
+    if (!server) {
+      printf("detectnet-daemon:  failed to create job server on %s\n",
+             socketPath);
+      return 0;
+    }
+
+    server->Start();
+
+    while (!signal_recieved) {
+      if (!server->Poll(500))
+        break;
+    }
+
+    printf("\nwaiting for running jobs to finish...\n");
+    delete server;
+  }
+
   printf("\nshutting down...\n");
-  CUDA(cudaFreeHost(imgCPU));
-  delete pednet;
-  delete facenet;
+
+  for (int n = 0; n < numWorkers; n++)
+    destroyDetector(&detectors[n]);
+
   return 0;
 }
@@ -0,0 +1,471 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "jobServer.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+
+#define MAX_REQUEST_LENGTH 4096
+
+
+// client constructor
+jobServer::client::client( int _fd )
+{
+	fd     = _fd;
+	hungup = false;
+}
+
+
+// client destructor
+jobServer::client::~client()
+{
+	if( fd >= 0 )
+		close(fd);
+}
+
+
+// client send
+bool jobServer::client::send( const std::string& line )
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if( hungup )
+		return false;
+
+	const std::string msg = line + "\n";
+	size_t sent = 0;
+
+	while( sent < msg.size() )
+	{
+		const ssize_t result = ::send(fd, msg.c_str() + sent, msg.size() - sent, MSG_NOSIGNAL);
+
+		if( result < 0 )
+		{
+			if( errno == EINTR )
+				continue;
+
+			if( errno == EAGAIN || errno == EWOULDBLOCK )
+			{
+				// the client is slow to read, wait for room in the socket buffer
+				struct pollfd pfd;
+
+				pfd.fd      = fd;
+				pfd.events  = POLLOUT;
+				pfd.revents = 0;
+
+				if( poll(&pfd, 1, 1000) > 0 )
+					continue;
+			}
+
+			hungup = true;
+			return false;
+		}
+
+		sent += result;
+	}
+
+	return true;
+}
+
+
+// constructor
+jobServer::jobServer()
+{
+	mListenFD   = -1;
+	mNumWorkers = 0;
+	mNextID     = 1;
+	mRunning    = 0;
+	mCompleted  = 0;
+	mFailed     = 0;
+	mStop       = false;
+}
+
+
+// destructor
+jobServer::~jobServer()
+{
+	Stop();
+
+	if( mListenFD >= 0 )
+	{
+		close(mListenFD);
+		mListenFD = -1;
+		unlink(mPath.c_str());
+	}
+}
+
+
+// Create
+jobServer* jobServer::Create( const char* path, uint32_t numWorkers, const ProcessFunc& process )
+{
+	if( !path || numWorkers == 0 || !process )
+		return NULL;
+
+	jobServer* server = new jobServer();
+
+	if( !server )
+		return NULL;
+
+	server->mNumWorkers = numWorkers;
+	server->mProcess    = process;
+
+	if( !server->init(path) )
+	{
+		printf("jobServer -- failed to listen on %s\n", path);
+		delete server;
+		return NULL;
+	}
+
+	return server;
+}
+
+
+// init
+bool jobServer::init( const char* path )
+{
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(sockaddr_un));
+
+	if( strlen(path) >= sizeof(addr.sun_path) )
+	{
+		printf("jobServer -- socket path is too long (%s)\n", path);
+		return false;
+	}
+
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	mListenFD = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if( mListenFD < 0 )
+	{
+		printf("jobServer -- socket() failed (errno=%i) (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	// a socket file left behind by a previous instance would make bind() fail
+	unlink(path);
+
+	if( bind(mListenFD, (struct sockaddr*)&addr, sizeof(sockaddr_un)) < 0 )
+	{
+		printf("jobServer -- bind() failed (errno=%i) (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	mPath = path;
+
+	if( listen(mListenFD, 16) < 0 )
+	{
+		printf("jobServer -- listen() failed (errno=%i) (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	printf("jobServer -- listening on %s\n", path);
+	return true;
+}
+
+
+// Start
+bool jobServer::Start()
+{
+	if( mWorkers.size() > 0 )
+		return true;
+
+	mStop = false;
+
+	for( uint32_t n=0; n < mNumWorkers; n++ )
+		mWorkers.push_back(std::thread(&jobServer::workerThread, this, n));
+
+	printf("jobServer -- started %u workers\n", mNumWorkers);
+	return true;
+}
+
+
+// Stop
+void jobServer::Stop()
+{
+	std::deque<pending> queued;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if( mStop && mWorkers.size() == 0 )
+			return;
+
+		mStop = true;
+		queued.swap(mQueue);
+		mFailed += queued.size();
+	}
+
+	mEvent.notify_all();
+
+	for( size_t n=0; n < queued.size(); n++ )
+	{
+		std::ostringstream ss;
+		ss << "FAILED " << queued[n].work.id << " server is shutting down";
+		queued[n].owner->send(ss.str());
+	}
+
+	for( size_t n=0; n < mWorkers.size(); n++ )
+		mWorkers[n].join();
+
+	mWorkers.clear();
+	mClients.clear();
+}
+
+
+// GetQueued
+size_t jobServer::GetQueued()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mQueue.size();
+}
+
+
+// Poll
+bool jobServer::Poll( int timeout )
+{
+	std::vector<struct pollfd> fds(mClients.size() + 1);
+
+	fds[0].fd      = mListenFD;
+	fds[0].events  = POLLIN;
+	fds[0].revents = 0;
+
+	for( size_t n=0; n < mClients.size(); n++ )
+	{
+		fds[n+1].fd      = mClients[n]->fd;
+		fds[n+1].events  = POLLIN;
+		fds[n+1].revents = 0;
+	}
+
+	const int result = poll(fds.data(), fds.size(), timeout);
+
+	if( result < 0 )
+	{
+		if( errno == EINTR )
+			return true;
+
+		printf("jobServer -- poll() failed (errno=%i) (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	if( result == 0 )
+		return true;
+
+	// read from the clients (back to front, so they can be removed as they disconnect)
+	for( size_t n=mClients.size(); n > 0; n-- )
+	{
+		if( fds[n].revents == 0 )
+			continue;
+
+		if( !read(mClients[n-1]) )
+			mClients.erase(mClients.begin() + (n-1));
+	}
+
+	if( fds[0].revents & POLLIN )
+		accept();
+
+	return true;
+}
+
+
+// accept
+void jobServer::accept()
+{
+	while(true)
+	{
+		const int fd = accept4(mListenFD, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+		if( fd < 0 )
+		{
+			if( errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR )
+				printf("jobServer -- accept() failed (errno=%i) (%s)\n", errno, strerror(errno));
+
+			return;
+		}
+
+		mClients.push_back(clientPtr(new client(fd)));
+	}
+}
+
+
+// read
+bool jobServer::read( const clientPtr& c )
+{
+	char buffer[1024];
+
+	while(true)
+	{
+		const ssize_t result = recv(c->fd, buffer, sizeof(buffer), 0);
+
+		if( result == 0 )
+			return false;	// the client is done sending (its jobs still reply if it's listening)
+
+		if( result < 0 )
+		{
+			if( errno == EINTR )
+				continue;
+
+			return (errno == EAGAIN || errno == EWOULDBLOCK);
+		}
+
+		c->input.append(buffer, result);
+
+		// handle each complete line
+		size_t newline = std::string::npos;
+
+		while( (newline = c->input.find('\n')) != std::string::npos )
+		{
+			std::string line = c->input.substr(0, newline);
+			c->input.erase(0, newline + 1);
+
+			if( line.size() > 0 && line[line.size()-1] == '\r' )
+				line.erase(line.size()-1);
+
+			if( line.size() > 0 )
+				request(c, line);
+		}
+
+		if( c->input.size() > MAX_REQUEST_LENGTH )
+		{
+			c->send("ERROR request too long");
+			return false;
+		}
+	}
+}
+
+
+// request
+void jobServer::request( const clientPtr& c, const std::string& line )
+{
+	std::istringstream in(line);
+	std::string command;
+	in >> command;
+
+	if( command == "SUBMIT" )
+	{
+		pending p;
+		in >> p.work.video >> p.work.thumbnail >> p.work.log;
+
+		if( p.work.video.size() == 0 )
+		{
+			c->send("ERROR usage: SUBMIT <video> [<thumbnail>|-] [<log>]");
+			return;
+		}
+
+		if( p.work.thumbnail == "-" )
+			p.work.thumbnail.clear();
+
+		if( access(p.work.video.c_str(), R_OK) != 0 )
+		{
+			c->send("ERROR can't read " + p.work.video);
+			return;
+		}
+
+		p.owner = c;
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			if( mStop )
+			{
+				c->send("ERROR server is shutting down");
+				return;
+			}
+
+			p.work.id = mNextID++;
+
+			// reply before a worker can start sending results for it
+			std::ostringstream ss;
+			ss << "JOB " << p.work.id;
+			c->send(ss.str());
+
+			mQueue.push_back(p);
+		}
+
+		mEvent.notify_one();
+	}
+	else if( command == "STATUS" )
+	{
+		std::ostringstream ss;
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			ss << "STATUS " << mQueue.size() << " " << mRunning << " " << mCompleted << " " << mFailed;
+		}
+
+		c->send(ss.str());
+	}
+	else
+	{
+		c->send("ERROR unknown request " + command);
+	}
+}
+
+
+// workerThread
+void jobServer::workerThread( uint32_t worker )
+{
+	while(true)
+	{
+		pending p;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mEvent.wait(lock, [&]{ return mQueue.size() > 0 || mStop; });
+
+			if( mStop )
+				return;
+
+			p = mQueue.front();
+			mQueue.pop_front();
+			mRunning++;
+		}
+
+		printf("jobServer -- worker %u processing job %llu (%s)\n", worker, (unsigned long long)p.work.id, p.work.video.c_str());
+
+		// prefix every line with the job it belongs to
+		std::ostringstream prefix;
+		prefix << "RESULT " << p.work.id << " ";
+
+		const std::string resultPrefix = prefix.str();
+		clientPtr owner = p.owner;
+
+		EmitFunc emit = [&]( const char* line ) { return owner->send(resultPrefix + line); };
+
+		std::string message;
+		const bool result = mProcess(worker, p.work, emit, &message);
+
+		std::ostringstream ss;
+
+		if( result )
+			ss << "DONE " << p.work.id;
+		else
+			ss << "FAILED " << p.work.id << " " << (message.size() > 0 ? message : "error");
+
+		owner->send(ss.str());
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			mRunning--;
+
+			if( result )
+				mCompleted++;
+			else
+				mFailed++;
+		}
+	}
+}
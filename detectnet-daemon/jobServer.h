@@ -0,0 +1,169 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __JOB_SERVER_H_
+#define __JOB_SERVER_H_
+
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Default path of the socket that detectnet-daemon listens on for jobs.
+ */
+#define JOB_SERVER_DEFAULT_SOCKET "/tmp/detectnet.sock"
+
+
+/**
+ * Accepts video clips to process over a Unix domain socket, queues them, and runs them
+ * on a pool of worker threads, streaming each job's results back to the client that
+ * submitted it as they're produced.
+ *
+ * The protocol is line-based text.  Requests from the client:
+ *
+ *    SUBMIT <video> [<thumbnail>|-] [<log>]    queue a clip, replies JOB <id>
+ *    STATUS                                    replies STATUS <queued> <running> <completed> <failed>
+ *
+ * Then, for each job, in the order they're produced:
+ *
+ *    RESULT <id> <line>              a line of results from the worker
+ *    DONE <id>                       the job finished
+ *    FAILED <id> <message>           the job couldn't be processed
+ *
+ * A thumbnail of '-' skips it.  When a log file is given, the results are written
+ * to it (as a binary detectionLog) instead of being sent as RESULT lines.
+ *
+ * Unrecognized requests are answered with ERROR <message>.  Several jobs can be submitted
+ * on one connection, and their results are interleaved.  Jobs keep running if the client
+ * stops reading, but their results are discarded once the connection is gone.
+ */
+class jobServer
+{
+public:
+	/**
+	 * A clip submitted for processing.
+	 */
+	struct job
+	{
+		uint64_t    id;
+		std::string video;
+		std::string thumbnail;	// empty if not requested
+		std::string log;		// detectionLog file for the results, empty to send them as RESULT lines
+	};
+
+	/**
+	 * Sends a line of results for a job to its client.
+	 * @returns false if the client has gone away (the job may stop early)
+	 */
+	typedef std::function<bool( const char* line )> EmitFunc;
+
+	/**
+	 * Processes a job on a worker thread.
+	 * @param worker index of the worker, for selecting per-worker resources (like networks)
+	 * @returns false (after setting message) if the job failed
+	 */
+	typedef std::function<bool( uint32_t worker, const job& job, const EmitFunc& emit, std::string* message )> ProcessFunc;
+
+	/**
+	 * Create a server listening on the socket path (replacing a stale socket file).
+	 */
+	static jobServer* Create( const char* path, uint32_t numWorkers, const ProcessFunc& process );
+
+	/**
+	 * Destroy (stopping the server if needed, and removing the socket file)
+	 */
+	~jobServer();
+
+	/**
+	 * Launch the worker threads.
+	 */
+	bool Start();
+
+	/**
+	 * Wait for connections and requests for up to timeout milliseconds (-1 to wait forever).
+	 * Run this in a loop on the main thread.
+	 * @returns false on error
+	 */
+	bool Poll( int timeout=-1 );
+
+	/**
+	 * Stop accepting jobs, finish the ones that are running and disconnect the clients.
+	 * Jobs still in the queue are failed.
+	 */
+	void Stop();
+
+	/**
+	 * Number of jobs waiting in the queue.
+	 */
+	size_t GetQueued();
+
+	/**
+	 * Number of worker threads.
+	 */
+	inline uint32_t GetNumWorkers() const				{ return mNumWorkers; }
+
+protected:
+	jobServer();
+
+	// a client connection, kept alive by the jobs it submitted until they're done
+	struct client
+	{
+		client( int fd );
+		~client();
+
+		bool send( const std::string& line );
+
+		int         fd;
+		std::mutex  mutex;	// serializes the lines written by the workers
+		std::string input;	// partial request line
+		bool        hungup;
+	};
+
+	typedef std::shared_ptr<client> clientPtr;
+
+	struct pending
+	{
+		job       work;
+		clientPtr owner;
+	};
+
+	bool init( const char* path );
+	void accept();
+	bool read( const clientPtr& c );
+	void request( const clientPtr& c, const std::string& line );
+	void workerThread( uint32_t worker );
+
+	ProcessFunc mProcess;
+	uint32_t    mNumWorkers;
+
+	std::string mPath;
+	int         mListenFD;
+
+	std::vector<clientPtr>   mClients;
+	std::vector<std::thread> mWorkers;
+
+	std::deque<pending>     mQueue;
+	std::mutex              mMutex;
+	std::condition_variable mEvent;
+
+	uint64_t mNextID;
+	uint32_t mRunning;
+	uint64_t mCompleted;
+	uint64_t mFailed;
+
+	bool mStop;
+};
+
+
+#endif
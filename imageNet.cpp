@@ -3,7 +3,6 @@
  */
  
 #include "imageNet.h"
-#include "cudaMappedMemory.h"
 #include "cudaResize.h"
 
 
@@ -191,7 +190,11 @@ int imageNet::Classify( float* rgba, uint32_t width, uint32_t height, float* con
 	// process with GIE
 	void* inferenceBuffers[] = { mInputCUDA, mOutputs[0].CUDA };
 	
-	mContext->execute(1, inferenceBuffers);
+	if( !executeNetwork(1, inferenceBuffers) )
+	{
+		printf(LOG_GIE "imageNet::Classify() -- failed to execute tensorRT context\n");
+		return -1;
+	}
 	
 	//CUDA(cudaDeviceSynchronize());
 	PROFILER_REPORT();
@@ -3,6 +3,7 @@
  */
  
 #include "cudaUtility.h"
+#include "imageFormat.h"
 
 
 
@@ -98,3 +99,62 @@ cudaError_t cudaPreImageNetMean( float4* input, size_t inputWidth, size_t inputH
 }
 
 
+
+// gpuPreImageNetPacked
+template<imageFormat format>
+__global__ void gpuPreImageNetPacked( float2 scale, uint8_t* input, int iPitch, float* output, int oWidth, int oHeight, float3 mean_value )
+{
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+	const int n = oWidth * oHeight;
+	
+	if( x >= oWidth || y >= oHeight )
+		return;
+
+	const int dx = ((float)x * scale.x);
+	const int dy = ((float)y * scale.y);
+
+	const float3 rgb = imageFormatLoadRGB<format>(input + dy * iPitch + dx * imageFormatChannels(format));
+	
+	output[n * 0 + y * oWidth + x] = rgb.z - mean_value.x;
+	output[n * 1 + y * oWidth + x] = rgb.y - mean_value.y;
+	output[n * 2 + y * oWidth + x] = rgb.x - mean_value.z;
+}
+
+
+// cudaPreImageNetMean
+cudaError_t cudaPreImageNetMean( void* input, imageFormat format, size_t inputPitch, size_t inputWidth, size_t inputHeight,
+				             float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( inputWidth == 0 || outputWidth == 0 || inputHeight == 0 || outputHeight == 0 )
+		return cudaErrorInvalidValue;
+
+	if( inputPitch == 0 )
+		inputPitch = inputWidth * imageFormatChannels(format);
+
+	const float2 scale = make_float2( float(inputWidth) / float(outputWidth),
+							    float(inputHeight) / float(outputHeight) );
+
+	// launch kernel
+	const dim3 blockDim(8, 8);
+	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
+
+	#define launchPacked(fmt) gpuPreImageNetPacked<fmt><<<gridDim, blockDim>>>(scale, (uint8_t*)input, inputPitch, output, outputWidth, outputHeight, mean_value)
+
+	switch(format)
+	{
+		case FORMAT_RGB8:	launchPacked(FORMAT_RGB8);  break;
+		case FORMAT_BGR8:	launchPacked(FORMAT_BGR8);  break;
+		case FORMAT_RGBA8:	launchPacked(FORMAT_RGBA8); break;
+		case FORMAT_BGRA8:	launchPacked(FORMAT_BGRA8); break;
+		case FORMAT_GRAY8:	launchPacked(FORMAT_GRAY8); break;
+		default:			return cudaErrorInvalidValue;
+	}
+
+	#undef launchPacked
+
+	return CUDA(cudaGetLastError());
+}
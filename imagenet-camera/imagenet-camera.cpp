@@ -15,6 +15,11 @@
 #include "cudaFont.h"
 #include "imageNet.h"
 
+#include "commandLine.h"
+#include "framePipeline.h"
+
+#include <vector>
+
 
 #define DEFAULT_CAMERA -1	// -1 for onboard camera, or change to index of /dev/video V4L2 camera (>=0)	
 		
@@ -54,6 +59,16 @@ int main( int argc, char** argv )
 		printf("\ncan't catch SIGINT\n");
 
 
+	/*
+	 * latency tracing (--trace reports percentiles on exit, --trace=file.csv also records every frame)
+	 */
+	commandLine cmdLine(argc, argv);
+	latencyTrace* trace = NULL;
+	
+	if( cmdLine.GetFlag("trace") )
+		trace = latencyTrace::Create(cmdLine.GetString("trace"));
+
+
 	/*
 	 * create the camera device
 	 */
@@ -65,6 +80,9 @@ int main( int argc, char** argv )
 		return 0;
 	}
 	
+	// capture straight from the gstreamer buffers (falls back to copying if unsupported)
+	camera->SetZeroCopy(true);
+	
 	printf("\nimagenet-camera:  successfully initialized video device\n");
 	printf("    width:  %u\n", camera->GetWidth());
 	printf("   height:  %u\n", camera->GetHeight());
@@ -94,7 +112,7 @@ int main( int argc, char** argv )
 	}
 	else
 	{
-		texture = glTexture::Create(camera->GetWidth(), camera->GetHeight(), GL_RGBA32F_ARB/*GL_RGBA8*/);
+		texture = glTexture::Create(camera->GetWidth(), camera->GetHeight(), GL_RGBA8);
 
 		if( !texture )
 			printf("imagenet-camera:  failed to create openGL texture\n");
@@ -120,40 +138,77 @@ int main( int argc, char** argv )
 	
 	
 	/*
-	 * processing loop
+	 * per-frame buffers, one for each slot of the pipeline
 	 */
-	float confidence = 0.0f;
+	struct frameSlot
+	{
+		float* rgba;
+		int    classIndex;
+		float  confidence;
+	};
 	
-	while( !signal_recieved )
+	std::vector<frameSlot> slots;
+	
+	const uint32_t imgWidth  = camera->GetWidth();
+	const uint32_t imgHeight = camera->GetHeight();
+	
+	
+	/*
+	 * capture stage:  take the newest frame from the camera and convert it to RGBA
+	 */
+	auto capture = [&]( uint32_t slot, frameStamp* stamp ) -> bool
 	{
 		void* imgCPU  = NULL;
 		void* imgCUDA = NULL;
 		
-		// get the latest frame
-		if( !camera->Capture(&imgCPU, &imgCUDA, 1000) )
+		if( !camera->Capture(&imgCPU, &imgCUDA, 1000, stamp) )
+		{
 			printf("\nimagenet-camera:  failed to capture frame\n");
+			return false;
+		}
 		//else
 		//	printf("imagenet-camera:  recieved new frame  CPU=0x%p  GPU=0x%p\n", imgCPU, imgCUDA);
 		
-		// convert from YUV to RGBA
-		void* imgRGBA = NULL;
+		const bool converted = camera->ConvertRGBA(imgCUDA, slots[slot].rgba);
 		
-		if( !camera->ConvertRGBA(imgCUDA, &imgRGBA) )
+		// give the frame back to the camera (this waits for the conversion to finish)
+		camera->Release(imgCPU);
+		
+		if( !converted )
 			printf("imagenet-camera:  failed to convert from NV12 to RGBA\n");
-
-		// classify image
-		const int img_class = net->Classify((float*)imgRGBA, camera->GetWidth(), camera->GetHeight(), &confidence);
+		
+		return converted;
+	};
+	
+	
+	/*
+	 * inference stage:  classify the image
+	 */
+	auto classify = [&]( uint32_t slot, const frameStamp& stamp ) -> bool
+	{
+		frameSlot& frame = slots[slot];
+		frame.classIndex = net->Classify(frame.rgba, imgWidth, imgHeight, &frame.confidence);
+		return true;
+	};
+	
 	
-		if( img_class >= 0 )
+	/*
+	 * presentation stage:  overlay the result and draw the frame
+	 */
+	auto present = [&]( uint32_t slot, const frameStamp& stamp ) -> bool
+	{
+		frameSlot& frame = slots[slot];
+		
+		if( frame.classIndex >= 0 )
 		{
-			printf("imagenet-camera:  %2.5f%% class #%i (%s)\n", confidence * 100.0f, img_class, net->GetClassDesc(img_class));	
+			printf("imagenet-camera:  %2.5f%% class #%i (%s)\n", frame.confidence * 100.0f, frame.classIndex, net->GetClassDesc(frame.classIndex));	
 
 			if( font != NULL )
 			{
 				char str[256];
-				sprintf(str, "%05.2f%% %s", confidence * 100.0f, net->GetClassDesc(img_class));
+				sprintf(str, "%05.2f%% %s", frame.confidence * 100.0f, net->GetClassDesc(frame.classIndex));
 	
-				font->RenderOverlay((float4*)imgRGBA, (float4*)imgRGBA, camera->GetWidth(), camera->GetHeight(),
+				font->RenderOverlay((float4*)frame.rgba, (float4*)frame.rgba, imgWidth, imgHeight,
 								    str, 0, 0, make_float4(255.0f, 255.0f, 255.0f, 255.0f));
 			}
 			
@@ -175,17 +230,14 @@ int main( int argc, char** argv )
 
 			if( texture != NULL )
 			{
-				// rescale image pixel intensities for display
-				CUDA(cudaNormalizeRGBA((float4*)imgRGBA, make_float2(0.0f, 255.0f), 
-								   (float4*)imgRGBA, make_float2(0.0f, 1.0f), 
-		 						   camera->GetWidth(), camera->GetHeight()));
-
-				// map from CUDA to openGL using GL interop
+				// rescale the pixel intensities and pack them to RGBA8, straight into the texture's PBO (via GL interop)
 				void* tex_map = texture->MapCUDA();
 
 				if( tex_map != NULL )
 				{
-					cudaMemcpy(tex_map, imgRGBA, texture->GetSize(), cudaMemcpyDeviceToDevice);
+					CUDA(cudaNormalizeToRGBA8((float4*)frame.rgba, make_float2(0.0f, 255.0f), 
+									      (uchar4*)tex_map, imgWidth, imgHeight));
+
 					texture->Unmap();
 				}
 
@@ -195,8 +247,63 @@ int main( int argc, char** argv )
 
 			display->EndRender();
 		}
+		
+		return true;
+	};
+	
+	
+	/*
+	 * run capture and inference on their own threads, and present from this one (which owns the GL context)
+	 */
+	framePipeline* pipeline = framePipeline::Create(capture, classify, present);
+	
+	if( !pipeline )
+	{
+		printf("imagenet-camera:  failed to create pipeline\n");
+		return 0;
 	}
 	
+	pipeline->SetTrace(trace);
+	slots.resize(pipeline->GetNumSlots());
+	
+	for( uint32_t n=0; n < slots.size(); n++ )
+	{
+		slots[n].classIndex = -1;
+		slots[n].confidence = 0.0f;
+		
+		if( CUDA_FAILED(cudaMalloc((void**)&slots[n].rgba, imgWidth * imgHeight * sizeof(float4))) )
+		{
+			printf("imagenet-camera:  failed to allocate memory for %ux%u RGBA image\n", imgWidth, imgHeight);
+			return 0;
+		}
+	}
+	
+	pipeline->Start();
+	
+	while( !signal_recieved )
+		pipeline->Present(1000);
+	
+	pipeline->Stop();
+	
+	printf("\nimagenet-camera:  %llu frames captured, %llu classified, %llu presented (%llu dropped before inference, %llu before presenting)\n",
+		  (unsigned long long)pipeline->GetFrames(framePipeline::CAPTURE), (unsigned long long)pipeline->GetFrames(framePipeline::INFERENCE),
+		  (unsigned long long)pipeline->GetFrames(framePipeline::PRESENT), (unsigned long long)pipeline->GetDropped(framePipeline::INFERENCE),
+		  (unsigned long long)pipeline->GetDropped(framePipeline::PRESENT));
+	
+	if( trace != NULL )
+	{
+		printf("imagenet-camera:  camera %llu frames captured, %llu dropped, %llu skipped\n",
+			  (unsigned long long)camera->GetCaptured(), (unsigned long long)camera->GetDropped(), (unsigned long long)camera->GetSkipped());
+		
+		trace->Report();
+		delete trace;
+	}
+	
+	delete pipeline;
+	
+	for( uint32_t n=0; n < slots.size(); n++ )
+		CUDA(cudaFree(slots[n].rgba));
+	
 	printf("\nimagenet-camera:  un-initializing video device\n");
 	
 	
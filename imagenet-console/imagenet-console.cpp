@@ -87,7 +87,7 @@ int main( int argc, char** argv )
 	}
 	
 	printf("\nshutting down...\n");
-	CUDA(cudaFreeHost(imgCPU));
+	cudaFreeMappedPool(imgCPU);
 	delete net;
 	return 0;
 }
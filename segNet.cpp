@@ -4,7 +4,7 @@
  
 #include "segNet.h"
 
-#include "cudaMappedMemory.h"
+#include "cudaAllocator.h"
 #include "cudaOverlay.h"
 #include "cudaResize.h"
 
@@ -20,13 +20,29 @@ segNet::segNet() : tensorNet()
 
 	mClassMap[0] = NULL;
 	mClassMap[1] = NULL;
+
+	mBatchSize = 0;
 }
 
 
 // destructor
 segNet::~segNet()
 {
-	
+	if( mClassColors[0] != NULL )
+	{
+		cudaAllocator::Get(MEM_MAPPED)->Free(mClassColors[0]);
+
+		mClassColors[0] = NULL;
+		mClassColors[1] = NULL;
+	}
+
+	if( mClassMap[0] != NULL )
+	{
+		cudaAllocator::Get(MEM_MAPPED)->Free(mClassMap[0]);
+
+		mClassMap[0] = NULL;
+		mClassMap[1] = NULL;
+	}
 }
 
 
@@ -68,26 +84,7 @@ segNet* segNet::Create( int argc, char** argv )
 		if( argc > 3 )
 			modelName = argv[3];	
 
-		segNet::NetworkType type = segNet::SEGNET_CUSTOM;
-
-		if( strcasecmp(modelName, "fcn-alexnet-cityscapes-sd") == 0 || strcasecmp(modelName, "fcn-alexnet-cityscapes") == 0 )
-			type = segNet::FCN_ALEXNET_CITYSCAPES_SD;
-		else if( strcasecmp(modelName, "fcn-alexnet-cityscapes-hd") == 0 )
-			type = segNet::FCN_ALEXNET_CITYSCAPES_HD;
-		else if( strcasecmp(modelName, "fcn-alexnet-pascal-voc") == 0 )
-			type = segNet::FCN_ALEXNET_PASCAL_VOC;
-		else if( strcasecmp(modelName, "fcn-alexnet-synthia-cvpr16") == 0 )
-			type = segNet::FCN_ALEXNET_SYNTHIA_CVPR16;
-		else if( strcasecmp(modelName, "fcn-alexnet-synthia-summer-sd") == 0 || strcasecmp(modelName, "fcn-alexnet-synthia-summer") == 0)
-			type = segNet::FCN_ALEXNET_SYNTHIA_SUMMER_SD;
-		else if( strcasecmp(modelName, "fcn-alexnet-synthia-summer-hd") == 0 )
-			type = segNet::FCN_ALEXNET_SYNTHIA_SUMMER_HD;
-		else if( strcasecmp(modelName, "fcn-alexnet-aerial-fpv-720p") == 0 )
-			type = segNet::FCN_ALEXNET_AERIAL_FPV_720p;
-		/*else if( strcasecmp(modelName, "fcn-alexnet-aerial-fpv-720p-4ch") == 0 )
-			type = segNet::FCN_ALEXNET_AERIAL_FPV_720p_4ch;
-		else if( strcasecmp(modelName, "fcn-alexnet-aerial-fpv-720p-21ch") == 0 )
-			type = segNet::FCN_ALEXNET_AERIAL_FPV_720p_21ch;*/
+		const segNet::NetworkType type = NetworkTypeFromStr(modelName);
 
 		// create segnet from pretrained model
 		return segNet::Create(type);
@@ -113,6 +110,37 @@ segNet* segNet::Create( int argc, char** argv )
 }
 
 
+// NetworkTypeFromStr
+segNet::NetworkType segNet::NetworkTypeFromStr( const char* modelName )
+{
+	if( !modelName )
+		return segNet::SEGNET_CUSTOM;
+
+	segNet::NetworkType type = segNet::SEGNET_CUSTOM;
+
+	if( strcasecmp(modelName, "fcn-alexnet-cityscapes-sd") == 0 || strcasecmp(modelName, "fcn-alexnet-cityscapes") == 0 )
+		type = segNet::FCN_ALEXNET_CITYSCAPES_SD;
+	else if( strcasecmp(modelName, "fcn-alexnet-cityscapes-hd") == 0 )
+		type = segNet::FCN_ALEXNET_CITYSCAPES_HD;
+	else if( strcasecmp(modelName, "fcn-alexnet-pascal-voc") == 0 )
+		type = segNet::FCN_ALEXNET_PASCAL_VOC;
+	else if( strcasecmp(modelName, "fcn-alexnet-synthia-cvpr16") == 0 )
+		type = segNet::FCN_ALEXNET_SYNTHIA_CVPR16;
+	else if( strcasecmp(modelName, "fcn-alexnet-synthia-summer-sd") == 0 || strcasecmp(modelName, "fcn-alexnet-synthia-summer") == 0)
+		type = segNet::FCN_ALEXNET_SYNTHIA_SUMMER_SD;
+	else if( strcasecmp(modelName, "fcn-alexnet-synthia-summer-hd") == 0 )
+		type = segNet::FCN_ALEXNET_SYNTHIA_SUMMER_HD;
+	else if( strcasecmp(modelName, "fcn-alexnet-aerial-fpv-720p") == 0 )
+		type = segNet::FCN_ALEXNET_AERIAL_FPV_720p;
+	/*else if( strcasecmp(modelName, "fcn-alexnet-aerial-fpv-720p-4ch") == 0 )
+		type = segNet::FCN_ALEXNET_AERIAL_FPV_720p_4ch;
+	else if( strcasecmp(modelName, "fcn-alexnet-aerial-fpv-720p-21ch") == 0 )
+		type = segNet::FCN_ALEXNET_AERIAL_FPV_720p_21ch;*/
+
+	return type;
+}
+
+
 // Create
 segNet* segNet::Create( const char* prototxt, const char* model, const char* labels_path, const char* colors_path, const char* input_blob, const char* output_blob, uint32_t maxBatchSize )
 {
@@ -149,7 +177,7 @@ segNet* segNet::Create( const char* prototxt, const char* model, const char* lab
 	// initialize array of class colors
 	const uint32_t numClasses = net->GetNumClasses();
 	
-	if( !cudaAllocMapped((void**)&net->mClassColors[0], (void**)&net->mClassColors[1], numClasses * sizeof(float4)) )
+	if( !cudaAllocator::Get(MEM_MAPPED)->Alloc((void**)&net->mClassColors[0], (void**)&net->mClassColors[1], numClasses * sizeof(float4)) )
 		return NULL;
 	
 	for( uint32_t n=0; n < numClasses; n++ )
@@ -167,7 +195,7 @@ segNet* segNet::Create( const char* prototxt, const char* model, const char* lab
 		
 	printf(LOG_GIE "segNet outputs -- s_w %i  s_h %i  s_c %i\n", s_w, s_h, s_c);
 
-	if( !cudaAllocMapped((void**)&net->mClassMap[0], (void**)&net->mClassMap[1], s_w * s_h * sizeof(uint8_t)) )
+	if( !cudaAllocator::Get(MEM_MAPPED)->Alloc((void**)&net->mClassMap[0], (void**)&net->mClassMap[1], maxBatchSize * s_w * s_h * sizeof(uint8_t)) )
 		return NULL;
 
 	// load class info
@@ -330,20 +358,47 @@ bool segNet::Overlay( float* rgba, float* output, uint32_t width, uint32_t heigh
 		return false;
 	}
 
-	// downsample and convert to band-sequential BGR
-	if( CUDA_FAILED(cudaPreImageNet((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight)) )
+	if( !Process(&rgba, &width, &height, 1, ignore_class) )
+		return false;
+
+	return GetOverlay(0, rgba, output, width, height);
+}
+
+
+// Process
+bool segNet::Process( float** rgba, const uint32_t* width, const uint32_t* height, uint32_t batchSize, const char* ignore_class )
+{
+	if( !rgba || !width || !height || batchSize == 0 || batchSize > mMaxBatchSize )
 	{
-		printf("segNet::Overlay() -- cudaPreImageNet failed\n");
+		printf("segNet::Process( 0x%p, %u ) -> invalid parameters\n", rgba, batchSize);
 		return false;
 	}
 
+	// downsample and convert to band-sequential BGR, one network input plane per image
+	const size_t inputStride = mWidth * mHeight * 3;
+
+	for( uint32_t b=0; b < batchSize; b++ )
+	{
+		if( !rgba[b] || width[b] == 0 || height[b] == 0 )
+		{
+			printf("segNet::Process( 0x%p, %u, %u ) -> invalid image %u in batch\n", rgba[b], width[b], height[b], b);
+			return false;
+		}
+
+		if( CUDA_FAILED(cudaPreImageNet((float4*)rgba[b], width[b], height[b], mInputCUDA + b * inputStride, mWidth, mHeight)) )
+		{
+			printf("segNet::Process() -- cudaPreImageNet failed\n");
+			return false;
+		}
+	}
+
 	
 	// process with GIE
 	void* inferenceBuffers[] = { mInputCUDA, mOutputs[0].CUDA };
 	
-	if( !mContext->execute(1, inferenceBuffers) )
+	if( !executeNetwork(batchSize, inferenceBuffers) )
 	{
-		printf(LOG_GIE "segNet::Overlay() -- failed to execute tensorRT context\n");
+		printf(LOG_GIE "segNet::Process() -- failed to execute tensorRT context\n");
 		return false;
 	}
 
@@ -351,66 +406,81 @@ bool segNet::Overlay( float* rgba, float* output, uint32_t width, uint32_t heigh
 
 	
 	// retrieve scores
-	float* scores = mOutputs[0].CPU;
-
 	const int s_w = mOutputs[0].dims.w;
 	const int s_h = mOutputs[0].dims.h;
 	const int s_c = mOutputs[0].dims.c;
-		
-	//const float s_x = float(width) / float(s_w);		// TODO bug: this should use mWidth/mHeight dimensions, in case user dimensions are different
-	//const float s_y = float(height) / float(s_h);
-	const float s_x = float(s_w) / float(mWidth);
-	const float s_y = float(s_h) / float(mHeight);
 
 	// if desired, find the ID of the class to ignore (typically void)
 	const int ignoreID = FindClassID(ignore_class);
 	
-	printf(LOG_GIE "segNet::Overlay -- s_w %i  s_h %i  s_c %i  s_x %f  s_y %f\n", s_w, s_h, s_c, s_x, s_y);
-	printf(LOG_GIE "segNet::Overlay -- ignoring class '%s' id=%i\n", ignore_class, ignoreID);
+	printf(LOG_GIE "segNet::Process -- s_w %i  s_h %i  s_c %i  batch %u\n", s_w, s_h, s_c, batchSize);
+	printf(LOG_GIE "segNet::Process -- ignoring class '%s' id=%i\n", ignore_class, ignoreID);
 
 
 	// find the argmax-classified class of each tile
-	uint8_t* classMap = mClassMap[0];
-
-	for( uint32_t y=0; y < s_h; y++ )
+	for( uint32_t b=0; b < batchSize; b++ )
 	{
-		for( uint32_t x=0; x < s_w; x++ )
-		{
-			float p_max[3] = {-100000.0f, -100000.0f, -100000.0f };
-			int   c_max[3] = { -1, -1, -1 };
+		const float* scores = mOutputs[0].CPU + b * (s_w * s_h * s_c);
+		uint8_t* classMap   = mClassMap[0] + b * (s_w * s_h);
 
-			for( uint32_t c=0; c < s_c; c++ )	// classes
+		for( int y=0; y < s_h; y++ )
+		{
+			for( int x=0; x < s_w; x++ )
 			{
-				const float p = scores[c * s_w * s_h + y * s_w + x];
+				float p_max[3] = {-100000.0f, -100000.0f, -100000.0f };
+				int   c_max[3] = { -1, -1, -1 };
 
-				if( c_max[0] < 0 || p > p_max[0] )
-				{
-					p_max[0] = p;
-					c_max[0] = c;
-				}
-				else if( c_max[1] < 0 || p > p_max[1] )
+				for( int c=0; c < s_c; c++ )	// classes
 				{
-					p_max[1] = p;
-					c_max[1] = c;
-				}
-				else if( c_max[2] < 0 || p > p_max[2] )
-				{
-					p_max[2] = p;
-					c_max[2] = c;
+					const float p = scores[c * s_w * s_h + y * s_w + x];
+
+					if( c_max[0] < 0 || p > p_max[0] )
+					{
+						p_max[0] = p;
+						c_max[0] = c;
+					}
+					else if( c_max[1] < 0 || p > p_max[1] )
+					{
+						p_max[1] = p;
+						c_max[1] = c;
+					}
+					else if( c_max[2] < 0 || p > p_max[2] )
+					{
+						p_max[2] = p;
+						c_max[2] = c;
+					}
 				}
+
+				const int argmax = (c_max[0] == ignoreID) ? c_max[1] : c_max[0];
+
+				classMap[y * s_w + x] = argmax;
 			}
+		}
+	}
 
-			/*printf("%02u %u  class %i  %f  %s  class %i  %f  %s  class %i  %f  %s\n", x, y, 
-				   c_max[0], p_max[0], (c_max[0] >= 0 && c_max[0] < GetNumClasses()) ? GetClassLabel(c_max[0]) : " ", 
-				   c_max[1], p_max[1], (c_max[1] >= 0 && c_max[1] < GetNumClasses()) ? GetClassLabel(c_max[1]) : " ",
-				   c_max[2], p_max[2], (c_max[2] >= 0 && c_max[2] < GetNumClasses()) ? GetClassLabel(c_max[2]) : " ");
-			*/
+	mBatchSize = batchSize;
+	return true;
+}
 
-			const int argmax = (c_max[0] == ignoreID) ? c_max[1] : c_max[0];
 
-			classMap[y * s_w + x] = argmax;
-		}
+// GetOverlay
+bool segNet::GetOverlay( uint32_t batchIndex, float* rgba, float* output, uint32_t width, uint32_t height )
+{
+	if( !rgba || width == 0 || height == 0 || !output || batchIndex >= mBatchSize )
+	{
+		printf("segNet::GetOverlay( %u, 0x%p, %u, %u ) -> invalid parameters\n", batchIndex, rgba, width, height);
+		return false;
 	}
+
+	const int s_w = mOutputs[0].dims.w;
+	const int s_h = mOutputs[0].dims.h;
+		
+	//const float s_x = float(width) / float(s_w);		// TODO bug: this should use mWidth/mHeight dimensions, in case user dimensions are different
+	//const float s_y = float(height) / float(s_h);
+	const float s_x = float(s_w) / float(mWidth);
+	const float s_y = float(s_h) / float(mHeight);
+
+	const uint8_t* classMap = mClassMap[0] + batchIndex * (s_w * s_h);
 	   
 	// overlay pixels onto original
 	for( uint32_t y=0; y < height; y++ )
@@ -428,29 +498,18 @@ bool segNet::Overlay( float* rgba, float* output, uint32_t width, uint32_t heigh
 
 			#define CHK_BOUNDS(x, y)		( (y < 0 ? 0 : (y >= (s_h - 1) ? (s_h - 1) : y)) * s_w + (x < 0 ? 0 : (x >= (s_w - 1) ? (s_w - 1) : x)) )
 
-			/*const uint8_t classIdx[] = { classMap[y1 * s_w + x1],
-								    classMap[y1 * s_w + x2],
-								    classMap[y2 * s_w + x2],
-								    classMap[y2 * s_w + x1] };*/
-
 			const uint8_t classIdx[] = { classMap[CHK_BOUNDS(x1, y1)],
 								    classMap[CHK_BOUNDS(x2, y1)],
 								    classMap[CHK_BOUNDS(x2, y2)],
 								    classMap[CHK_BOUNDS(x1, y2)] };
 
-
 			float* cc[] = { GetClassColor(classIdx[0]),
 						 GetClassColor(classIdx[1]),
 						 GetClassColor(classIdx[2]),
 						 GetClassColor(classIdx[3]) };
 
-			
-
 			const float x1d = cx - float(x1);
 			const float y1d = cy - float(y1);
-		
-			const float x2d = 1.0f - x1d;
-			const float y2d = 1.0f - y1d;
 
 			const float x1f = 1.0f - x1d;
 			const float y1f = 1.0f - y1d;
@@ -458,22 +517,6 @@ bool segNet::Overlay( float* rgba, float* output, uint32_t width, uint32_t heigh
 			const float x2f = 1.0f - x1f;
 			const float y2f = 1.0f - y1f;
 
-			int c_index = 0;
-
-			/*if( y2d > y1d )
-			{
-				if( x2d > y2d )			c_index = 2;
-				else 					c_index = 3;
-			}
-			else
-			{
-				if( x2d > y2d )			c_index = 1;
-				else						c_index = 0;
-			}*/
-			
-			//float* c_color = GetClassColor(classIdx[c_index]);
-			//printf("x %u y %u cx %f cy %f  x1d %f y1d %f  x2d %f y2d %f  c %i\n", x, y, cx, cy, x1d, y1d, x2d, y2d, c_index);
-
 			float c_color[] = { cc[0][0] * x1f * y1f + cc[1][0] * x2f * y1f + cc[2][0] * x2f * y2f + cc[3][0] * x1f * y2f,
 						     cc[0][1] * x1f * y1f + cc[1][1] * x2f * y1f + cc[2][1] * x2f * y2f + cc[3][1] * x1f * y2f,
 						     cc[0][2] * x1f * y1f + cc[1][2] * x2f * y1f + cc[2][2] * x2f * y2f + cc[3][2] * x1f * y2f,
@@ -496,5 +539,38 @@ bool segNet::Overlay( float* rgba, float* output, uint32_t width, uint32_t heigh
 }
 
 
-	
-	
+// GetMask
+bool segNet::GetMask( uint32_t batchIndex, uint8_t* output, uint32_t width, uint32_t height )
+{
+	if( !output || width == 0 || height == 0 || batchIndex >= mBatchSize )
+	{
+		printf("segNet::GetMask( %u, 0x%p, %u, %u ) -> invalid parameters\n", batchIndex, output, width, height);
+		return false;
+	}
+
+	const int s_w = mOutputs[0].dims.w;
+	const int s_h = mOutputs[0].dims.h;
+
+	const float s_x = float(s_w) / float(mWidth);
+	const float s_y = float(s_h) / float(mHeight);
+
+	const uint8_t* classMap = mClassMap[0] + batchIndex * (s_w * s_h);
+
+	// nearest-neighbor sample of the class map, so the mask only ever contains valid class indices
+	for( uint32_t y=0; y < height; y++ )
+	{
+		const int cy = int(float(y) * s_y);
+		const int my = (cy >= s_h) ? (s_h - 1) : cy;
+
+		for( uint32_t x=0; x < width; x++ )
+		{
+			const int cx = int(float(x) * s_x);
+			const int mx = (cx >= s_w) ? (s_w - 1) : cx;
+
+			output[y * width + x] = classMap[my * s_w + mx];
+		}
+	}
+
+	return true;
+}
+
@@ -72,6 +72,12 @@ public:
 	 * Load a new network instance by parsing the command line.
 	 */
 	static segNet* Create( int argc, char** argv );
+
+	/**
+	 * Parse a pretrained network name (i.e. "fcn-alexnet-cityscapes-hd") into its type.
+	 * @returns the matching NetworkType, or SEGNET_CUSTOM if the name wasn't recognized.
+	 */
+	static NetworkType NetworkTypeFromStr( const char* model_name );
 	
 	/**
 	 * Destroy
@@ -89,6 +95,38 @@ public:
 	 * @returns true on success, false on error.
 	 */
 	bool Overlay( float* input, float* output, uint32_t width, uint32_t height, const char* ignore_class="void" );
+
+	/**
+	 * Classify a batch of images in one pass through the network, without producing any output.
+	 * Afterwards, the results of each image can be retrieved with GetOverlay() or GetMask().
+	 * @param rgba array of float4 input images in CUDA device memory, RGBA colorspace with values 0-255.
+	 * @param width array containing the width of each input image in pixels.
+	 * @param height array containing the height of each input image in pixels.
+	 * @param batchSize number of images in the batch (up to GetMaxBatchSize())
+	 * @param ignore_class label name of class to ignore in the classification (or NULL to process all).
+	 * @returns true on success, false on error.
+	 */
+	bool Process( float** rgba, const uint32_t* width, const uint32_t* height, uint32_t batchSize, const char* ignore_class="void" );
+
+	/**
+	 * Produce the segmentation overlay for an image from the last call to Process().
+	 * @param batchIndex index of the image within the batch that was processed.
+	 * @param input float4 input image in CUDA device memory that was passed to Process().
+	 * @param output float4 output image in CUDA device memory, RGBA colorspace with values 0-255.
+	 * @param width width of the input/output images in pixels.
+	 * @param height height of the input/output images in pixels.
+	 */
+	bool GetOverlay( uint32_t batchIndex, float* input, float* output, uint32_t width, uint32_t height );
+
+	/**
+	 * Produce the class label mask for an image from the last call to Process(),
+	 * where each output pixel contains the class index of that location.
+	 * @param batchIndex index of the image within the batch that was processed.
+	 * @param output uint8 output image in CPU memory, of size width * height bytes.
+	 * @param width width of the output mask in pixels.
+	 * @param height height of the output mask in pixels.
+	 */
+	bool GetMask( uint32_t batchIndex, uint8_t* output, uint32_t width, uint32_t height );
 	
 	/**
 	 * Find the ID of a particular class (by label name).
@@ -139,7 +177,8 @@ protected:
 	
 	std::vector<std::string> mClassLabels;
 	float*   mClassColors[2];	/**< array of overlay colors in shared CPU/GPU memory */
-	uint8_t* mClassMap[2];		/**< runtime buffer for the argmax-classified class index of each tile */
+	uint8_t* mClassMap[2];		/**< runtime buffer for the argmax-classified class index of each tile (per batch entry) */
+	uint32_t mBatchSize;		/**< number of images in the last batch from Process() */
 
 	NetworkType mNetworkType;
 };
@@ -0,0 +1,480 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "segNet.h"
+
+#include "loadImage.h"
+#include "commandLine.h"
+#include "threadPool.h"
+#include "cudaMappedPool.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <signal.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+
+bool signal_recieved = false;
+
+void sig_handler(int signo)
+{
+	if( signo == SIGINT )
+	{
+		printf("received SIGINT\n");
+		signal_recieved = true;
+	}
+}
+
+
+uint64_t current_timestamp() {
+    struct timeval te;
+    gettimeofday(&te, NULL); // get current time
+    return te.tv_sec*1000LL + te.tv_usec/1000; // caculate milliseconds
+}
+
+
+// image that has made it through the decode stage
+struct batchImage
+{
+	std::string inputPath;
+	std::string outputPath;
+
+	float* cpu;
+	float* cuda;
+	int    width;
+	int    height;
+	bool   loaded;
+};
+
+
+// counting semaphore used to bound the number of images in flight
+class batchSlots
+{
+public:
+	batchSlots( uint32_t count ) : mCount(count) 	{ }
+
+	void Acquire()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mEvent.wait(lock, [this]{ return mCount > 0; });
+		mCount--;
+	}
+
+	void Release()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mCount++;
+		}
+
+		mEvent.notify_one();
+	}
+
+private:
+	uint32_t mCount;
+	std::mutex mMutex;
+	std::condition_variable mEvent;
+};
+
+
+// hasImageExtension
+static bool hasImageExtension( const char* filename )
+{
+	const char* ext = strrchr(filename, '.');
+
+	if( !ext )
+		return false;
+
+	return strcasecmp(ext, ".png") == 0 || strcasecmp(ext, ".jpg") == 0 ||
+		  strcasecmp(ext, ".jpeg") == 0 || strcasecmp(ext, ".bmp") == 0;
+}
+
+
+// listImages (from a directory, or a text file containing one path per line)
+static bool listImages( const char* path, std::vector<std::string>& files )
+{
+	struct stat st;
+
+	if( stat(path, &st) != 0 )
+	{
+		printf("segnet-batch:  failed to stat '%s'\n", path);
+		return false;
+	}
+
+	if( S_ISDIR(st.st_mode) )
+	{
+		DIR* dir = opendir(path);
+
+		if( !dir )
+		{
+			printf("segnet-batch:  failed to open directory '%s'\n", path);
+			return false;
+		}
+
+		struct dirent* entry = NULL;
+
+		while( (entry = readdir(dir)) != NULL )
+		{
+			if( entry->d_name[0] == '.' || !hasImageExtension(entry->d_name) )
+				continue;
+
+			files.push_back(std::string(path) + "/" + entry->d_name);
+		}
+
+		closedir(dir);
+		std::sort(files.begin(), files.end());
+	}
+	else
+	{
+		FILE* f = fopen(path, "r");
+
+		if( !f )
+		{
+			printf("segnet-batch:  failed to open file list '%s'\n", path);
+			return false;
+		}
+
+		char str[1024];
+
+		while( fgets(str, sizeof(str), f) != NULL )
+		{
+			const int len = strlen(str);
+
+			if( len > 0 && str[len-1] == '\n' )
+				str[len-1] = 0;
+
+			if( str[0] != 0 )
+				files.push_back(str);
+		}
+
+		fclose(f);
+	}
+
+	return true;
+}
+
+
+// outputFilename
+static std::string outputFilename( const std::string& input, const char* outputDir, bool mask )
+{
+	std::string name = input;
+
+	if( outputDir != NULL )
+	{
+		const size_t slash = input.find_last_of('/');
+		name = std::string(outputDir) + "/" + ((slash != std::string::npos) ? input.substr(slash + 1) : input);
+	}
+
+	// masks are always written losslessly
+	if( mask )
+	{
+		const size_t dot = name.find_last_of('.');
+		name = ((dot != std::string::npos) ? name.substr(0, dot) : name) + ".png";
+	}
+
+	return name;
+}
+
+
+// main entry point
+int main( int argc, char** argv )
+{
+	printf("segnet-batch\n  args (%i):  ", argc);
+
+	for( int i=0; i < argc; i++ )
+		printf("%i [%s]  ", i, argv[i]);
+
+	printf("\n\n");
+
+	if( argc < 2 || argv[1][0] == '-' )
+	{
+		printf("usage:  segnet-batch <image dir | file list> [output dir] [options]\n\n");
+		printf("   --network=NAME       pretrained network to load (default fcn-alexnet-cityscapes-sd)\n");
+		printf("   --model=PATH         custom caffemodel (with --prototxt, --labels, --colors)\n");
+		printf("   --batch_size=N       images per inference batch (default 2)\n");
+		printf("   --decode_threads=N   image decoding threads (default number of cores)\n");
+		printf("   --encode_threads=N   image encoding threads (default number of cores)\n");
+		printf("   --mask               write class index masks instead of overlays\n");
+		printf("   --alpha=N            overlay alpha for classes without an explicit alpha (default 120)\n");
+		printf("   --memory=TYPE        memory for the network bindings (device, mapped, pinned)\n\n");
+		printf("when no output directory is given, images are overwritten in place.\n");
+		return 0;
+	}
+
+	if( signal(SIGINT, sig_handler) == SIG_ERR )
+		printf("\ncan't catch SIGINT\n");
+
+	commandLine cmdLine(argc, argv);
+
+	const char* inputPath = argv[1];
+	const char* outputDir = (argc > 2 && argv[2][0] != '-') ? argv[2] : NULL;
+	const bool  maskMode  = cmdLine.GetFlag("mask");
+
+	int batchSize     = cmdLine.GetInt("batch_size");
+	int decodeThreads = cmdLine.GetInt("decode_threads");
+	int encodeThreads = cmdLine.GetInt("encode_threads");
+	float alpha       = cmdLine.GetFloat("alpha");
+
+	if( batchSize < 1 )		batchSize = 2;
+	if( decodeThreads < 1 )	decodeThreads = 0;
+	if( encodeThreads < 1 )	encodeThreads = 0;
+	if( alpha <= 0.0f )		alpha = 120.0f;
+
+
+	// gather the list of images to process
+	std::vector<std::string> files;
+
+	if( !listImages(inputPath, files) )
+		return 0;
+
+	printf("segnet-batch:  found %zu images in '%s'\n", files.size(), inputPath);
+
+	if( files.size() == 0 )
+		return 0;
+
+	if( outputDir != NULL )
+		mkdir(outputDir, 0755);
+
+
+	// select where the network bindings get allocated
+	const char* memoryStr = cmdLine.GetString("memory");
+
+	if( memoryStr != NULL )
+	{
+		cudaMemoryType memoryType;
+
+		if( !cudaMemoryTypeFromStr(memoryStr, &memoryType) )
+		{
+			printf("segnet-batch:   unknown memory type '%s'\n", memoryStr);
+			return 0;
+		}
+
+		cudaAllocator::SetDefaultType(memoryType);
+	}
+
+
+	// create the segNet once for the whole batch job
+	segNet* net = NULL;
+
+	if( cmdLine.GetString("model") != NULL )
+	{
+		net = segNet::Create(argc, argv);
+	}
+	else
+	{
+		const char* networkName = cmdLine.GetString("network");
+		const segNet::NetworkType type = segNet::NetworkTypeFromStr(networkName ? networkName : "fcn-alexnet-cityscapes-sd");
+
+		if( type == segNet::SEGNET_CUSTOM )
+		{
+			printf("segnet-batch:   unknown network '%s'\n", networkName);
+			return 0;
+		}
+
+		net = segNet::Create(type, batchSize);
+	}
+
+	if( !net )
+	{
+		printf("segnet-batch:   failed to initialize segnet\n");
+		return 0;
+	}
+
+	if( (uint32_t)batchSize > net->GetMaxBatchSize() )
+		batchSize = net->GetMaxBatchSize();
+
+	net->SetGlobalAlpha(alpha);
+
+
+	// setup the decode & encode stages
+	threadPool* decodePool = threadPool::Create(decodeThreads);
+	threadPool* encodePool = threadPool::Create(encodeThreads);
+
+	if( !decodePool || !encodePool )
+	{
+		printf("segnet-batch:   failed to create worker threads\n");
+		return 0;
+	}
+
+	printf("segnet-batch:  batch size %i, %u decode threads, %u encode threads\n", batchSize, decodePool->GetNumThreads(), encodePool->GetNumThreads());
+
+	batchSlots slots(batchSize * 4);	// bounds the memory used by decoded images waiting on the GPU or encoder
+
+	std::vector<batchImage*> decoded;
+	std::mutex decodeMutex;
+	std::condition_variable decodeEvent;
+
+	const uint64_t timeBegin = current_timestamp();
+
+	for( size_t n=0; n < files.size(); n++ )
+	{
+		const std::string inputFile  = files[n];
+		const std::string outputFile = outputFilename(inputFile, outputDir, maskMode);
+
+		decodePool->Enqueue([&, inputFile, outputFile]()
+		{
+			slots.Acquire();
+
+			batchImage* img = new batchImage();
+
+			img->inputPath  = inputFile;
+			img->outputPath = outputFile;
+			img->cpu        = NULL;
+			img->cuda       = NULL;
+			img->width      = 0;
+			img->height     = 0;
+			img->loaded     = !signal_recieved && loadImageRGBA(inputFile.c_str(), (float4**)&img->cpu, (float4**)&img->cuda, &img->width, &img->height);
+
+			{
+				std::lock_guard<std::mutex> lock(decodeMutex);
+				decoded.push_back(img);
+			}
+
+			decodeEvent.notify_one();
+		});
+	}
+
+
+	// run inference on batches as images become available
+	size_t numRemaining = files.size();
+	size_t numFailed    = 0;
+
+	while( numRemaining > 0 )
+	{
+		std::vector<batchImage*> batch;
+
+		{
+			const size_t batchMax = std::min<size_t>(batchSize, numRemaining);
+
+			std::unique_lock<std::mutex> lock(decodeMutex);
+			decodeEvent.wait(lock, [&]{ return decoded.size() >= batchMax; });
+
+			batch.assign(decoded.begin(), decoded.begin() + batchMax);
+			decoded.erase(decoded.begin(), decoded.begin() + batchMax);
+		}
+
+		numRemaining -= batch.size();
+
+		// drop images that failed to load
+		std::vector<float*>   batchCUDA;
+		std::vector<uint32_t> batchWidth;
+		std::vector<uint32_t> batchHeight;
+
+		for( size_t n=0; n < batch.size(); n++ )
+		{
+			if( !batch[n]->loaded )
+			{
+				if( !signal_recieved )
+					printf("segnet-batch:  failed to load image '%s'\n", batch[n]->inputPath.c_str());
+
+				numFailed++;
+
+				if( batch[n]->cpu != NULL )
+					cudaFreeMappedPool(batch[n]->cpu);
+
+				delete batch[n];
+				slots.Release();
+
+				batch.erase(batch.begin() + n);
+				n--;
+				continue;
+			}
+
+			batchCUDA.push_back(batch[n]->cuda);
+			batchWidth.push_back(batch[n]->width);
+			batchHeight.push_back(batch[n]->height);
+		}
+
+		if( batch.size() == 0 )
+			continue;
+
+		const bool result = net->Process(&batchCUDA[0], &batchWidth[0], &batchHeight[0], batch.size());
+
+		if( !result )
+			printf("segnet-batch:  failed to process batch of %zu images\n", batch.size());
+
+		// produce the outputs and hand them off to the encoder threads
+		for( size_t n=0; n < batch.size(); n++ )
+		{
+			batchImage* img = batch[n];
+
+			if( !result )
+			{
+				numFailed++;
+				cudaFreeMappedPool(img->cpu);
+				delete img;
+				slots.Release();
+				continue;
+			}
+
+			if( maskMode )
+			{
+				uint8_t* mask = (uint8_t*)malloc(img->width * img->height);
+
+				if( !mask || !net->GetMask(n, mask, img->width, img->height) )
+				{
+					printf("segnet-batch:  failed to generate mask for '%s'\n", img->inputPath.c_str());
+					free(mask);
+					mask = NULL;
+				}
+
+				// the decoded image is no longer needed
+				cudaFreeMappedPool(img->cpu);
+				img->cpu = NULL;
+
+				encodePool->Enqueue([&, img, mask]()
+				{
+					if( mask != NULL )
+					{
+						if( !saveImageGray(img->outputPath.c_str(), mask, img->width, img->height) )
+							printf("segnet-batch:  failed to save output image to '%s'\n", img->outputPath.c_str());
+
+						free(mask);
+					}
+
+					delete img;
+					slots.Release();
+				});
+			}
+			else
+			{
+				// blend the overlay in place, since the original isn't needed afterwards
+				if( !net->GetOverlay(n, img->cuda, img->cuda, img->width, img->height) )
+					printf("segnet-batch:  failed to generate overlay for '%s'\n", img->inputPath.c_str());
+
+				encodePool->Enqueue([&, img]()
+				{
+					if( !saveImageRGBA(img->outputPath.c_str(), (float4*)img->cpu, img->width, img->height) )
+						printf("segnet-batch:  failed to save output image to '%s'\n", img->outputPath.c_str());
+
+					cudaFreeMappedPool(img->cpu);
+					delete img;
+					slots.Release();
+				});
+			}
+		}
+	}
+
+	decodePool->Wait();
+	encodePool->Wait();
+
+	const uint64_t timeElapsed = current_timestamp() - timeBegin;
+	const size_t   numImages   = files.size() - numFailed;
+
+	printf("\nsegnet-batch:  processed %zu images (%zu failed) in %.2f seconds, %.2f images/sec\n",
+		  numImages, numFailed, timeElapsed / 1000.0f, (timeElapsed > 0) ? (numImages * 1000.0f / timeElapsed) : 0.0f);
+
+	cudaMappedPool::Default()->PrintStats();
+
+	printf("\nshutting down...\n");
+	delete decodePool;
+	delete encodePool;
+	delete net;
+	return 0;
+}
@@ -74,7 +74,7 @@ int main( int argc, char** argv )
 	float* outCPU  = NULL;
 	float* outCUDA = NULL;
 
-	if( !cudaAllocMapped((void**)&outCPU, (void**)&outCUDA, imgWidth * imgHeight * sizeof(float) * 4) )
+	if( !cudaAllocMappedPool((void**)&outCPU, (void**)&outCUDA, imgWidth * imgHeight * sizeof(float) * 4) )
 	{
 		printf("segnet-console:  failed to allocate CUDA memory for output image (%ix%i)\n", imgWidth, imgHeight);
 		return 0;
@@ -102,8 +102,8 @@ int main( int argc, char** argv )
 
 	
 	printf("\nshutting down...\n");
-	CUDA(cudaFreeHost(imgCPU));
-	CUDA(cudaFreeHost(outCPU));
+	cudaFreeMappedPool(imgCPU);
+	cudaFreeMappedPool(outCPU);
 	delete net;
 	return 0;
 }
@@ -0,0 +1,30 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "tensorBackend.h"
+
+#ifndef CPU_ONLY
+#include "tensorBackendGIE.h"
+
+static tensorBackend::Factory gFactory = tensorBackendGIE::Create;
+#else
+static tensorBackend::Factory gFactory = NULL;	// there's no TensorRT, one needs to be registered
+#endif
+
+
+// Create
+tensorBackend* tensorBackend::Create()
+{
+	if( !gFactory )
+		return NULL;
+
+	return gFactory();
+}
+
+
+// SetFactory
+void tensorBackend::SetFactory( Factory factory )
+{
+	gFactory = factory;
+}
@@ -0,0 +1,114 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __TENSOR_BACKEND_H__
+#define __TENSOR_BACKEND_H__
+
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+/**
+ * Prefix used for tagging printed log output
+ * @ingroup deepVision
+ */
+#define LOG_GIE "[GIE]  "
+
+
+/**
+ * Dimensions of a network binding (per batch item).
+ * @ingroup deepVision
+ */
+struct tensorDims
+{
+	int c;	/**< channels */
+	int h;	/**< height */
+	int w;	/**< width */
+};
+
+
+/**
+ * Inference engine that tensorNet runs networks with.  By default this is TensorRT
+ * (tensorBackendGIE), but another implementation can be registered with SetFactory(),
+ * which is how CPU_ONLY builds (that don't have TensorRT) are able to run networks.
+ *
+ * The bindings passed to Execute() are ordered as the input followed by the outputs,
+ * in the order that they were requested from Load().
+ * @ingroup deepVision
+ */
+class tensorBackend
+{
+public:
+	/**
+	 * Function that creates a new backend instance.
+	 */
+	typedef tensorBackend* (*Factory)();
+
+	/**
+	 * Create a new instance of the registered backend.
+	 * @returns NULL if no backend is available (i.e. in CPU_ONLY builds, until one is registered)
+	 */
+	static tensorBackend* Create();
+
+	/**
+	 * Register the factory used by Create() for networks loaded from now on.
+	 */
+	static void SetFactory( Factory factory );
+
+	/**
+	 * Destroy
+	 */
+	virtual ~tensorBackend()		{ }
+
+	/**
+	 * Load a network model and prepare it for execution.
+	 * @param prototxt File path to the deployable network prototxt
+	 * @param model File path to the caffemodel
+	 * @param outputs names of the output blobs
+	 * @param maxBatchSize maximum batch size the network will be executed with
+	 */
+	virtual bool Load( const char* prototxt, const char* model,
+				    const std::vector<std::string>& outputs, uint32_t maxBatchSize ) = 0;
+
+	/**
+	 * Retrieve the dimensions of an input or output blob of the loaded network.
+	 */
+	virtual bool GetDims( const char* blob, tensorDims* dims ) = 0;
+
+	/**
+	 * Run the network on a batch.
+	 * @param bindings GPU pointers to the input followed by each of the outputs
+	 */
+	virtual bool Execute( uint32_t batchSize, void** bindings ) = 0;
+
+	/**
+	 * Enable layer profiling times.
+	 */
+	virtual void EnableProfiler()		{ }
+
+	/**
+	 * Enable debug messages and synchronization (before Load).
+	 */
+	virtual void EnableDebug()		{ }
+
+	/**
+	 * Disable FP16 (before Load).
+	 */
+	virtual void DisableFP16()		{ }
+
+	/**
+	 * Query for half-precision FP16 support.
+	 */
+	virtual bool HasFP16() const		{ return false; }
+
+	/**
+	 * Print the profiling timings accumulated since the last report.
+	 */
+	virtual void ProfilerReport()		{ }
+};
+
+
+#endif
@@ -0,0 +1,311 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+ 
+#include "tensorBackendGIE.h"
+
+#include <iostream>
+#include <fstream>
+
+
+
+// constructor
+tensorBackendGIE::tensorBackendGIE()
+{
+	mEngine  = NULL;
+	mInfer   = NULL;
+	mContext = NULL;
+
+	mEnableDebug    = false;
+	mEnableProfiler = false;
+	mEnableFP16     = false;
+	mOverride16     = false;
+}
+
+
+// Destructor
+tensorBackendGIE::~tensorBackendGIE()
+{
+	if( mContext != NULL )
+	{
+		mContext->destroy();
+		mContext = NULL;
+	}
+
+	if( mEngine != NULL )
+	{
+		mEngine->destroy();
+		mEngine = NULL;
+	}
+		
+	if( mInfer != NULL )
+	{
+		mInfer->destroy();
+		mInfer = NULL;
+	}
+}
+
+
+// Create
+tensorBackend* tensorBackendGIE::Create()
+{
+	return new tensorBackendGIE();
+}
+
+
+// EnableProfiler
+void tensorBackendGIE::EnableProfiler()
+{
+	mEnableProfiler = true;
+
+	if( mContext != NULL )
+		mContext->setProfiler(&gProfiler);
+}
+
+
+// EnableDebug
+void tensorBackendGIE::EnableDebug()
+{
+	mEnableDebug = true;
+}
+
+
+// DisableFP16 (i.e. for debugging or unsupported network)
+void tensorBackendGIE::DisableFP16()
+{
+	mOverride16 = true;
+}
+
+
+// ProfilerReport
+void tensorBackendGIE::ProfilerReport()
+{
+	if( !mEnableProfiler )
+		return;
+
+	printf(LOG_GIE "layer network time - %f ms\n", gProfiler.timingAccumulator);
+	gProfiler.timingAccumulator = 0.0f;
+}
+
+
+// Create an optimized GIE network from caffe prototxt and model file
+bool tensorBackendGIE::ProfileModel(const std::string& deployFile,			   // name for caffe prototxt
+					         const std::string& modelFile,			   // name for model 
+					         const std::vector<std::string>& outputs,   // network outputs
+					         unsigned int maxBatchSize,				   // batch size - NB must be at least as large as the batch we want to run with)
+					         std::ostream& gieModelStream)			   // output stream for the GIE model
+{
+	// create API root class - must span the lifetime of the engine usage
+	nvinfer1::IBuilder* builder = createInferBuilder(gLogger);
+	nvinfer1::INetworkDefinition* network = builder->createNetwork();
+
+	builder->setDebugSync(mEnableDebug);
+	builder->setMinFindIterations(3);	// allow time for TX1 GPU to spin up
+     builder->setAverageFindIterations(2);
+
+	// parse the caffe model to populate the network, then set the outputs
+	nvcaffeparser1::ICaffeParser* parser = nvcaffeparser1::createCaffeParser();
+
+	mEnableFP16 = (mOverride16 == true) ? false : builder->platformHasFastFp16();
+	printf(LOG_GIE "platform %s FP16 support.\n", mEnableFP16 ? "has" : "does not have");
+	printf(LOG_GIE "loading %s %s\n", deployFile.c_str(), modelFile.c_str());
+	
+	nvinfer1::DataType modelDataType = mEnableFP16 ? nvinfer1::DataType::kHALF : nvinfer1::DataType::kFLOAT; // create a 16-bit model if it's natively supported
+	const nvcaffeparser1::IBlobNameToTensor *blobNameToTensor =
+		parser->parse(deployFile.c_str(),		// caffe deploy file
+					  modelFile.c_str(),		// caffe model file
+					 *network,					// network definition that the parser will populate
+					  modelDataType);
+
+	if( !blobNameToTensor )
+	{
+		printf(LOG_GIE "failed to parse caffe network\n");
+		return false;
+	}
+	
+	// the caffe file has no notion of outputs, so we need to manually say which tensors the engine should generate	
+	const size_t num_outputs = outputs.size();
+	
+	for( size_t n=0; n < num_outputs; n++ )
+	{
+		nvinfer1::ITensor* tensor = blobNameToTensor->find(outputs[n].c_str());
+	
+		if( !tensor )
+			printf(LOG_GIE "failed to retrieve tensor for output '%s'\n", outputs[n].c_str());
+		else
+			printf(LOG_GIE "retrieved output tensor '%s'\n", tensor->getName());
+
+		network->markOutput(*tensor);
+	}
+
+	// Build the engine
+	printf(LOG_GIE "configuring CUDA engine\n");
+		
+	builder->setMaxBatchSize(maxBatchSize);
+	builder->setMaxWorkspaceSize(16 << 20);
+
+	// set up the network for paired-fp16 format
+	if(mEnableFP16)
+		builder->setHalf2Mode(true);
+
+	printf(LOG_GIE "building CUDA engine\n");
+	nvinfer1::ICudaEngine* engine = builder->buildCudaEngine(*network);
+	
+	if( !engine )
+	{
+		printf(LOG_GIE "failed to build CUDA engine\n");
+		return false;
+	}
+
+	printf(LOG_GIE "completed building CUDA engine\n");
+
+	// we don't need the network any more, and we can destroy the parser
+	network->destroy();
+	parser->destroy(); //delete parser;
+
+	// serialize the engine, then close everything down
+	engine->serialize(gieModelStream);
+	engine->destroy();
+	builder->destroy();
+	
+	return true;
+}
+
+
+
+
+// Load
+bool tensorBackendGIE::Load( const char* prototxt_path, const char* model_path,
+					    const std::vector<std::string>& output_blobs, uint32_t maxBatchSize )
+{
+	/*
+	 * attempt to load network from cache before profiling with tensorRT
+	 */
+	std::stringstream gieModelStream;
+	gieModelStream.seekg(0, gieModelStream.beg);
+
+	char cache_path[512];
+	sprintf(cache_path, "%s.%u.tensorcache", model_path, maxBatchSize);
+	printf(LOG_GIE "attempting to open cache file %s\n", cache_path);
+	
+	std::ifstream cache( cache_path );
+
+	if( !cache )
+	{
+		printf(LOG_GIE "cache file not found, profiling network model\n");
+	
+		if( !ProfileModel(prototxt_path, model_path, output_blobs, maxBatchSize, gieModelStream) )
+		{
+			printf("failed to load %s\n", model_path);
+			return false;
+		}
+	
+		printf(LOG_GIE "network profiling complete, writing cache to %s\n", cache_path);
+		std::ofstream outFile;
+		outFile.open(cache_path);
+		outFile << gieModelStream.rdbuf();
+		outFile.close();
+		gieModelStream.seekg(0, gieModelStream.beg);
+		printf(LOG_GIE "completed writing cache to %s\n", cache_path);
+	}
+	else
+	{
+		printf(LOG_GIE "loading network profile from cache... %s\n", cache_path);
+		gieModelStream << cache.rdbuf();
+		cache.close();
+
+		// test for half FP16 support
+		nvinfer1::IBuilder* builder = createInferBuilder(gLogger);
+		
+		if( builder != NULL )
+		{
+			mEnableFP16 = !mOverride16 && builder->platformHasFastFp16();
+			printf(LOG_GIE "platform %s FP16 support.\n", mEnableFP16 ? "has" : "does not have");
+			builder->destroy();	
+		}
+	}
+
+	printf(LOG_GIE "%s loaded\n", model_path);
+	
+
+	
+	/*
+	 * create runtime inference engine execution context
+	 */
+	nvinfer1::IRuntime* infer = createInferRuntime(gLogger);
+	
+	if( !infer )
+	{
+		printf(LOG_GIE "failed to create InferRuntime\n");
+		return false;
+	}
+	
+	nvinfer1::ICudaEngine* engine = infer->deserializeCudaEngine(gieModelStream);
+
+	if( !engine )
+	{
+		printf(LOG_GIE "failed to create CUDA engine\n");
+		return false;
+	}
+	
+	nvinfer1::IExecutionContext* context = engine->createExecutionContext();
+	
+	if( !context )
+	{
+		printf(LOG_GIE "failed to create execution context\n");
+		return false;
+	}
+
+	if( mEnableDebug )
+	{
+		printf(LOG_GIE "enabling context debug sync.\n");
+		context->setDebugSync(true);
+	}
+
+	if( mEnableProfiler )
+		context->setProfiler(&gProfiler);
+
+	printf(LOG_GIE "CUDA engine context initialized with %u bindings\n", engine->getNbBindings());
+	
+	mInfer   = infer;
+	mEngine  = engine;
+	mContext = context;
+
+	return true;
+}
+
+
+// GetDims
+bool tensorBackendGIE::GetDims( const char* blob, tensorDims* dims )
+{
+	if( !mEngine || !blob || !dims )
+		return false;
+
+	const int index = mEngine->getBindingIndex(blob);
+
+	if( index < 0 )
+	{
+		printf(LOG_GIE "failed to find binding '%s'\n", blob);
+		return false;
+	}
+
+	printf(LOG_GIE "%s  binding index:  %i\n", blob, index);
+
+	const nvinfer1::Dims3 bindingDims = mEngine->getBindingDimensions(index);
+
+	dims->c = bindingDims.c;
+	dims->h = bindingDims.h;
+	dims->w = bindingDims.w;
+
+	return true;
+}
+
+
+// Execute
+bool tensorBackendGIE::Execute( uint32_t batchSize, void** bindings )
+{
+	if( !mContext )
+		return false;
+
+	return mContext->execute(batchSize, bindings);
+}
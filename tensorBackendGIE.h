@@ -0,0 +1,105 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __TENSOR_BACKEND_GIE_H__
+#define __TENSOR_BACKEND_GIE_H__
+
+
+#include "tensorBackend.h"
+
+#include "NvInfer.h"
+#include "NvCaffeParser.h"
+
+#include <sstream>
+#include <stdio.h>
+
+
+/**
+ * tensorBackend that runs networks with TensorRT (GIE), caching the
+ * optimized engine next to the model as <model>.<batch>.tensorcache
+ * @ingroup deepVision
+ */
+class tensorBackendGIE : public tensorBackend
+{
+public:
+	/**
+	 * Create a new TensorRT backend (the default tensorBackend factory)
+	 */
+	static tensorBackend* Create();
+
+	/**
+	 * Destroy
+	 */
+	virtual ~tensorBackendGIE();
+
+	virtual bool Load( const char* prototxt, const char* model,
+				    const std::vector<std::string>& outputs, uint32_t maxBatchSize );
+
+	virtual bool GetDims( const char* blob, tensorDims* dims );
+	virtual bool Execute( uint32_t batchSize, void** bindings );
+
+	virtual void EnableProfiler();
+	virtual void EnableDebug();
+	virtual void DisableFP16();
+
+	virtual bool HasFP16() const		{ return mEnableFP16; }
+	virtual void ProfilerReport();
+
+protected:
+	tensorBackendGIE();
+
+	/**
+	 * Create and output an optimized network model
+	 * @param deployFile name for network prototxt
+	 * @param modelFile name for model
+	 * @param outputs network outputs
+	 * @param maxBatchSize maximum batch size
+	 * @param modelStream output model stream
+	 */
+	bool ProfileModel( const std::string& deployFile, const std::string& modelFile,
+				    const std::vector<std::string>& outputs,
+				    uint32_t maxBatchSize, std::ostream& modelStream);
+
+	/**
+	 * Logger class for GIE info/warning/errors
+	 */
+	class Logger : public nvinfer1::ILogger
+	{
+		void log( Severity severity, const char* msg ) override
+		{
+			if( severity != Severity::kINFO /*|| mEnableDebug*/ )
+				printf(LOG_GIE "%s\n", msg);
+		}
+	} gLogger;
+
+	/**
+	 * Profiler interface for measuring layer timings
+	 */
+	class Profiler : public nvinfer1::IProfiler
+	{
+	public:
+		Profiler() : timingAccumulator(0.0f)	{ }
+
+		virtual void reportLayerTime(const char* layerName, float ms)
+		{
+			printf(LOG_GIE "layer %s - %f ms\n", layerName, ms);
+			timingAccumulator += ms;
+		}
+
+		float timingAccumulator;
+
+	} gProfiler;
+
+	nvinfer1::IRuntime* mInfer;
+	nvinfer1::ICudaEngine* mEngine;
+	nvinfer1::IExecutionContext* mContext;
+
+	bool mEnableProfiler;
+	bool mEnableDebug;
+	bool mEnableFP16;
+	bool mOverride16;
+};
+
+
+#endif
@@ -6,14 +6,12 @@
 #define __TENSOR_NET_H__
 
 
-#include "NvInfer.h"
-#include "NvCaffeParser.h"
-
-#include <sstream>
+#include "tensorBackend.h"
+#include "cudaAllocator.h"
 
 
 /**
- * Abstract class for loading a tensor network with TensorRT.
+ * Abstract class for loading a tensor network with TensorRT (or the registered tensorBackend).
  * For example implementations, @see imageNet and @see detectNet
  * @ingroup deepVision
  */
@@ -69,7 +67,18 @@ public:
 	/**
  	 * Query for half-precision FP16 support.
 	 */
-	inline bool HasFP16() const		{ return mEnableFP16; }
+	inline bool HasFP16() const		{ return mBackend != NULL && mBackend->HasFP16(); }
+
+	/**
+	 * Retrieve the maximum batch size the network was optimized for.
+	 */
+	inline uint32_t GetMaxBatchSize() const	{ return mMaxBatchSize; }
+
+	/**
+	 * Retrieve the type of memory the network's input/output bindings were allocated with.
+	 * This is selected by cudaAllocator::GetDefaultType() when the network is loaded.
+	 */
+	inline cudaMemoryType GetMemoryType() const	{ return mAllocator->GetType(); }
 
 	
 protected:
@@ -80,58 +89,17 @@ protected:
 	tensorNet();
 			  
 	/**
-	 * Create and output an optimized network model
-	 * @note this function is automatically used by LoadNetwork, but also can 
-	 *       be used individually to perform the network operations offline.
-	 * @param deployFile name for network prototxt
-	 * @param modelFile name for model
-	 * @param outputs network outputs
-	 * @param maxBatchSize maximum batch size 
-	 * @param modelStream output model stream
+	 * Run inference on the bindings, and if the binding memory isn't shared with
+	 * the CPU, copy the outputs for the batch back to their CPU buffers.
+	 * @param batchSize number of images in the batch (up to the max batch size)
+	 * @param bindings array of GPU pointers to the input and output bindings
 	 */
-	bool ProfileModel( const std::string& deployFile, const std::string& modelFile,
-				    const std::vector<std::string>& outputs,
-				    uint32_t maxBatchSize, std::ostream& modelStream);
+	bool executeNetwork( uint32_t batchSize, void** bindings );
 				
-	/**
-	 * Prefix used for tagging printed log output
-	 */
-	#define LOG_GIE "[GIE]  "
-	
-	/**
-	 * Logger class for GIE info/warning/errors
-	 */
-	class Logger : public nvinfer1::ILogger			
-	{
-		void log( Severity severity, const char* msg ) override
-		{
-			if( severity != Severity::kINFO /*|| mEnableDebug*/ )
-				printf(LOG_GIE "%s\n", msg);
-		}
-	} gLogger;
-
-	/**
-	 * Profiler interface for measuring layer timings
-	 */
-	class Profiler : public nvinfer1::IProfiler
-	{
-	public:
-		Profiler() : timingAccumulator(0.0f)	{ }
-		
-		virtual void reportLayerTime(const char* layerName, float ms)
-		{
-			printf(LOG_GIE "layer %s - %f ms\n", layerName, ms);
-			timingAccumulator += ms;
-		}
-		
-		float timingAccumulator;
-		
-	} gProfiler;
-
 	/**
 	 * When profiling is enabled, end a profiling section and report timing statistics.
 	 */
-	inline void PROFILER_REPORT()		{ if(mEnableProfiler) { printf(LOG_GIE "layer network time - %f ms\n", gProfiler.timingAccumulator); gProfiler.timingAccumulator = 0.0f; } }
+	inline void PROFILER_REPORT()		{ if(mBackend != NULL) mBackend->ProfilerReport(); }
 
 protected:
 
@@ -141,9 +109,10 @@ protected:
 	std::string mMeanPath;
 	std::string mInputBlobName;
 
-	nvinfer1::IRuntime* mInfer;
-	nvinfer1::ICudaEngine* mEngine;
-	nvinfer1::IExecutionContext* mContext;
+	tensorBackend* mBackend;	/**< inference engine that runs the network */
+
+	cudaAllocator* mAllocator;
+	cudaArena*     mBindings;	/**< arena holding the input and output buffers */
 	
 	uint32_t mWidth;
 	uint32_t mHeight;
@@ -153,15 +122,14 @@ protected:
 	uint32_t mMaxBatchSize;
 	bool	 mEnableProfiler;
 	bool     mEnableDebug;
-	bool	 mEnableFP16;
 	bool     mOverride16;
 	
-	nvinfer1::Dims3 mInputDims;
+	tensorDims mInputDims;
 	
 	struct outputLayer
 	{
 		std::string name;
-		nvinfer1::Dims3 dims;
+		tensorDims dims;
 		uint32_t size;
 		float* CPU;
 		float* CUDA;
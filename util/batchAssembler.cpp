@@ -0,0 +1,200 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "batchAssembler.h"
+
+#include <stdio.h>
+#include <chrono>
+
+
+// constructor
+batchAssembler::batchAssembler()
+{
+	mMaxBatchSize = 0;
+	mWindow       = 0;
+	mPendingSince = 0;
+	mRunning      = false;
+	mStop         = false;
+
+	mBatches.store(0);
+	mFrames.store(0);
+	mDropped.store(0);
+}
+
+
+// destructor
+batchAssembler::~batchAssembler()
+{
+	Stop();
+}
+
+
+// Create
+batchAssembler* batchAssembler::Create( uint32_t maxBatchSize, uint32_t window, const BatchFunc& process, const ReleaseFunc& release )
+{
+	if( maxBatchSize == 0 || !process )
+		return NULL;
+
+	batchAssembler* assembler = new batchAssembler();
+
+	if( !assembler )
+		return NULL;
+
+	assembler->mMaxBatchSize = maxBatchSize;
+	assembler->mWindow       = (uint64_t)window * 1000;
+	assembler->mProcess      = process;
+	assembler->mRelease      = release;
+
+	assembler->mPending.reserve(maxBatchSize);
+	return assembler;
+}
+
+
+// Start
+bool batchAssembler::Start()
+{
+	if( mRunning )
+		return true;
+
+	mStop    = false;
+	mRunning = true;
+	mThread  = std::thread(&batchAssembler::processThread, this);
+
+	return true;
+}
+
+
+// Stop
+void batchAssembler::Stop()
+{
+	if( !mRunning )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+
+	mEvent.notify_all();
+	mThread.join();
+
+	release(mPending);
+	mRunning = false;
+}
+
+
+// release
+void batchAssembler::release( std::vector<frame>& frames )
+{
+	if( mRelease )
+	{
+		for( size_t n=0; n < frames.size(); n++ )
+			mRelease(frames[n]);
+	}
+
+	frames.clear();
+}
+
+
+// Push
+void batchAssembler::Push( uint32_t source, void* cpu, void* cuda, const frameStamp& stamp )
+{
+	frame f;
+
+	f.source = source;
+	f.cpu    = cpu;
+	f.cuda   = cuda;
+	f.stamp  = stamp;
+
+	frame replaced;
+	bool  wasReplaced = false;
+	bool  full = false;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		// the newest frame from a source wins
+		for( size_t n=0; n < mPending.size(); n++ )
+		{
+			if( mPending[n].source != source )
+				continue;
+
+			replaced    = mPending[n];
+			mPending[n] = f;
+			wasReplaced = true;
+			break;
+		}
+
+		if( !wasReplaced )
+		{
+			if( mPending.size() == 0 )
+				mPendingSince = traceTime();
+
+			mPending.push_back(f);
+		}
+
+		full = (mPending.size() >= mMaxBatchSize);
+	}
+
+	if( wasReplaced )
+	{
+		mDropped++;
+
+		if( mRelease )
+			mRelease(replaced);
+	}
+
+	// the thread is woken up by the timeout when the batch isn't full yet,
+	// but it has to find out about the first frame to start the window
+	if( full || !wasReplaced )
+		mEvent.notify_one();
+}
+
+
+// processThread
+void batchAssembler::processThread()
+{
+	std::vector<frame> batch;
+	batch.reserve(mMaxBatchSize);
+
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+
+			while( !mStop )
+			{
+				if( mPending.size() >= mMaxBatchSize )
+					break;
+
+				if( mPending.size() == 0 )
+				{
+					mEvent.wait(lock);
+					continue;
+				}
+
+				// wait out what's left of the window for the oldest frame
+				const uint64_t now = traceTime();
+				const uint64_t deadline = mPendingSince + mWindow;
+
+				if( now >= deadline )
+					break;
+
+				mEvent.wait_for(lock, std::chrono::nanoseconds(deadline - now));
+			}
+
+			if( mStop )
+				return;
+
+			batch.swap(mPending);
+		}
+
+		mProcess(batch.data(), batch.size());
+
+		mBatches++;
+		mFrames += batch.size();
+
+		release(batch);
+	}
+}
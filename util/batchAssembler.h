@@ -0,0 +1,143 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __BATCH_ASSEMBLER_H_
+#define __BATCH_ASSEMBLER_H_
+
+
+#include "latencyTrace.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Collects frames from several video streams into batches, so that one pass through
+ * a network (with batch size > 1) serves all of the cameras instead of one per frame.
+ *
+ * A batch is processed once it holds maxBatchSize frames, or once the oldest frame in it
+ * has waited for the latency window, whichever comes first.  Each source has at most one
+ * frame in a batch:  if a newer frame from the same source arrives before the batch is
+ * processed, it replaces the older one.  With as many sources as the batch size, batches
+ * normally fill up without waiting for the window to expire.
+ *
+ * Batches are processed on the assembler's own thread, which then releases the frames.
+ * Frames from a captureManager can be pushed from its callback (returning true to keep
+ * them), with the release function handing them back through captureManager::Release().
+ * @ingroup util
+ */
+class batchAssembler
+{
+public:
+	/**
+	 * A frame waiting in a batch.
+	 */
+	struct frame
+	{
+		uint32_t   source;	/**< index of the stream it came from */
+		void*      cpu;		/**< CPU address of the image */
+		void*      cuda;		/**< CUDA address of the image */
+		frameStamp stamp;	/**< sequence number and capture time */
+	};
+
+	/**
+	 * Processes a batch of frames (from different sources) and passes the results back to each stream.
+	 */
+	typedef std::function<void( const frame* frames, uint32_t batchSize )> BatchFunc;
+
+	/**
+	 * Gives a frame back to its source once it's been processed (or replaced by a newer frame).
+	 */
+	typedef std::function<void( const frame& frame )> ReleaseFunc;
+
+	/**
+	 * Create a new batch assembler.
+	 * @param maxBatchSize maximum number of frames in a batch (e.g. the network's GetMaxBatchSize())
+	 * @param window latency budget in microseconds, the longest that a frame waits for the batch to fill
+	 * @param process called with each batch
+	 * @param release optional, called for every frame after it's done with
+	 */
+	static batchAssembler* Create( uint32_t maxBatchSize, uint32_t window, const BatchFunc& process,
+							 const ReleaseFunc& release=ReleaseFunc() );
+
+	/**
+	 * Destroy (stopping the processing thread if needed)
+	 */
+	~batchAssembler();
+
+	/**
+	 * Launch the processing thread.
+	 */
+	bool Start();
+
+	/**
+	 * Stop the processing thread, releasing any frames still waiting.
+	 */
+	void Stop();
+
+	/**
+	 * Add a frame to the next batch (from any thread).
+	 */
+	void Push( uint32_t source, void* cpu, void* cuda, const frameStamp& stamp );
+
+	/**
+	 * Maximum number of frames in a batch.
+	 */
+	inline uint32_t GetMaxBatchSize() const			{ return mMaxBatchSize; }
+
+	/**
+	 * Number of batches that have been processed.
+	 */
+	inline uint64_t GetBatches() const				{ return mBatches; }
+
+	/**
+	 * Number of frames that have been processed.
+	 */
+	inline uint64_t GetFrames() const				{ return mFrames; }
+
+	/**
+	 * Number of frames that were replaced by a newer one from the same source.
+	 */
+	inline uint64_t GetDropped() const				{ return mDropped; }
+
+	/**
+	 * Average number of frames per batch.
+	 */
+	inline float GetAverageBatchSize() const			{ return mBatches > 0 ? float(mFrames) / float(mBatches) : 0.0f; }
+
+protected:
+	batchAssembler();
+
+	void processThread();
+	void release( std::vector<frame>& frames );
+
+	BatchFunc   mProcess;
+	ReleaseFunc mRelease;
+
+	uint32_t mMaxBatchSize;
+	uint64_t mWindow;		// in nanoseconds
+
+	std::vector<frame> mPending;
+	uint64_t mPendingSince;	// when the first frame of the pending batch arrived
+
+	std::mutex mMutex;
+	std::condition_variable mEvent;
+	std::thread mThread;
+
+	std::atomic<uint64_t> mBatches;
+	std::atomic<uint64_t> mFrames;
+	std::atomic<uint64_t> mDropped;
+
+	bool mRunning;
+	bool mStop;
+};
+
+
+#endif
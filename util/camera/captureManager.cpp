@@ -0,0 +1,323 @@
+/*
+ * inference-101
+ */
+
+#include "captureManager.h"
+#include "v4l2Camera.h"
+
+#ifndef CPU_ONLY
+#include "gstCamera.h"
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+
+#define MAX_EVENTS 16
+#define WAKE_EVENT UINT32_MAX
+
+
+// constructor
+captureManager::captureManager()
+{
+	mEpollFD = -1;
+	mWakeFD  = -1;
+	mRunning = false;
+	mStop    = false;
+}
+
+
+// destructor
+captureManager::~captureManager()
+{
+	Stop();
+
+	if( mWakeFD >= 0 )
+	{
+		close(mWakeFD);
+		mWakeFD = -1;
+	}
+
+	if( mEpollFD >= 0 )
+	{
+		close(mEpollFD);
+		mEpollFD = -1;
+	}
+}
+
+
+// Create
+captureManager* captureManager::Create()
+{
+	captureManager* mgr = new captureManager();
+
+	if( !mgr )
+		return NULL;
+
+	if( !mgr->init() )
+	{
+		printf("captureManager -- failed to create instance\n");
+		delete mgr;
+		return NULL;
+	}
+
+	return mgr;
+}
+
+
+// init
+bool captureManager::init()
+{
+	mEpollFD = epoll_create1(EPOLL_CLOEXEC);
+
+	if( mEpollFD < 0 )
+	{
+		printf("captureManager -- epoll_create1() failed (errno=%i) (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	mWakeFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if( mWakeFD < 0 )
+	{
+		printf("captureManager -- eventfd() failed (errno=%i) (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	struct epoll_event event;
+	memset(&event, 0, sizeof(epoll_event));
+
+	event.events   = EPOLLIN;
+	event.data.u32 = WAKE_EVENT;
+
+	if( epoll_ctl(mEpollFD, EPOLL_CTL_ADD, mWakeFD, &event) < 0 )
+	{
+		printf("captureManager -- epoll_ctl() failed (errno=%i) (%s)\n", errno, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+
+// addSource
+int captureManager::addSource( int fd, v4l2Camera* v4l2, gstCamera* gst, const FrameFunc& callback )
+{
+	if( mRunning )
+	{
+		printf("captureManager -- sources can't be added while the capture thread is running\n");
+		return -1;
+	}
+
+	if( fd < 0 || !callback )
+		return -1;
+
+	const uint32_t index = mSources.size();
+
+	struct epoll_event event;
+	memset(&event, 0, sizeof(epoll_event));
+
+	event.events   = EPOLLIN;
+	event.data.u32 = index;
+
+	if( epoll_ctl(mEpollFD, EPOLL_CTL_ADD, fd, &event) < 0 )
+	{
+		printf("captureManager -- failed to add source %u (errno=%i) (%s)\n", index, errno, strerror(errno));
+		return -1;
+	}
+
+	source s;
+
+	s.v4l2     = v4l2;
+	s.gst      = gst;
+	s.callback = callback;
+	s.fd       = fd;
+	s.frames   = 0;
+
+	mSources.push_back(s);
+	return index;
+}
+
+
+// AddSource
+int captureManager::AddSource( v4l2Camera* camera, const FrameFunc& callback )
+{
+	if( !camera )
+		return -1;
+
+	return addSource(camera->GetFD(), camera, NULL, callback);
+}
+
+
+// AddSource
+int captureManager::AddSource( gstCamera* camera, const FrameFunc& callback )
+{
+#ifndef CPU_ONLY
+	if( !camera )
+		return -1;
+
+	return addSource(camera->GetEventFD(), NULL, camera, callback);
+#else
+	printf("captureManager -- gstreamer cameras aren't available in CPU_ONLY builds\n");
+	return -1;
+#endif
+}
+
+
+// Release
+bool captureManager::Release( uint32_t index, void* ptr )
+{
+	if( index >= mSources.size() )
+		return false;
+
+	if( mSources[index].v4l2 != NULL )
+		return mSources[index].v4l2->Release(ptr);
+
+#ifndef CPU_ONLY
+	if( mSources[index].gst != NULL )
+		return mSources[index].gst->Release(ptr);
+#endif
+
+	return false;
+}
+
+
+// dispatch
+bool captureManager::dispatch( uint32_t index )
+{
+	source& s = mSources[index];
+
+	void* cpu  = NULL;
+	void* cuda = NULL;
+
+	frameStamp stamp;
+	bool captured = false;
+
+	if( s.v4l2 != NULL )
+	{
+		captured = s.v4l2->Capture(&cpu, &cuda, 0, &stamp);
+	}
+#ifndef CPU_ONLY
+	else if( s.gst != NULL )
+	{
+		// reset the event, any frames published after this signal it again
+		uint64_t count = 0;
+
+		if( read(s.fd, &count, sizeof(count)) < 0 && errno != EAGAIN )
+			printf("captureManager -- failed to read event for source %u (errno=%i) (%s)\n", index, errno, strerror(errno));
+
+		captured = s.gst->Capture(&cpu, &cuda, 0, &stamp);
+	}
+#endif
+
+	if( !captured )
+		return false;
+
+	s.frames++;
+
+	if( !s.callback(index, cpu, cuda, stamp) )
+		Release(index, cpu);
+
+	return true;
+}
+
+
+// Poll
+int captureManager::Poll( unsigned long timeout )
+{
+	struct epoll_event events[MAX_EVENTS];
+
+	const int wait_ms = (timeout == ULONG_MAX) ? -1 : (timeout > INT_MAX ? INT_MAX : (int)timeout);
+	const int numEvents = epoll_wait(mEpollFD, events, MAX_EVENTS, wait_ms);
+
+	if( numEvents < 0 )
+	{
+		if( errno == EINTR )
+			return 0;
+
+		printf("captureManager -- epoll_wait() failed (errno=%i) (%s)\n", errno, strerror(errno));
+		return -1;
+	}
+
+	int dispatched = 0;
+
+	for( int n=0; n < numEvents; n++ )
+	{
+		const uint32_t index = events[n].data.u32;
+
+		if( index == WAKE_EVENT )
+		{
+			uint64_t count = 0;
+
+			if( read(mWakeFD, &count, sizeof(count)) < 0 && errno != EAGAIN )
+				printf("captureManager -- failed to read wake event (errno=%i) (%s)\n", errno, strerror(errno));
+
+			continue;
+		}
+
+		if( index >= mSources.size() )
+			continue;
+
+		// a V4L2 device reports errors when it's unplugged (or isn't streaming),
+		// stop waiting on it instead of waking up for it continuously
+		if( events[n].events & (EPOLLERR | EPOLLHUP) )
+		{
+			printf("captureManager -- source %u reported an error, removing it from the capture loop\n", index);
+			epoll_ctl(mEpollFD, EPOLL_CTL_DEL, mSources[index].fd, NULL);
+			continue;
+		}
+
+		if( dispatch(index) )
+			dispatched++;
+	}
+
+	return dispatched;
+}
+
+
+// Start
+bool captureManager::Start()
+{
+	if( mRunning )
+		return true;
+
+	mStop    = false;
+	mRunning = true;
+	mThread  = std::thread(&captureManager::captureThread, this);
+
+	return true;
+}
+
+
+// Stop
+void captureManager::Stop()
+{
+	if( !mRunning )
+		return;
+
+	mStop = true;
+
+	const uint64_t wake = 1;
+
+	if( write(mWakeFD, &wake, sizeof(wake)) < 0 )
+		printf("captureManager -- failed to wake the capture thread (errno=%i) (%s)\n", errno, strerror(errno));
+
+	mThread.join();
+	mRunning = false;
+}
+
+
+// captureThread
+void captureManager::captureThread()
+{
+	while( !mStop )
+	{
+		if( Poll() < 0 )
+			break;
+	}
+}
@@ -0,0 +1,126 @@
+/*
+ * inference-101
+ */
+
+#ifndef __CAPTURE_MANAGER_H_
+#define __CAPTURE_MANAGER_H_
+
+
+#include "latencyTrace.h"
+
+#include <stdint.h>
+#include <limits.h>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+
+class v4l2Camera;
+class gstCamera;
+
+
+/**
+ * Waits on any number of cameras from one thread with epoll, and dispatches each frame
+ * to a callback for its source as soon as the camera has it ready, so capturing from
+ * many cameras doesn't take a thread (and a select() loop) per device.
+ *
+ * V4L2 cameras are waited on through their device file, gstCamera through the eventfd
+ * it signals for every frame.  Add the sources and Open() the cameras before calling
+ * Start() or Poll() (a V4L2 device that isn't streaming reports an error, and is dropped).
+ * @ingroup util
+ */
+class captureManager
+{
+public:
+	/**
+	 * Receives a frame from a source.  Return true to keep the frame (hand it back later
+	 * with Release()), or false to have it released as soon as the callback returns.
+	 * @param cuda is NULL if the camera's memory couldn't be mapped into CUDA
+	 */
+	typedef std::function<bool( uint32_t source, void* cpu, void* cuda, const frameStamp& stamp )> FrameFunc;
+
+	/**
+	 * Create a new capture manager.
+	 */
+	static captureManager* Create();
+
+	/**
+	 * Destroy (stopping the capture thread if needed, the cameras aren't deleted)
+	 */
+	~captureManager();
+
+	/**
+	 * Register a V4L2 camera.
+	 * @returns the index of the source, or -1 on error
+	 */
+	int AddSource( v4l2Camera* camera, const FrameFunc& callback );
+
+	/**
+	 * Register a gstreamer camera (its frames are taken with Capture(), so the newest frame wins).
+	 * @returns the index of the source, or -1 on error
+	 */
+	int AddSource( gstCamera* camera, const FrameFunc& callback );
+
+	/**
+	 * Wait for frames from any of the sources and dispatch them on the calling thread.
+	 * @param timeout milliseconds to wait (ULONG_MAX to wait forever)
+	 * @returns the number of frames dispatched, or -1 on error
+	 */
+	int Poll( unsigned long timeout=ULONG_MAX );
+
+	/**
+	 * Launch a thread that runs Poll() until Stop().
+	 */
+	bool Start();
+
+	/**
+	 * Stop the capture thread.
+	 */
+	void Stop();
+
+	/**
+	 * Give a frame that a callback kept back to its camera.
+	 */
+	bool Release( uint32_t source, void* ptr );
+
+	/**
+	 * Number of sources.
+	 */
+	inline uint32_t GetNumSources() const			{ return mSources.size(); }
+
+	/**
+	 * Number of frames dispatched from a source.
+	 */
+	inline uint64_t GetFrames( uint32_t source ) const	{ return source < mSources.size() ? mSources[source].frames : 0; }
+
+protected:
+	captureManager();
+
+	bool init();
+	int  addSource( int fd, v4l2Camera* v4l2, gstCamera* gst, const FrameFunc& callback );
+	bool dispatch( uint32_t source );
+	void captureThread();
+
+	struct source
+	{
+		v4l2Camera* v4l2;
+		gstCamera*  gst;
+		FrameFunc   callback;
+		int         fd;
+		uint64_t    frames;
+	};
+
+	std::vector<source> mSources;
+
+	int mEpollFD;
+	int mWakeFD;	// eventfd that interrupts Poll() for Stop()
+
+	std::thread mThread;
+	std::atomic<bool> mStop;
+	bool mRunning;
+};
+
+
+#endif
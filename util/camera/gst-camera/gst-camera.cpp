@@ -50,6 +50,9 @@ int main( int argc, char** argv )
 		return 0;
 	}
 	
+	// capture straight from the gstreamer buffers (falls back to copying if unsupported)
+	camera->SetZeroCopy(true);
+	
 	printf("\ngst-camera:  successfully initialized video device\n");
 	printf("    width:  %u\n", camera->GetWidth());
 	printf("   height:  %u\n", camera->GetHeight());
@@ -65,8 +68,8 @@ int main( int argc, char** argv )
 	if( !display )
 		printf("\ngst-camera:  failed to create openGL display\n");
 
-	const size_t texSz = camera->GetWidth() * camera->GetHeight() * sizeof(float4);
-	float4* texIn = (float4*)malloc(texSz);
+	const size_t texSz = camera->GetWidth() * camera->GetHeight() * sizeof(uchar4);
+	uchar4* texIn = (uchar4*)malloc(texSz);
 
 	/*if( texIn != NULL )
 		memset(texIn, 0, texSz);*/
@@ -74,9 +77,9 @@ int main( int argc, char** argv )
 	if( texIn != NULL )
 		for( uint32_t y=0; y < camera->GetHeight(); y++ )
 			for( uint32_t x=0; x < camera->GetWidth(); x++ )
-				texIn[y*camera->GetWidth()+x] = make_float4(0.0f, 1.0f, 1.0f, 1.0f);
+				texIn[y*camera->GetWidth()+x] = make_uchar4(0, 255, 255, 255);
 
-	glTexture* texture = glTexture::Create(camera->GetWidth(), camera->GetHeight(), GL_RGBA32F_ARB/*GL_RGBA8*/, texIn);
+	glTexture* texture = glTexture::Create(camera->GetWidth(), camera->GetHeight(), GL_RGBA8, texIn);
 
 	if( !texture )
 		printf("gst-camera:  failed to create openGL texture\n");
@@ -112,10 +115,8 @@ int main( int argc, char** argv )
 		if( !camera->ConvertRGBA(imgCUDA, &imgRGBA) )
 			printf("gst-camera:  failed to convert from NV12 to RGBA\n");
 
-		// rescale image pixel intensities
-		CUDA(cudaNormalizeRGBA((float4*)imgRGBA, make_float2(0.0f, 255.0f), 
-						   (float4*)imgRGBA, make_float2(0.0f, 1.0f), 
- 						   camera->GetWidth(), camera->GetHeight()));
+		// the frame was converted into imgRGBA, so give it back to the camera
+		camera->Release(imgCPU);
 
 		// update display
 		if( display != NULL )
@@ -125,12 +126,13 @@ int main( int argc, char** argv )
 
 			if( texture != NULL )
 			{
+				// rescale the pixel intensities and pack them to RGBA8, straight into the texture's PBO
 				void* tex_map = texture->MapCUDA();
 
 				if( tex_map != NULL )
 				{
-					cudaMemcpy(tex_map, imgRGBA, texture->GetSize(), cudaMemcpyDeviceToDevice);
-					CUDA(cudaDeviceSynchronize());
+					CUDA(cudaNormalizeToRGBA8((float4*)imgRGBA, make_float2(0.0f, 255.0f), 
+									      (uchar4*)tex_map, camera->GetWidth(), camera->GetHeight()));
 
 					texture->Unmap();
 				}
@@ -11,13 +11,11 @@
 #include <sstream> 
 #include <unistd.h>
 #include <string.h>
-
-#include <QMutex>
-#include <QWaitCondition>
+#include <errno.h>
+#include <sys/eventfd.h>
 
 #include "cudaMappedMemory.h"
-#include "cudaYUV.h"
-#include "cudaRGB.h"
+#include "cudaColorspace.h"
 
 
 
@@ -34,19 +32,29 @@ gstCamera::gstCamera()
 	mDepth  = 0;
 	mSize   = 0;
 	
-	mWaitEvent  = new QWaitCondition();
-	mWaitMutex  = new QMutex();
-	mRingMutex  = new QMutex();
+	mRing        = NULL;
+	mQueuePolicy = frameRing::DROP_OLDEST;
+	mQueueSize   = 0;
+	mZeroCopy    = false;
+	mLatestRGBA  = 0;
+	mEventFD     = -1;
+	mColorspace  = COLORSPACE_BT601_FULL;
 	
-	mLatestRGBA       = 0;
-	mLatestRingbuffer = 0;
-	mLatestRetrieved  = false;
+	mUnregisterPending = false;
 	
 	for( uint32_t n=0; n < NUM_RINGBUFFERS; n++ )
 	{
-		mRingbufferCPU[n] = NULL;
-		mRingbufferGPU[n] = NULL;
-		mRGBA[n]          = NULL;
+		mSlots[n].cpu           = NULL;
+		mSlots[n].gpu           = NULL;
+		mSlots[n].timestamp     = 0;
+		mSlots[n].ringbufferCPU = NULL;
+		mSlots[n].ringbufferGPU = NULL;
+		mSlots[n].sample        = NULL;
+		mSlots[n].buffer        = NULL;
+		mSlots[n].consumed      = NULL;
+		mSlots[n].captured      = false;
+		
+		mRGBA[n] = NULL;
 	}
 }
 
@@ -54,7 +62,65 @@ gstCamera::gstCamera()
 // destructor	
 gstCamera::~gstCamera()
 {
+	// stop the streaming thread before the queue and buffers it uses are freed
+	if( mPipeline != NULL )
+		gst_element_set_state(mPipeline, GST_STATE_NULL);
+	
+	if( mEventFD >= 0 )
+	{
+		close(mEventFD);
+		mEventFD = -1;
+	}
+	
+	// the frames still queued or held (the caller can't use them after this anyway)
+	for( uint32_t n=0; n < NUM_RINGBUFFERS; n++ )
+		releaseSample(n);
+	
+	delete mRing;
+	mRing = NULL;
+	
+	unregisterBuffers();
+	
+	for( uint32_t n=0; n < NUM_RINGBUFFERS; n++ )
+	{
+		if( mSlots[n].consumed != NULL )
+			CUDA(cudaEventDestroy(mSlots[n].consumed));
+		
+		if( mSlots[n].ringbufferCPU != NULL )
+			CUDA(cudaFreeHost(mSlots[n].ringbufferCPU));
+		
+		if( mRGBA[n] != NULL )
+			CUDA(cudaFree(mRGBA[n]));
+	}
+}
+
+
+// ConvertRGBA
+bool gstCamera::ConvertRGBA( void* input, float* output )
+{
+	return Convert(input, output, FORMAT_RGBA32F);
+}
+
+
+// Convert
+bool gstCamera::Convert( void* input, void* output, imageFormat format, cudaStream_t stream )
+{
+	if( !input || !output )
+		return false;
 	
+	if( CUDA_FAILED(cudaConvertColor(input, GetFormat(), output, format, mWidth, mHeight, mColorspace, stream)) )
+	{
+		printf(LOG_CUDA "gstCamera -- failed to convert %ux%u frame from %s to %s\n", mWidth, mHeight, imageFormatToStr(GetFormat()), imageFormatToStr(format));
+		return false;
+	}
+	
+	// Release() waits for this conversion (and only this) before the camera can reuse the frame
+	const int slot = findSlot(input);
+	
+	if( slot >= 0 )
+		CUDA(cudaEventRecord(mSlots[slot].consumed, stream));
+	
+	return true;
 }
 
 
@@ -78,18 +144,8 @@ bool gstCamera::ConvertRGBA( void* input, void** output )
 		printf(LOG_CUDA "gstreamer camera -- allocated %u RGBA ringbuffers\n", NUM_RINGBUFFERS);
 	}
 	
-	if( onboardCamera() )
-	{
-		// onboard camera is NV12
-		if( CUDA_FAILED(cudaNV12ToRGBAf((uint8_t*)input, (float4*)mRGBA[mLatestRGBA], mWidth, mHeight)) )
-			return false;
-	}
-	else
-	{
-		// USB webcam is RGB
-		if( CUDA_FAILED(cudaRGBToRGBAf((uchar3*)input, (float4*)mRGBA[mLatestRGBA], mWidth, mHeight)) )
-			return false;
-	}
+	if( !ConvertRGBA(input, (float*)mRGBA[mLatestRGBA]) )
+		return false;
 	
 	*output     = mRGBA[mLatestRGBA];
 	mLatestRGBA = (mLatestRGBA + 1) % NUM_RINGBUFFERS;
@@ -129,35 +185,251 @@ GstFlowReturn gstCamera::onBuffer(_GstAppSink* sink, void* user_data)
 	
 
 // Capture
-bool gstCamera::Capture( void** cpu, void** cuda, unsigned long timeout )
+bool gstCamera::Capture( void** cpu, void** cuda, unsigned long timeout, frameStamp* stamp )
 {
-	mWaitMutex->lock();
-    const bool wait_result = mWaitEvent->wait(mWaitMutex, timeout);
-    mWaitMutex->unlock();
-	
-	if( !wait_result )
+	if( !mRing )
 		return false;
 	
-	mRingMutex->lock();
-	const uint32_t latest = mLatestRingbuffer;
-	const bool retrieved = mLatestRetrieved;
-	mLatestRetrieved = true;
-	mRingMutex->unlock();
+	// take the newest frame, the producer won't touch the slot until it's released
+	int slot = mRing->Acquire(timeout);
 	
-	// skip if it was already retrieved
-	if( retrieved )
+	if( slot < 0 )
 		return false;
 	
+	// skip ahead to the newest frame here instead of with AcquireLatest(), so that
+	// the zero-copy samples of the older frames are given back before they're freed
+	int newer = -1;
+	
+	while( (newer = mRing->Acquire(0)) >= 0 )
+	{
+		releaseSample(slot);
+		mRing->Skip(slot);
+		slot = newer;
+	}
+	
+	mSlots[slot].captured = true;
+	
 	if( cpu != NULL )
-		*cpu = mRingbufferCPU[latest];
+		*cpu = mSlots[slot].cpu;
 	
 	if( cuda != NULL )
-		*cuda = mRingbufferGPU[latest];
+		*cuda = mSlots[slot].gpu;
+	
+	if( stamp != NULL )
+	{
+		stamp->sequence  = mRing->GetSequence(slot);
+		stamp->timestamp = mSlots[slot].timestamp;
+	}
+	
+	return true;
+}
+
+
+// findSlot (the pointers are only read from slots the consumers own)
+int gstCamera::findSlot( void* ptr ) const
+{
+	if( !ptr || !mRing )
+		return -1;
+	
+	const uint32_t numSlots = mRing->GetNumSlots();
+	
+	for( uint32_t n=0; n < numSlots; n++ )
+	{
+		if( mSlots[n].captured && (ptr == mSlots[n].cpu || ptr == mSlots[n].gpu) )
+			return n;
+	}
+	
+	return -1;
+}
+
+
+// Release
+bool gstCamera::Release( void* ptr, cudaStream_t stream )
+{
+	const int slot = findSlot(ptr);
+	
+	if( slot < 0 )
+	{
+		printf(LOG_GSTREAMER "gstreamer camera -- Release() called with unknown frame 0x%p\n", ptr);
+		return false;
+	}
+	
+	captureSlot* frame = &mSlots[slot];
+	
+	// wait for the kernels still reading from the frame (not the rest of the GPU's work)
+	// before the buffer can go back to the pipeline or the camera can reuse the slot
+	if( stream != NULL )
+		CUDA(cudaEventRecord(frame->consumed, stream));
+	
+	CUDA(cudaEventSynchronize(frame->consumed));
+	
+	// this thread owns the slot until it's released, so the zero-copy sample can be given back here
+	releaseSample(slot);
+	
+	frame->captured = false;
+	mRing->Release(slot);
+	
+	// the last frame held over from Close() lets the pinned regions go
+	if( mUnregisterPending && numCaptured() == 0 && mUnregisterPending.exchange(false) )
+		unregisterBuffers();
+	
+	return true;
+}
+
+
+// numCaptured (frames the consumers hold)
+uint32_t gstCamera::numCaptured() const
+{
+	uint32_t count = 0;
+	
+	for( uint32_t n=0; mRing != NULL && n < mRing->GetNumSlots(); n++ )
+	{
+		if( mSlots[n].captured )
+			count++;
+	}
+	
+	return count;
+}
+
+
+// SetZeroCopy
+void gstCamera::SetZeroCopy( bool enable )
+{
+	mZeroCopy = enable;
+}
+
+
+// SetQueue
+void gstCamera::SetQueue( uint32_t numFrames, frameRing::Policy policy )
+{
+	if( numFrames > NUM_RINGBUFFERS )
+		numFrames = NUM_RINGBUFFERS;
+	
+	mQueueSize   = numFrames;
+	mQueuePolicy = policy;
+}
+
+
+// releaseSample (only from the thread that owns the slot)
+void gstCamera::releaseSample( uint32_t n )
+{
+	std::lock_guard<std::mutex> lock(mRegisterMutex);
+	
+	if( !mSlots[n].sample )
+		return;
+	
+	gst_buffer_unmap(mSlots[n].buffer, &mSlots[n].map);
+	gst_sample_unref(mSlots[n].sample);
+	
+	mSlots[n].sample = NULL;
+	mSlots[n].buffer = NULL;
+}
+
+
+// drainQueue (take back the frames that were published but never captured)
+void gstCamera::drainQueue()
+{
+	if( !mRing )
+		return;
+	
+	int slot = -1;
+	
+	while( (slot = mRing->Acquire(0)) >= 0 )
+	{
+		releaseSample(slot);
+		mRing->Release(slot);
+	}
+	
+	// and reset the frame event, so pollers don't wake up for them
+	uint64_t event = 0;
+	
+	if( mEventFD >= 0 && read(mEventFD, &event, sizeof(event)) < 0 && errno != EAGAIN )
+		printf(LOG_GSTREAMER "gstreamer camera -- failed to reset frame event (errno=%i) (%s)\n", errno, strerror(errno));
+}
+
+
+// registerBuffer
+bool gstCamera::registerBuffer( void* ptr, size_t size, void** gpu )
+{
+	uint8_t* data = (uint8_t*)ptr;
+	
+	std::lock_guard<std::mutex> lock(mRegisterMutex);
+	
+	// buffer pools hand back the same memory, so it's usually already registered
+	for( size_t n=0; n < mRegistered.size(); n++ )
+	{
+		if( data >= mRegistered[n].base && data + size <= mRegistered[n].base + mRegistered[n].size )
+		{
+			*gpu = (uint8_t*)mRegistered[n].gpu + (data - mRegistered[n].base);
+			return true;
+		}
+	}
+	
+	// make room by dropping regions that no slot is holding a sample from (the consumers
+	// give samples back from their own threads in Release(), which is locked out meanwhile)
+	if( mRegistered.size() >= MAX_REGISTERED )
+	{
+		for( size_t n=0; n < mRegistered.size(); )
+		{
+			bool inUse = false;
+			
+			for( uint32_t i=0; i < NUM_RINGBUFFERS; i++ )
+			{
+				if( mSlots[i].sample != NULL && mSlots[i].map.data >= mRegistered[n].base && mSlots[i].map.data < mRegistered[n].base + mRegistered[n].size )
+					inUse = true;
+			}
+			
+			if( inUse )
+			{
+				n++;
+				continue;
+			}
+			
+			cudaHostUnregister(mRegistered[n].base);
+			mRegistered.erase(mRegistered.begin() + n);
+		}
+		
+		if( mRegistered.size() >= MAX_REGISTERED )
+			return false;
+	}
+	
+	// pin the buffer and map it into the GPU's address space
+	if( cudaHostRegister(data, size, cudaHostRegisterMapped) != cudaSuccess )
+	{
+		cudaGetLastError();	// clear the error, the frame gets copied instead
+		return false;
+	}
+	
+	hostRegion region;
+	
+	region.base = data;
+	region.size = size;
+	region.gpu  = NULL;
+	
+	if( CUDA_FAILED(cudaHostGetDevicePointer(&region.gpu, data, 0)) )
+	{
+		cudaHostUnregister(data);
+		return false;
+	}
 	
+	mRegistered.push_back(region);
+	*gpu = region.gpu;
 	return true;
 }
 
 
+// unregisterBuffers
+void gstCamera::unregisterBuffers()
+{
+	std::lock_guard<std::mutex> lock(mRegisterMutex);
+	
+	for( size_t n=0; n < mRegistered.size(); n++ )
+		cudaHostUnregister(mRegistered[n].base);
+	
+	mRegistered.clear();
+}
+
+
 #define release_return { gst_sample_unref(gstSample); return; }
 
 
@@ -242,34 +514,114 @@ void gstCamera::checkBuffer()
 	
 	//printf(LOG_GSTREAMER "gstreamer camera recieved %ix%i frame (%u bytes, %u bpp)\n", width, height, gstSize, mDepth);
 	
+	// the PTS is in running time, adding the pipeline's base time gives the time on the pipeline
+	// clock, which is the monotonic system clock (if the PTS is missing, use when it arrived)
+	const uint64_t arrival = traceTime();
+	uint64_t timestamp = arrival;
+	
+	if( GST_BUFFER_PTS_IS_VALID(gstBuffer) )
+	{
+		timestamp = gst_element_get_base_time(mPipeline) + GST_BUFFER_PTS(gstBuffer);
+		
+		if( timestamp > arrival )
+			timestamp = arrival;
+	}
+	
+	// claim a slot in the queue (with the BLOCK policy this applies backpressure to the pipeline,
+	// but not indefinitely so that Close() can still stop the streaming thread)
+	const int slot = mRing != NULL ? mRing->AcquireWrite(250) : -1;
+	
+	if( slot < 0 )
+	{
+		gst_buffer_unmap(gstBuffer, &map);
+		gst_sample_unref(gstSample);
+		return;
+	}
+	
+	// a slot reclaimed from the queue by DROP_OLDEST still has the zero-copy
+	// sample of the frame that was dropped (slots from the free list never do)
+	captureSlot* frame = &mSlots[slot];
+	releaseSample(slot);
+	
+	// zero-copy:  keep the sample mapped and hand its memory out directly
+	if( mZeroCopy )
+	{
+		void* gstCUDA = NULL;
+		
+		if( registerBuffer(gstData, gstSize, &gstCUDA) )
+		{
+			frame->sample = gstSample;
+			frame->buffer = gstBuffer;
+			frame->map    = map;
+			frame->cpu    = gstData;
+			frame->gpu    = gstCUDA;
+			
+			frame->timestamp = timestamp;
+			
+			publish(slot);
+			return;
+		}
+		
+		// if nothing could be registered the platform doesn't support it, otherwise just copy this frame
+		if( mRegistered.size() == 0 )
+		{
+			printf(LOG_GSTREAMER "gstreamer camera -- couldn't map buffers into CUDA, disabling zero-copy capture\n");
+			mZeroCopy = false;
+		}
+	}
+	
 	// make sure ringbuffer is allocated
-	if( !mRingbufferCPU[0] )
+	if( !frame->ringbufferCPU )
 	{
-		for( uint32_t n=0; n < NUM_RINGBUFFERS; n++ )
+		const uint32_t numSlots = mRing->GetNumSlots();
+		
+		for( uint32_t n=0; n < numSlots; n++ )
 		{
-			if( !cudaAllocMapped(&mRingbufferCPU[n], &mRingbufferGPU[n], gstSize) )
+			if( mSlots[n].ringbufferCPU != NULL )
+				continue;
+			
+			if( !cudaAllocMapped(&mSlots[n].ringbufferCPU, &mSlots[n].ringbufferGPU, gstSize) )
 				printf(LOG_CUDA "gstreamer camera -- failed to allocate ringbuffer %u  (size=%u)\n", n, gstSize);
 		}
 		
-		printf(LOG_CUDA "gstreamer camera -- allocated %u ringbuffers, %u bytes each\n", NUM_RINGBUFFERS, gstSize);
+		printf(LOG_CUDA "gstreamer camera -- allocated %u ringbuffers, %u bytes each\n", numSlots, gstSize);
+		
+		if( !frame->ringbufferCPU )
+		{
+			mRing->Cancel(slot);
+			gst_buffer_unmap(gstBuffer, &map);
+			gst_sample_unref(gstSample);
+			return;
+		}
 	}
 	
-	// copy to next ringbuffer
-	const uint32_t nextRingbuffer = (mLatestRingbuffer + 1) % NUM_RINGBUFFERS;		
-	
-	//printf(LOG_GSTREAMER "gstreamer camera -- using ringbuffer #%u for next frame\n", nextRingbuffer);
-	memcpy(mRingbufferCPU[nextRingbuffer], gstData, gstSize);
+	// copy to the slot's ringbuffer
+	//printf(LOG_GSTREAMER "gstreamer camera -- using ringbuffer #%i for next frame\n", slot);
+	memcpy(frame->ringbufferCPU, gstData, gstSize);
 	gst_buffer_unmap(gstBuffer, &map); 
 	//gst_buffer_unref(gstBuffer);
 	gst_sample_unref(gstSample);
 	
+	frame->cpu = frame->ringbufferCPU;
+	frame->gpu = frame->ringbufferGPU;
+	
+	frame->timestamp = timestamp;
+	
+	// hand it over to Capture()
+	publish(slot);
+}
+
+
+// publish
+void gstCamera::publish( int slot )
+{
+	mRing->Publish(slot);
+	
+	// wake up anyone waiting on the camera with poll/epoll
+	const uint64_t event = 1;
 	
-	// update and signal sleeping threads
-	mRingMutex->lock();
-	mLatestRingbuffer = nextRingbuffer;
-	mLatestRetrieved  = false;
-	mRingMutex->unlock();
-	mWaitEvent->wakeAll();
+	if( write(mEventFD, &event, sizeof(event)) < 0 && errno != EAGAIN )
+		printf(LOG_GSTREAMER "gstreamer camera -- failed to signal frame event (errno=%i) (%s)\n", errno, strerror(errno));
 }
 
 
@@ -324,6 +676,10 @@ gstCamera* gstCamera::Create( uint32_t width, uint32_t height, int v4l2_device )
 	cam->mHeight     = height;
 	cam->mDepth      = cam->onboardCamera() ? 12 : 24;	// NV12 or RGB
 	cam->mSize       = (width * height * cam->mDepth) / 8;
+	cam->mEventFD    = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	
+	if( cam->mEventFD < 0 )
+		printf(LOG_GSTREAMER "gstreamer camera -- failed to create frame eventfd (errno=%i) (%s)\n", errno, strerror(errno));
 
 	if( !cam->init() )
 	{
@@ -414,6 +770,35 @@ bool gstCamera::init()
 // Open
 bool gstCamera::Open()
 {
+	// the regions left pinned by the last Close() are reused, and unregistered by the next one
+	mUnregisterPending = false;
+	
+	// create the frame queue
+	if( !mRing )
+	{
+		uint32_t queueSize = mQueueSize;
+		
+		if( queueSize == 0 )
+			queueSize = mZeroCopy ? 4 : NUM_RINGBUFFERS;	// don't hold on to too many of the pipeline's buffers
+		
+		mRing = frameRing::Create(queueSize, mQueuePolicy);
+		
+		if( !mRing )
+		{
+			printf(LOG_GSTREAMER "gstreamer camera -- failed to create frame queue\n");
+			return false;
+		}
+		
+		for( uint32_t n=0; n < queueSize; n++ )
+		{
+			if( CUDA_FAILED(cudaEventCreateWithFlags(&mSlots[n].consumed, cudaEventDisableTiming)) )
+			{
+				printf(LOG_GSTREAMER "gstreamer camera -- failed to create frame events\n");
+				return false;
+			}
+		}
+	}
+	
 	// transition pipline to STATE_PLAYING
 	printf(LOG_GSTREAMER "gstreamer transitioning pipeline to GST_STATE_PLAYING\n");
 	
@@ -460,6 +845,26 @@ void gstCamera::Close()
 		printf(LOG_GSTREAMER "gstreamer failed to set pipeline state to PLAYING (error %u)\n", result);
 
 	usleep(250*1000);
+	
+	// give back the frames still in the queue, so they can't come out of Capture()
+	// after the next Open() pointing at buffers that have been unmapped
+	drainQueue();
+	
+	// the frames the consumers hold stay mapped (and pinned) until they're released,
+	// then the last Release() unregisters the buffers
+	const uint32_t outstanding = numCaptured();
+	
+	if( outstanding > 0 )
+	{
+		printf(LOG_GSTREAMER "gstreamer camera -- %u frames are still captured during Close(), keeping their buffers mapped until Release()\n", outstanding);
+		mUnregisterPending = true;
+		
+		// in case the last one came back in the meantime
+		if( numCaptured() > 0 || !mUnregisterPending.exchange(false) )
+			return;
+	}
+	
+	unregisterBuffers();
 }
 
 
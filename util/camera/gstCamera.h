@@ -6,12 +6,16 @@
 #define __GSTREAMER_CAMERA_H__
 
 #include <gst/gst.h>
+#include <mutex>
 #include <string>
+#include <vector>
+
+#include "frameRing.h"
+#include "latencyTrace.h"
+#include "cudaColorspace.h"
 
 
 struct _GstAppSink;
-class QWaitCondition;
-class QMutex;
 
 
 /**
@@ -32,12 +36,54 @@ public:
 	bool Open();
 	void Close();
 	
-	// Capture YUV (NV12)
-	bool Capture( void** cpu, void** cuda, unsigned long timeout=ULONG_MAX );
+	// Capture YUV (NV12), taking the newest frame (older ones that weren't captured are skipped).
+	// The frame belongs to the caller until it's returned with Release(), the camera won't write to it meanwhile.
+	// The optional stamp receives the frame's sequence number and capture time (from the buffer PTS).
+	bool Capture( void** cpu, void** cuda, unsigned long timeout=ULONG_MAX, frameStamp* stamp=NULL );
+	
+	// Return a frame from Capture() once the CPU/GPU are done with it (either pointer can be passed).
+	// This waits for the conversions of the frame done with Convert() -- if other kernels read it too,
+	// pass the stream they were launched on so those are waited for as well.  In zero-copy mode this
+	// also unmaps the GstBuffer and drops the reference to it, so it goes back to the source's pool.
+	bool Release( void* ptr, cudaStream_t stream=NULL );
+	
+	// Enable zero-copy capture (before Open), where Capture() returns the GstBuffer's own memory
+	// mapped into CUDA instead of a copy in the ringbuffer.  Close() gives back the frames that were
+	// queued but never captured (the ones the caller holds stay mapped until they're released).
+	void SetZeroCopy( bool enable );
+	
+	// Is zero-copy capture in use (it's disabled if the buffers can't be mapped into CUDA)
+	inline bool IsZeroCopy() const		  { return mZeroCopy; }
+	
+	// Set the number of frames in the queue and what happens when the consumers are holding all of them (before Open).
+	// By default the queue has 16 frames (4 when zero-copy) and drops the oldest frame.
+	void SetQueue( uint32_t numFrames, frameRing::Policy policy=frameRing::DROP_OLDEST );
+	
+	// File descriptor (eventfd) that's signalled every time a frame is queued, for waiting on several
+	// cameras at once with poll/epoll.  Read it to reset it before taking the frame with Capture().
+	inline int GetEventFD() const		  { return mEventFD; }
+	
+	// Number of frames captured from the pipeline, and how many were lost on the way
+	inline uint64_t GetCaptured() const	  { return mRing != NULL ? mRing->GetPublished() : 0; }
+	inline uint64_t GetDropped() const	  { return mRing != NULL ? mRing->GetDropped() : 0; }	// no free frames in the queue
+	inline uint64_t GetSkipped() const	  { return mRing != NULL ? mRing->GetSkipped() : 0; }	// superseded before Capture()
 	
 	// Takes in captured YUV-NV12 CUDA image, converts to float4 RGBA (with pixel intensity 0-255)
 	bool ConvertRGBA( void* input, void** output );
 	
+	// Converts into a float4 RGBA buffer provided by the caller (GetWidth() * GetHeight() * sizeof(float4) of GPU memory)
+	bool ConvertRGBA( void* input, float* output );
+	
+	// Converts a captured frame into any format in one pass (e.g. FORMAT_RGBA8 for display, FORMAT_BGR8 for OpenCV),
+	// into a buffer provided by the caller of imageFormatSize(format, GetWidth(), GetHeight()) bytes of GPU memory
+	bool Convert( void* input, void* output, imageFormat format, cudaStream_t stream=NULL );
+	
+	// Format of the captured frames (FORMAT_NV12 from the onboard camera, FORMAT_RGB8 from V4L2)
+	inline imageFormat GetFormat() const	  { return onboardCamera() ? FORMAT_NV12 : FORMAT_RGB8; }
+	
+	// Set the YUV color space the frames are converted from (BT.601 full range by default)
+	inline void SetColorspace( colorSpace colorspace )	{ mColorspace = colorspace; }
+	
 	// Image dimensions
 	inline uint32_t GetWidth() const	  { return mWidth; }
 	inline uint32_t GetHeight() const	  { return mHeight; }
@@ -59,6 +105,14 @@ private:
 	bool buildLaunchStr();
 	void checkMsgBus();
 	void checkBuffer();
+	void publish( int slot );
+	
+	int  findSlot( void* ptr ) const;
+	uint32_t numCaptured() const;
+	void releaseSample( uint32_t n );
+	void drainQueue();
+	bool registerBuffer( void* ptr, size_t size, void** gpu );
+	void unregisterBuffers();
 	
 	_GstBus*     mBus;
 	_GstAppSink* mAppSink;
@@ -73,18 +127,53 @@ private:
 	
 	static const uint32_t NUM_RINGBUFFERS = 16;
 	
-	void* mRingbufferCPU[NUM_RINGBUFFERS];
-	void* mRingbufferGPU[NUM_RINGBUFFERS];
-	
-	QWaitCondition* mWaitEvent;
-	
-	QMutex* mWaitMutex;
-	QMutex* mRingMutex;
+	// a frame in the queue, either copied into the ringbuffer or (zero-copy) the mapped
+	// GstBuffer, which is kept until the frame is released or dropped (free slots never hold one)
+	struct captureSlot
+	{
+		void* cpu;
+		void* gpu;
+		
+		uint64_t timestamp;
+		
+		void* ringbufferCPU;
+		void* ringbufferGPU;
+		
+		GstSample* sample;
+		GstBuffer* buffer;
+		GstMapInfo map;
+		
+		cudaEvent_t consumed;		// recorded after the kernels reading the frame, Release() waits for it
+		
+		std::atomic<bool> captured;	// handed out by Capture(), waiting for Release()
+	};
+	
+	// host memory registered with CUDA, buffer pools recycle the same memory so this stays small
+	struct hostRegion
+	{
+		uint8_t* base;
+		size_t   size;
+		void*    gpu;
+	};
+	
+	static const uint32_t MAX_REGISTERED = 32;
+	
+	captureSlot mSlots[NUM_RINGBUFFERS];
+	frameRing*  mRing;
+	
+	frameRing::Policy mQueuePolicy;
+	uint32_t          mQueueSize;
+	
+	std::vector<hostRegion> mRegistered;
+	std::mutex              mRegisterMutex;	// guards mRegistered, and the slots' samples against registerBuffer()
+	std::atomic<bool>       mUnregisterPending;	// Close() left frames captured, the last Release() unregisters
+	bool mZeroCopy;
+	
+	int mEventFD;
+	
+	colorSpace mColorspace;
 	
 	uint32_t mLatestRGBA;
-	uint32_t mLatestRingbuffer;
-	bool     mLatestRetrieved;
-	
 	void* mRGBA[NUM_RINGBUFFERS];
 	int   mV4L2Device;	// -1 for onboard, >=0 for V4L2 device
 	
@@ -0,0 +1,525 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "gstEncoder.h"
+#include "gstUtility.h"
+
+#include <gst/gst.h>
+#include <gst/app/gstappsrc.h>
+
+#include <sstream>
+#include <strings.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "cudaMappedMemory.h"
+#include "cudaNormalize.h"
+#include "cudaRGB.h"
+
+
+// elementExists
+static bool elementExists( const char* name )
+{
+	GstElementFactory* factory = gst_element_factory_find(name);
+
+	if( !factory )
+		return false;
+
+	gst_object_unref(factory);
+	return true;
+}
+
+
+// quoteLaunchValue (quotes a property value for gst_parse_launch(), so a path with spaces or
+// pipeline syntax in it stays one value -- returns false for control characters, which can't be quoted)
+static bool quoteLaunchValue( const std::string& value, std::string* quoted )
+{
+	*quoted = "\"";
+
+	for( size_t n=0; n < value.size(); n++ )
+	{
+		const char c = value[n];
+
+		if( (unsigned char)c < 0x20 || c == 0x7F )
+			return false;
+
+		if( c == '"' || c == '\\' )
+			*quoted += '\\';
+
+		*quoted += c;
+	}
+
+	*quoted += '"';
+	return true;
+}
+
+
+// constructor
+gstEncoder::gstEncoder()
+{
+	mCodec     = CODEC_H264;
+	mWidth     = 0;
+	mHeight    = 0;
+	mFramerate = 0;
+	mBitrate   = 0;
+	mSize      = 0;
+	mBus       = NULL;
+	mAppSrc    = NULL;
+	mPipeline  = NULL;
+	mFrames    = 0;
+	mDropped   = 0;
+	mStreaming = false;
+	mStop      = false;
+}
+
+
+// destructor
+gstEncoder::~gstEncoder()
+{
+	Close();
+
+	// the pipeline gives its buffers back as it's destroyed, before the pool is freed
+	if( mAppSrc != NULL )
+	{
+		gst_object_unref(mAppSrc);
+		mAppSrc = NULL;
+	}
+
+	if( mBus != NULL )
+	{
+		gst_object_unref(mBus);
+		mBus = NULL;
+	}
+
+	if( mPipeline != NULL )
+	{
+		gst_object_unref(mPipeline);
+		mPipeline = NULL;
+	}
+
+	for( size_t n=0; n < mSlots.size(); n++ )
+	{
+		if( mSlots[n].cpu != NULL )
+			CUDA(cudaFreeHost(mSlots[n].cpu));
+
+		if( mSlots[n].converted != NULL )
+			CUDA(cudaEventDestroy(mSlots[n].converted));
+	}
+}
+
+
+// Create
+gstEncoder* gstEncoder::Create( Codec codec, const char* output, uint32_t width, uint32_t height, uint32_t framerate, uint32_t bitrate, uint32_t numBuffers )
+{
+	if( !output || width == 0 || height == 0 || numBuffers == 0 )
+		return NULL;
+
+	if( !gstreamerInit() )
+	{
+		printf(LOG_GSTREAMER "failed to initialize gstreamer API\n");
+		return NULL;
+	}
+
+	gstEncoder* enc = new gstEncoder();
+
+	if( !enc )
+		return NULL;
+
+	enc->mCodec     = codec;
+	enc->mOutput    = output;
+	enc->mWidth     = width;
+	enc->mHeight    = height;
+	enc->mFramerate = (framerate > 0) ? framerate : 30;
+	enc->mBitrate   = bitrate;
+	enc->mSize      = width * height * sizeof(uchar4);
+
+	if( !enc->init(numBuffers) )
+	{
+		printf(LOG_GSTREAMER "failed to init gstEncoder\n");
+		delete enc;
+		return NULL;
+	}
+
+	return enc;
+}
+
+
+// buildLaunchStr
+bool gstEncoder::buildLaunchStr()
+{
+	std::ostringstream ss;
+
+	// frames come in as RGBA8, timestamped as they're pushed
+	ss << "appsrc name=mysource is-live=true do-timestamp=true format=time ";
+	ss << "caps=\"video/x-raw, format=(string)RGBA, width=(int)" << mWidth << ", height=(int)" << mHeight << ", ";
+	ss << "framerate=(fraction)" << mFramerate << "/1\" ! videoconvert ! ";
+
+	if( mCodec == CODEC_H264 )
+	{
+		if( elementExists("omxh264enc") )
+			ss << "video/x-raw, format=(string)I420 ! omxh264enc bitrate=" << mBitrate << " ! video/x-h264, stream-format=(string)byte-stream ! ";
+		else
+			ss << "x264enc bitrate=" << (mBitrate / 1000) << " speed-preset=ultrafast tune=zerolatency ! ";
+
+		ss << "h264parse ! ";
+	}
+	else
+	{
+		ss << "jpegenc ! ";
+	}
+
+	if( strncmp(mOutput.c_str(), "rtp://", 6) == 0 )
+	{
+		// rtp://<host>:<port>
+		const std::string address = mOutput.substr(6);
+		const size_t colon = address.rfind(':');
+
+		if( colon == std::string::npos || colon == 0 || atoi(address.c_str() + colon + 1) <= 0 )
+		{
+			printf(LOG_GSTREAMER "gstreamer encoder -- invalid RTP address %s (expected rtp://<host>:<port>)\n", mOutput.c_str());
+			return false;
+		}
+
+		if( mCodec == CODEC_H264 )
+			ss << "rtph264pay config-interval=1 pt=96 ! ";
+		else
+			ss << "rtpjpegpay ! ";
+
+		std::string host;
+
+		if( !quoteLaunchValue(address.substr(0, colon), &host) )
+		{
+			printf(LOG_GSTREAMER "gstreamer encoder -- invalid characters in the RTP host\n");
+			return false;
+		}
+
+		ss << "udpsink host=" << host << " port=" << atoi(address.c_str() + colon + 1) << " sync=false async=false";
+	}
+	else
+	{
+		// pick the container from the file extension (none for raw streams)
+		const char* ext = strrchr(mOutput.c_str(), '.');
+
+		if( ext != NULL )
+		{
+			if( strcasecmp(ext, ".mp4") == 0 )
+				ss << "mp4mux ! ";
+			else if( strcasecmp(ext, ".mkv") == 0 )
+				ss << "matroskamux ! ";
+			else if( strcasecmp(ext, ".avi") == 0 )
+				ss << "avimux ! ";
+		}
+
+		std::string location;
+
+		if( !quoteLaunchValue(mOutput, &location) )
+		{
+			printf(LOG_GSTREAMER "gstreamer encoder -- invalid characters in the output filename\n");
+			return false;
+		}
+
+		ss << "filesink location=" << location << " sync=false";
+	}
+
+	mLaunchStr = ss.str();
+
+	printf(LOG_GSTREAMER "gstreamer encoder pipeline string:\n");
+	printf("%s\n", mLaunchStr.c_str());
+	return true;
+}
+
+
+// init
+bool gstEncoder::init( uint32_t numBuffers )
+{
+	GError* err = NULL;
+
+	// build pipeline string
+	if( !buildLaunchStr() )
+	{
+		printf(LOG_GSTREAMER "gstreamer encoder failed to build pipeline string\n");
+		return false;
+	}
+
+	// launch pipeline
+	mPipeline = gst_parse_launch(mLaunchStr.c_str(), &err);
+
+	if( err != NULL )
+	{
+		printf(LOG_GSTREAMER "gstreamer encoder failed to create pipeline\n");
+		printf(LOG_GSTREAMER "   (%s)\n", err->message);
+		g_error_free(err);
+		return false;
+	}
+
+	GstPipeline* pipeline = GST_PIPELINE(mPipeline);
+
+	if( !pipeline )
+	{
+		printf(LOG_GSTREAMER "gstreamer failed to cast GstElement into GstPipeline\n");
+		return false;
+	}
+
+	// retrieve pipeline bus
+	mBus = gst_pipeline_get_bus(pipeline);
+
+	if( !mBus )
+	{
+		printf(LOG_GSTREAMER "gstreamer failed to retrieve GstBus from pipeline\n");
+		return false;
+	}
+
+	// get the appsrc
+	GstElement* appsrcElement = gst_bin_get_by_name(GST_BIN(pipeline), "mysource");
+	GstAppSrc* appsrc = GST_APP_SRC(appsrcElement);
+
+	if( !appsrcElement || !appsrc )
+	{
+		printf(LOG_GSTREAMER "gstreamer failed to retrieve AppSrc element from pipeline\n");
+		return false;
+	}
+
+	mAppSrc = appsrc;
+
+	// allocate the buffer pool
+	mSlots.resize(numBuffers);
+
+	for( uint32_t n=0; n < numBuffers; n++ )
+	{
+		slot& s = mSlots[n];
+
+		s.encoder   = this;
+		s.cpu       = NULL;
+		s.cuda      = NULL;
+		s.converted = NULL;
+		s.busy      = false;
+
+		if( !cudaAllocMapped(&s.cpu, &s.cuda, mSize) )
+			return false;
+
+		if( CUDA_FAILED(cudaEventCreateWithFlags(&s.converted, cudaEventDisableTiming)) )
+			return false;
+	}
+
+	return true;
+}
+
+
+// Open
+bool gstEncoder::Open()
+{
+	if( mStreaming )
+		return true;
+
+	printf(LOG_GSTREAMER "gstreamer encoder transitioning pipeline to GST_STATE_PLAYING\n");
+
+	const GstStateChangeReturn result = gst_element_set_state(mPipeline, GST_STATE_PLAYING);
+
+	if( result != GST_STATE_CHANGE_SUCCESS && result != GST_STATE_CHANGE_ASYNC )
+	{
+		printf(LOG_GSTREAMER "gstreamer encoder failed to set pipeline state to PLAYING (error %u)\n", result);
+		return false;
+	}
+
+	checkMsgBus();
+
+	mStop      = false;
+	mStreaming = true;
+	mThread    = std::thread(&gstEncoder::encoderThread, this);
+
+	return true;
+}
+
+
+// Close
+void gstEncoder::Close()
+{
+	if( !mStreaming )
+		return;
+
+	// push the frames that are already queued, then stop the thread
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+
+	mEvent.notify_all();
+	mThread.join();
+
+	// end the stream, and give the muxer a chance to finalize the file
+	gst_app_src_end_of_stream(mAppSrc);
+
+	GstMessage* msg = gst_bus_timed_pop_filtered(mBus, 5 * GST_SECOND, (GstMessageType)(GST_MESSAGE_EOS|GST_MESSAGE_ERROR));
+
+	if( msg != NULL )
+	{
+		gst_message_print(mBus, msg, this);
+		gst_message_unref(msg);
+	}
+	else
+	{
+		printf(LOG_GSTREAMER "gstreamer encoder -- timed out waiting for the end of the stream\n");
+	}
+
+	printf(LOG_GSTREAMER "gstreamer encoder transitioning pipeline to GST_STATE_NULL\n");
+
+	const GstStateChangeReturn result = gst_element_set_state(mPipeline, GST_STATE_NULL);
+
+	if( result != GST_STATE_CHANGE_SUCCESS )
+		printf(LOG_GSTREAMER "gstreamer encoder failed to set pipeline state to NULL (error %u)\n", result);
+
+	mStreaming = false;
+
+	printf(LOG_GSTREAMER "gstreamer encoder -- %llu frames encoded, %llu dropped\n", (unsigned long long)mFrames, (unsigned long long)mDropped);
+}
+
+
+// Encode
+bool gstEncoder::Encode( float4* rgba, const float2& range )
+{
+	if( !rgba || !mStreaming )
+		return false;
+
+	slot* s = acquire();
+
+	if( !s )
+		return false;
+
+	if( CUDA_FAILED(cudaNormalizeToRGBA8(rgba, range, (uchar4*)s->cuda, mWidth, mHeight)) )
+	{
+		onBufferFree(s);
+		return false;
+	}
+
+	return submit(s);
+}
+
+
+// Encode
+bool gstEncoder::Encode( void* image, imageFormat format, size_t pitch )
+{
+	if( !image || !mStreaming )
+		return false;
+
+	slot* s = acquire();
+
+	if( !s )
+		return false;
+
+	if( CUDA_FAILED(cudaPackedToRGBA8(image, format, pitch, (uchar4*)s->cuda, mWidth, mHeight)) )
+	{
+		onBufferFree(s);
+		return false;
+	}
+
+	return submit(s);
+}
+
+
+// acquire
+gstEncoder::slot* gstEncoder::acquire()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for( size_t n=0; n < mSlots.size(); n++ )
+	{
+		if( !mSlots[n].busy )
+		{
+			mSlots[n].busy = true;
+			return &mSlots[n];
+		}
+	}
+
+	// every buffer is still in the pipeline, the encoder is falling behind
+	mDropped++;
+	return NULL;
+}
+
+
+// submit
+bool gstEncoder::submit( slot* s )
+{
+	// wait for the conversion (but not the rest of the caller's work) to finish reading
+	// the input, so the caller can reuse it as soon as Encode() returns
+	if( CUDA_FAILED(cudaEventRecord(s->converted)) || CUDA_FAILED(cudaEventSynchronize(s->converted)) )
+	{
+		onBufferFree(s);
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQueue.push_back(s);
+	}
+
+	mEvent.notify_one();
+	return true;
+}
+
+
+// onBufferFree
+void gstEncoder::onBufferFree( void* user_data )
+{
+	slot* s = (slot*)user_data;
+
+	std::lock_guard<std::mutex> lock(s->encoder->mMutex);
+	s->busy = false;
+}
+
+
+// encoderThread
+void gstEncoder::encoderThread()
+{
+	while(true)
+	{
+		slot* s = NULL;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mEvent.wait(lock, [this]{ return mQueue.size() > 0 || mStop; });
+
+			if( mQueue.size() == 0 )
+				return;
+
+			s = mQueue.front();
+			mQueue.pop_front();
+		}
+
+		// hand the converted buffer to the pipeline without copying it
+		// (it comes back to the pool through onBufferFree once it's been encoded)
+		GstBuffer* buffer = gst_buffer_new_wrapped_full((GstMemoryFlags)0, s->cpu, mSize, 0, mSize, s, onBufferFree);
+
+		if( !buffer )
+		{
+			onBufferFree(s);
+			continue;
+		}
+
+		// appsrc takes ownership of the buffer
+		const GstFlowReturn result = gst_app_src_push_buffer(mAppSrc, buffer);
+
+		if( result != GST_FLOW_OK )
+			printf(LOG_GSTREAMER "gstreamer encoder -- failed to push buffer (%i)\n", (int)result);
+		else
+			mFrames++;
+
+		checkMsgBus();
+	}
+}
+
+
+// checkMsgBus
+void gstEncoder::checkMsgBus()
+{
+	while(true)
+	{
+		GstMessage* msg = gst_bus_pop(mBus);
+
+		if( !msg )
+			break;
+
+		gst_message_print(mBus, msg, this);
+		gst_message_unref(msg);
+	}
+}
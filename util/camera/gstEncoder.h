@@ -0,0 +1,129 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __GSTREAMER_ENCODER_H__
+#define __GSTREAMER_ENCODER_H__
+
+#include <gst/gst.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cudaUtility.h"
+#include "imageFormat.h"
+
+
+struct _GstAppSrc;
+
+
+/**
+ * Encodes frames with gstreamer (through an appsrc) to a video file or an RTP stream,
+ * for watching the output of headless devices that have no display for glDisplay.
+ *
+ * Frames are converted to RGBA8 on the GPU, into a small pool of mapped (pinned) buffers
+ * that are handed to the pipeline without copying.  Encode() returns once the conversion has
+ * finished (so the input can be reused right away), and the encoder's thread pushes the frame
+ * into the pipeline.
+ * When all of the buffers are still being encoded, new frames are dropped instead of
+ * stalling the caller (i.e. inference).
+ * @ingroup util
+ */
+class gstEncoder
+{
+public:
+	// Compression format
+	enum Codec
+	{
+		CODEC_H264,		// omxh264enc (or x264enc where it isn't available)
+		CODEC_MJPEG		// jpegenc
+	};
+
+	// Create an encoder writing to a file (.mp4, .mkv, .avi, or a raw .h264/.mjpeg stream),
+	// or streaming RTP over UDP with an output of rtp://<host>:<port>.  The bitrate (in bits
+	// per second) applies to H.264, numBuffers is the size of the buffer pool.
+	static gstEncoder* Create( Codec codec, const char* output, uint32_t width, uint32_t height,
+						  uint32_t framerate=30, uint32_t bitrate=4000000, uint32_t numBuffers=4 );
+
+	// Destroy (closing the stream first, if needed)
+	~gstEncoder();
+
+	// Start the pipeline and the encoder's thread
+	bool Open();
+
+	// Finish the stream (waiting for the file to be finalized) and stop
+	void Close();
+
+	// Queue a float4 RGBA frame in CUDA memory, with pixel values in the given range.
+	// The frame is copied before returning, so the caller can overwrite it afterwards.
+	// Returns false if the frame was dropped (all of the buffers are busy) or an error occurred.
+	bool Encode( float4* rgba, const float2& range=make_float2(0.0f, 255.0f) );
+
+	// Queue a packed 8-bit frame in CUDA memory (e.g. the BGR data of a cv::Mat in mapped memory).
+	// The pitch is the size of each row in bytes, or 0 if the rows are tightly packed.
+	bool Encode( void* image, imageFormat format, size_t pitch=0 );
+
+	// Output dimensions
+	inline uint32_t GetWidth() const		{ return mWidth; }
+	inline uint32_t GetHeight() const		{ return mHeight; }
+
+	// Number of frames pushed to the pipeline, and dropped because no buffer was free
+	inline uint64_t GetFrames() const		{ return mFrames; }
+	inline uint64_t GetDropped() const		{ return mDropped; }
+
+protected:
+	gstEncoder();
+
+	// a buffer in the pool
+	struct slot
+	{
+		gstEncoder* encoder;
+		void*       cpu;
+		void*       cuda;
+		cudaEvent_t converted;	// recorded after the conversion kernel, and waited on by Encode()
+		bool        busy;		// being converted, queued, or held by the pipeline
+	};
+
+	bool init( uint32_t numBuffers );
+	bool buildLaunchStr();
+
+	slot* acquire();
+	bool  submit( slot* s );
+	void  encoderThread();
+	void  checkMsgBus();
+
+	static void onBufferFree( void* user_data );
+
+	Codec       mCodec;
+	std::string mOutput;
+	std::string mLaunchStr;
+
+	uint32_t mWidth;
+	uint32_t mHeight;
+	uint32_t mFramerate;
+	uint32_t mBitrate;
+	uint32_t mSize;
+
+	_GstBus*     mBus;
+	_GstAppSrc*  mAppSrc;
+	_GstElement* mPipeline;
+
+	std::vector<slot>       mSlots;
+	std::deque<slot*>       mQueue;		// converted frames, waiting to be pushed
+	std::mutex              mMutex;
+	std::condition_variable mEvent;
+	std::thread             mThread;
+
+	std::atomic<uint64_t> mFrames;
+	std::atomic<uint64_t> mDropped;
+
+	bool mStreaming;
+	bool mStop;
+};
+
+#endif
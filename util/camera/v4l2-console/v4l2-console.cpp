@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include <signal.h>
+#include <string.h>
 //#include <unistd.h>
 #include <QImage>
 
@@ -38,7 +39,7 @@ int main( int argc, char** argv )
 	if( argc < 2 )
 	{
 		printf("v4l2-console:  0 arguments were supplied.\n");
-		printf("usage:  v4l2-console <filename>\n");
+		printf("usage:  v4l2-console <filename> [--mmap]\n");
 		printf("      ./v4l2-console /dev/video0\n");
 		
 		return 0;
@@ -53,7 +54,9 @@ int main( int argc, char** argv )
 	/*
 	 * create the camera device
 	 */
-	v4l2Camera* camera = v4l2Camera::Create(dev_path);
+	const bool use_mmap = (argc > 2 && strcmp(argv[2], "--mmap") == 0);
+
+	v4l2Camera* camera = v4l2Camera::Create(dev_path, use_mmap ? v4l2Camera::IO_MMAP : v4l2Camera::IO_USERPTR);
 	
 	if( !camera )
 	{
@@ -65,6 +68,7 @@ int main( int argc, char** argv )
 	printf("    width:  %u\n", camera->GetWidth());
 	printf("   height:  %u\n", camera->GetHeight());
 	printf("    depth:  %u (bpp)\n", camera->GetPixelDepth());
+	printf("       io:  %s\n", (camera->GetIOMethod() == v4l2Camera::IO_USERPTR) ? "userptr (CUDA mapped)" : "mmap");
 	
 	
 	/*
@@ -0,0 +1,338 @@
+/*
+ * inference-101
+ */
+
+// A fake V4L2 capture device for v4l2-test, loaded with LD_PRELOAD.  It intercepts
+// open(), ioctl(), mmap() and munmap() for /dev/fakevideo0 and passes everything
+// else through.  The device streams 64x48 YUYV frames, and each frame is filled
+// with the low byte of its sequence number so the test can tell them apart.
+//
+// Environment variables (read on every ioctl, so the test can change them between cameras):
+//
+//    V4L2_FAKE_NO_USERPTR    VIDIOC_REQBUFS fails for V4L2_MEMORY_USERPTR
+//    V4L2_FAKE_FAIL_QBUF=n   the n'th VIDIOC_QBUF of a userptr buffer fails (counting from 0)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+
+#define FAKE_DEVICE_PATH   "/dev/fakevideo0"
+#define FAKE_WIDTH         64
+#define FAKE_HEIGHT        48
+#define FAKE_PITCH         (FAKE_WIDTH * 2)
+#define FAKE_IMAGE_SIZE    (FAKE_PITCH * FAKE_HEIGHT)
+#define FAKE_BUFFER_SIZE   ((FAKE_IMAGE_SIZE + 4095) & ~4095)
+#define FAKE_MAX_BUFFERS   8
+
+
+// the state of the (one) fake device
+static int      gFD          = -1;
+static uint32_t gMemory      = 0;
+static uint32_t gBufferCount = 0;
+static uint32_t gSequence    = 0;
+static uint32_t gQueueCount  = 0;	// userptr QBUFs since REQBUFS, for V4L2_FAKE_FAIL_QBUF
+
+static void*         gBuffers[FAKE_MAX_BUFFERS];	// V4L2_MEMORY_MMAP
+static unsigned long gUserPtr[FAKE_MAX_BUFFERS];	// V4L2_MEMORY_USERPTR
+static bool          gQueued[FAKE_MAX_BUFFERS];
+
+
+// freeBuffers
+static void freeBuffers()
+{
+	for( uint32_t n=0; n < FAKE_MAX_BUFFERS; n++ )
+	{
+		free(gBuffers[n]);
+
+		gBuffers[n] = NULL;
+		gUserPtr[n] = 0;
+		gQueued[n]  = false;
+	}
+
+	gBufferCount = 0;
+}
+
+
+// anyQueued
+static bool anyQueued()
+{
+	for( uint32_t n=0; n < gBufferCount; n++ )
+	{
+		if( gQueued[n] )
+			return true;
+	}
+
+	return false;
+}
+
+
+// fail
+static int fail( int error )
+{
+	errno = error;
+	return -1;
+}
+
+
+// requestBuffers
+static int requestBuffers( v4l2_requestbuffers* req )
+{
+	if( req->memory == V4L2_MEMORY_USERPTR && getenv("V4L2_FAKE_NO_USERPTR") != NULL )
+		return fail(EINVAL);
+
+	// like videobuf2, the buffers can't be swapped out while the driver still has some
+	if( req->count > 0 && gBufferCount > 0 && anyQueued() )
+	{
+		printf("v4l2-fake -- VIDIOC_REQBUFS while %s buffers are still queued\n", gMemory == V4L2_MEMORY_USERPTR ? "userptr" : "mmap");
+		return fail(EBUSY);
+	}
+
+	freeBuffers();
+
+	if( req->count == 0 )
+		return 0;
+
+	gMemory      = req->memory;
+	gBufferCount = (req->count > FAKE_MAX_BUFFERS) ? FAKE_MAX_BUFFERS : req->count;
+	gQueueCount  = 0;
+	req->count   = gBufferCount;
+
+	if( gMemory == V4L2_MEMORY_MMAP )
+	{
+		for( uint32_t n=0; n < gBufferCount; n++ )
+		{
+			if( posix_memalign(&gBuffers[n], 4096, FAKE_BUFFER_SIZE) != 0 )
+				return fail(ENOMEM);
+		}
+	}
+
+	return 0;
+}
+
+
+// queueBuffer
+static int queueBuffer( v4l2_buffer* buf )
+{
+	if( buf->memory != gMemory || buf->index >= gBufferCount || gQueued[buf->index] )
+		return fail(EINVAL);
+
+	if( gMemory == V4L2_MEMORY_USERPTR )
+	{
+		const char* failQueue = getenv("V4L2_FAKE_FAIL_QBUF");
+
+		if( failQueue != NULL && (uint32_t)atoi(failQueue) == gQueueCount++ )
+			return fail(EINVAL);
+
+		if( buf->length < FAKE_IMAGE_SIZE || buf->m.userptr == 0 )
+			return fail(EINVAL);
+
+		gUserPtr[buf->index] = buf->m.userptr;
+	}
+
+	gQueued[buf->index] = true;
+	return 0;
+}
+
+
+// dequeueBuffer
+static int dequeueBuffer( v4l2_buffer* buf )
+{
+	for( uint32_t n=0; n < gBufferCount; n++ )
+	{
+		if( !gQueued[n] )
+			continue;
+
+		uint8_t* ptr = (gMemory == V4L2_MEMORY_USERPTR) ? (uint8_t*)gUserPtr[n] : (uint8_t*)gBuffers[n];
+		memset(ptr, gSequence & 0xFF, FAKE_IMAGE_SIZE);
+
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+
+		gQueued[n] = false;
+
+		buf->index     = n;
+		buf->bytesused = FAKE_IMAGE_SIZE;
+		buf->sequence  = gSequence++;
+		buf->flags     = V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC;
+
+		buf->timestamp.tv_sec  = ts.tv_sec;
+		buf->timestamp.tv_usec = ts.tv_nsec / 1000;
+
+		return 0;
+	}
+
+	return fail(EAGAIN);
+}
+
+
+// fakeIoctl
+static int fakeIoctl( unsigned long request, void* arg )
+{
+	switch( (uint32_t)request )
+	{
+		case VIDIOC_QUERYCAP:
+		{
+			v4l2_capability* caps = (v4l2_capability*)arg;
+			memset(caps, 0, sizeof(v4l2_capability));
+			strcpy((char*)caps->driver, "v4l2-fake");
+			strcpy((char*)caps->card, "v4l2-fake");
+			caps->capabilities = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_STREAMING;
+			return 0;
+		}
+
+		case VIDIOC_ENUM_FMT:
+		{
+			v4l2_fmtdesc* desc = (v4l2_fmtdesc*)arg;
+
+			if( desc->index > 0 )
+				return fail(EINVAL);
+
+			desc->pixelformat = V4L2_PIX_FMT_YUYV;
+			strcpy((char*)desc->description, "YUYV 4:2:2");
+			return 0;
+		}
+
+		case VIDIOC_G_FMT:
+		case VIDIOC_S_FMT:
+		case VIDIOC_TRY_FMT:
+		{
+			v4l2_format* fmt = (v4l2_format*)arg;
+
+			fmt->fmt.pix.width        = FAKE_WIDTH;
+			fmt->fmt.pix.height       = FAKE_HEIGHT;
+			fmt->fmt.pix.pixelformat  = V4L2_PIX_FMT_YUYV;
+			fmt->fmt.pix.field        = V4L2_FIELD_NONE;
+			fmt->fmt.pix.bytesperline = FAKE_PITCH;
+			fmt->fmt.pix.sizeimage    = FAKE_IMAGE_SIZE;
+			return 0;
+		}
+
+		case VIDIOC_REQBUFS:
+			return requestBuffers((v4l2_requestbuffers*)arg);
+
+		case VIDIOC_QUERYBUF:
+		{
+			v4l2_buffer* buf = (v4l2_buffer*)arg;
+
+			if( buf->index >= gBufferCount )
+				return fail(EINVAL);
+
+			buf->length   = FAKE_IMAGE_SIZE;
+			buf->m.offset = buf->index * FAKE_BUFFER_SIZE;
+			return 0;
+		}
+
+		case VIDIOC_EXPBUF:
+		{
+			// any fd will do, v4l2Camera only hands it out and closes it
+			v4l2_exportbuffer* exp = (v4l2_exportbuffer*)arg;
+			exp->fd = eventfd(0, 0);
+			return 0;
+		}
+
+		case VIDIOC_QBUF:		return queueBuffer((v4l2_buffer*)arg);
+		case VIDIOC_DQBUF:		return dequeueBuffer((v4l2_buffer*)arg);
+		case VIDIOC_STREAMON:	return 0;
+
+		case VIDIOC_STREAMOFF:
+		{
+			// stopping the stream takes back every buffer the driver had
+			for( uint32_t n=0; n < gBufferCount; n++ )
+				gQueued[n] = false;
+
+			return 0;
+		}
+	}
+
+	return fail(EINVAL);	// the controls, frame sizes and intervals aren't enumerable
+}
+
+
+extern "C" {
+
+// open
+int open( const char* path, int flags, ... )
+{
+	static int (*realOpen)(const char*, int, ...) = (int (*)(const char*, int, ...))dlsym(RTLD_NEXT, "open");
+
+	va_list args;
+	va_start(args, flags);
+	const mode_t mode = va_arg(args, mode_t);
+	va_end(args);
+
+	if( strcmp(path, FAKE_DEVICE_PATH) != 0 )
+		return realOpen(path, flags, mode);
+
+	// an eventfd that's always readable, so select() in v4l2Camera::Capture() returns immediately
+	freeBuffers();
+	gFD = eventfd(1, 0);
+	return gFD;
+}
+
+
+// ioctl
+int ioctl( int fd, unsigned long request, ... )
+{
+	static int (*realIoctl)(int, unsigned long, ...) = (int (*)(int, unsigned long, ...))dlsym(RTLD_NEXT, "ioctl");
+
+	va_list args;
+	va_start(args, request);
+	void* arg = va_arg(args, void*);
+	va_end(args);
+
+	if( fd < 0 || fd != gFD )
+		return realIoctl(fd, request, arg);
+
+	return fakeIoctl(request, arg);
+}
+
+
+// mmap
+void* mmap( void* addr, size_t length, int prot, int flags, int fd, off_t offset )
+{
+	static void* (*realMmap)(void*, size_t, int, int, int, off_t) = (void* (*)(void*, size_t, int, int, int, off_t))dlsym(RTLD_NEXT, "mmap");
+
+	if( fd < 0 || fd != gFD )
+		return realMmap(addr, length, prot, flags, fd, offset);
+
+	const uint32_t index = offset / FAKE_BUFFER_SIZE;
+
+	if( gMemory != V4L2_MEMORY_MMAP || index >= gBufferCount )
+	{
+		errno = EINVAL;
+		return MAP_FAILED;
+	}
+
+	return gBuffers[index];
+}
+
+
+// munmap
+int munmap( void* addr, size_t length )
+{
+	static int (*realMunmap)(void*, size_t) = (int (*)(void*, size_t))dlsym(RTLD_NEXT, "munmap");
+
+	for( uint32_t n=0; n < FAKE_MAX_BUFFERS; n++ )
+	{
+		if( addr != NULL && addr == gBuffers[n] )
+			return 0;	// freed with the next VIDIOC_REQBUFS
+	}
+
+	return realMunmap(addr, length);
+}
+
+}
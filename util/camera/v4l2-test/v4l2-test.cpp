@@ -0,0 +1,223 @@
+/*
+ * inference-101
+ */
+
+#include "v4l2Camera.h"
+#include "commandLine.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+// the fake device from libv4l2-fake.so (see v4l2-fake.cpp)
+#define FAKE_DEVICE_PATH  "/dev/fakevideo0"
+#define FAKE_LIBRARY      "libv4l2-fake.so"
+
+
+// failures are counted instead of returning, so one run reports everything that broke
+static int gFailures = 0;
+
+#define CHECK(x)	if( !(x) ) { printf("v4l2-test:  FAILED  %s  (line %i)\n", #x, __LINE__); gFailures++; }
+
+
+// ioMethodStr
+static const char* ioMethodStr( v4l2Camera::IOMethod io )
+{
+	return (io == v4l2Camera::IO_USERPTR) ? "userptr" : "mmap";
+}
+
+
+// captureHeld
+static bool captureHeld( v4l2Camera* camera, bool fake, void** cpu, frameStamp* stamp )
+{
+	void* cuda = NULL;
+
+	if( !camera->Capture(cpu, &cuda, 1000, stamp) )
+		return false;
+
+	if( camera->GetIOMethod() == v4l2Camera::IO_USERPTR && cuda == NULL )
+	{
+		printf("v4l2-test:  userptr frame 0x%p has no CUDA address\n", *cpu);
+		return false;
+	}
+
+	// the fake device fills each frame with the low byte of its sequence number
+	if( fake && *(uint8_t*)*cpu != (stamp->sequence & 0xFF) )
+	{
+		printf("v4l2-test:  frame %llu has the contents of another frame (%u)\n", (unsigned long long)stamp->sequence, *(uint8_t*)*cpu);
+		return false;
+	}
+
+	return true;
+}
+
+
+// testCamera
+static void testCamera( const char* device, bool fake, v4l2Camera::IOMethod requested, int expected )
+{
+	printf("\nv4l2-test:  %s, requesting %s buffers\n", device, ioMethodStr(requested));
+
+	v4l2Camera* camera = v4l2Camera::Create(device, requested);
+
+	CHECK(camera != NULL);
+
+	if( !camera )
+		return;
+
+	if( expected >= 0 )
+		CHECK(camera->GetIOMethod() == (v4l2Camera::IOMethod)expected);
+
+	printf("v4l2-test:  %ux%u, using %s buffers\n", camera->GetWidth(), camera->GetHeight(), ioMethodStr(camera->GetIOMethod()));
+
+	CHECK(camera->Open());
+
+	// hold three frames, and give the middle one back
+	void*      held[3] = { NULL, NULL, NULL };
+	frameStamp stamps[3];
+
+	for( int n=0; n < 3; n++ )
+	{
+		CHECK(captureHeld(camera, fake, &held[n], &stamps[n]));
+
+		if( n > 0 )
+			CHECK(stamps[n].sequence > stamps[n-1].sequence);
+	}
+
+	CHECK(held[0] != held[1] && held[0] != held[2] && held[1] != held[2]);
+	CHECK(camera->Release(held[1]));
+
+	// the driver mustn't write into the frames that are still held
+	for( int n=0; n < 8; n++ )
+	{
+		frameStamp stamp;
+		void* image = camera->Capture(1000, &stamp);
+
+		CHECK(image != NULL);
+		CHECK(image != held[0] && image != held[2]);
+
+		if( fake && image != NULL )
+			CHECK(*(uint8_t*)image == (stamp.sequence & 0xFF));
+	}
+
+	CHECK(*(uint8_t*)held[0] == (stamps[0].sequence & 0xFF) || !fake);
+	CHECK(*(uint8_t*)held[2] == (stamps[2].sequence & 0xFF) || !fake);
+
+	CHECK(camera->Release(held[0]));
+
+	// a frame held across Close() / Open() stays the caller's
+	CHECK(camera->Close());
+	CHECK(camera->Open());
+
+	for( int n=0; n < 8; n++ )
+	{
+		void* image = camera->Capture(1000);
+
+		CHECK(image != NULL);
+		CHECK(image != held[2]);
+	}
+
+	CHECK(*(uint8_t*)held[2] == (stamps[2].sequence & 0xFF) || !fake);
+	CHECK(camera->Release(held[2]));
+
+	// stopping the stream takes back the buffers, Open() has to queue them again
+	CHECK(camera->Close());
+	CHECK(camera->Open());
+
+	for( int n=0; n < 3; n++ )
+		CHECK(captureHeld(camera, fake, &held[n], &stamps[n]));
+
+	for( int n=0; n < 3; n++ )
+		CHECK(camera->Release(held[n]));
+
+	for( int n=0; n < 8; n++ )
+		CHECK(camera->Capture(1000) != NULL);
+
+	CHECK(camera->Close());
+	delete camera;
+}
+
+
+// preloadFake (re-runs the test with the fake device loaded from the lib directory next to bin)
+static int preloadFake( char** argv )
+{
+	char exePath[PATH_MAX];
+	const ssize_t length = readlink("/proc/self/exe", exePath, sizeof(exePath) - 1);
+
+	if( length <= 0 )
+	{
+		printf("v4l2-test:  failed to find the executable's path\n");
+		return 1;
+	}
+
+	exePath[length] = '\0';
+
+	char* slash = strrchr(exePath, '/');
+
+	if( slash != NULL )
+		*slash = '\0';
+
+	char libPath[PATH_MAX + 64];
+	snprintf(libPath, sizeof(libPath), "%s/../lib/%s", exePath, FAKE_LIBRARY);
+
+	if( access(libPath, R_OK) != 0 )
+	{
+		printf("v4l2-test:  couldn't find %s\n", libPath);
+		return 1;
+	}
+
+	setenv("LD_PRELOAD", libPath, 1);
+	execv("/proc/self/exe", argv);
+
+	printf("v4l2-test:  failed to re-run with LD_PRELOAD=%s\n", libPath);
+	return 1;
+}
+
+
+int main( int argc, char** argv )
+{
+	commandLine cmdLine(argc, argv);
+
+	const char* device = cmdLine.GetString("device");
+
+	if( device != NULL )
+	{
+		// a real device (e.g. vivid), which may or may not support userptr
+		testCamera(device, false, v4l2Camera::IO_USERPTR, -1);
+		testCamera(device, false, v4l2Camera::IO_MMAP, v4l2Camera::IO_MMAP);
+	}
+	else
+	{
+		const char* preload = getenv("LD_PRELOAD");
+
+		if( !preload || !strstr(preload, FAKE_LIBRARY) )
+			return preloadFake(argv);
+
+		unsetenv("V4L2_FAKE_NO_USERPTR");
+		unsetenv("V4L2_FAKE_FAIL_QBUF");
+
+		testCamera(FAKE_DEVICE_PATH, true, v4l2Camera::IO_USERPTR, v4l2Camera::IO_USERPTR);
+		testCamera(FAKE_DEVICE_PATH, true, v4l2Camera::IO_MMAP, v4l2Camera::IO_MMAP);
+
+		// the driver doesn't support userptr
+		setenv("V4L2_FAKE_NO_USERPTR", "1", 1);
+		testCamera(FAKE_DEVICE_PATH, true, v4l2Camera::IO_USERPTR, v4l2Camera::IO_MMAP);
+		unsetenv("V4L2_FAKE_NO_USERPTR");
+
+		// the driver accepts userptr, but not the third buffer
+		setenv("V4L2_FAKE_FAIL_QBUF", "2", 1);
+		testCamera(FAKE_DEVICE_PATH, true, v4l2Camera::IO_USERPTR, v4l2Camera::IO_MMAP);
+		unsetenv("V4L2_FAKE_FAIL_QBUF");
+	}
+
+	if( gFailures > 0 )
+	{
+		printf("\nv4l2-test:  %i checks FAILED\n", gFailures);
+		return 1;
+	}
+
+	printf("\nv4l2-test:  all checks passed\n");
+	return 0;
+}
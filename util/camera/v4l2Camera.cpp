@@ -3,6 +3,7 @@
  */
 
 #include "v4l2Camera.h"
+#include "cudaMappedMemory.h"
 
 #include <fcntl.h> 
 #include <unistd.h>
@@ -38,8 +39,10 @@ v4l2Camera::v4l2Camera( const char* device_path ) : mDevicePath(device_path)
 {	
 	mFD = -1;
 
-	mBuffersMMap     = NULL;
-	mBufferCountMMap = 0;
+	mBuffers         = NULL;
+	mBufferCount     = 0;
+	mLastCapture     = NULL;
+	mIOMethod        = IO_USERPTR;
 	mRequestWidth    = 0;
 	mRequestHeight   = 0;
 	mRequestFormat   = 1;
@@ -49,23 +52,80 @@ v4l2Camera::v4l2Camera( const char* device_path ) : mDevicePath(device_path)
 	mHeight     = 0;
 	mPitch      = 0;
 	mPixelDepth = 0;
+	mImageSize  = 0;
 }
 
 
 // destructor	
 v4l2Camera::~v4l2Camera()
 {
-	// close file
+	// close file (which also releases the driver's references to the buffers)
 	if( mFD >= 0 )
 	{
 		close(mFD);
 		mFD = -1;
 	}
+
+	freeBuffers();
+}
+
+
+// freeBuffers
+void v4l2Camera::freeBuffers()
+{
+	if( !mBuffers )
+		return;
+
+	for( size_t n=0; n < mBufferCount; n++ )
+	{
+		if( mBuffers[n].dmabuf >= 0 )
+			close(mBuffers[n].dmabuf);
+
+		if( !mBuffers[n].ptr )
+			continue;
+
+		if( mIOMethod == IO_USERPTR )
+		{
+			CUDA(cudaFreeHost(mBuffers[n].ptr));
+		}
+		else
+		{
+			if( mBuffers[n].gpu != NULL )
+				cudaHostUnregister(mBuffers[n].ptr);
+
+			munmap(mBuffers[n].ptr, mBuffers[n].buf.length);
+		}
+	}
+
+	free(mBuffers);
+
+	mBuffers     = NULL;
+	mBufferCount = 0;
+}
+
+
+// Capture
+void* v4l2Camera::Capture( size_t timeout, frameStamp* stamp )
+{
+	// the image from last time goes back to the driver
+	if( mLastCapture != NULL )
+	{
+		Release(mLastCapture);
+		mLastCapture = NULL;
+	}
+
+	void* image_ptr = NULL;
+
+	if( !Capture(&image_ptr, NULL, timeout, stamp) )
+		return NULL;
+
+	mLastCapture = image_ptr;
+	return image_ptr;
 }
 
 
-// ProcessEmit
-void* v4l2Camera::Capture( size_t timeout )
+// Capture
+bool v4l2Camera::Capture( void** cpu, void** cuda, size_t timeout, frameStamp* stamp )
 {
 	fd_set fds;
 	FD_ZERO(&fds);
@@ -76,8 +136,6 @@ void* v4l2Camera::Capture( size_t timeout )
 	tv.tv_sec  = 0;
 	tv.tv_usec = 0;
 
-	const bool threaded = true; //false;
-
 	if( timeout > 0 )
 	{
 		tv.tv_sec  = timeout / 1000;
@@ -92,13 +150,13 @@ void* v4l2Camera::Capture( size_t timeout )
 	{
 		//if (EINTR == errno)
 		printf("v4l2 -- select() failed (errno=%i) (%s)\n", errno, strerror(errno));
-		return NULL;
+		return false;
 	}
 	else if( result == 0 )
 	{
 		if( timeout > 0 )
 			printf("v4l2 -- select() timed out...\n");
-		return NULL;	// timeout, not necessarily an error (TRY_AGAIN)
+		return false;	// timeout, not necessarily an error (TRY_AGAIN)
 	}
 
 	// dequeue input buffer from V4L2
@@ -106,30 +164,115 @@ void* v4l2Camera::Capture( size_t timeout )
 	memset(&buf, 0, sizeof(v4l2_buffer));
 
 	buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-	buf.memory = V4L2_MEMORY_MMAP;	//V4L2_MEMORY_USERPTR;
+	buf.memory = (mIOMethod == IO_USERPTR) ? V4L2_MEMORY_USERPTR : V4L2_MEMORY_MMAP;
 
 	if( xioctl(mFD, VIDIOC_DQBUF, &buf) < 0 )
 	{
-		printf("v4l2 -- ioctl(VIDIOC_DQBUF) failed (errno=%i) (%s)\n", errno, strerror(errno));
-		return NULL;
+		if( errno != EAGAIN )
+			printf("v4l2 -- ioctl(VIDIOC_DQBUF) failed (errno=%i) (%s)\n", errno, strerror(errno));
+
+		return false;
 	}
 	
-	if( buf.index >= mBufferCountMMap )
+	if( buf.index >= mBufferCount )
 	{
-		printf("v4l2 -- invalid mmap buffer index (%u)\n", buf.index);
-		return NULL;
+		printf("v4l2 -- invalid capture buffer index (%u)\n", buf.index);
+		return false;
 	}
 	
 	// emit ringbuffer entry
 	//printf("v4l2 -- recieved %ux%u video frame (index=%u)\n", mWidth, mHeight, (uint32_t)buf.index);
 
-	void* image_ptr = mBuffersMMap[buf.index].ptr;
+	v4l2_capture_buffer* buffer = &mBuffers[buf.index];
+	buffer->queued   = false;
+	buffer->captured = true;	// the caller owns it until Release()
+
+	// the driver's timestamp is when the first byte was captured, if it's on the monotonic clock
+	if( stamp != NULL )
+	{
+		stamp->sequence = buf.sequence;
+
+		if( (buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC )
+			stamp->timestamp = (uint64_t)buf.timestamp.tv_sec * 1000000000ULL + (uint64_t)buf.timestamp.tv_usec * 1000ULL;
+		else
+			stamp->timestamp = traceTime();
+	}
+
+	if( cpu != NULL )
+		*cpu = buffer->ptr;
+
+	if( cuda != NULL )
+		*cuda = buffer->gpu;
+
+	return true;
+}
+
+
+// Release
+bool v4l2Camera::Release( void* ptr )
+{
+	if( !ptr )
+		return false;
+
+	for( size_t n=0; n < mBufferCount; n++ )
+	{
+		if( ptr != mBuffers[n].ptr && ptr != mBuffers[n].gpu )
+			continue;
+
+		if( !mBuffers[n].captured )
+			return true;
+
+		if( ptr == mLastCapture )
+			mLastCapture = NULL;
+
+		mBuffers[n].captured = false;
+		return queueBuffer(n);
+	}
+
+	printf("v4l2 -- Release() called with unknown image 0x%p\n", ptr);
+	return false;
+}
+
+
+// GetDMABuf
+int v4l2Camera::GetDMABuf( void* ptr ) const
+{
+	for( size_t n=0; n < mBufferCount; n++ )
+	{
+		if( ptr == mBuffers[n].ptr || ptr == mBuffers[n].gpu )
+			return mBuffers[n].dmabuf;
+	}
+
+	return -1;
+}
+
+
+// queueBuffer
+bool v4l2Camera::queueBuffer( size_t index )
+{
+	v4l2_capture_buffer* buffer = &mBuffers[index];
+	struct v4l2_buffer buf;
+
+	memset(&buf, 0, sizeof(v4l2_buffer));
+
+	buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	buf.memory = buffer->buf.memory;
+	buf.index  = index;
+
+	if( buf.memory == V4L2_MEMORY_USERPTR )
+	{
+		buf.m.userptr = (unsigned long)buffer->ptr;
+		buf.length    = buffer->buf.length;
+	}
 
-	// re-queue buffer to V4L2
 	if( xioctl(mFD, VIDIOC_QBUF, &buf) < 0 )
+	{
 		printf("v4l2 -- ioctl(VIDIOC_QBUF) failed (errno=%i) (%s)\n", errno, strerror(errno));
+		return false;
+	}
 
-	return image_ptr;
+	buffer->queued = true;
+	return true;
 }
 
 
@@ -156,44 +299,79 @@ bool v4l2Camera::initMMap()
 		return false;
 	}
 
-	mBuffersMMap = (v4l2_mmap*)malloc( req.count * sizeof(v4l2_mmap) );
+	mIOMethod = IO_MMAP;
+	mBuffers  = (v4l2_capture_buffer*)malloc( req.count * sizeof(v4l2_capture_buffer) );
 	
-	if( !mBuffersMMap )
+	if( !mBuffers )
 		return false;
 
-	memset(mBuffersMMap, 0, req.count * sizeof(v4l2_mmap));
+	memset(mBuffers, 0, req.count * sizeof(v4l2_capture_buffer));
+
+	for( size_t n=0; n < req.count; n++ )
+		mBuffers[n].dmabuf = -1;
+
+	mBufferCount = req.count;
+
+	size_t numExported   = 0;
+	size_t numRegistered = 0;
 
 	for( size_t n=0; n < req.count; n++ )
 	{
-		mBuffersMMap[n].buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-		mBuffersMMap[n].buf.memory = V4L2_MEMORY_MMAP;
-		mBuffersMMap[n].buf.index  = n;
+		mBuffers[n].buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		mBuffers[n].buf.memory = V4L2_MEMORY_MMAP;
+		mBuffers[n].buf.index  = n;
 		
-		if( xioctl(mFD, VIDIOC_QUERYBUF, &mBuffersMMap[n].buf) < 0 )
+		if( xioctl(mFD, VIDIOC_QUERYBUF, &mBuffers[n].buf) < 0 )
 		{
 			printf( "v4l2 -- failed retrieve mmap buffer info (errno=%i) (%s)\n", errno, strerror(errno));
 			return false;
 		}
 
-		mBuffersMMap[n].ptr = mmap(NULL, mBuffersMMap[n].buf.length,
-							  PROT_READ|PROT_WRITE, MAP_SHARED,
-							  mFD, mBuffersMMap[n].buf.m.offset);
+		void* ptr = mmap(NULL, mBuffers[n].buf.length,
+					  PROT_READ|PROT_WRITE, MAP_SHARED,
+					  mFD, mBuffers[n].buf.m.offset);
 
-		if( mBuffersMMap[n].ptr == MAP_FAILED )
+		if( ptr == MAP_FAILED )
 		{
 			printf( "v4l2 -- failed to mmap buffer (errno=%i) (%s)\n", errno, strerror(errno));
 			return false;
 		}
 
-		if( xioctl(mFD, VIDIOC_QBUF, &mBuffersMMap[n].buf) < 0 )
+		mBuffers[n].ptr = ptr;
+
+		// export the buffer as a dmabuf, for importing into other devices
+		struct v4l2_exportbuffer expbuf;
+		memset(&expbuf, 0, sizeof(v4l2_exportbuffer));
+
+		expbuf.type  = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		expbuf.index = n;
+		expbuf.flags = O_RDONLY | O_CLOEXEC;
+
+		if( xioctl(mFD, VIDIOC_EXPBUF, &expbuf) == 0 )
 		{
-			printf( "v4l2 -- failed to queue mmap buffer (errno=%i) (%s)\n", errno, strerror(errno));
-			return false;
+			mBuffers[n].dmabuf = expbuf.fd;
+			numExported++;
 		}
+
+		// map it into CUDA, which depends on the driver's memory being pinnable
+		if( cudaHostRegister(ptr, mBuffers[n].buf.length, cudaHostRegisterMapped) == cudaSuccess )
+		{
+			if( cudaHostGetDevicePointer(&mBuffers[n].gpu, ptr, 0) == cudaSuccess )
+				numRegistered++;
+			else
+			{
+				cudaHostUnregister(ptr);
+				mBuffers[n].gpu = NULL;
+			}
+		}
+
+		cudaGetLastError();	// clear any errors, these are optional
+
+		if( !queueBuffer(n) )
+			return false;
 	}
 
-	mBufferCountMMap = req.count;	
-	printf("v4l2 -- mapped %zu capture buffers with mmap\n", mBufferCountMMap); 	
+	printf("v4l2 -- mapped %zu capture buffers with mmap (%zu exported as dmabuf, %zu mapped into CUDA)\n", mBufferCount, numExported, numRegistered); 	
 	return true;
 }
 
@@ -319,9 +497,21 @@ bool v4l2Camera::initStream()
 	mHeight     = fmt.fmt.pix.height;
 	mPitch      = fmt.fmt.pix.bytesperline;
 	mPixelDepth = (mPitch * 8) / mWidth;
+	mImageSize  = fmt.fmt.pix.sizeimage;
 
-	// initMMap
-	if( !initMMap() )		// initUserPtr()
+	if( mImageSize == 0 )
+		mImageSize = mPitch * mHeight;
+
+	// capture into CUDA mapped memory if the driver supports it, otherwise use its own buffers
+	if( mIOMethod == IO_USERPTR )
+	{
+		if( initUserPtr() )
+			return true;
+
+		printf("v4l2 -- falling back to mmap buffers\n");
+	}
+
+	if( !initMMap() )
 		return false;
 
 	return true;
@@ -329,10 +519,12 @@ bool v4l2Camera::initStream()
 
 
 // Create
-v4l2Camera* v4l2Camera::Create( const char* device_path )
+v4l2Camera* v4l2Camera::Create( const char* device_path, IOMethod io )
 {
 	v4l2Camera* cam = new v4l2Camera(device_path);
 
+	cam->mIOMethod = io;
+
 	if( !cam->init() )
 	{
 		printf("v4l2 -- failed to create instance %s\n", device_path);
@@ -375,6 +567,21 @@ bool v4l2Camera::Open()
 {
 	printf( "v4l2Camera::Open(%s)\n", mDevicePath.c_str());
 
+	// the image from Capture(timeout) is only valid until the next capture, so it goes back too
+	if( mLastCapture != NULL )
+	{
+		Release(mLastCapture);
+		mLastCapture = NULL;
+	}
+
+	// give the driver back any buffers it dropped when streaming was stopped,
+	// except the ones the caller still holds (those are queued by Release())
+	for( size_t n=0; n < mBufferCount; n++ )
+	{
+		if( !mBuffers[n].queued && !mBuffers[n].captured && !queueBuffer(n) )
+			return false;
+	}
+
 	// begin streaming
 	enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
@@ -404,6 +611,10 @@ bool v4l2Camera::Close()
 		//return false;
 	}
 
+	// stopping the stream dequeues all the buffers
+	for( size_t n=0; n < mBufferCount; n++ )
+		mBuffers[n].queued = false;
+
 	return true;
 }
 
@@ -450,32 +661,59 @@ bool v4l2Camera::initUserPtr()
 
 	if ( xioctl(mFD, VIDIOC_REQBUFS, &req) < 0 ) 
 	{
-		const int err = errno;
-		printf( "v4l2 -- failed to request buffers (errno=%i) (%s)\n", errno, strerror(errno));
+		printf( "v4l2 -- does not support userptr (errno=%i) (%s)\n", errno, strerror(errno));
 		return false;
 	}
 
-	// queue ringbuffer
-#if 0
-	for( size_t n=0; n < mRingbuffer.size(); n++ )
+	if( req.count < 2 )
+		req.count = REQUESTED_RINGBUFFERS;
+
+	mBuffers = (v4l2_capture_buffer*)malloc( req.count * sizeof(v4l2_capture_buffer) );
+	
+	if( !mBuffers )
+		return false;
+
+	memset(mBuffers, 0, req.count * sizeof(v4l2_capture_buffer));
+
+	// allocate the ringbuffer in CUDA mapped memory (which is page-aligned, as drivers require)
+	mIOMethod    = IO_USERPTR;
+	mBufferCount = req.count;
+
+	bool queued = true;
+
+	for( size_t n=0; n < mBufferCount; n++ )
 	{
-		struct v4l2_buffer buf;
-		memset(&buf, 0, sizeof(v4l2_buffer));
-		
-		buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-		buf.memory = V4L2_MEMORY_USERPTR;
-		buf.index  = n;
-		buf.length = mRingbuffer[n]->GetSize();
+		mBuffers[n].dmabuf     = -1;
+		mBuffers[n].buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		mBuffers[n].buf.memory = V4L2_MEMORY_USERPTR;
+		mBuffers[n].buf.index  = n;
+		mBuffers[n].buf.length = mImageSize;
 
-		buf.m.userptr = (unsigned long)mRingbuffer[n]->GetCPU();
+		if( !cudaAllocMapped(&mBuffers[n].ptr, &mBuffers[n].gpu, mImageSize) )
+		{
+			printf( "v4l2 -- failed to allocate %u bytes for capture buffer %zu\n", mImageSize, n);
+			queued = false;
+			break;
+		}
 
-		if( xioctl(mFD, VIDIOC_QBUF, &buf) < 0 )
+		if( !queueBuffer(n) )
 		{
-			printf( "v4l2 -- failed to queue buffer %zu (errno=%i) (%s)\n", n, errno, strerror(errno));
-			return false;
+			queued = false;
+			break;
 		}
 	}
-#endif
 
+	if( !queued )
+	{
+		// release the buffers from the driver before freeing them (it still has
+		// some of them queued), so it can be set up for mmap instead
+		req.count = 0;
+		xioctl(mFD, VIDIOC_REQBUFS, &req);
+
+		freeBuffers();
+		return false;
+	}
+
+	printf("v4l2 -- allocated %zu capture buffers in CUDA mapped memory (userptr)\n", mBufferCount);
 	return true;
 }
\ No newline at end of file
@@ -8,16 +8,25 @@
 
 #include <linux/videodev2.h>
 
+#include "latencyTrace.h"
+
 #include <stdint.h>
 #include <string>
 #include <vector>
 
 
 
-struct v4l2_mmap
+/**
+ * Capture buffer shared with the V4L2 driver.
+ */
+struct v4l2_capture_buffer
 {
 	struct v4l2_buffer buf;
-	void*  ptr;
+	void*  ptr;		/**< CPU address */
+	void*  gpu;		/**< CUDA address (NULL if it couldn't be mapped into CUDA) */
+	int    dmabuf;	/**< exported dmabuf file descriptor (-1 if unsupported) */
+	bool   queued;	/**< the driver owns it */
+	bool   captured;	/**< returned by Capture(), and not given back with Release() yet */
 };
 
 
@@ -28,11 +37,21 @@ struct v4l2_mmap
 class v4l2Camera
 {
 public:	
+	/**
+	 * How the capture buffers are shared with the driver.
+	 */
+	enum IOMethod
+	{
+		IO_USERPTR,	/**< the driver writes into CUDA mapped memory from v4l2Camera, so frames are accessible from CUDA without a copy */
+		IO_MMAP		/**< the driver's own buffers, mapped into the process (and exported as dmabuf when the driver supports it) */
+	};
+
 	/**
 	 * Create V4L2 interface
 	 * @param path Filename of the video device (e.g. /dev/video0)
+	 * @param io preferred buffer sharing method, IO_USERPTR falls back to IO_MMAP if the driver doesn't support it
 	 */
-	static v4l2Camera* Create( const char* device_path );
+	static v4l2Camera* Create( const char* device_path, IOMethod io=IO_USERPTR );
 
 	/**
 	 * Destructor
@@ -50,9 +69,41 @@ public:
 	bool Close();
 
 	/**
-	 * Return the next image.
+	 * Return the next image, which stays valid until the next call to Capture().
+	 * @param stamp optional, receives the driver's sequence number and capture timestamp
+	 */
+	void* Capture( size_t timeout=0, frameStamp* stamp=NULL );
+
+	/**
+	 * Dequeue the next image.  It belongs to the caller (the driver won't write to it)
+	 * until it's returned with Release().
+	 * @param cpu receives the CPU address of the image
+	 * @param cuda receives the CUDA address of the image (NULL if the buffer couldn't be mapped into CUDA)
+	 * @param stamp optional, receives the driver's sequence number and capture timestamp
+	 */
+	bool Capture( void** cpu, void** cuda, size_t timeout=0, frameStamp* stamp=NULL );
+
+	/**
+	 * Give an image from Capture() back to the driver (either pointer can be passed).
+	 */
+	bool Release( void* ptr );
+
+	/**
+	 * Retrieve the dmabuf file descriptor of a captured image, for importing it into other APIs.
+	 * @returns -1 if the driver couldn't export it (or the image isn't from IO_MMAP)
 	 */
-	void* Capture( size_t timeout=0 );
+	int GetDMABuf( void* ptr ) const;
+
+	/**
+	 * Return the device's file descriptor, which is readable when a frame is ready
+	 * (for waiting on several cameras at once with poll/epoll).
+	 */
+	inline int GetFD() const						{ return mFD; }
+
+	/**
+	 * Return the buffer sharing method that's in use.
+	 */
+	inline IOMethod GetIOMethod() const				{ return mIOMethod; }
 
 	/**
 	 * Get width, in pixels, of camera image.
@@ -85,6 +136,8 @@ private:
 
 	bool initUserPtr();
 	bool initMMap();
+	bool queueBuffer( size_t index );
+	void freeBuffers();
 
 	int 	mFD;
 	int	    mRequestFormat;
@@ -94,9 +147,13 @@ private:
 	uint32_t mHeight;
 	uint32_t mPitch;
 	uint32_t mPixelDepth;
+	uint32_t mImageSize;
+
+	IOMethod mIOMethod;
 
-	v4l2_mmap* mBuffersMMap;
-	size_t mBufferCountMMap;
+	v4l2_capture_buffer* mBuffers;
+	size_t mBufferCount;
+	void*  mLastCapture;	// image from Capture(timeout), released on the next call
 
 	std::vector<v4l2_fmtdesc> mFormats;
 	std::string mDevicePath;
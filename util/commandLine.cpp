@@ -129,7 +129,12 @@ const char* commandLine::GetString( const char* string_ref )
 		int length = (int)strlen(string_ref);
 
 		if (!strncasecmp(string_argv, string_ref, length))
+		{
+			if( string_argv[length] == '\0' )
+				return NULL;	// flag without a value
+
 			return (string_argv + length + 1);
+		}
 			//*string_retval = &string_argv[length+1];
 	}
 
@@ -0,0 +1,219 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+/*
+ * In CPU_ONLY builds the util/cuda kernels (*.cu) aren't compiled, so their
+ * entry points are implemented here with the host versions from cpuKernels.h
+ */
+#ifdef CPU_ONLY
+
+#include "cpuKernels.h"
+
+#include "cudaResize.h"
+#include "cudaNormalize.h"
+#include "cudaOverlay.h"
+#include "cudaRGB.h"
+#include "cudaYUV.h"
+#include "cudaColorspace.h"
+#include "cudaFont.h"
+
+
+// cudaResize
+cudaError_t cudaResize( float* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight )
+{
+	return cpuResize(input, inputWidth, inputHeight, output, outputWidth, outputHeight);
+}
+
+// cudaResizeRGBA
+cudaError_t cudaResizeRGBA( float4* input, size_t inputWidth, size_t inputHeight, float4* output, size_t outputWidth, size_t outputHeight )
+{
+	return cpuResizeRGBA(input, inputWidth, inputHeight, output, outputWidth, outputHeight);
+}
+
+// cudaResize (pitched)
+cudaError_t cudaResize( float* input, size_t inputPitch, size_t inputWidth, size_t inputHeight, float* output, size_t outputPitch, size_t outputWidth, size_t outputHeight, resizeFilter filter, const int4* roi )
+{
+	return cpuResize(input, inputPitch, inputWidth, inputHeight, output, outputPitch, outputWidth, outputHeight, filter, roi);
+}
+
+// cudaResizeRGBA (pitched)
+cudaError_t cudaResizeRGBA( float4* input, size_t inputPitch, size_t inputWidth, size_t inputHeight, float4* output, size_t outputPitch, size_t outputWidth, size_t outputHeight, resizeFilter filter, const int4* roi )
+{
+	return cpuResizeRGBA(input, inputPitch, inputWidth, inputHeight, output, outputPitch, outputWidth, outputHeight, filter, roi);
+}
+
+// cudaResizeBatchRGBA
+cudaError_t cudaResizeBatchRGBA( resizeROI* rois, uint32_t count, uint32_t maxOutputWidth, uint32_t maxOutputHeight, resizeFilter filter )
+{
+	return cpuResizeBatchRGBA(rois, count, maxOutputWidth, maxOutputHeight, filter);
+}
+
+// cudaPreImageNet
+cudaError_t cudaPreImageNet( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight )
+{
+	return cpuPreImageNet(input, inputWidth, inputHeight, output, outputWidth, outputHeight);
+}
+
+// cudaPreImageNetMean
+cudaError_t cudaPreImageNetMean( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value )
+{
+	return cpuPreImageNetMean(input, inputWidth, inputHeight, output, outputWidth, outputHeight, mean_value);
+}
+
+// cudaPreImageNetMean (packed 8-bit)
+cudaError_t cudaPreImageNetMean( void* input, imageFormat format, size_t inputPitch, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value )
+{
+	return cpuPreImageNetMean(input, format, inputPitch, inputWidth, inputHeight, output, outputWidth, outputHeight, mean_value);
+}
+
+// cudaNormalizeRGBA
+cudaError_t cudaNormalizeRGBA( float4* input, const float2& input_range, float4* output, const float2& output_range, size_t width, size_t height )
+{
+	return cpuNormalizeRGBA(input, input_range, output, output_range, width, height);
+}
+
+// cudaNormalizeToRGBA8
+cudaError_t cudaNormalizeToRGBA8( float4* input, const float2& input_range, uchar4* output, size_t width, size_t height )
+{
+	return cpuNormalizeToRGBA8(input, input_range, output, width, height);
+}
+
+// cudaRGBToRGBAf
+cudaError_t cudaRGBToRGBAf( uchar3* input, float4* output, size_t width, size_t height )
+{
+	return cpuRGBToRGBAf(input, output, width, height);
+}
+
+// cudaPackedToRGBAf
+cudaError_t cudaPackedToRGBAf( void* input, imageFormat format, size_t inputPitch, float4* output, size_t width, size_t height )
+{
+	return cpuPackedToRGBAf(input, format, inputPitch, output, width, height);
+}
+
+// cudaPackedToRGBA8
+cudaError_t cudaPackedToRGBA8( void* input, imageFormat format, size_t inputPitch, uchar4* output, size_t width, size_t height )
+{
+	return cpuPackedToRGBA8(input, format, inputPitch, output, width, height);
+}
+
+// cudaRectOutlineOverlay
+cudaError_t cudaRectOutlineOverlay( float4* input, float4* output, uint32_t width, uint32_t height, float4* boundingBoxes, int numBoxes, const float4& color )
+{
+	return cpuRectOutlineOverlay(input, output, width, height, boundingBoxes, numBoxes, color);
+}
+
+// cudaOverlayTiles
+cudaError_t cudaOverlayTiles( float4* output, uint32_t width, uint32_t height, overlayPrimitive* primitives, int4* tiles, uint32_t numTiles, uint32_t* indices, float4* font, size_t fontMapWidth, const int2& fontCellSize, cudaTextureObject_t fontTexture )
+{
+	return cpuOverlayTiles(output, width, height, primitives, tiles, numTiles, indices, font, fontMapWidth, fontCellSize, fontTexture);
+}
+
+// cudaFontTextureCreate
+cudaError_t cudaFontTextureCreate( float4* fontMap, size_t width, size_t height, cudaTextureObject_t* texture )
+{
+	if( !fontMap || width == 0 || height == 0 || !texture )
+		return cudaErrorInvalidValue;
+
+	*texture = 0;	// the host versions read the font map itself
+	return cudaSuccess;
+}
+
+// cudaFontTextureDestroy
+cudaError_t cudaFontTextureDestroy( cudaTextureObject_t texture )
+{
+	return cudaSuccess;
+}
+
+//-----------------------------------------------------------------------------------
+// YUV
+//-----------------------------------------------------------------------------------
+
+cudaError_t cudaRGBAToI420( uchar4* input, size_t inputPitch, uint8_t* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuRGBAToI420(input, inputPitch, output, outputPitch, width, height);
+}
+
+cudaError_t cudaRGBAToI420( uchar4* input, uint8_t* output, size_t width, size_t height )
+{
+	return cudaRGBAToI420(input, width * sizeof(uchar4), output, width * sizeof(uint8_t), width, height);
+}
+
+cudaError_t cudaRGBAToYV12( uchar4* input, size_t inputPitch, uint8_t* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuRGBAToYV12(input, inputPitch, output, outputPitch, width, height);
+}
+
+cudaError_t cudaRGBAToYV12( uchar4* input, uint8_t* output, size_t width, size_t height )
+{
+	return cudaRGBAToYV12(input, width * sizeof(uchar4), output, width * sizeof(uint8_t), width, height);
+}
+
+cudaError_t cudaUYVYToRGBA( uchar2* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuUYVYToRGBA(input, inputPitch, output, outputPitch, width, height);
+}
+
+cudaError_t cudaUYVYToRGBA( uchar2* input, uchar4* output, size_t width, size_t height )
+{
+	return cudaUYVYToRGBA(input, width * sizeof(uchar2), output, width * sizeof(uchar4), width, height);
+}
+
+cudaError_t cudaYUYVToRGBA( uchar2* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuYUYVToRGBA(input, inputPitch, output, outputPitch, width, height);
+}
+
+cudaError_t cudaYUYVToRGBA( uchar2* input, uchar4* output, size_t width, size_t height )
+{
+	return cudaYUYVToRGBA(input, width * sizeof(uchar2), output, width * sizeof(uchar4), width, height);
+}
+
+cudaError_t cudaUYVYToGray( uchar2* input, size_t inputPitch, float* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuUYVYToGray(input, inputPitch, output, outputPitch, width, height);
+}
+
+cudaError_t cudaUYVYToGray( uchar2* input, float* output, size_t width, size_t height )
+{
+	return cudaUYVYToGray(input, width * sizeof(uchar2), output, width * sizeof(uint8_t), width, height);
+}
+
+cudaError_t cudaYUYVToGray( uchar2* input, size_t inputPitch, float* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuYUYVToGray(input, inputPitch, output, outputPitch, width, height);
+}
+
+cudaError_t cudaYUYVToGray( uchar2* input, float* output, size_t width, size_t height )
+{
+	return cudaYUYVToGray(input, width * sizeof(uchar2), output, width * sizeof(float), width, height);
+}
+
+cudaError_t cudaNV12ToRGBA( uint8_t* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuNV12ToRGBA(input, inputPitch, output, outputPitch, width, height);
+}
+
+cudaError_t cudaNV12ToRGBA( uint8_t* input, uchar4* output, size_t width, size_t height )
+{
+	return cudaNV12ToRGBA(input, width * sizeof(uint8_t), output, width * sizeof(uchar4), width, height);
+}
+
+cudaError_t cudaNV12ToRGBAf( uint8_t* input, size_t inputPitch, float4* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuNV12ToRGBAf(input, inputPitch, output, outputPitch, width, height);
+}
+
+cudaError_t cudaNV12ToRGBAf( uint8_t* input, float4* output, size_t width, size_t height )
+{
+	return cudaNV12ToRGBAf(input, width * sizeof(uint8_t), output, width * sizeof(float4), width, height);
+}
+
+// cudaConvertColorPlanes
+cudaError_t cudaConvertColorPlanes( const colorPlanes& input, imageFormat inputFormat, const colorPlanes& output, imageFormat outputFormat, uint32_t width, uint32_t height, const colorConversion& coefficients, cudaStream_t stream )
+{
+	return cpuConvertColorPlanes(input, inputFormat, output, outputFormat, width, height, coefficients, stream);
+}
+
+
+#endif
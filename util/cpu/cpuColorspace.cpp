@@ -0,0 +1,40 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "cpuKernels.h"
+#include "imageIO.h"
+
+
+// cpuConvertColor
+template<imageFormat inputFormat, imageFormat outputFormat>
+static cudaError_t cpuConvertColor( const colorPlanes& input, const colorPlanes& output, uint32_t width, uint32_t height,
+							 const colorConversion& cc, cudaStream_t /*stream*/ )
+{
+	// each task takes whole rows of 2x2 blocks, so no two write the same chroma row
+	imageParallelRows(iDivUp(height, 2), [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin * 2; y < rowEnd * 2; y += 2 )
+			for( uint32_t x=0; x < width; x += 2 )
+				colorConvertBlock<inputFormat, outputFormat>(input, output, x, y, width, height, cc);
+	});
+
+	return cudaSuccess;
+}
+
+
+typedef cudaError_t (*convertColorFunc)( const colorPlanes&, const colorPlanes&, uint32_t, uint32_t, const colorConversion&, cudaStream_t );
+
+static const convertColorFunc convertColorTable[FORMAT_UNKNOWN][FORMAT_UNKNOWN] = COLOR_CONVERSION_TABLE(cpuConvertColor);
+
+
+// cpuConvertColorPlanes
+cudaError_t cpuConvertColorPlanes( const colorPlanes& input, imageFormat inputFormat,
+						     const colorPlanes& output, imageFormat outputFormat,
+						     uint32_t width, uint32_t height, const colorConversion& coefficients, cudaStream_t stream )
+{
+	if( inputFormat >= FORMAT_UNKNOWN || outputFormat >= FORMAT_UNKNOWN || width == 0 || height == 0 )
+		return cudaErrorInvalidValue;
+
+	return convertColorTable[inputFormat][outputFormat](input, output, width, height, coefficients, stream);
+}
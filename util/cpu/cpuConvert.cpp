@@ -0,0 +1,357 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "cpuKernels.h"
+#include "imageIO.h"
+
+#include <math.h>
+
+
+// cpuNormalizeRGBA
+cudaError_t cpuNormalizeRGBA( float4* input, const float2& input_range,
+					     float4* output, const float2& output_range,
+					     size_t  width,  size_t height )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( width == 0 || height == 0  )
+		return cudaErrorInvalidValue;
+
+	const float multiplier = output_range.y / input_range.y;
+
+	imageParallelRows(height, [&](int rowBegin, int rowEnd)
+	{
+		for( size_t i=rowBegin * width; i < rowEnd * width; i++ )
+		{
+			const float4 px = input[i];
+
+			output[i] = make_float4(px.x * multiplier,
+							    px.y * multiplier,
+							    px.z * multiplier,
+							    px.w * multiplier);
+		}
+	});
+
+	return cudaSuccess;
+}
+
+
+// cpuNormalizeToRGBA8
+cudaError_t cpuNormalizeToRGBA8( float4* input, const float2& input_range,
+					       uchar4* output, size_t width, size_t height )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( width == 0 || height == 0 || input_range.y <= input_range.x )
+		return cudaErrorInvalidValue;
+
+	const float offset     = input_range.x;
+	const float multiplier = 255.0f / (input_range.y - input_range.x);
+
+	#define pack(v) (unsigned char)fminf(fmaxf((v - offset) * multiplier + 0.5f, 0.0f), 255.0f)
+
+	imageParallelRows(height, [&](int rowBegin, int rowEnd)
+	{
+		for( size_t i=rowBegin * width; i < rowEnd * width; i++ )
+		{
+			const float4 px = input[i];
+			output[i] = make_uchar4(pack(px.x), pack(px.y), pack(px.z), pack(px.w));
+		}
+	});
+
+	#undef pack
+
+	return cudaSuccess;
+}
+
+
+// cpuRGBToRGBAf
+cudaError_t cpuRGBToRGBAf( uchar3* input, float4* output, size_t width, size_t height )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	imageParallelRows(height, [&](int rowBegin, int rowEnd)
+	{
+		for( size_t i=rowBegin * width; i < rowEnd * width; i++ )
+		{
+			const uchar3 px = input[i];
+			output[i] = make_float4(px.x, px.y, px.z, 255.0f);
+		}
+	});
+
+	return cudaSuccess;
+}
+
+
+// storeRGBA
+static inline void storeRGBA( float4& dst, const float3& px )	{ dst = make_float4(px.x, px.y, px.z, 255.0f); }
+static inline void storeRGBA( uchar4& dst, const float3& px )	{ dst = make_uchar4(px.x, px.y, px.z, 255); }
+
+
+// cpuPackedToRGBA
+template<imageFormat format, typename T>
+static void cpuPackedToRGBA( uint8_t* input, size_t inputPitch, T* output, size_t width, size_t height )
+{
+	imageParallelRows(height, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+		{
+			const uint8_t* src = input + y * inputPitch;
+			T*             dst = output + y * width;
+
+			for( size_t x=0; x < width; x++ )
+			{
+				const float3 px = imageFormatLoadRGB<format>(src + x * imageFormatChannels(format));
+				storeRGBA(dst[x], px);
+			}
+		}
+	});
+}
+
+
+// cpuPackedToRGBAf
+cudaError_t cpuPackedToRGBAf( void* input, imageFormat format, size_t inputPitch, float4* output, size_t width, size_t height )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( width == 0 || height == 0 )
+		return cudaErrorInvalidValue;
+
+	if( inputPitch == 0 )
+		inputPitch = width * imageFormatChannels(format);
+
+	switch(format)
+	{
+		case FORMAT_RGB8:	cpuPackedToRGBA<FORMAT_RGB8>((uint8_t*)input, inputPitch, output, width, height);  break;
+		case FORMAT_BGR8:	cpuPackedToRGBA<FORMAT_BGR8>((uint8_t*)input, inputPitch, output, width, height);  break;
+		case FORMAT_RGBA8:	cpuPackedToRGBA<FORMAT_RGBA8>((uint8_t*)input, inputPitch, output, width, height); break;
+		case FORMAT_BGRA8:	cpuPackedToRGBA<FORMAT_BGRA8>((uint8_t*)input, inputPitch, output, width, height); break;
+		case FORMAT_GRAY8:	cpuPackedToRGBA<FORMAT_GRAY8>((uint8_t*)input, inputPitch, output, width, height); break;
+		default:			return cudaErrorInvalidValue;
+	}
+
+	return cudaSuccess;
+}
+
+
+// cpuPackedToRGBA8
+cudaError_t cpuPackedToRGBA8( void* input, imageFormat format, size_t inputPitch, uchar4* output, size_t width, size_t height )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( width == 0 || height == 0 )
+		return cudaErrorInvalidValue;
+
+	if( inputPitch == 0 )
+		inputPitch = width * imageFormatChannels(format);
+
+	switch(format)
+	{
+		case FORMAT_RGB8:	cpuPackedToRGBA<FORMAT_RGB8>((uint8_t*)input, inputPitch, output, width, height);  break;
+		case FORMAT_BGR8:	cpuPackedToRGBA<FORMAT_BGR8>((uint8_t*)input, inputPitch, output, width, height);  break;
+		case FORMAT_RGBA8:	cpuPackedToRGBA<FORMAT_RGBA8>((uint8_t*)input, inputPitch, output, width, height); break;
+		case FORMAT_BGRA8:	cpuPackedToRGBA<FORMAT_BGRA8>((uint8_t*)input, inputPitch, output, width, height); break;
+		case FORMAT_GRAY8:	cpuPackedToRGBA<FORMAT_GRAY8>((uint8_t*)input, inputPitch, output, width, height); break;
+		default:			return cudaErrorInvalidValue;
+	}
+
+	return cudaSuccess;
+}
+
+
+//-----------------------------------------------------------------------------------
+// RGBA to YUV 4:2:0 planar (I420 & YV12)
+//-----------------------------------------------------------------------------------
+
+static inline uint8_t rgb_to_y( uint8_t r, uint8_t g, uint8_t b )
+{
+	return static_cast<uint8_t>(((int)(30 * r) + (int)(59 * g) + (int)(11 * b)) / 100);
+}
+
+static inline uint8_t rgb_to_u( uint8_t r, uint8_t g, uint8_t b )
+{
+	return static_cast<uint8_t>(((int)(-17 * r) - (int)(33 * g) + (int)(50 * b) + 12800) / 100);
+}
+
+static inline uint8_t rgb_to_v( uint8_t r, uint8_t g, uint8_t b )
+{
+	return static_cast<uint8_t>(((int)(50 * r) - (int)(42 * g) - (int)(8 * b) + 12800) / 100);
+}
+
+
+// cpuRGBATo420 (the chroma of each 2x2 block is taken from its bottom-right pixel, like the GPU version)
+template<bool formatYV12>
+static cudaError_t cpuRGBATo420( uchar4* input, size_t inputPitch, uint8_t* output, size_t outputPitch, size_t width, size_t height )
+{
+	if( !input || !inputPitch || !output || !outputPitch || !width || !height )
+		return cudaErrorInvalidValue;
+
+	const int planeSize = height * outputPitch;
+
+	uint8_t* y_plane = output;
+	uint8_t* u_plane;
+	uint8_t* v_plane;
+
+	if( formatYV12 )
+	{
+		u_plane = y_plane + planeSize;
+		v_plane = u_plane + (planeSize / 4);
+	}
+	else
+	{
+		v_plane = y_plane + planeSize;
+		u_plane = v_plane + (planeSize / 4);
+	}
+
+	const int srcAlignedWidth = inputPitch / sizeof(uchar4);
+	const int uvPitch = outputPitch / 2;
+
+	imageParallelRows(height / 2, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin*2; y < rowEnd*2; y += 2 )
+		{
+			for( int x=0; x + 1 < (int)width; x += 2 )
+			{
+				for( int j=0; j < 2; j++ )
+				{
+					for( int i=0; i < 2; i++ )
+					{
+						const uchar4 px = input[(y + j) * srcAlignedWidth + x + i];
+						y_plane[(y + j) * outputPitch + x + i] = rgb_to_y(px.x, px.y, px.z);
+					}
+				}
+
+				const uchar4 px = input[(y + 1) * srcAlignedWidth + x + 1];
+				const int uvIndex = (y / 2) * uvPitch + (x / 2);
+
+				u_plane[uvIndex] = rgb_to_u(px.x, px.y, px.z);
+				v_plane[uvIndex] = rgb_to_v(px.x, px.y, px.z);
+			}
+		}
+	});
+
+	return cudaSuccess;
+}
+
+
+// cpuRGBAToYV12
+cudaError_t cpuRGBAToYV12( uchar4* input, size_t inputPitch, uint8_t* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuRGBATo420<false>(input, inputPitch, output, outputPitch, width, height);
+}
+
+
+// cpuRGBAToI420
+cudaError_t cpuRGBAToI420( uchar4* input, size_t inputPitch, uint8_t* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuRGBATo420<true>(input, inputPitch, output, outputPitch, width, height);
+}
+
+
+//-----------------------------------------------------------------------------------
+// YUYV/UYVY to RGBA and grayscale
+//-----------------------------------------------------------------------------------
+
+// cpuConvertPitched (the legacy YUV entry points, which are BT.601 full range like the GPU versions)
+static cudaError_t cpuConvertPitched( void* input, imageFormat inputFormat, size_t inputPitch,
+							   void* output, imageFormat outputFormat, size_t outputPitch, size_t width, size_t height )
+{
+	colorPlanes inputPlanes;
+	colorPlanes outputPlanes;
+
+	colorPlanesInit(input, inputFormat, width, height, &inputPlanes, inputPitch);
+	colorPlanesInit(output, outputFormat, width, height, &outputPlanes, outputPitch);
+
+	return cpuConvertColorPlanes(inputPlanes, inputFormat, outputPlanes, outputFormat, width, height, colorConversionInit(COLORSPACE_BT601_FULL));
+}
+
+
+// cpuYUYVToGray
+template<bool formatUYVY>
+static cudaError_t cpuYUYVToGray( uchar2* input, size_t inputPitch, float* output, size_t outputPitch, size_t width, size_t height )
+{
+	if( !input || !inputPitch || !output || !outputPitch || !width || !height )
+		return cudaErrorInvalidValue;
+
+	imageParallelRows(height, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+		{
+			const uchar4* src = (const uchar4*)((uint8_t*)input + y * inputPitch);
+			float2*       dst = (float2*)output + y * (outputPitch / sizeof(float2));
+
+			for( size_t x=0; x < width / 2; x++ )
+			{
+				const uchar4 macroPx = src[x];
+
+				dst[x] = make_float2((formatUYVY ? macroPx.y : macroPx.x) / 255.0f,
+								 (formatUYVY ? macroPx.w : macroPx.z) / 255.0f);
+			}
+		}
+	});
+
+	return cudaSuccess;
+}
+
+
+cudaError_t cpuUYVYToRGBA( uchar2* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height )
+{
+	if( !input || !inputPitch || !output || !outputPitch || !width || !height )
+		return cudaErrorInvalidValue;
+
+	return cpuConvertPitched(input, FORMAT_UYVY, inputPitch, output, FORMAT_RGBA8, outputPitch, width, height);
+}
+
+cudaError_t cpuYUYVToRGBA( uchar2* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height )
+{
+	if( !input || !inputPitch || !output || !outputPitch || !width || !height )
+		return cudaErrorInvalidValue;
+
+	return cpuConvertPitched(input, FORMAT_YUYV, inputPitch, output, FORMAT_RGBA8, outputPitch, width, height);
+}
+
+cudaError_t cpuUYVYToGray( uchar2* input, size_t inputPitch, float* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuYUYVToGray<true>(input, inputPitch, output, outputPitch, width, height);
+}
+
+cudaError_t cpuYUYVToGray( uchar2* input, size_t inputPitch, float* output, size_t outputPitch, size_t width, size_t height )
+{
+	return cpuYUYVToGray<false>(input, inputPitch, output, outputPitch, width, height);
+}
+
+
+//-----------------------------------------------------------------------------------
+// NV12 to RGBA
+//-----------------------------------------------------------------------------------
+
+// cpuNV12ToRGBA
+cudaError_t cpuNV12ToRGBA( uint8_t* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( inputPitch == 0 || outputPitch == 0 || width == 0 || height == 0 )
+		return cudaErrorInvalidValue;
+
+	return cpuConvertPitched(input, FORMAT_NV12, inputPitch, output, FORMAT_RGBA8, outputPitch, width, height);
+}
+
+
+// cpuNV12ToRGBAf
+cudaError_t cpuNV12ToRGBAf( uint8_t* input, size_t inputPitch, float4* output, size_t outputPitch, size_t width, size_t height )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( inputPitch == 0 || outputPitch == 0 || width == 0 || height == 0 )
+		return cudaErrorInvalidValue;
+
+	return cpuConvertPitched(input, FORMAT_NV12, inputPitch, output, FORMAT_RGBA32F, outputPitch, width, height);
+}
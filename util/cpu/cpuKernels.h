@@ -0,0 +1,194 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __CPU_KERNELS_H_
+#define __CPU_KERNELS_H_
+
+
+#include "cudaUtility.h"
+#include "imageFormat.h"
+#include "cudaOverlay.h"
+#include "cudaResize.h"
+#include "cudaColorspace.h"
+#include <stdint.h>
+
+
+/*
+ * Host reference implementations of the util/cuda kernels.
+ *
+ * Each function takes the same arguments as its cuda* counterpart and produces the same
+ * output, but runs on the CPU (split across rows with imageParallelRows()).  They are always
+ * built, so GPU builds can validate their kernels against them, and in CPU_ONLY builds they
+ * back the cuda* entry points themselves.  Pointers are expected to be CPU-accessible.
+ */
+
+
+//////////////////////////////////////////////////////////////////////////////////
+/// @name Resizing and network pre-processing
+/// @ingroup util
+//////////////////////////////////////////////////////////////////////////////////
+
+///@{
+
+/**
+ * Nearest-neighbor resize of a single-channel float image, @see cudaResize()
+ */
+cudaError_t cpuResize( float* input,  size_t inputWidth,  size_t inputHeight,
+				   float* output, size_t outputWidth, size_t outputHeight );
+
+/**
+ * Nearest-neighbor resize of a float4 RGBA image, @see cudaResizeRGBA()
+ */
+cudaError_t cpuResizeRGBA( float4* input,  size_t inputWidth,  size_t inputHeight,
+				       float4* output, size_t outputWidth, size_t outputHeight );
+
+/**
+ * Filtered resize of a region of a pitched single-channel float image, @see cudaResize()
+ */
+cudaError_t cpuResize( float* input,  size_t inputPitch,  size_t inputWidth,  size_t inputHeight,
+				   float* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
+				   resizeFilter filter, const int4* roi=NULL );
+
+/**
+ * Filtered resize of a region of a pitched float4 RGBA image, @see cudaResizeRGBA()
+ */
+cudaError_t cpuResizeRGBA( float4* input,  size_t inputPitch,  size_t inputWidth,  size_t inputHeight,
+				       float4* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
+				       resizeFilter filter, const int4* roi=NULL );
+
+/**
+ * Crop and resize a batch of regions, @see cudaResizeBatchRGBA()
+ */
+cudaError_t cpuResizeBatchRGBA( resizeROI* rois, uint32_t count, uint32_t maxOutputWidth, uint32_t maxOutputHeight, resizeFilter filter );
+
+/**
+ * Resize a float4 RGBA image into band-sequential BGR planes, @see cudaPreImageNet()
+ */
+cudaError_t cpuPreImageNet( float4* input, size_t inputWidth, size_t inputHeight,
+				        float* output, size_t outputWidth, size_t outputHeight );
+
+/**
+ * Resize a float4 RGBA image into band-sequential BGR planes with mean subtraction, @see cudaPreImageNetMean()
+ */
+cudaError_t cpuPreImageNetMean( float4* input, size_t inputWidth, size_t inputHeight,
+				            float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value );
+
+/**
+ * Resize a packed 8-bit image (RGB, BGR, ...) into band-sequential BGR planes with mean subtraction, @see cudaPreImageNetMean()
+ */
+cudaError_t cpuPreImageNetMean( void* input, imageFormat format, size_t inputPitch, size_t inputWidth, size_t inputHeight,
+				            float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value );
+
+///@}
+
+
+//////////////////////////////////////////////////////////////////////////////////
+/// @name Normalization, RGB conversion and overlays
+/// @ingroup util
+//////////////////////////////////////////////////////////////////////////////////
+
+///@{
+
+/**
+ * Rebase the pixel intensities of an image between two scales, @see cudaNormalizeRGBA()
+ */
+cudaError_t cpuNormalizeRGBA( float4* input,  const float2& input_range,
+					     float4* output, const float2& output_range,
+					     size_t  width,  size_t height );
+
+/**
+ * Rescale a float4 RGBA image to 0-255 and pack it into 8-bit RGBA, @see cudaNormalizeToRGBA8()
+ */
+cudaError_t cpuNormalizeToRGBA8( float4* input, const float2& input_range,
+					       uchar4* output, size_t width, size_t height );
+
+/**
+ * Convert 8-bit RGB to float4 RGBA, @see cudaRGBToRGBAf()
+ */
+cudaError_t cpuRGBToRGBAf( uchar3* input, float4* output, size_t width, size_t height );
+
+/**
+ * Convert a packed 8-bit image in any imageFormat to float4 RGBA, @see cudaPackedToRGBAf()
+ */
+cudaError_t cpuPackedToRGBAf( void* input, imageFormat format, size_t inputPitch, float4* output, size_t width, size_t height );
+
+/**
+ * Convert a packed 8-bit image in any imageFormat to 8-bit RGBA, @see cudaPackedToRGBA8()
+ */
+cudaError_t cpuPackedToRGBA8( void* input, imageFormat format, size_t inputPitch, uchar4* output, size_t width, size_t height );
+
+/**
+ * Blend filled rectangles over an image, @see cudaRectOutlineOverlay()
+ */
+cudaError_t cpuRectOutlineOverlay( float4* input, float4* output, uint32_t width, uint32_t height, float4* boundingBoxes, int numBoxes, const float4& color );
+
+/**
+ * Blend the boxes and glyphs binned into tiles over an image (reading glyphs from font, not the texture), @see cudaOverlayTiles()
+ */
+cudaError_t cpuOverlayTiles( float4* output, uint32_t width, uint32_t height,
+				         overlayPrimitive* primitives, int4* tiles, uint32_t numTiles, uint32_t* indices,
+				         float4* font, size_t fontMapWidth, const int2& fontCellSize,
+				         cudaTextureObject_t fontTexture=0 );
+
+///@}
+
+
+//////////////////////////////////////////////////////////////////////////////////
+/// @name YUV conversion
+/// @ingroup util
+//////////////////////////////////////////////////////////////////////////////////
+
+///@{
+
+/**
+ * Convert RGBA uchar4 to YUV I420 planar, @see cudaRGBAToI420()
+ */
+cudaError_t cpuRGBAToI420( uchar4* input, size_t inputPitch, uint8_t* output, size_t outputPitch, size_t width, size_t height );
+
+/**
+ * Convert RGBA uchar4 to YUV YV12 planar, @see cudaRGBAToYV12()
+ */
+cudaError_t cpuRGBAToYV12( uchar4* input, size_t inputPitch, uint8_t* output, size_t outputPitch, size_t width, size_t height );
+
+/**
+ * Convert UYVY 4:2:2 packed to RGBA uchar4, @see cudaUYVYToRGBA()
+ */
+cudaError_t cpuUYVYToRGBA( uchar2* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height );
+
+/**
+ * Convert YUYV 4:2:2 packed to RGBA uchar4, @see cudaYUYVToRGBA()
+ */
+cudaError_t cpuYUYVToRGBA( uchar2* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height );
+
+/**
+ * Convert UYVY 4:2:2 packed to float grayscale, @see cudaUYVYToGray()
+ */
+cudaError_t cpuUYVYToGray( uchar2* input, size_t inputPitch, float* output, size_t outputPitch, size_t width, size_t height );
+
+/**
+ * Convert YUYV 4:2:2 packed to float grayscale, @see cudaYUYVToGray()
+ */
+cudaError_t cpuYUYVToGray( uchar2* input, size_t inputPitch, float* output, size_t outputPitch, size_t width, size_t height );
+
+/**
+ * Convert NV12 to packed 8-bit, @see cudaNV12ToRGBA()
+ */
+cudaError_t cpuNV12ToRGBA( uint8_t* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height );
+
+/**
+ * Convert NV12 to float4 RGBA, @see cudaNV12ToRGBAf()
+ */
+cudaError_t cpuNV12ToRGBAf( uint8_t* input, size_t inputPitch, float4* output, size_t outputPitch, size_t width, size_t height );
+
+/**
+ * Convert the planes of an image between any two formats, @see cudaConvertColorPlanes()
+ */
+cudaError_t cpuConvertColorPlanes( const colorPlanes& input, imageFormat inputFormat,
+						     const colorPlanes& output, imageFormat outputFormat,
+						     uint32_t width, uint32_t height, const colorConversion& coefficients, cudaStream_t stream=NULL );
+
+///@}
+
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "cpuKernels.h"
+#include "imageIO.h"
+
+#include <algorithm>
+
+
+// cpuRectOutlineOverlay
+cudaError_t cpuRectOutlineOverlay( float4* input, float4* output, uint32_t width, uint32_t height, float4* rects, int numRects, const float4& color )
+{
+	if( !input || !output || width == 0 || height == 0 || !rects || numRects == 0 )
+		return cudaErrorInvalidValue;
+
+	const float alpha = color.w / 255.0f;
+	const float ialph = 1.0f - alpha;
+
+	imageParallelRows(height, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+		{
+			const float fy = y;
+
+			for( uint32_t x=0; x < width; x++ )
+			{
+				const float fx = x;
+				float4 px = input[y * width + x];
+
+				for( int nr=0; nr < numRects; nr++ )
+				{
+					const float4 r = rects[nr];
+
+					if( fy >= r.y && fy <= r.w && fx >= r.x && fx <= r.z )
+					{
+						px.x = alpha * color.x + ialph * px.x;
+						px.y = alpha * color.y + ialph * px.y;
+						px.z = alpha * color.z + ialph * px.z;
+					}
+				}
+
+				output[y * width + x] = px;
+			}
+		}
+	});
+
+	return cudaSuccess;
+}
+
+
+// cpuOverlayTiles
+cudaError_t cpuOverlayTiles( float4* output, uint32_t width, uint32_t height,
+				         overlayPrimitive* primitives, int4* tiles, uint32_t numTiles, uint32_t* indices,
+				         float4* font, size_t fontMapWidth, const int2& fontCellSize,
+				         cudaTextureObject_t fontTexture )
+{
+	if( numTiles == 0 )
+		return cudaSuccess;
+
+	if( !output || width == 0 || height == 0 || !primitives || !tiles || !indices )
+		return cudaErrorInvalidValue;
+
+	const overlayFontMap fontMap = { font, (int)fontMapWidth };
+
+	// the tiles don't overlap, so they're split among the threads like rows
+	imageParallelRows(numTiles, [&](int tileBegin, int tileEnd)
+	{
+		for( int n=tileBegin; n < tileEnd; n++ )
+		{
+			const int4 tile = tiles[n];
+
+			const int x1 = std::min(tile.x + OVERLAY_TILE_SIZE, (int)width);
+			const int y1 = std::min(tile.y + OVERLAY_TILE_SIZE, (int)height);
+
+			for( int y=tile.y; y < y1; y++ )
+			{
+				for( int x=tile.x; x < x1; x++ )
+				{
+					float4 px = output[y * width + x];
+
+					for( int i=0; i < tile.w; i++ )
+						px = overlayBlend(primitives[indices[tile.z + i]], px, x, y, fontMap, fontCellSize);
+
+					output[y * width + x] = px;
+				}
+			}
+		}
+	});
+
+	return cudaSuccess;
+}
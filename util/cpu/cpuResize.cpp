@@ -0,0 +1,262 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "cpuKernels.h"
+#include "imageIO.h"
+
+
+// cpuResample
+template <typename T>
+static void cpuResample( const float2& scale, T* input, int iWidth, T* output, int oWidth, int oHeight )
+{
+	imageParallelRows(oHeight, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+		{
+			const T* src = input + int((float)y * scale.y) * iWidth;
+			T*       dst = output + y * oWidth;
+
+			for( int x=0; x < oWidth; x++ )
+				dst[x] = src[int((float)x * scale.x)];
+		}
+	});
+}
+
+
+// cpuResize
+cudaError_t cpuResize( float* input, size_t inputWidth, size_t inputHeight,
+				   float* output, size_t outputWidth, size_t outputHeight )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( inputWidth == 0 || outputWidth == 0 || inputHeight == 0 || outputHeight == 0 )
+		return cudaErrorInvalidValue;
+
+	const float2 scale = make_float2( float(inputWidth) / float(outputWidth),
+							    float(inputHeight) / float(outputHeight) );
+
+	cpuResample<float>(scale, input, inputWidth, output, outputWidth, outputHeight);
+	return cudaSuccess;
+}
+
+
+// cpuResizeRGBA
+cudaError_t cpuResizeRGBA( float4* input,  size_t inputWidth, size_t inputHeight,
+				       float4* output, size_t outputWidth, size_t outputHeight )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( inputWidth == 0 || outputWidth == 0 || inputHeight == 0 || outputHeight == 0 )
+		return cudaErrorInvalidValue;
+
+	const float2 scale = make_float2( float(inputWidth) / float(outputWidth),
+							    float(inputHeight) / float(outputHeight) );
+
+	cpuResample<float4>(scale, input, inputWidth, output, outputWidth, outputHeight);
+	return cudaSuccess;
+}
+
+
+// cpuResizeROI
+template<typename T>
+static cudaError_t cpuResizeROI( T* input,  size_t inputPitch,  size_t inputWidth,  size_t inputHeight,
+					        T* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
+					        resizeFilter filter, const int4* roi )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( inputWidth == 0 || outputWidth == 0 || inputHeight == 0 || outputHeight == 0 || filter > RESIZE_AREA )
+		return cudaErrorInvalidValue;
+
+	const int4 region = (roi != NULL) ? *roi : make_int4(0, 0, inputWidth, inputHeight);
+
+	if( region.x < 0 || region.y < 0 || region.z <= 0 || region.w <= 0 ||
+	    region.x + region.z > (int)inputWidth || region.y + region.w > (int)inputHeight )
+		return cudaErrorInvalidValue;
+
+	const float2 scale = make_float2( float(region.z) / float(outputWidth),
+							    float(region.w) / float(outputHeight) );
+
+	imageParallelRows(outputHeight, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+		{
+			T* dst = resizeRow(output, outputPitch, y);
+
+			for( int x=0; x < (int)outputWidth; x++ )
+				dst[x] = resizeSample(input, inputPitch, region, scale, x, y, filter);
+		}
+	});
+
+	return cudaSuccess;
+}
+
+
+// cpuResize
+cudaError_t cpuResize( float* input,  size_t inputPitch,  size_t inputWidth,  size_t inputHeight,
+				   float* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
+				   resizeFilter filter, const int4* roi )
+{
+	return cpuResizeROI<float>(input, inputPitch, inputWidth, inputHeight, output, outputPitch, outputWidth, outputHeight, filter, roi);
+}
+
+
+// cpuResizeRGBA
+cudaError_t cpuResizeRGBA( float4* input,  size_t inputPitch,  size_t inputWidth,  size_t inputHeight,
+				       float4* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
+				       resizeFilter filter, const int4* roi )
+{
+	return cpuResizeROI<float4>(input, inputPitch, inputWidth, inputHeight, output, outputPitch, outputWidth, outputHeight, filter, roi);
+}
+
+
+// cpuResizeBatchRGBA
+cudaError_t cpuResizeBatchRGBA( resizeROI* rois, uint32_t count, uint32_t maxOutputWidth, uint32_t maxOutputHeight, resizeFilter filter )
+{
+	if( !rois )
+		return cudaErrorInvalidDevicePointer;
+
+	if( count == 0 )
+		return cudaSuccess;
+
+	if( maxOutputWidth == 0 || maxOutputHeight == 0 || filter > RESIZE_AREA )
+		return cudaErrorInvalidValue;
+
+	// each region is one job, spread over the threads like rows
+	imageParallelRows(count, [&](int begin, int end)
+	{
+		for( int n=begin; n < end; n++ )
+		{
+			const resizeROI& r = rois[n];
+
+			const uint32_t width  = (r.outputWidth < maxOutputWidth) ? r.outputWidth : maxOutputWidth;
+			const uint32_t height = (r.outputHeight < maxOutputHeight) ? r.outputHeight : maxOutputHeight;
+
+			const float2 scale = make_float2( float(r.roi.z) / float(r.outputWidth),
+									    float(r.roi.w) / float(r.outputHeight) );
+
+			for( uint32_t y=0; y < height; y++ )
+			{
+				float4* dst = resizeRow(r.output, r.outputPitch, y);
+
+				for( uint32_t x=0; x < width; x++ )
+					dst[x] = resizeSample(r.input, r.inputPitch, r.roi, scale, x, y, filter);
+			}
+		}
+	});
+
+	return cudaSuccess;
+}
+
+
+// cpuPreImageNetMean
+cudaError_t cpuPreImageNetMean( float4* input, size_t inputWidth, size_t inputHeight,
+				            float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( inputWidth == 0 || outputWidth == 0 || inputHeight == 0 || outputHeight == 0 )
+		return cudaErrorInvalidValue;
+
+	const float2 scale = make_float2( float(inputWidth) / float(outputWidth),
+							    float(inputHeight) / float(outputHeight) );
+
+	const int oWidth  = outputWidth;
+	const int oHeight = outputHeight;
+	const int n       = oWidth * oHeight;
+
+	imageParallelRows(oHeight, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+		{
+			const float4* src = input + int((float)y * scale.y) * inputWidth;
+
+			float* b = output + n * 0 + y * oWidth;
+			float* g = output + n * 1 + y * oWidth;
+			float* r = output + n * 2 + y * oWidth;
+
+			for( int x=0; x < oWidth; x++ )
+			{
+				const float4 px = src[int((float)x * scale.x)];
+
+				b[x] = px.z - mean_value.x;
+				g[x] = px.y - mean_value.y;
+				r[x] = px.x - mean_value.z;
+			}
+		}
+	});
+
+	return cudaSuccess;
+}
+
+
+// cpuPreImageNet
+cudaError_t cpuPreImageNet( float4* input, size_t inputWidth, size_t inputHeight,
+				        float* output, size_t outputWidth, size_t outputHeight )
+{
+	return cpuPreImageNetMean(input, inputWidth, inputHeight, output, outputWidth, outputHeight, make_float3(0.0f, 0.0f, 0.0f));
+}
+
+
+// cpuPreImageNetPacked
+template<imageFormat format>
+static void cpuPreImageNetPacked( const float2& scale, uint8_t* input, size_t iPitch, float* output, int oWidth, int oHeight, const float3& mean_value )
+{
+	const int n = oWidth * oHeight;
+
+	imageParallelRows(oHeight, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+		{
+			const uint8_t* src = input + int((float)y * scale.y) * iPitch;
+
+			float* b = output + n * 0 + y * oWidth;
+			float* g = output + n * 1 + y * oWidth;
+			float* r = output + n * 2 + y * oWidth;
+
+			for( int x=0; x < oWidth; x++ )
+			{
+				const float3 px = imageFormatLoadRGB<format>(src + int((float)x * scale.x) * imageFormatChannels(format));
+
+				b[x] = px.z - mean_value.x;
+				g[x] = px.y - mean_value.y;
+				r[x] = px.x - mean_value.z;
+			}
+		}
+	});
+}
+
+
+// cpuPreImageNetMean (packed 8-bit)
+cudaError_t cpuPreImageNetMean( void* input, imageFormat format, size_t inputPitch, size_t inputWidth, size_t inputHeight,
+				            float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( inputWidth == 0 || outputWidth == 0 || inputHeight == 0 || outputHeight == 0 )
+		return cudaErrorInvalidValue;
+
+	if( inputPitch == 0 )
+		inputPitch = inputWidth * imageFormatChannels(format);
+
+	const float2 scale = make_float2( float(inputWidth) / float(outputWidth),
+							    float(inputHeight) / float(outputHeight) );
+
+	switch(format)
+	{
+		case FORMAT_RGB8:	cpuPreImageNetPacked<FORMAT_RGB8>(scale, (uint8_t*)input, inputPitch, output, outputWidth, outputHeight, mean_value);  break;
+		case FORMAT_BGR8:	cpuPreImageNetPacked<FORMAT_BGR8>(scale, (uint8_t*)input, inputPitch, output, outputWidth, outputHeight, mean_value);  break;
+		case FORMAT_RGBA8:	cpuPreImageNetPacked<FORMAT_RGBA8>(scale, (uint8_t*)input, inputPitch, output, outputWidth, outputHeight, mean_value); break;
+		case FORMAT_BGRA8:	cpuPreImageNetPacked<FORMAT_BGRA8>(scale, (uint8_t*)input, inputPitch, output, outputWidth, outputHeight, mean_value); break;
+		case FORMAT_GRAY8:	cpuPreImageNetPacked<FORMAT_GRAY8>(scale, (uint8_t*)input, inputPitch, output, outputWidth, outputHeight, mean_value); break;
+		default:			return cudaErrorInvalidValue;
+	}
+
+	return cudaSuccess;
+}
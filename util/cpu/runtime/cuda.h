@@ -0,0 +1,15 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __CPU_CUDA_H_
+#define __CPU_CUDA_H_
+
+
+/*
+ * Host-only stand-in for <cuda.h> in CPU_ONLY builds, @see cuda_runtime.h
+ */
+#include "cuda_runtime.h"
+
+
+#endif
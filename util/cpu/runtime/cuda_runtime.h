@@ -0,0 +1,234 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __CPU_CUDA_RUNTIME_H_
+#define __CPU_CUDA_RUNTIME_H_
+
+
+/*
+ * Host-only stand-in for <cuda_runtime.h>, used by CPU_ONLY builds.
+ *
+ * It provides the CUDA vector types and the subset of the runtime API that the
+ * library uses, with "device" memory being ordinary host memory.  The util/cuda
+ * kernels are replaced by the host implementations from util/cpu.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define __host__
+#define __device__
+#define __global__
+#define __constant__
+#define __forceinline__		inline __attribute__((always_inline))
+#define __align__(n)		__attribute__((aligned(n)))
+
+
+//-----------------------------------------------------------------------------------
+// vector types
+//-----------------------------------------------------------------------------------
+
+#define CPU_VECTOR_TYPES(type, name, align2, align4)								\
+	struct name##1 { type x; };												\
+	struct __align__(align2) name##2 { type x, y; };								\
+	struct name##3 { type x, y, z; };											\
+	struct __align__(align4) name##4 { type x, y, z, w; };							\
+																		\
+	inline name##1 make_##name##1( type x )							{ name##1 v = { x }; return v; }			\
+	inline name##2 make_##name##2( type x, type y )					{ name##2 v = { x, y }; return v; }		\
+	inline name##3 make_##name##3( type x, type y, type z )			{ name##3 v = { x, y, z }; return v; }		\
+	inline name##4 make_##name##4( type x, type y, type z, type w )	{ name##4 v = { x, y, z, w }; return v; }
+
+CPU_VECTOR_TYPES(signed char,    char,   2,  4)
+CPU_VECTOR_TYPES(unsigned char,  uchar,  2,  4)
+CPU_VECTOR_TYPES(short,          short,  4,  8)
+CPU_VECTOR_TYPES(unsigned short, ushort, 4,  8)
+CPU_VECTOR_TYPES(int,            int,    8,  16)
+CPU_VECTOR_TYPES(unsigned int,   uint,   8,  16)
+CPU_VECTOR_TYPES(float,          float,  8,  16)
+CPU_VECTOR_TYPES(double,         double, 16, 16)
+
+#undef CPU_VECTOR_TYPES
+
+
+struct dim3
+{
+	unsigned int x, y, z;
+
+	dim3( unsigned int vx=1, unsigned int vy=1, unsigned int vz=1 ) : x(vx), y(vy), z(vz)	{ }
+};
+
+
+//-----------------------------------------------------------------------------------
+// errors
+//-----------------------------------------------------------------------------------
+
+enum cudaError
+{
+	cudaSuccess                   = 0,
+	cudaErrorMemoryAllocation     = 2,
+	cudaErrorInvalidValue         = 11,
+	cudaErrorInvalidDevicePointer = 17,
+	cudaErrorInvalidSymbol        = 13,
+	cudaErrorNotSupported         = 71
+};
+
+typedef enum cudaError cudaError_t;
+
+inline const char* cudaGetErrorString( cudaError_t error )
+{
+	switch(error)
+	{
+		case cudaSuccess:					return "no error";
+		case cudaErrorMemoryAllocation:		return "out of memory";
+		case cudaErrorInvalidValue:			return "invalid argument";
+		case cudaErrorInvalidDevicePointer:	return "invalid device pointer";
+		case cudaErrorInvalidSymbol:		return "invalid device symbol";
+		case cudaErrorNotSupported:			return "operation not supported";
+	}
+
+	return "unknown error";
+}
+
+inline cudaError_t cudaGetLastError()		{ return cudaSuccess; }
+inline cudaError_t cudaPeekAtLastError()	{ return cudaSuccess; }
+
+
+//-----------------------------------------------------------------------------------
+// device
+//-----------------------------------------------------------------------------------
+
+enum cudaDeviceAttr
+{
+	cudaDevAttrIntegrated = 18
+};
+
+#define cudaDeviceMapHost	0x08
+
+inline cudaError_t cudaGetDevice( int* device )					{ *device = 0; return cudaSuccess; }
+inline cudaError_t cudaSetDevice( int device )					{ return (device == 0) ? cudaSuccess : cudaErrorInvalidValue; }
+inline cudaError_t cudaSetDeviceFlags( unsigned int flags )		{ return cudaSuccess; }
+inline cudaError_t cudaDeviceSynchronize()						{ return cudaSuccess; }
+inline cudaError_t cudaThreadSynchronize()						{ return cudaSuccess; }
+
+inline cudaError_t cudaDeviceGetAttribute( int* value, cudaDeviceAttr attr, int device )
+{
+	if( !value )
+		return cudaErrorInvalidValue;
+
+	*value = (attr == cudaDevAttrIntegrated) ? 1 : 0;	// the CPU shares memory with itself
+	return cudaSuccess;
+}
+
+
+//-----------------------------------------------------------------------------------
+// streams
+//-----------------------------------------------------------------------------------
+
+typedef struct CUstream_st* cudaStream_t;
+
+inline cudaError_t cudaStreamCreate( cudaStream_t* stream )		{ *stream = NULL; return cudaSuccess; }
+inline cudaError_t cudaStreamDestroy( cudaStream_t stream )		{ return cudaSuccess; }
+inline cudaError_t cudaStreamSynchronize( cudaStream_t stream )	{ return cudaSuccess; }
+
+
+//-----------------------------------------------------------------------------------
+// events (work completes as it's issued, so they're always signaled)
+//-----------------------------------------------------------------------------------
+
+typedef struct CUevent_st* cudaEvent_t;
+
+#define cudaEventDefault		0x00
+#define cudaEventBlockingSync		0x01
+#define cudaEventDisableTiming	0x02
+
+inline cudaError_t cudaEventCreate( cudaEvent_t* event )								{ *event = (cudaEvent_t)1; return cudaSuccess; }
+inline cudaError_t cudaEventCreateWithFlags( cudaEvent_t* event, unsigned int flags )	{ return cudaEventCreate(event); }
+inline cudaError_t cudaEventDestroy( cudaEvent_t event )								{ return cudaSuccess; }
+inline cudaError_t cudaEventRecord( cudaEvent_t event, cudaStream_t stream=NULL )		{ return cudaSuccess; }
+inline cudaError_t cudaEventQuery( cudaEvent_t event )								{ return cudaSuccess; }
+inline cudaError_t cudaEventSynchronize( cudaEvent_t event )							{ return cudaSuccess; }
+
+// there are no timestamps to measure between, so host code has to be timed with a clock
+inline cudaError_t cudaEventElapsedTime( float* ms, cudaEvent_t start, cudaEvent_t end )	{ return cudaErrorNotSupported; }
+
+
+//-----------------------------------------------------------------------------------
+// textures (the host kernels read memory directly, so there are never any objects)
+//-----------------------------------------------------------------------------------
+
+typedef unsigned long long cudaTextureObject_t;
+
+
+//-----------------------------------------------------------------------------------
+// memory
+//-----------------------------------------------------------------------------------
+
+enum cudaMemcpyKind
+{
+	cudaMemcpyHostToHost     = 0,
+	cudaMemcpyHostToDevice   = 1,
+	cudaMemcpyDeviceToHost   = 2,
+	cudaMemcpyDeviceToDevice = 3,
+	cudaMemcpyDefault        = 4
+};
+
+#define cudaHostAllocDefault		0x00
+#define cudaHostAllocPortable		0x01
+#define cudaHostAllocMapped		0x02
+#define cudaHostAllocWriteCombined	0x04
+
+#define cudaHostRegisterDefault	0x00
+#define cudaHostRegisterPortable	0x01
+#define cudaHostRegisterMapped	0x02
+
+inline cudaError_t cudaMalloc( void** ptr, size_t size )
+{
+	*ptr = malloc(size);
+	return (*ptr != NULL) ? cudaSuccess : cudaErrorMemoryAllocation;
+}
+
+inline cudaError_t cudaMallocHost( void** ptr, size_t size )							{ return cudaMalloc(ptr, size); }
+inline cudaError_t cudaHostAlloc( void** ptr, size_t size, unsigned int flags )		{ return cudaMalloc(ptr, size); }
+
+inline cudaError_t cudaFree( void* ptr )			{ free(ptr); return cudaSuccess; }
+inline cudaError_t cudaFreeHost( void* ptr )		{ free(ptr); return cudaSuccess; }
+
+inline cudaError_t cudaHostGetDevicePointer( void** devPtr, void* hostPtr, unsigned int flags )
+{
+	*devPtr = hostPtr;
+	return (hostPtr != NULL) ? cudaSuccess : cudaErrorInvalidValue;
+}
+
+inline cudaError_t cudaHostRegister( void* ptr, size_t size, unsigned int flags )	{ return cudaSuccess; }
+inline cudaError_t cudaHostUnregister( void* ptr )									{ return cudaSuccess; }
+
+inline cudaError_t cudaMemcpy( void* dst, const void* src, size_t count, cudaMemcpyKind kind )
+{
+	if( dst != src )
+		memmove(dst, src, count);
+
+	return cudaSuccess;
+}
+
+inline cudaError_t cudaMemcpyAsync( void* dst, const void* src, size_t count, cudaMemcpyKind kind, cudaStream_t stream=NULL )
+{
+	return cudaMemcpy(dst, src, count, kind);
+}
+
+inline cudaError_t cudaMemset( void* ptr, int value, size_t count )
+{
+	memset(ptr, value, count);
+	return cudaSuccess;
+}
+
+inline cudaError_t cudaMemsetAsync( void* ptr, int value, size_t count, cudaStream_t stream=NULL )
+{
+	return cudaMemset(ptr, value, count);
+}
+
+
+#endif
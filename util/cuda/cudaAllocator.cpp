@@ -0,0 +1,444 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "cudaAllocator.h"
+
+#include <stdlib.h>
+#include <strings.h>
+
+
+static const int numMemoryTypes = MEM_HOST + 1;
+
+static cudaAllocator* gAllocators[numMemoryTypes] = { NULL };
+static std::mutex     gAllocatorMutex;
+
+static int gDefaultType = -1;	// determined from the device on first use
+
+
+// cudaMemoryTypeFromStr
+bool cudaMemoryTypeFromStr( const char* str, cudaMemoryType* type )
+{
+	if( !str || !type )
+		return false;
+
+	for( int n=0; n < numMemoryTypes; n++ )
+	{
+		if( strcasecmp(str, cudaMemoryTypeToStr((cudaMemoryType)n)) == 0 )
+		{
+			*type = (cudaMemoryType)n;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+// cudaMemoryTypeToStr
+const char* cudaMemoryTypeToStr( cudaMemoryType type )
+{
+	switch(type)
+	{
+		case MEM_DEVICE:	return "device";
+		case MEM_MAPPED:	return "mapped";
+		case MEM_PINNED:	return "pinned";
+		case MEM_HOST:		return "host";
+	}
+
+	return "unknown";
+}
+
+
+// constructor
+cudaAllocator::cudaAllocator( cudaMemoryType type )
+{
+	mType        = type;
+	mOutstanding = 0;
+	mPeak        = 0;
+}
+
+
+// destructor
+cudaAllocator::~cudaAllocator()
+{
+	while( mAllocations.size() > 0 )
+		Free(mAllocations.begin()->first);
+}
+
+
+// Get
+cudaAllocator* cudaAllocator::Get( cudaMemoryType type )
+{
+	if( type < 0 || type >= numMemoryTypes )
+		return NULL;
+
+	std::lock_guard<std::mutex> lock(gAllocatorMutex);
+
+	// allocators are never deleted, so outstanding memory isn't freed after CUDA shuts down at exit
+	if( !gAllocators[type] )
+		gAllocators[type] = new cudaAllocator(type);
+
+	return gAllocators[type];
+}
+
+
+// GetDefaultType
+cudaMemoryType cudaAllocator::GetDefaultType()
+{
+	std::lock_guard<std::mutex> lock(gAllocatorMutex);
+
+	if( gDefaultType < 0 )
+	{
+#ifdef CPU_ONLY
+		gDefaultType = MEM_HOST;
+#else
+		int integrated = 1;
+
+		if( CUDA_FAILED(cudaDeviceGetAttribute(&integrated, cudaDevAttrIntegrated, 0)) )
+			integrated = 1;
+
+		gDefaultType = integrated ? MEM_MAPPED : MEM_PINNED;
+#endif
+		printf(LOG_CUDA "default memory type:  %s\n", cudaMemoryTypeToStr((cudaMemoryType)gDefaultType));
+	}
+
+	return (cudaMemoryType)gDefaultType;
+}
+
+
+// SetDefaultType
+void cudaAllocator::SetDefaultType( cudaMemoryType type )
+{
+	std::lock_guard<std::mutex> lock(gAllocatorMutex);
+	gDefaultType = type;
+}
+
+
+// Alloc
+bool cudaAllocator::Alloc( void** cpuPtr, void** gpuPtr, size_t size )
+{
+	if( !cpuPtr || !gpuPtr || size == 0 )
+		return false;
+
+	Allocation alloc;
+
+	alloc.cpu  = NULL;
+	alloc.gpu  = NULL;
+	alloc.size = size;
+
+	if( mType == MEM_MAPPED )
+	{
+		if( CUDA_FAILED(cudaHostAlloc(&alloc.cpu, size, cudaHostAllocMapped)) )
+			return false;
+
+		if( CUDA_FAILED(cudaHostGetDevicePointer(&alloc.gpu, alloc.cpu, 0)) )
+		{
+			CUDA(cudaFreeHost(alloc.cpu));
+			return false;
+		}
+	}
+	else if( mType == MEM_HOST )
+	{
+		alloc.cpu = malloc(size);
+		alloc.gpu = alloc.cpu;
+
+		if( !alloc.cpu )
+			return false;
+	}
+	else
+	{
+		if( CUDA_FAILED(cudaMalloc(&alloc.gpu, size)) )
+			return false;
+
+		if( mType == MEM_PINNED )
+		{
+			if( CUDA_FAILED(cudaMallocHost(&alloc.cpu, size)) )
+				alloc.cpu = NULL;
+		}
+		else
+		{
+			alloc.cpu = malloc(size);
+		}
+
+		if( !alloc.cpu )
+		{
+			CUDA(cudaFree(alloc.gpu));
+			return false;
+		}
+	}
+
+	memset(alloc.cpu, 0, size);
+
+	if( mType == MEM_DEVICE || mType == MEM_PINNED )
+		CUDA(cudaMemset(alloc.gpu, 0, size));
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		mAllocations[alloc.cpu] = alloc;
+		mOutstanding += size;
+
+		if( mOutstanding > mPeak )
+			mPeak = mOutstanding;
+	}
+
+	*cpuPtr = alloc.cpu;
+	*gpuPtr = alloc.gpu;
+	return true;
+}
+
+
+// Free
+bool cudaAllocator::Free( void* cpuPtr )
+{
+	if( !cpuPtr )
+		return false;
+
+	Allocation alloc;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		std::map<void*, Allocation>::iterator iter = mAllocations.find(cpuPtr);
+
+		if( iter == mAllocations.end() )
+		{
+			printf(LOG_CUDA "cudaAllocator(%s) -- %p was not allocated by this allocator\n", cudaMemoryTypeToStr(mType), cpuPtr);
+			return false;
+		}
+
+		alloc = iter->second;
+		mAllocations.erase(iter);
+		mOutstanding -= alloc.size;
+	}
+
+	if( mType == MEM_MAPPED )
+	{
+		CUDA(cudaFreeHost(alloc.cpu));
+	}
+	else if( mType == MEM_HOST )
+	{
+		free(alloc.cpu);
+	}
+	else
+	{
+		CUDA(cudaFree(alloc.gpu));
+
+		if( mType == MEM_PINNED )
+			CUDA(cudaFreeHost(alloc.cpu));
+		else
+			free(alloc.cpu);
+	}
+
+	return true;
+}
+
+
+// find (locates the allocation containing the pointer)
+bool cudaAllocator::find( void* cpuPtr, Allocation* alloc )
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	std::map<void*, Allocation>::iterator iter = mAllocations.upper_bound(cpuPtr);
+
+	if( iter == mAllocations.begin() )
+		return false;
+
+	iter--;
+
+	if( (uint8_t*)cpuPtr >= (uint8_t*)iter->second.cpu + iter->second.size )
+		return false;
+
+	*alloc = iter->second;
+	return true;
+}
+
+
+// GetDevicePtr
+void* cudaAllocator::GetDevicePtr( void* cpuPtr )
+{
+	Allocation alloc;
+
+	if( !find(cpuPtr, &alloc) )
+		return NULL;
+
+	return (uint8_t*)alloc.gpu + ((uint8_t*)cpuPtr - (uint8_t*)alloc.cpu);
+}
+
+
+// copy
+bool cudaAllocator::copy( void* cpuPtr, size_t size, cudaStream_t stream, bool upload )
+{
+	if( IsCoherent() )
+		return true;
+
+	Allocation alloc;
+
+	if( !find(cpuPtr, &alloc) )
+	{
+		printf(LOG_CUDA "cudaAllocator(%s) -- %p is not inside an allocation\n", cudaMemoryTypeToStr(mType), cpuPtr);
+		return false;
+	}
+
+	const size_t offset = (uint8_t*)cpuPtr - (uint8_t*)alloc.cpu;
+
+	if( size == 0 || offset + size > alloc.size )
+		size = alloc.size - offset;
+
+	void* gpuPtr = (uint8_t*)alloc.gpu + offset;
+
+	void* dst = upload ? gpuPtr : cpuPtr;
+	void* src = upload ? cpuPtr : gpuPtr;
+
+	const cudaMemcpyKind kind = upload ? cudaMemcpyHostToDevice : cudaMemcpyDeviceToHost;
+
+	// only pinned memory can be copied asynchronously
+	if( stream != NULL && mType == MEM_PINNED )
+		return CUDA_SUCCESS(cudaMemcpyAsync(dst, src, size, kind, stream));
+
+	return CUDA_SUCCESS(cudaMemcpy(dst, src, size, kind));
+}
+
+
+// Upload
+bool cudaAllocator::Upload( void* cpuPtr, size_t size, cudaStream_t stream )
+{
+	return copy(cpuPtr, size, stream, true);
+}
+
+
+// Download
+bool cudaAllocator::Download( void* cpuPtr, size_t size, cudaStream_t stream )
+{
+	return copy(cpuPtr, size, stream, false);
+}
+
+
+// GetOutstandingBytes
+size_t cudaAllocator::GetOutstandingBytes()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mOutstanding;
+}
+
+
+// GetOutstandingCount
+size_t cudaAllocator::GetOutstandingCount()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mAllocations.size();
+}
+
+
+// GetTotalOutstandingBytes
+size_t cudaAllocator::GetTotalOutstandingBytes()
+{
+	size_t total = 0;
+
+	for( int n=0; n < numMemoryTypes; n++ )
+	{
+		cudaAllocator* allocator = NULL;
+
+		{
+			std::lock_guard<std::mutex> lock(gAllocatorMutex);
+			allocator = gAllocators[n];
+		}
+
+		if( allocator != NULL )
+			total += allocator->GetOutstandingBytes();
+	}
+
+	return total;
+}
+
+
+// PrintStats
+void cudaAllocator::PrintStats()
+{
+	for( int n=0; n < numMemoryTypes; n++ )
+	{
+		cudaAllocator* allocator = NULL;
+
+		{
+			std::lock_guard<std::mutex> lock(gAllocatorMutex);
+			allocator = gAllocators[n];
+		}
+
+		if( !allocator )
+			continue;
+
+		std::lock_guard<std::mutex> lock(allocator->mMutex);
+
+		printf(LOG_CUDA "cudaAllocator(%s) -- %zu allocations outstanding, %zu bytes (peak %zu bytes)\n",
+			  cudaMemoryTypeToStr(allocator->mType), allocator->mAllocations.size(), allocator->mOutstanding, allocator->mPeak);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------
+
+// constructor
+cudaArena::cudaArena( cudaAllocator* allocator, size_t alignment )
+{
+	mAllocator = allocator;
+	mAlignment = alignment;
+	mCPU       = NULL;
+	mGPU       = NULL;
+	mTotal     = 0;
+}
+
+
+// destructor
+cudaArena::~cudaArena()
+{
+	if( mCPU != NULL )
+	{
+		mAllocator->Free(mCPU);
+		mCPU = NULL;
+		mGPU = NULL;
+	}
+}
+
+
+// Create
+cudaArena* cudaArena::Create( cudaAllocator* allocator, size_t alignment )
+{
+	if( !allocator )
+		return NULL;
+
+	if( alignment == 0 )
+		alignment = 1;
+
+	return new cudaArena(allocator, alignment);
+}
+
+
+// Reserve
+uint32_t cudaArena::Reserve( size_t size )
+{
+	const size_t offset = ((mTotal + mAlignment - 1) / mAlignment) * mAlignment;
+
+	mSizes.push_back(size);
+	mOffsets.push_back(offset);
+
+	mTotal = offset + size;
+	return mSizes.size() - 1;
+}
+
+
+// Commit
+bool cudaArena::Commit()
+{
+	if( mCPU != NULL )
+	{
+		printf(LOG_CUDA "cudaArena::Commit() -- arena was already committed\n");
+		return false;
+	}
+
+	if( !mAllocator->Alloc(&mCPU, &mGPU, mTotal) )
+	{
+		printf(LOG_CUDA "cudaArena::Commit() -- failed to allocate %zu bytes of %s memory\n", mTotal, cudaMemoryTypeToStr(mAllocator->GetType()));
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,245 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __CUDA_ALLOCATOR_H_
+#define __CUDA_ALLOCATOR_H_
+
+
+#include "cudaUtility.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+
+/**
+ * Placement of memory allocated by cudaAllocator.
+ * Every allocation has a CPU pointer and a GPU pointer -- depending on the type
+ * these either alias the same memory, or are mirrors kept in sync with Upload()/Download().
+ * @ingroup util
+ */
+enum cudaMemoryType
+{
+	MEM_DEVICE = 0,	/**< device memory with a pageable host mirror, synchronized with explicit copies */
+	MEM_MAPPED,		/**< ZeroCopy mapped host memory, shared by the CPU and GPU (best on Jetson/integrated GPUs) */
+	MEM_PINNED,		/**< device memory with a pinned host staging mirror, for fast (async) copies on discrete GPUs */
+	MEM_HOST			/**< plain host memory, with the GPU pointer aliasing the CPU pointer (CPU-only builds) */
+};
+
+
+/**
+ * Convert a string ("device", "mapped", "pinned", "host") to a cudaMemoryType.
+ * @returns true if the string was recognized.
+ * @ingroup util
+ */
+bool cudaMemoryTypeFromStr( const char* str, cudaMemoryType* type );
+
+
+/**
+ * Convert a cudaMemoryType to a string.
+ * @ingroup util
+ */
+const char* cudaMemoryTypeToStr( cudaMemoryType type );
+
+
+/**
+ * Allocator for one type of memory, which tracks each allocation and the outstanding bytes.
+ * There is one shared allocator instance per memory type, retrieved with cudaAllocator::Get().
+ * @ingroup util
+ */
+class cudaAllocator
+{
+public:
+	/**
+	 * Retrieve the shared allocator for the specified memory type.
+	 */
+	static cudaAllocator* Get( cudaMemoryType type );
+
+	/**
+	 * Retrieve the shared allocator for the default memory type.
+	 */
+	static inline cudaAllocator* Get()			{ return Get(GetDefaultType()); }
+
+	/**
+	 * Get the default memory type used for network bindings.  Unless overridden with
+	 * SetDefaultType(), this is MEM_MAPPED on integrated GPUs (like Jetson) and MEM_PINNED on discrete GPUs,
+	 * or MEM_HOST in CPU_ONLY builds.
+	 */
+	static cudaMemoryType GetDefaultType();
+
+	/**
+	 * Override the default memory type, i.e. before creating networks.
+	 */
+	static void SetDefaultType( cudaMemoryType type );
+
+	/**
+	 * Allocate a buffer, returning its CPU and GPU pointers.
+	 */
+	bool Alloc( void** cpuPtr, void** gpuPtr, size_t size );
+
+	/**
+	 * Free a buffer by its CPU pointer.
+	 */
+	bool Free( void* cpuPtr );
+
+	/**
+	 * Copy a range of a buffer from the CPU mirror to the GPU.  The pointer may be
+	 * anywhere inside an allocation.  This is a no-op for coherent memory types.
+	 * @param size number of bytes to copy (0 for the remainder of the allocation)
+	 * @param stream if non-NULL the copy is asynchronous on the stream, otherwise it's synchronous
+	 */
+	bool Upload( void* cpuPtr, size_t size=0, cudaStream_t stream=NULL );
+
+	/**
+	 * Copy a range of a buffer from the GPU to its CPU mirror.
+	 * @see Upload() for the parameters.
+	 */
+	bool Download( void* cpuPtr, size_t size=0, cudaStream_t stream=NULL );
+
+	/**
+	 * Retrieve the GPU pointer corresponding to a CPU pointer inside an allocation.
+	 */
+	void* GetDevicePtr( void* cpuPtr );
+
+	/**
+	 * Retrieve the memory type of this allocator.
+	 */
+	inline cudaMemoryType GetType() const		{ return mType; }
+
+	/**
+	 * True if the CPU and GPU see the same memory, i.e. no Upload()/Download() is needed.
+	 */
+	inline bool IsCoherent() const			{ return mType == MEM_MAPPED || mType == MEM_HOST; }
+
+	/**
+	 * Retrieve the number of bytes currently allocated (not freed) from this allocator.
+	 */
+	size_t GetOutstandingBytes();
+
+	/**
+	 * Retrieve the number of allocations that haven't been freed.
+	 */
+	size_t GetOutstandingCount();
+
+	/**
+	 * Retrieve the number of bytes currently allocated from all allocators.
+	 */
+	static size_t GetTotalOutstandingBytes();
+
+	/**
+	 * Print the outstanding allocations of every allocator to stdout.
+	 */
+	static void PrintStats();
+
+protected:
+	cudaAllocator( cudaMemoryType type );
+	~cudaAllocator();
+
+	struct Allocation
+	{
+		void*  cpu;
+		void*  gpu;
+		size_t size;
+	};
+
+	bool find( void* cpuPtr, Allocation* alloc );
+	bool copy( void* cpuPtr, size_t size, cudaStream_t stream, bool upload );
+
+	cudaMemoryType mType;
+
+	std::map<void*, Allocation> mAllocations;	// keyed by CPU pointer
+	std::mutex mMutex;
+
+	size_t mOutstanding;
+	size_t mPeak;
+};
+
+
+/**
+ * Arena that bulk-allocates several buffers (like a network's bindings) from a single
+ * allocation.  Sizes are reserved first, then Commit() allocates the arena and
+ * sub-divides it.  Everything is released when the arena is deleted.
+ * @ingroup util
+ */
+class cudaArena
+{
+public:
+	/**
+	 * Create an empty arena using the specified allocator.
+	 * @param alignment byte alignment of each buffer within the arena
+	 */
+	static cudaArena* Create( cudaAllocator* allocator, size_t alignment=256 );
+
+	/**
+	 * Destroy the arena, freeing its memory.
+	 */
+	~cudaArena();
+
+	/**
+	 * Reserve a buffer of the specified size.  Must be called before Commit().
+	 * @returns the index of the buffer.
+	 */
+	uint32_t Reserve( size_t size );
+
+	/**
+	 * Allocate the memory for all of the reserved buffers.
+	 */
+	bool Commit();
+
+	/**
+	 * Retrieve the CPU pointer of a buffer (after Commit)
+	 */
+	inline void* GetCPU( uint32_t index ) const		{ return (uint8_t*)mCPU + mOffsets[index]; }
+
+	/**
+	 * Retrieve the GPU pointer of a buffer (after Commit)
+	 */
+	inline void* GetGPU( uint32_t index ) const		{ return (uint8_t*)mGPU + mOffsets[index]; }
+
+	/**
+	 * Retrieve the size of a buffer
+	 */
+	inline size_t GetSize( uint32_t index ) const		{ return mSizes[index]; }
+
+	/**
+	 * Retrieve the number of buffers
+	 */
+	inline uint32_t GetCount() const				{ return mSizes.size(); }
+
+	/**
+	 * Retrieve the total size of the arena, including alignment padding.
+	 */
+	inline size_t GetTotalSize() const				{ return mTotal; }
+
+	/**
+	 * Retrieve the allocator used by the arena.
+	 */
+	inline cudaAllocator* GetAllocator() const		{ return mAllocator; }
+
+	/**
+	 * Copy (part of) a buffer from the CPU to the GPU, @see cudaAllocator::Upload()
+	 */
+	inline bool Upload( uint32_t index, size_t size=0, cudaStream_t stream=NULL )		{ return mAllocator->Upload(GetCPU(index), size ? size : mSizes[index], stream); }
+
+	/**
+	 * Copy (part of) a buffer from the GPU to the CPU, @see cudaAllocator::Download()
+	 */
+	inline bool Download( uint32_t index, size_t size=0, cudaStream_t stream=NULL )	{ return mAllocator->Download(GetCPU(index), size ? size : mSizes[index], stream); }
+
+protected:
+	cudaArena( cudaAllocator* allocator, size_t alignment );
+
+	cudaAllocator* mAllocator;
+
+	std::vector<size_t> mSizes;
+	std::vector<size_t> mOffsets;
+
+	void*  mCPU;
+	void*  mGPU;
+	size_t mTotal;
+	size_t mAlignment;
+};
+
+
+#endif
@@ -0,0 +1,126 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "cudaColorspace.h"
+
+
+// colorConversionInit
+colorConversion colorConversionInit( colorSpace colorspace )
+{
+	const bool bt709 = (colorspace == COLORSPACE_BT709 || colorspace == COLORSPACE_BT709_FULL);
+	const bool full  = (colorspace == COLORSPACE_BT601_FULL || colorspace == COLORSPACE_BT709_FULL);
+
+	// weights of R and B in the luminance
+	const float kr = bt709 ? 0.2126f : 0.299f;
+	const float kb = bt709 ? 0.0722f : 0.114f;
+	const float kg = 1.0f - kr - kb;
+
+	// limited range squeezes Y into 219 levels and U/V into 224
+	const float ys = full ? 1.0f : 219.0f / 255.0f;
+	const float cs = full ? 1.0f : 224.0f / 255.0f;
+
+	colorConversion cc;
+
+	cc.toYUV[0] = make_float3(ys * kr, ys * kg, ys * kb);
+	cc.toYUV[1] = make_float3(cs * -kr / (2.0f * (1.0f - kb)), cs * -kg / (2.0f * (1.0f - kb)), cs * 0.5f);
+	cc.toYUV[2] = make_float3(cs * 0.5f, cs * -kg / (2.0f * (1.0f - kr)), cs * -kb / (2.0f * (1.0f - kr)));
+
+	cc.toRGB[0] = make_float3(1.0f / ys, 0.0f, 2.0f * (1.0f - kr) / cs);
+	cc.toRGB[1] = make_float3(1.0f / ys, -2.0f * kb * (1.0f - kb) / (kg * cs), -2.0f * kr * (1.0f - kr) / (kg * cs));
+	cc.toRGB[2] = make_float3(1.0f / ys, 2.0f * (1.0f - kb) / cs, 0.0f);
+
+	cc.offset = make_float3(full ? 0.0f : 16.0f, 128.0f, 128.0f);
+	cc.luma   = make_float3(kr, kg, kb);
+
+	return cc;
+}
+
+
+// colorPlanesInit
+bool colorPlanesInit( void* image, imageFormat format, size_t width, size_t height, colorPlanes* planes, size_t pitch )
+{
+	if( !image || !planes || format >= FORMAT_UNKNOWN )
+		return false;
+
+	memset(planes, 0, sizeof(colorPlanes));
+
+	uint8_t* ptr = (uint8_t*)image;
+
+	const size_t chromaWidth  = (width + 1) / 2;
+	const size_t chromaHeight = (height + 1) / 2;
+
+	planes->ptr[0] = ptr;
+
+	switch(format)
+	{
+		case FORMAT_RGBA32F:
+			planes->pitch[0] = pitch ? pitch : width * sizeof(float4);
+			break;
+
+		case FORMAT_NV12:
+			planes->pitch[0] = pitch ? pitch : width;
+			planes->pitch[1] = pitch ? pitch : chromaWidth * 2;
+			planes->ptr[1]   = ptr + planes->pitch[0] * height;
+			break;
+
+		case FORMAT_I420:
+		case FORMAT_YV12:
+		{
+			planes->pitch[0] = pitch ? pitch : width;
+			planes->pitch[1] = pitch ? pitch / 2 : chromaWidth;
+			planes->pitch[2] = planes->pitch[1];
+
+			uint8_t* first  = ptr + planes->pitch[0] * height;
+			uint8_t* second = first + planes->pitch[1] * chromaHeight;
+
+			planes->ptr[1] = (format == FORMAT_I420) ? first : second;	// U
+			planes->ptr[2] = (format == FORMAT_I420) ? second : first;	// V
+			break;
+		}
+
+		case FORMAT_YUYV:
+		case FORMAT_UYVY:
+			planes->pitch[0] = pitch ? pitch : chromaWidth * 4;
+			break;
+
+		default:
+			planes->pitch[0] = pitch ? pitch : width * imageFormatChannels(format);
+			break;
+	}
+
+	return true;
+}
+
+
+// cudaConvertColor
+cudaError_t cudaConvertColor( void* input, imageFormat inputFormat, void* output, imageFormat outputFormat,
+					     size_t width, size_t height, colorSpace colorspace, cudaStream_t stream )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( width == 0 || height == 0 || inputFormat >= FORMAT_UNKNOWN || outputFormat >= FORMAT_UNKNOWN )
+		return cudaErrorInvalidValue;
+
+	const bool packed422 = (inputFormat == FORMAT_YUYV || inputFormat == FORMAT_UYVY ||
+					    outputFormat == FORMAT_YUYV || outputFormat == FORMAT_UYVY);
+
+	if( packed422 && (width % 2) != 0 )
+	{
+		printf(LOG_CUDA "cudaConvertColor() -- %s to %s needs an even width (was %zu)\n", imageFormatToStr(inputFormat), imageFormatToStr(outputFormat), width);
+		return cudaErrorInvalidValue;
+	}
+
+	if( inputFormat == outputFormat )
+		return CUDA(cudaMemcpyAsync(output, input, imageFormatSize(inputFormat, width, height), cudaMemcpyDeviceToDevice, stream));
+
+	colorPlanes inputPlanes;
+	colorPlanes outputPlanes;
+
+	if( !colorPlanesInit(input, inputFormat, width, height, &inputPlanes) ||
+	    !colorPlanesInit(output, outputFormat, width, height, &outputPlanes) )
+		return cudaErrorInvalidValue;
+
+	return cudaConvertColorPlanes(inputPlanes, inputFormat, outputPlanes, outputFormat, width, height, colorConversionInit(colorspace), stream);
+}
@@ -0,0 +1,61 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "cudaColorspace.h"
+
+
+// gpuConvertColor
+template<imageFormat inputFormat, imageFormat outputFormat>
+__global__ void gpuConvertColor( colorPlanes input, colorPlanes output, int width, int height, colorConversion cc )
+{
+	const int x = (blockIdx.x * blockDim.x + threadIdx.x) * 2;
+	const int y = (blockIdx.y * blockDim.y + threadIdx.y) * 2;
+
+	if( x >= width || y >= height )
+		return;
+
+	colorConvertBlock<inputFormat, outputFormat>(input, output, x, y, width, height, cc);
+}
+
+
+// launchConvertColor
+template<imageFormat inputFormat, imageFormat outputFormat>
+static cudaError_t launchConvertColor( const colorPlanes& input, const colorPlanes& output, uint32_t width, uint32_t height,
+							    const colorConversion& cc, cudaStream_t stream )
+{
+	// one thread per 2x2 block
+	const dim3 blockDim(16, 8);
+	const dim3 gridDim(iDivUp(iDivUp(width, 2), blockDim.x), iDivUp(iDivUp(height, 2), blockDim.y));
+
+	gpuConvertColor<inputFormat, outputFormat><<<gridDim, blockDim, 0, stream>>>(input, output, width, height, cc);
+
+	return CUDA(cudaGetLastError());
+}
+
+
+// every pair of formats, so each conversion is instantiated with its loads and stores inlined
+typedef cudaError_t (*convertColorFunc)( const colorPlanes&, const colorPlanes&, uint32_t, uint32_t, const colorConversion&, cudaStream_t );
+
+static const convertColorFunc convertColorTable[FORMAT_UNKNOWN][FORMAT_UNKNOWN] = COLOR_CONVERSION_TABLE(launchConvertColor);
+
+
+// cudaConvertColorPlanes
+cudaError_t cudaConvertColorPlanes( const colorPlanes& input, imageFormat inputFormat,
+						      const colorPlanes& output, imageFormat outputFormat,
+						      uint32_t width, uint32_t height, const colorConversion& coefficients, cudaStream_t stream )
+{
+	if( inputFormat >= FORMAT_UNKNOWN || outputFormat >= FORMAT_UNKNOWN || width == 0 || height == 0 )
+		return cudaErrorInvalidValue;
+
+	// camera formats into the RGBA layouts have vectorized kernels, if the rows can be accessed 16 bytes at a time
+	const bool vectorOutput = (outputFormat == FORMAT_RGBA8 || outputFormat == FORMAT_BGRA8 || outputFormat == FORMAT_RGBA32F) && colorPlanesAligned(output, 1);
+
+	if( vectorOutput && inputFormat == FORMAT_NV12 && colorPlanesAligned(input, 2) )
+		return cudaConvertNV12Vector(input, output, outputFormat, width, height, coefficients, stream);
+
+	if( vectorOutput && (inputFormat == FORMAT_YUYV || inputFormat == FORMAT_UYVY) && colorPlanesAligned(input, 1) )
+		return cudaConvertYUYVVector(input, inputFormat, output, outputFormat, width, height, coefficients, stream);
+
+	return convertColorTable[inputFormat][outputFormat](input, output, width, height, coefficients, stream);
+}
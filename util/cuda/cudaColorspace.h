@@ -0,0 +1,378 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __CUDA_COLORSPACE_H__
+#define __CUDA_COLORSPACE_H__
+
+
+#include "cudaUtility.h"
+#include "imageFormat.h"
+
+#include <math.h>
+#include <stdint.h>
+
+
+/**
+ * YUV color standard and range used when converting between YUV and RGB.
+ * Limited range has Y in 16-235 and U/V in 16-240 (most video), full range uses 0-255 (JPEG).
+ * @ingroup util
+ */
+enum colorSpace
+{
+	COLORSPACE_BT601 = 0,		/**< ITU-R BT.601 (SD video and most cameras), limited range */
+	COLORSPACE_BT709,			/**< ITU-R BT.709 (HD video), limited range */
+	COLORSPACE_BT601_FULL,		/**< ITU-R BT.601, full range */
+	COLORSPACE_BT709_FULL		/**< ITU-R BT.709, full range */
+};
+
+
+/**
+ * Name of the color space, for logging
+ * @ingroup util
+ */
+inline const char* colorSpaceToStr( colorSpace colorspace )
+{
+	switch(colorspace)
+	{
+		case COLORSPACE_BT601:		return "bt601";
+		case COLORSPACE_BT709:		return "bt709";
+		case COLORSPACE_BT601_FULL:	return "bt601-full";
+		case COLORSPACE_BT709_FULL:	return "bt709-full";
+	}
+
+	return "unknown";
+}
+
+
+/**
+ * Convert an image from one format to another in a single pass, e.g. a camera's NV12 straight
+ * into the float4 RGBA a network takes, RGBA8 for display or I420 for an encoder.  Any of the
+ * imageFormat formats can be converted to any other, and the color space applies when one side
+ * is YUV and the other is RGB (or gray).  The images are expected to have tightly packed rows
+ * (see imageFormatSize()), and YUYV/UYVY need an even width.  Converting an image to its own
+ * format copies it.
+ * @ingroup util
+ */
+cudaError_t cudaConvertColor( void* input, imageFormat inputFormat, void* output, imageFormat outputFormat,
+					     size_t width, size_t height, colorSpace colorspace=COLORSPACE_BT601, cudaStream_t stream=NULL );
+
+
+//////////////////////////////////////////////////////////////////////////////////
+/// @name Internals of cudaConvertColor(), shared by the kernels and the CPU version
+/// @ingroup util
+//////////////////////////////////////////////////////////////////////////////////
+
+///@{
+
+/**
+ * Coefficients of a colorSpace.  YUV is converted to RGB (0-255) by subtracting offset and
+ * multiplying by toRGB, RGB is converted to YUV by multiplying with toYUV and adding offset.
+ */
+struct colorConversion
+{
+	float3 toRGB[3];	/**< rows of the YUV to RGB matrix */
+	float3 toYUV[3];	/**< rows of the RGB to YUV matrix */
+	float3 offset;		/**< (16, 128, 128) for limited range, (0, 128, 128) for full range */
+	float3 luma;		/**< weights of R, G and B in the luminance of FORMAT_GRAY8 */
+};
+
+/**
+ * Compute the coefficients of a color space.
+ */
+colorConversion colorConversionInit( colorSpace colorspace );
+
+/**
+ * Pointers to the planes of an image and the size in bytes of their rows.  Packed formats only
+ * use the first plane, NV12 the first two, and I420/YV12 have their U plane second and V third.
+ */
+struct colorPlanes
+{
+	uint8_t* ptr[3];
+	uint32_t pitch[3];
+};
+
+/**
+ * Find the planes of an image stored back-to-back.  With a pitch of 0 the rows are tightly
+ * packed (see imageFormatSize()), otherwise pitch is the size of the rows of the first plane,
+ * and the chroma planes follow it with the same pitch (NV12) or half of it (I420/YV12).
+ */
+bool colorPlanesInit( void* image, imageFormat format, size_t width, size_t height, colorPlanes* planes, size_t pitch=0 );
+
+/**
+ * Are the first numPlanes planes aligned for 16-byte loads and stores of every row.
+ */
+inline bool colorPlanesAligned( const colorPlanes& planes, int numPlanes )
+{
+	for( int n=0; n < numPlanes; n++ )
+	{
+		if( ((size_t)planes.ptr[n] % 16) != 0 || (planes.pitch[n] % 16) != 0 )
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Convert between two formats, one thread per 2x2 block of pixels (used by cudaConvertColor()).
+ */
+cudaError_t cudaConvertColorPlanes( const colorPlanes& input, imageFormat inputFormat,
+						      const colorPlanes& output, imageFormat outputFormat,
+						      uint32_t width, uint32_t height, const colorConversion& coefficients, cudaStream_t stream );
+
+/**
+ * Convert NV12 to RGBA8, BGRA8 or RGBA32F with 16 pixels per thread on two rows that share a chroma row,
+ * reading and writing 16 bytes at a time.  The planes need to be colorPlanesAligned() (used by cudaConvertColor()).
+ */
+cudaError_t cudaConvertNV12Vector( const colorPlanes& input, const colorPlanes& output, imageFormat outputFormat,
+						     uint32_t width, uint32_t height, const colorConversion& coefficients, cudaStream_t stream );
+
+/**
+ * Convert YUYV or UYVY to RGBA8, BGRA8 or RGBA32F with 16 pixels per thread, reading and writing 16 bytes
+ * at a time.  The planes need to be colorPlanesAligned() (used by cudaConvertColor()).
+ */
+cudaError_t cudaConvertYUYVVector( const colorPlanes& input, imageFormat inputFormat, const colorPlanes& output, imageFormat outputFormat,
+						     uint32_t width, uint32_t height, const colorConversion& coefficients, cudaStream_t stream );
+
+/**
+ * Number of pixels along a row that each thread of the vectorized kernels converts.
+ */
+#define COLOR_VECTOR_PIXELS 16
+
+/**
+ * Byte n (0-15) of a 16-byte vector, as a float.
+ */
+inline __host__ __device__ float colorVectorByte( const uint4& v, int n )
+{
+	const uint32_t word = (n < 4) ? v.x : (n < 8) ? v.y : (n < 12) ? v.z : v.w;
+	return (word >> ((n & 3) * 8)) & 0xFF;
+}
+
+/**
+ * Clamp and round to 8 bits.
+ */
+inline __host__ __device__ uint8_t colorPack( float v )
+{
+	return (uint8_t)fminf(fmaxf(v + 0.5f, 0.0f), 255.0f);
+}
+
+/**
+ * Convert a YUV pixel (x=Y, y=U, z=V) to RGB 0-255, clamped to the RGB gamut.  Alpha is kept.
+ */
+inline __host__ __device__ float4 colorYUVToRGB( const float4& yuv, const colorConversion& cc )
+{
+	const float y = yuv.x - cc.offset.x;
+	const float u = yuv.y - cc.offset.y;
+	const float v = yuv.z - cc.offset.z;
+
+	return make_float4(fminf(fmaxf(cc.toRGB[0].x * y + cc.toRGB[0].y * u + cc.toRGB[0].z * v, 0.0f), 255.0f),
+				    fminf(fmaxf(cc.toRGB[1].x * y + cc.toRGB[1].y * u + cc.toRGB[1].z * v, 0.0f), 255.0f),
+				    fminf(fmaxf(cc.toRGB[2].x * y + cc.toRGB[2].y * u + cc.toRGB[2].z * v, 0.0f), 255.0f),
+				    yuv.w);
+}
+
+/**
+ * Convert an RGB pixel (0-255) to YUV (x=Y, y=U, z=V).  Alpha is kept.
+ */
+inline __host__ __device__ float4 colorRGBToYUV( const float4& rgb, const colorConversion& cc )
+{
+	return make_float4(cc.toYUV[0].x * rgb.x + cc.toYUV[0].y * rgb.y + cc.toYUV[0].z * rgb.z + cc.offset.x,
+				    cc.toYUV[1].x * rgb.x + cc.toYUV[1].y * rgb.y + cc.toYUV[1].z * rgb.z + cc.offset.y,
+				    cc.toYUV[2].x * rgb.x + cc.toYUV[2].y * rgb.y + cc.toYUV[2].z * rgb.z + cc.offset.z,
+				    rgb.w);
+}
+
+/**
+ * Read pixel (x, y) of an image, as RGBA 0-255 for the RGB and gray formats or as (Y, U, V, 255)
+ * for the YUV formats.  The chroma of the subsampled formats is shared by the pixels it covers.
+ */
+template<imageFormat format>
+inline __host__ __device__ float4 colorLoad( const colorPlanes& img, int x, int y )
+{
+	const uint8_t* row = img.ptr[0] + y * img.pitch[0];
+
+	switch(format)
+	{
+		case FORMAT_RGB8:	{ const uint8_t* p = row + x * 3; return make_float4(p[0], p[1], p[2], 255.0f); }
+		case FORMAT_BGR8:	{ const uint8_t* p = row + x * 3; return make_float4(p[2], p[1], p[0], 255.0f); }
+		case FORMAT_RGBA8:	{ const uint8_t* p = row + x * 4; return make_float4(p[0], p[1], p[2], p[3]); }
+		case FORMAT_BGRA8:	{ const uint8_t* p = row + x * 4; return make_float4(p[2], p[1], p[0], p[3]); }
+		case FORMAT_GRAY8:	return make_float4(row[x], row[x], row[x], 255.0f);
+		case FORMAT_RGBA32F:	return ((const float4*)row)[x];
+		case FORMAT_NV12:
+		{
+			const uint8_t* uv = img.ptr[1] + (y / 2) * img.pitch[1] + (x / 2) * 2;
+			return make_float4(row[x], uv[0], uv[1], 255.0f);
+		}
+		case FORMAT_I420:
+		case FORMAT_YV12:
+		{
+			const int chroma = (x / 2);
+			return make_float4(row[x], img.ptr[1][(y / 2) * img.pitch[1] + chroma], img.ptr[2][(y / 2) * img.pitch[2] + chroma], 255.0f);
+		}
+		case FORMAT_YUYV:	{ const uint8_t* m = row + (x / 2) * 4; return make_float4(m[(x & 1) * 2], m[1], m[3], 255.0f); }
+		case FORMAT_UYVY:	{ const uint8_t* m = row + (x / 2) * 4; return make_float4(m[(x & 1) * 2 + 1], m[0], m[2], 255.0f); }
+		default:			return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+	}
+}
+
+/**
+ * Write pixel (x, y) of an RGB or gray image from RGBA 0-255.
+ */
+template<imageFormat format>
+inline __host__ __device__ void colorStore( const colorPlanes& img, int x, int y, const float4& px, const colorConversion& cc )
+{
+	uint8_t* row = img.ptr[0] + y * img.pitch[0];
+
+	switch(format)
+	{
+		case FORMAT_RGB8:	{ uint8_t* p = row + x * 3; p[0] = colorPack(px.x); p[1] = colorPack(px.y); p[2] = colorPack(px.z); break; }
+		case FORMAT_BGR8:	{ uint8_t* p = row + x * 3; p[0] = colorPack(px.z); p[1] = colorPack(px.y); p[2] = colorPack(px.x); break; }
+		case FORMAT_RGBA8:	((uchar4*)row)[x] = make_uchar4(colorPack(px.x), colorPack(px.y), colorPack(px.z), colorPack(px.w)); break;
+		case FORMAT_BGRA8:	((uchar4*)row)[x] = make_uchar4(colorPack(px.z), colorPack(px.y), colorPack(px.x), colorPack(px.w)); break;
+		case FORMAT_GRAY8:	row[x] = colorPack(cc.luma.x * px.x + cc.luma.y * px.y + cc.luma.z * px.z); break;
+		case FORMAT_RGBA32F:	((float4*)row)[x] = px; break;
+		default:			break;
+	}
+}
+
+/**
+ * Write 4 pixels of an RGBA8, BGRA8 or RGBA32F image starting at (x, y) with 16-byte stores,
+ * x being a multiple of 4 and the rows colorPlanesAligned().  Other formats are written by colorStore().
+ */
+template<imageFormat format>
+inline __host__ __device__ void colorStoreVector( const colorPlanes& img, int x, int y, const float4 px[4], const colorConversion& cc )
+{
+	uint8_t* row = img.ptr[0] + y * img.pitch[0];
+
+	#define colorPackRGBA(r, g, b, a)	(uint32_t(colorPack(r)) | (uint32_t(colorPack(g)) << 8) | (uint32_t(colorPack(b)) << 16) | (uint32_t(colorPack(a)) << 24))
+
+	switch(format)
+	{
+		case FORMAT_RGBA8:
+			*(uint4*)(row + x * 4) = make_uint4(colorPackRGBA(px[0].x, px[0].y, px[0].z, px[0].w), colorPackRGBA(px[1].x, px[1].y, px[1].z, px[1].w),
+									colorPackRGBA(px[2].x, px[2].y, px[2].z, px[2].w), colorPackRGBA(px[3].x, px[3].y, px[3].z, px[3].w));
+			break;
+
+		case FORMAT_BGRA8:
+			*(uint4*)(row + x * 4) = make_uint4(colorPackRGBA(px[0].z, px[0].y, px[0].x, px[0].w), colorPackRGBA(px[1].z, px[1].y, px[1].x, px[1].w),
+									colorPackRGBA(px[2].z, px[2].y, px[2].x, px[2].w), colorPackRGBA(px[3].z, px[3].y, px[3].x, px[3].w));
+			break;
+
+		case FORMAT_RGBA32F:
+			for( int n=0; n < 4; n++ )
+				((float4*)row)[x + n] = px[n];
+			break;
+
+		default:
+			for( int n=0; n < 4; n++ )
+				colorStore<format>(img, x + n, y, px[n], cc);
+			break;
+	}
+
+	#undef colorPackRGBA
+}
+
+/**
+ * Convert the 2x2 block of pixels with its top-left corner at (x, y), which are even.  Reads past
+ * the right and bottom edges repeat the last column/row, and writes past them are skipped.
+ * The chroma of 4:2:0 outputs is the average of the block, and of 4:2:2 outputs of each pair.
+ */
+template<imageFormat inputFormat, imageFormat outputFormat>
+inline __host__ __device__ void colorConvertBlock( const colorPlanes& input, const colorPlanes& output,
+									  int x, int y, int width, int height, const colorConversion& cc )
+{
+	const int x1 = (x + 1 < width) ? x + 1 : x;
+	const int y1 = (y + 1 < height) ? y + 1 : y;
+
+	float4 px[4] = { colorLoad<inputFormat>(input, x, y),  colorLoad<inputFormat>(input, x1, y),
+				  colorLoad<inputFormat>(input, x, y1), colorLoad<inputFormat>(input, x1, y1) };
+
+	if( imageFormatIsYUV(inputFormat) && !imageFormatIsYUV(outputFormat) )
+	{
+		for( int n=0; n < 4; n++ )
+			px[n] = colorYUVToRGB(px[n], cc);
+	}
+	else if( !imageFormatIsYUV(inputFormat) && imageFormatIsYUV(outputFormat) )
+	{
+		for( int n=0; n < 4; n++ )
+			px[n] = colorRGBToYUV(px[n], cc);
+	}
+
+	const bool right  = (x + 1 < width);
+	const bool bottom = (y + 1 < height);
+
+	if( !imageFormatIsYUV(outputFormat) )
+	{
+		colorStore<outputFormat>(output, x, y, px[0], cc);
+
+		if( right )		colorStore<outputFormat>(output, x + 1, y, px[1], cc);
+		if( bottom )		colorStore<outputFormat>(output, x, y + 1, px[2], cc);
+		if( right && bottom )	colorStore<outputFormat>(output, x + 1, y + 1, px[3], cc);
+
+		return;
+	}
+
+	if( outputFormat == FORMAT_YUYV || outputFormat == FORMAT_UYVY )
+	{
+		// the width is even, so both pixels of each pair are in the image
+		const int Y = (outputFormat == FORMAT_YUYV) ? 0 : 1;
+		const int C = (outputFormat == FORMAT_YUYV) ? 1 : 0;
+
+		for( int j=0; j < (bottom ? 2 : 1); j++ )
+		{
+			uint8_t* m = output.ptr[0] + (y + j) * output.pitch[0] + (x / 2) * 4;
+
+			m[Y]     = colorPack(px[j*2].x);
+			m[Y + 2] = colorPack(px[j*2+1].x);
+			m[C]     = colorPack((px[j*2].y + px[j*2+1].y) * 0.5f);
+			m[C + 2] = colorPack((px[j*2].z + px[j*2+1].z) * 0.5f);
+		}
+
+		return;
+	}
+
+	// 4:2:0
+	output.ptr[0][y * output.pitch[0] + x] = colorPack(px[0].x);
+
+	if( right )		output.ptr[0][y * output.pitch[0] + x + 1] = colorPack(px[1].x);
+	if( bottom )		output.ptr[0][(y + 1) * output.pitch[0] + x] = colorPack(px[2].x);
+	if( right && bottom )	output.ptr[0][(y + 1) * output.pitch[0] + x + 1] = colorPack(px[3].x);
+
+	const uint8_t u = colorPack((px[0].y + px[1].y + px[2].y + px[3].y) * 0.25f);
+	const uint8_t v = colorPack((px[0].z + px[1].z + px[2].z + px[3].z) * 0.25f);
+
+	if( outputFormat == FORMAT_NV12 )
+	{
+		uint8_t* uv = output.ptr[1] + (y / 2) * output.pitch[1] + x;
+
+		uv[0] = u;
+		uv[1] = v;
+	}
+	else
+	{
+		output.ptr[1][(y / 2) * output.pitch[1] + x / 2] = u;
+		output.ptr[2][(y / 2) * output.pitch[2] + x / 2] = v;
+	}
+}
+
+/**
+ * Initializer of a table indexed by [inputFormat][outputFormat], with an entry of func<in, out>
+ * for every pair of formats (in the order of the imageFormat enum).
+ */
+#define COLOR_CONVERSION_ROW(func, in)	{ func<in, FORMAT_RGB8>, func<in, FORMAT_BGR8>, func<in, FORMAT_RGBA8>,	\
+								  func<in, FORMAT_BGRA8>, func<in, FORMAT_GRAY8>, func<in, FORMAT_RGBA32F>,	\
+								  func<in, FORMAT_NV12>, func<in, FORMAT_I420>, func<in, FORMAT_YV12>,		\
+								  func<in, FORMAT_YUYV>, func<in, FORMAT_UYVY> }
+
+#define COLOR_CONVERSION_TABLE(func)	{ COLOR_CONVERSION_ROW(func, FORMAT_RGB8), COLOR_CONVERSION_ROW(func, FORMAT_BGR8),		\
+								  COLOR_CONVERSION_ROW(func, FORMAT_RGBA8), COLOR_CONVERSION_ROW(func, FORMAT_BGRA8),	\
+								  COLOR_CONVERSION_ROW(func, FORMAT_GRAY8), COLOR_CONVERSION_ROW(func, FORMAT_RGBA32F),	\
+								  COLOR_CONVERSION_ROW(func, FORMAT_NV12), COLOR_CONVERSION_ROW(func, FORMAT_I420),		\
+								  COLOR_CONVERSION_ROW(func, FORMAT_YV12), COLOR_CONVERSION_ROW(func, FORMAT_YUYV),		\
+								  COLOR_CONVERSION_ROW(func, FORMAT_UYVY) }
+
+///@}
+
+
+#endif
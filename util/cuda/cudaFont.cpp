@@ -0,0 +1,177 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "cudaFont.h"
+#include "cudaMappedMemory.h"
+#include "cudaOverlay.h"
+
+#include "loadImage.h"
+
+#include <math.h>
+
+
+// constructor
+cudaFont::cudaFont()
+{
+	mFontMapCPU = NULL;
+	mFontMapGPU = NULL;
+	
+	mFontMapWidth  = 0;
+	mFontMapHeight = 0;
+	
+	mFontCellSize = make_int2(24,32);
+
+	mFontTexture = 0;
+	mOverlay     = NULL;
+}
+
+
+
+// destructor
+cudaFont::~cudaFont()
+{
+	if( mOverlay != NULL )
+	{
+		delete mOverlay;
+		mOverlay = NULL;
+	}
+
+	if( mFontTexture != 0 )
+	{
+		CUDA(cudaFontTextureDestroy(mFontTexture));
+		mFontTexture = 0;
+	}
+
+	if( mFontMapCPU != NULL )
+	{
+		cudaFreeMappedPool(mFontMapCPU);
+		
+		mFontMapCPU = NULL; 
+		mFontMapGPU = NULL;
+	}
+}
+
+
+// Create
+cudaFont* cudaFont::Create( const char* bitmap_path )
+{
+	cudaFont* c = new cudaFont();
+	
+	if( !c )
+		return NULL;
+		
+	if( !c->init(bitmap_path) )
+	{
+		delete c;
+		return NULL;
+	}
+		
+	return c;
+}
+
+
+// init
+bool cudaFont::init( const char* bitmap_path )
+{
+	if( !loadImageRGBA(bitmap_path, &mFontMapCPU, &mFontMapGPU, &mFontMapWidth, &mFontMapHeight) )
+		return false;
+	
+	if( CUDA_FAILED(cudaFontTextureCreate(mFontMapGPU, mFontMapWidth, mFontMapHeight, &mFontTexture)) )
+		return false;
+
+	mOverlay = cudaOverlay::Create();
+
+	if( !mOverlay )
+		return false;
+		
+	return true;
+}
+
+
+// GetGlyph
+bool cudaFont::GetGlyph( char c, short2* cell ) const
+{
+	if( c < 32 || c > 126 || !cell )
+		return false;
+
+	const uint32_t cellsPerRow = mFontMapWidth / mFontCellSize.x;
+
+	c -= 32;
+
+	const uint32_t font_y = c / cellsPerRow;
+	const uint32_t font_x = c - (font_y * cellsPerRow);
+
+	*cell = make_short2(font_x * (mFontCellSize.x + 1), font_y * (mFontCellSize.y + 1));
+	return true;
+}
+
+
+// GetTextExtents
+int2 cudaFont::GetTextExtents( const char* str, float scale ) const
+{
+	int numGlyphs = 0;
+	short2 cell;
+
+	for( const char* c=str; c != NULL && *c != '\0'; c++ )
+	{
+		if( GetGlyph(*c, &cell) )
+			numGlyphs++;
+	}
+
+	if( numGlyphs == 0 )
+		return make_int2(0, 0);
+
+	return make_int2(ceilf(numGlyphs * mFontCellSize.x * scale), ceilf(mFontCellSize.y * scale));
+}
+
+
+// AddText
+bool cudaFont::AddText( const char* str, int x, int y, const float4& color, float scale, const float4& background )
+{
+	return mOverlay->AddText(this, str, x, y, color, scale, background);
+}
+
+
+// RenderText
+bool cudaFont::RenderText( float4* input, float4* output, uint32_t width, uint32_t height )
+{
+	return mOverlay->Render(input, output, width, height);
+}
+
+
+// ClearText
+void cudaFont::ClearText()
+{
+	mOverlay->Clear();
+}
+
+
+// RenderOverlay
+bool cudaFont::RenderOverlay( float4* input, float4* output, uint32_t width, uint32_t height, const std::vector< std::pair< std::string, int2 > >& text, const float4& color )
+{
+	if( !input || !output || width == 0 || height == 0 || text.size() == 0 )
+		return false;
+	
+	// anything already queued is drawn along with this text
+	const uint32_t numText = text.size();
+	
+	for( uint32_t t=0; t < numText; t++ )
+		AddText(text[t].first.c_str(), text[t].second.x, text[t].second.y, color);
+
+	return RenderText(input, output, width, height);
+}
+
+
+bool cudaFont::RenderOverlay( float4* input, float4* output, uint32_t width, uint32_t height, 
+							  const char* str, int x, int y, const float4& color )
+{
+	if( !str )
+		return false;
+		
+	std::vector< std::pair< std::string, int2 > > list;
+	
+	list.push_back( std::pair< std::string, int2 >( str, make_int2(x,y) ));
+	
+	return RenderOverlay(input, output, width, height, list, color);
+}
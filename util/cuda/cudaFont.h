@@ -11,8 +11,15 @@
 #include <vector>
 
 
+class cudaOverlay;
+
+
 /**
- * Font overlay rendering using CUDA
+ * Font overlay rendering using CUDA.
+ *
+ * Text can be drawn right away with RenderOverlay(), or queued from anywhere with AddText()
+ * and drawn all at once by RenderText() -- e.g. the labels of every detection in a frame,
+ * with one kernel launch at the end of the frame.  The font map is kept in a texture.
  * @ingroup util
  */
 class cudaFont
@@ -29,7 +36,7 @@ public:
 	~cudaFont();
 	
 	/**
-	 * Draw font overlay onto image
+	 * Draw font overlay onto image (the input is copied to the output first if they differ)
 	 */
 	bool RenderOverlay( float4* input, float4* output, uint32_t width, uint32_t height, 
 						const char* str, int x, int y, const float4& color=make_float4(0, 0, 0, 255));
@@ -40,6 +47,57 @@ public:
 	bool RenderOverlay( float4* input, float4* output, uint32_t width, uint32_t height, 
 						const std::vector< std::pair< std::string, int2 > >& text,
 						const float4& color=make_float4(0.0f, 0.0f, 0.0f, 255.0f));
+
+	/**
+	 * Queue a string to be drawn by RenderText(), with its top-left corner at (x, y).
+	 * Strings accumulate across calls until they're all drawn with one kernel launch.
+	 * @param scale size of the text relative to the font map (1 draws each glyph at its cell size)
+	 * @param background color of a box filled behind the text, or alpha 0 for none
+	 */
+	bool AddText( const char* str, int x, int y, const float4& color=make_float4(0.0f, 0.0f, 0.0f, 255.0f),
+			    float scale=1.0f, const float4& background=make_float4(0.0f, 0.0f, 0.0f, 0.0f) );
+
+	/**
+	 * Draw the text queued with AddText() onto an image, and clear the queue.
+	 * The input is copied to the output first if they differ.
+	 */
+	bool RenderText( float4* input, float4* output, uint32_t width, uint32_t height );
+
+	/**
+	 * Discard the text queued with AddText().
+	 */
+	void ClearText();
+
+	/**
+	 * Retrieve the size in pixels of a string drawn at the given scale.
+	 */
+	int2 GetTextExtents( const char* str, float scale=1.0f ) const;
+
+	/**
+	 * Retrieve the (u, v) of a character's cell in the font map.
+	 * @returns false if the character isn't in the font
+	 */
+	bool GetGlyph( char c, short2* cell ) const;
+
+	/**
+	 * Retrieve the RGBA font map in CUDA memory
+	 */
+	inline float4* GetFontMap() const			{ return mFontMapGPU; }
+
+	/**
+	 * Retrieve the width of the font map
+	 */
+	inline int GetFontMapWidth() const			{ return mFontMapWidth; }
+
+	/**
+	 * Retrieve the size of each character's cell
+	 */
+	inline int2 GetCellSize() const			{ return mFontCellSize; }
+
+	/**
+	 * Retrieve the texture object reading the font map (0 in CPU_ONLY builds)
+	 */
+	inline cudaTextureObject_t GetTexture() const	{ return mFontTexture; }
 	
 protected:
 	cudaFont();
@@ -51,12 +109,24 @@ protected:
 	int mFontMapWidth;
 	int mFontMapHeight;
 	int2 mFontCellSize;
-	
-	short4* mCommandCPU;
-	short4* mCommandGPU;
-	int     mCmdEntries;
-	
-	static const uint32_t MaxCommands = 1024;
+
+	cudaTextureObject_t mFontTexture;
+	cudaOverlay*        mOverlay;		// the queued text
 };
 
+
+/**
+ * Copy a font map into a CUDA array, and create a (point sampled) texture object reading it,
+ * so glyphs are fetched through the texture cache.  Used by cudaFont.
+ * @ingroup util
+ */
+cudaError_t cudaFontTextureCreate( float4* fontMap, size_t width, size_t height, cudaTextureObject_t* texture );
+
+
+/**
+ * Destroy a texture object from cudaFontTextureCreate(), and free its array.
+ * @ingroup util
+ */
+cudaError_t cudaFontTextureDestroy( cudaTextureObject_t texture );
+
 #endif
@@ -0,0 +1,223 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "cudaMappedPool.h"
+
+
+// constructor
+cudaMappedPool::cudaMappedPool()
+{
+	mMaxCached = DefaultMaxCachedBytes;
+	memset(&mStats, 0, sizeof(Stats));
+}
+
+
+// destructor
+cudaMappedPool::~cudaMappedPool()
+{
+	Trim();
+
+	for( std::map<void*,Buffer>::iterator iter = mOutstanding.begin(); iter != mOutstanding.end(); iter++ )
+		CUDA(cudaFreeHost(iter->first));
+}
+
+
+// Create
+cudaMappedPool* cudaMappedPool::Create( size_t maxCachedBytes )
+{
+	cudaMappedPool* pool = new cudaMappedPool();
+
+	if( !pool )
+		return NULL;
+
+	pool->mMaxCached = maxCachedBytes;
+	return pool;
+}
+
+
+// Default
+cudaMappedPool* cudaMappedPool::Default()
+{
+	// intentionally never deleted, so buffers aren't freed after CUDA shuts down at exit
+	static cudaMappedPool* pool = Create();
+	return pool;
+}
+
+
+// SizeClass
+size_t cudaMappedPool::SizeClass( size_t size )
+{
+	const size_t minSize = 4096;
+
+	if( size <= minSize )
+		return minSize;
+
+	// find the power-of-two below the size, and round up to a quarter of it
+	size_t pow2 = minSize;
+
+	while( pow2 * 2 < size )
+		pow2 *= 2;
+
+	const size_t step = pow2 / 4;
+	return ((size + step - 1) / step) * step;
+}
+
+
+// Alloc
+bool cudaMappedPool::Alloc( void** cpuPtr, void** gpuPtr, size_t size )
+{
+	if( !cpuPtr || !gpuPtr || size == 0 )
+		return false;
+
+	const size_t classSize = SizeClass(size);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	// look for a cached buffer of the same class
+	for( std::list<Buffer>::iterator iter = mCached.begin(); iter != mCached.end(); iter++ )
+	{
+		if( iter->size != classSize )
+			continue;
+
+		const Buffer buffer = *iter;
+		mCached.erase(iter);
+
+		mStats.hits++;
+		mStats.cached    -= buffer.size;
+		mStats.allocated += buffer.size;
+
+		mOutstanding[buffer.cpu] = buffer;
+
+		*cpuPtr = buffer.cpu;
+		*gpuPtr = buffer.gpu;
+		return true;
+	}
+
+	// allocate a new buffer
+	Buffer buffer;
+
+	buffer.cpu  = NULL;
+	buffer.gpu  = NULL;
+	buffer.size = classSize;
+
+	if( CUDA_FAILED(cudaHostAlloc(&buffer.cpu, classSize, cudaHostAllocMapped)) )
+	{
+		// release what's cached and try once more before giving up
+		evict(0);
+
+		if( CUDA_FAILED(cudaHostAlloc(&buffer.cpu, classSize, cudaHostAllocMapped)) )
+			return false;
+	}
+
+	if( CUDA_FAILED(cudaHostGetDevicePointer(&buffer.gpu, buffer.cpu, 0)) )
+	{
+		CUDA(cudaFreeHost(buffer.cpu));
+		return false;
+	}
+
+	mStats.misses++;
+	mStats.allocated += buffer.size;
+
+	if( mStats.allocated + mStats.cached > mStats.peak )
+		mStats.peak = mStats.allocated + mStats.cached;
+
+	mOutstanding[buffer.cpu] = buffer;
+
+	*cpuPtr = buffer.cpu;
+	*gpuPtr = buffer.gpu;
+	return true;
+}
+
+
+// Free
+bool cudaMappedPool::Free( void* cpuPtr )
+{
+	if( !cpuPtr )
+		return false;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::map<void*,Buffer>::iterator iter = mOutstanding.find(cpuPtr);
+
+	if( iter == mOutstanding.end() )
+	{
+		printf(LOG_CUDA "cudaMappedPool -- %p was not allocated from this pool\n", cpuPtr);
+		return false;
+	}
+
+	const Buffer buffer = iter->second;
+	mOutstanding.erase(iter);
+
+	mStats.allocated -= buffer.size;
+
+	if( buffer.size > mMaxCached )
+	{
+		CUDA(cudaFreeHost(buffer.cpu));
+		mStats.evictions++;
+		return true;
+	}
+
+	evict(mMaxCached - buffer.size);
+
+	mCached.push_front(buffer);
+	mStats.cached += buffer.size;
+	return true;
+}
+
+
+// evict (expects the mutex to be held)
+void cudaMappedPool::evict( size_t maxBytes )
+{
+	while( mStats.cached > maxBytes && mCached.size() > 0 )
+	{
+		const Buffer buffer = mCached.back();
+		mCached.pop_back();
+
+		CUDA(cudaFreeHost(buffer.cpu));
+
+		mStats.cached -= buffer.size;
+		mStats.evictions++;
+	}
+}
+
+
+// Trim
+void cudaMappedPool::Trim()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	evict(0);
+}
+
+
+// SetMaxCachedBytes
+void cudaMappedPool::SetMaxCachedBytes( size_t bytes )
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mMaxCached = bytes;
+	evict(bytes);
+}
+
+
+// GetStats
+cudaMappedPool::Stats cudaMappedPool::GetStats()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+
+// PrintStats
+void cudaMappedPool::PrintStats()
+{
+	const Stats stats = GetStats();
+	const uint64_t total = stats.hits + stats.misses;
+
+	printf(LOG_CUDA "cudaMappedPool -- %llu allocations, %llu hits, %llu misses (%.1f%% hit rate), %llu evictions\n",
+		  (unsigned long long)total, (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+		  (total > 0) ? (stats.hits * 100.0 / total) : 0.0, (unsigned long long)stats.evictions);
+
+	printf(LOG_CUDA "cudaMappedPool -- %zu bytes allocated, %zu bytes cached, %zu bytes peak\n",
+		  stats.allocated, stats.cached, stats.peak);
+}
@@ -0,0 +1,141 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __CUDA_MAPPED_POOL_H_
+#define __CUDA_MAPPED_POOL_H_
+
+
+#include "cudaUtility.h"
+
+#include <list>
+#include <map>
+#include <mutex>
+
+
+/**
+ * Pool of ZeroCopy mapped buffers that are reused by size class, to avoid
+ * calling cudaHostAlloc()/cudaFreeHost() for every image that gets loaded.
+ *
+ * Requested sizes are rounded up to a size class (4 classes per power-of-two),
+ * and buffers released back to the pool are kept for reuse until the cached
+ * bytes exceed the pool's limit, at which point the least recently released
+ * buffers are freed.  Unlike cudaAllocMapped(), buffers are not zero-filled.
+ *
+ * @ingroup util
+ */
+class cudaMappedPool
+{
+public:
+	/**
+	 * Pool statistics
+	 */
+	struct Stats
+	{
+		uint64_t hits;			/**< allocations served from the cache */
+		uint64_t misses;		/**< allocations that required cudaHostAlloc() */
+		uint64_t evictions;		/**< cached buffers freed to stay under the limit */
+		size_t   allocated;		/**< bytes currently handed out to the user */
+		size_t   cached;		/**< bytes currently held in the cache */
+		size_t   peak;			/**< maximum of allocated + cached */
+	};
+
+	/**
+	 * Create a new pool.
+	 * @param maxCachedBytes limit on the bytes kept cached for reuse (outstanding buffers don't count)
+	 */
+	static cudaMappedPool* Create( size_t maxCachedBytes=DefaultMaxCachedBytes );
+
+	/**
+	 * Retrieve the process-wide pool used by the image loaders.
+	 */
+	static cudaMappedPool* Default();
+
+	/**
+	 * Destroy the pool, freeing cached buffers.  Buffers still outstanding are freed too.
+	 */
+	~cudaMappedPool();
+
+	/**
+	 * Allocate a mapped buffer of at least the requested size.
+	 */
+	bool Alloc( void** cpuPtr, void** gpuPtr, size_t size );
+
+	/**
+	 * Release a buffer (by its CPU pointer) that was allocated from this pool.
+	 */
+	bool Free( void* cpuPtr );
+
+	/**
+	 * Free all of the cached buffers that aren't in use.
+	 */
+	void Trim();
+
+	/**
+	 * Set the limit on cached bytes, evicting buffers if it's now exceeded.
+	 */
+	void SetMaxCachedBytes( size_t bytes );
+
+	/**
+	 * Retrieve the current statistics.
+	 */
+	Stats GetStats();
+
+	/**
+	 * Print the statistics to stdout.
+	 */
+	void PrintStats();
+
+	/**
+	 * Round a requested size up to its size class.
+	 */
+	static size_t SizeClass( size_t size );
+
+	/**
+	 * Default limit on cached bytes (128MB)
+	 */
+	static const size_t DefaultMaxCachedBytes = 128 * 1024 * 1024;
+
+protected:
+	cudaMappedPool();
+
+	struct Buffer
+	{
+		void*  cpu;
+		void*  gpu;
+		size_t size;
+	};
+
+	void evict( size_t maxBytes );
+
+	std::list<Buffer>      mCached;		// most recently released at the front
+	std::map<void*,Buffer> mOutstanding;
+	std::mutex             mMutex;
+
+	size_t mMaxCached;
+	Stats  mStats;
+};
+
+
+/**
+ * Allocate ZeroCopy mapped memory from the default pool.
+ * Release it with cudaFreeMappedPool().
+ * @ingroup util
+ */
+inline bool cudaAllocMappedPool( void** cpuPtr, void** gpuPtr, size_t size )
+{
+	return cudaMappedPool::Default()->Alloc(cpuPtr, gpuPtr, size);
+}
+
+
+/**
+ * Release memory from cudaAllocMappedPool() back to the default pool.
+ * @ingroup util
+ */
+inline bool cudaFreeMappedPool( void* cpuPtr )
+{
+	return cudaMappedPool::Default()->Free(cpuPtr);
+}
+
+
+#endif
@@ -48,6 +48,42 @@ cudaError_t cudaNormalizeRGBA( float4* input, const float2& input_range,
 }
 
 
+// gpuNormalizeToRGBA8
+__global__ void gpuNormalizeToRGBA8( float4* input, uchar4* output, int width, int height, float offset, float scaling_factor )
+{
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if( x >= width || y >= height )
+		return;
+
+	const float4 px = input[ y * width + x ];
+
+	#define pack(v) (unsigned char)fminf(fmaxf((v - offset) * scaling_factor + 0.5f, 0.0f), 255.0f)
+
+	output[y*width+x] = make_uchar4(pack(px.x), pack(px.y), pack(px.z), pack(px.w));
+
+	#undef pack
+}
+
 
+// cudaNormalizeToRGBA8
+cudaError_t cudaNormalizeToRGBA8( float4* input, const float2& input_range,
+						    uchar4* output, size_t width, size_t height )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( width == 0 || height == 0 || input_range.y <= input_range.x )
+		return cudaErrorInvalidValue;
+
+	const float multiplier = 255.0f / (input_range.y - input_range.x);
 
+	// launch kernel
+	const dim3 blockDim(8, 8);
+	const dim3 gridDim(iDivUp(width,blockDim.x), iDivUp(height,blockDim.y));
 
+	gpuNormalizeToRGBA8<<<gridDim, blockDim>>>(input, output, width, height, input_range.x, multiplier);
+
+	return CUDA(cudaGetLastError());
+}
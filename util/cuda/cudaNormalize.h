@@ -18,5 +18,15 @@ cudaError_t cudaNormalizeRGBA( float4* input,  const float2& input_range,
 						 float4* output, const float2& output_range,
 						 size_t  width,  size_t height );
 
+
+/**
+ * Rescale the pixel intensities of a float4 RGBA image from input_range to 0-255 and pack
+ * them into 8-bit RGBA, for uploading to an RGBA8 texture (a quarter of the size of float4).
+ * Values outside of the range are clamped.
+ * @ingroup util
+ */
+cudaError_t cudaNormalizeToRGBA8( float4* input, const float2& input_range,
+						    uchar4* output, size_t width, size_t height );
+
 #endif
 
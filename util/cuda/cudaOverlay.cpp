@@ -0,0 +1,360 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "cudaOverlay.h"
+#include "cudaMappedMemory.h"
+#include "cudaFont.h"
+
+#include <math.h>
+#include <string.h>
+
+
+// constructor
+cudaOverlay::cudaOverlay()
+{
+	mPrimitivesCPU  = NULL;
+	mPrimitivesGPU  = NULL;
+	mTilesCPU       = NULL;
+	mTilesGPU       = NULL;
+	mIndicesCPU     = NULL;
+	mIndicesGPU     = NULL;
+	mPrimitivesSize = 0;
+	mTilesSize      = 0;
+	mIndicesSize    = 0;
+	mFont           = NULL;
+	mRendered       = NULL;
+}
+
+
+// destructor
+cudaOverlay::~cudaOverlay()
+{
+	if( mRendered != NULL )
+	{
+		CUDA(cudaEventSynchronize(mRendered));
+		CUDA(cudaEventDestroy(mRendered));
+		mRendered = NULL;
+	}
+
+	if( mPrimitivesCPU != NULL )
+		CUDA(cudaFreeHost(mPrimitivesCPU));
+
+	if( mTilesCPU != NULL )
+		CUDA(cudaFreeHost(mTilesCPU));
+
+	if( mIndicesCPU != NULL )
+		CUDA(cudaFreeHost(mIndicesCPU));
+}
+
+
+// Create
+cudaOverlay* cudaOverlay::Create( uint32_t maxPrimitives )
+{
+	cudaOverlay* overlay = new cudaOverlay();
+
+	if( !overlay )
+		return NULL;
+
+	if( !overlay->init(maxPrimitives) )
+	{
+		printf("cudaOverlay -- failed to initialize\n");
+		delete overlay;
+		return NULL;
+	}
+
+	return overlay;
+}
+
+
+// init
+bool cudaOverlay::init( uint32_t maxPrimitives )
+{
+	if( maxPrimitives == 0 )
+		maxPrimitives = 1;
+
+	mPrimitives.reserve(maxPrimitives);
+
+	if( CUDA_FAILED(cudaEventCreateWithFlags(&mRendered, cudaEventDisableTiming)) )
+		return false;
+
+	if( !reserve((void**)&mPrimitivesCPU, (void**)&mPrimitivesGPU, &mPrimitivesSize, maxPrimitives * sizeof(overlayPrimitive)) )
+		return false;
+
+	return true;
+}
+
+
+// reserve
+bool cudaOverlay::reserve( void** cpu, void** gpu, size_t* capacity, size_t size )
+{
+	if( size <= *capacity )
+		return true;
+
+	// grow by half again, so a few more boxes next frame don't reallocate again
+	size += size / 2;
+
+	if( *cpu != NULL )
+	{
+		CUDA(cudaFreeHost(*cpu));
+
+		*cpu      = NULL;
+		*gpu      = NULL;
+		*capacity = 0;
+	}
+
+	if( !cudaAllocMapped(cpu, gpu, size) )
+		return false;
+
+	*capacity = size;
+	return true;
+}
+
+
+// AddBox
+void cudaOverlay::AddBox( const float4& rect, const float4& color, float thickness )
+{
+	overlayPrimitive p;
+
+	p.rect      = rect;
+	p.color     = color;
+	p.thickness = thickness;
+	p.scale     = 1.0f;
+	p.type      = OVERLAY_BOX;
+
+	mPrimitives.push_back(p);
+}
+
+
+// AddBoxes
+void cudaOverlay::AddBoxes( const float* boundingBoxes, int numBoxes, const float4& color, float thickness )
+{
+	if( !boundingBoxes )
+		return;
+
+	for( int n=0; n < numBoxes; n++ )
+	{
+		const float* bb = boundingBoxes + n * 4;
+		AddBox(make_float4(bb[0], bb[1], bb[2], bb[3]), color, thickness);
+	}
+}
+
+
+// AddText
+bool cudaOverlay::AddText( cudaFont* font, const char* str, int x, int y, const float4& color, float scale, const float4& background )
+{
+	if( !font || !str || scale <= 0.0f )
+		return false;
+
+	if( mFont != NULL && mFont != font )
+	{
+		printf("cudaOverlay -- text from a different font is already queued, Render() it first\n");
+		return false;
+	}
+
+	mFont = font;
+
+	// the background goes under the glyphs, so it's queued first
+	if( background.w > 0.0f )
+	{
+		const int2 extents = font->GetTextExtents(str, scale);
+
+		if( extents.x > 0 )
+			AddBox(make_float4(x, y, x + extents.x - 1, y + extents.y - 1), background);
+	}
+
+	const float advance = font->GetCellSize().x * scale;
+
+	float pos = x;
+
+	for( const char* c=str; *c != '\0'; c++ )
+	{
+		short2 cell;
+
+		if( !font->GetGlyph(*c, &cell) )
+			continue;
+
+		overlayPrimitive p;
+
+		p.rect      = make_float4(pos, y, cell.x, cell.y);
+		p.color     = color;
+		p.thickness = 0.0f;
+		p.scale     = scale;
+		p.type      = OVERLAY_GLYPH;
+
+		mPrimitives.push_back(p);
+		pos += advance;
+	}
+
+	return true;
+}
+
+
+// Clear
+void cudaOverlay::Clear()
+{
+	mPrimitives.clear();
+	mFont = NULL;
+}
+
+
+// bin
+void cudaOverlay::bin( uint32_t index, uint32_t width, uint32_t height )
+{
+	const overlayPrimitive& p = mPrimitives[index];
+
+	float4 r = p.rect;
+
+	if( p.type == OVERLAY_GLYPH )
+	{
+		const int2 cellSize = mFont->GetCellSize();
+
+		r.z = r.x + ceilf(cellSize.x * p.scale) - 1;
+		r.w = r.y + ceilf(cellSize.y * p.scale) - 1;
+	}
+
+	// the pixels covered, clipped to the image
+	const int x0 = fmaxf(ceilf(r.x), 0.0f);
+	const int y0 = fmaxf(ceilf(r.y), 0.0f);
+	const int x1 = fminf(floorf(r.z), width - 1);
+	const int y1 = fminf(floorf(r.w), height - 1);
+
+	if( x0 > x1 || y0 > y1 )
+		return;
+
+	// the range of tiles entirely inside an outline, which aren't drawn in (empty for fills)
+	const bool hollow = (p.type == OVERLAY_BOX && p.thickness > 0.0f);
+
+	int innerX0 = -1, innerX1 = -2;
+	int innerY0 = -1, innerY1 = -2;
+
+	if( hollow )
+	{
+		const int ix0 = fmaxf(ceilf(r.x + p.thickness), 0.0f);
+		const int iy0 = fmaxf(ceilf(r.y + p.thickness), 0.0f);
+		const int ix1 = floorf(r.z - p.thickness);
+		const int iy1 = floorf(r.w - p.thickness);
+
+		if( ix1 >= ix0 && iy1 >= iy0 )
+		{
+			innerX0 = iDivUp(ix0, OVERLAY_TILE_SIZE);
+			innerY0 = iDivUp(iy0, OVERLAY_TILE_SIZE);
+			innerX1 = (ix1 + 1) / OVERLAY_TILE_SIZE - 1;
+			innerY1 = (iy1 + 1) / OVERLAY_TILE_SIZE - 1;
+		}
+	}
+
+	const uint32_t tilesX = iDivUp(width, OVERLAY_TILE_SIZE);
+
+	for( int ty=y0 / OVERLAY_TILE_SIZE; ty <= y1 / OVERLAY_TILE_SIZE; ty++ )
+	{
+		const bool innerRow = (ty >= innerY0 && ty <= innerY1);
+
+		for( int tx=x0 / OVERLAY_TILE_SIZE; tx <= x1 / OVERLAY_TILE_SIZE; tx++ )
+		{
+			if( innerRow && tx >= innerX0 && tx <= innerX1 )
+			{
+				tx = innerX1;	// skip to the right edge
+				continue;
+			}
+
+			const uint32_t tile = ty * tilesX + tx;
+
+			mBinned.push_back(make_uint2(tile, index));
+			mTileCount[tile]++;
+		}
+	}
+}
+
+
+// Render
+bool cudaOverlay::Render( float4* input, float4* output, uint32_t width, uint32_t height )
+{
+	if( !input || !output || width == 0 || height == 0 )
+	{
+		Clear();
+		return false;
+	}
+
+	if( input != output )
+	{
+		if( CUDA_FAILED(cudaMemcpyAsync(output, input, width * height * sizeof(float4), cudaMemcpyDeviceToDevice)) )
+		{
+			Clear();
+			return false;
+		}
+	}
+
+	const uint32_t numPrimitives = mPrimitives.size();
+
+	if( numPrimitives == 0 )
+		return true;
+
+	// bin the primitives into tiles, keeping the order they were added in within each tile
+	const uint32_t tilesX = iDivUp(width, OVERLAY_TILE_SIZE);
+	const uint32_t tilesY = iDivUp(height, OVERLAY_TILE_SIZE);
+
+	mBinned.clear();
+	mTileCount.assign(tilesX * tilesY, 0);
+
+	for( uint32_t n=0; n < numPrimitives; n++ )
+		bin(n, width, height);
+
+	const uint32_t numIndices = mBinned.size();
+
+	uint32_t numTiles = 0;
+
+	for( uint32_t n=0; n < mTileCount.size(); n++ )
+	{
+		if( mTileCount[n] > 0 )
+			numTiles++;
+	}
+
+	// the previous frame's launch may still be reading the buffers
+	CUDA(cudaEventSynchronize(mRendered));
+
+	if( !reserve((void**)&mPrimitivesCPU, (void**)&mPrimitivesGPU, &mPrimitivesSize, numPrimitives * sizeof(overlayPrimitive)) ||
+	    !reserve((void**)&mTilesCPU, (void**)&mTilesGPU, &mTilesSize, numTiles * sizeof(int4)) ||
+	    !reserve((void**)&mIndicesCPU, (void**)&mIndicesGPU, &mIndicesSize, numIndices * sizeof(uint32_t)) )
+	{
+		printf("cudaOverlay -- failed to allocate memory for %u primitives\n", numPrimitives);
+		Clear();
+		return false;
+	}
+
+	memcpy(mPrimitivesCPU, mPrimitives.data(), numPrimitives * sizeof(overlayPrimitive));
+
+	// lay out the tiles, turning the counts into each tile's offset in the indices
+	uint32_t tile   = 0;
+	uint32_t offset = 0;
+
+	for( uint32_t n=0; n < mTileCount.size(); n++ )
+	{
+		const uint32_t count = mTileCount[n];
+
+		if( count == 0 )
+			continue;
+
+		mTilesCPU[tile++] = make_int4((n % tilesX) * OVERLAY_TILE_SIZE, (n / tilesX) * OVERLAY_TILE_SIZE, offset, count);
+		mTileCount[n] = offset;
+		offset += count;
+	}
+
+	for( uint32_t n=0; n < numIndices; n++ )
+		mIndicesCPU[mTileCount[mBinned[n].x]++] = mBinned[n].y;
+
+	// draw everything in one launch
+	float4* font      = mFont != NULL ? mFont->GetFontMap() : NULL;
+	int     fontWidth = mFont != NULL ? mFont->GetFontMapWidth() : 0;
+	int2    cellSize  = mFont != NULL ? mFont->GetCellSize() : make_int2(0,0);
+
+	const cudaTextureObject_t fontTexture = mFont != NULL ? mFont->GetTexture() : 0;
+
+	Clear();
+
+	if( CUDA_FAILED(cudaOverlayTiles(output, width, height, mPrimitivesGPU, mTilesGPU, numTiles, mIndicesGPU, font, fontWidth, cellSize, fontTexture)) )
+		return false;
+
+	CUDA(cudaEventRecord(mRendered));
+	return true;
+}
@@ -66,3 +66,67 @@ cudaError_t cudaRectOutlineOverlay( float4* input, float4* output, uint32_t widt
 
 	return cudaGetLastError();
 }
+
+
+// overlayFontTexture
+struct overlayFontTexture
+{
+	cudaTextureObject_t texture;
+
+	inline __device__ float4 operator()( int u, int v ) const		{ return tex2D<float4>(texture, u + 0.5f, v + 0.5f); }
+};
+
+
+// gpuOverlayTiles
+template<typename Font>
+__global__ void gpuOverlayTiles( float4* output, int width, int height,
+						   overlayPrimitive* primitives, int4* tiles, uint32_t* indices,
+						   Font font, int2 fontCellSize )
+{
+	const int4 tile = tiles[blockIdx.x];
+
+	const int x = tile.x + threadIdx.x;
+	const int y = tile.y + threadIdx.y;
+
+	if( x >= width || y >= height )
+		return;
+
+	// each pixel is read and written once, with the tile's primitives blended in order
+	float4 px = output[y * width + x];
+
+	for( int n=0; n < tile.w; n++ )
+		px = overlayBlend(primitives[indices[tile.z + n]], px, x, y, font, fontCellSize);
+
+	output[y * width + x] = px;
+}
+
+
+// cudaOverlayTiles
+cudaError_t cudaOverlayTiles( float4* output, uint32_t width, uint32_t height,
+					     overlayPrimitive* primitives, int4* tiles, uint32_t numTiles, uint32_t* indices,
+					     float4* font, size_t fontMapWidth, const int2& fontCellSize,
+					     cudaTextureObject_t fontTexture )
+{
+	if( numTiles == 0 )
+		return cudaSuccess;
+
+	if( !output || width == 0 || height == 0 || !primitives || !tiles || !indices )
+		return cudaErrorInvalidValue;
+
+	// launch one block per tile that's drawn in
+	const dim3 blockDim(OVERLAY_TILE_SIZE, OVERLAY_TILE_SIZE);
+	const dim3 gridDim(numTiles);
+
+	if( fontTexture != 0 )
+	{
+		const overlayFontTexture fontTex = { fontTexture };
+		gpuOverlayTiles<<<gridDim, blockDim>>>(output, width, height, primitives, tiles, indices, fontTex, fontCellSize);
+	}
+	else
+	{
+		const overlayFontMap fontMap = { font, (int)fontMapWidth };
+		gpuOverlayTiles<<<gridDim, blockDim>>>(output, width, height, primitives, tiles, indices, fontMap, fontCellSize);
+	}
+
+	return cudaGetLastError();
+}
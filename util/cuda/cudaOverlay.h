@@ -7,9 +7,211 @@
 
 #include "cudaUtility.h"
 
+#include <math.h>
+#include <vector>
+
+
+class cudaFont;
+
+
+/**
+ * Size in pixels of the (square) tiles that cudaOverlay bins primitives into.
+ * @ingroup util
+ */
+#define OVERLAY_TILE_SIZE 16
+
+
+/**
+ * A box or glyph drawn by cudaOverlay.
+ * @ingroup util
+ */
+struct overlayPrimitive
+{
+	float4 rect;		/**< box:  left, top, right, bottom (pixels).  glyph:  x, y in the image and u, v of its cell in the font map */
+	float4 color;		/**< RGBA color, with alpha in 0-255 (for glyphs it's multiplied with the font map) */
+	float  thickness;	/**< width of a box's outline in pixels, or 0 to fill the box */
+	float  scale;		/**< size of a glyph relative to its cell in the font map */
+	int    type;		/**< OVERLAY_BOX or OVERLAY_GLYPH */
+};
+
+#define OVERLAY_BOX   0
+#define OVERLAY_GLYPH 1
+
+
+/**
+ * Reads texels of a font map from memory (the kernel reads them through a texture object instead).
+ * @ingroup util
+ */
+struct overlayFontMap
+{
+	const float4* map;
+	int           width;
+
+	inline __host__ __device__ float4 operator()( int u, int v ) const		{ return map[v * width + u]; }
+};
+
+
+/**
+ * Blend a primitive over pixel (x, y) if it covers it (shared by the kernel and the CPU version).
+ * Font is a functor returning the font map's texel at (u, v), like overlayFontMap.
+ * @ingroup util
+ */
+template<typename Font>
+inline __host__ __device__ float4 overlayBlend( const overlayPrimitive& p, float4 px, int x, int y,
+								        const Font& font, const int2& fontCellSize )
+{
+	const float4 r = p.rect;
+
+	if( p.type == OVERLAY_GLYPH )
+	{
+		// nearest texel of the glyph's cell
+		const int u = floorf((x - r.x) / p.scale);
+		const int v = floorf((y - r.y) / p.scale);
+
+		if( u < 0 || v < 0 || u >= fontCellSize.x || v >= fontCellSize.y )
+			return px;
+
+		const float4 f = font((int)r.z + u, (int)r.w + v);
+
+		const float alpha = f.w * p.color.w / (255.0f * 255.0f);
+		const float ialph = 1.0f - alpha;
+
+		px.x = alpha * f.x * p.color.x / 255.0f + ialph * px.x;
+		px.y = alpha * f.y * p.color.y / 255.0f + ialph * px.y;
+		px.z = alpha * f.z * p.color.z / 255.0f + ialph * px.z;
+		return px;
+	}
+
+	const float fx = x;
+	const float fy = y;
+
+	if( fx < r.x || fx > r.z || fy < r.y || fy > r.w )
+		return px;
+
+	// the inside of an outline
+	const float t = p.thickness;
+
+	if( t > 0.0f && fx >= r.x + t && fx <= r.z - t && fy >= r.y + t && fy <= r.w - t )
+		return px;
+
+	const float alpha = p.color.w / 255.0f;
+	const float ialph = 1.0f - alpha;
+
+	px.x = alpha * p.color.x + ialph * px.x;
+	px.y = alpha * p.color.y + ialph * px.y;
+	px.z = alpha * p.color.z + ialph * px.z;
+	return px;
+}
+
+
+/**
+ * Blend the primitives binned into tiles over an image, in place.  Each entry of tiles is
+ * (x, y) of the tile in the image, then the offset and count of its primitives in indices.
+ * Within a tile the primitives are blended in the order they're listed.  Glyphs are read
+ * through fontTexture if it isn't 0 (see cudaFontTextureCreate()), otherwise from font.
+ * Used by cudaOverlay.
+ * @ingroup util
+ */
+cudaError_t cudaOverlayTiles( float4* output, uint32_t width, uint32_t height,
+					     overlayPrimitive* primitives, int4* tiles, uint32_t numTiles, uint32_t* indices,
+					     float4* font, size_t fontMapWidth, const int2& fontCellSize,
+					     cudaTextureObject_t fontTexture=0 );
+
+
+/**
+ * Renders bounding boxes (filled or outlined, each with its own color) and text labels in one
+ * kernel launch.  Primitives are queued with the Add functions, then drawn by Render().
+ *
+ * Render() bins the primitives into OVERLAY_TILE_SIZE tiles on the CPU, and only the tiles
+ * that something is drawn in are launched, with one thread per pixel blending that tile's
+ * primitives in order.  So the cost follows the area that's drawn instead of the size of
+ * the image times the number of boxes, and later primitives are always drawn on top.
+ * @ingroup util
+ */
+class cudaOverlay
+{
+public:
+	/**
+	 * Create a renderer.
+	 * @param maxPrimitives initial capacity of the queue (it grows as needed)
+	 */
+	static cudaOverlay* Create( uint32_t maxPrimitives=1024 );
+
+	/**
+	 * Destroy
+	 */
+	~cudaOverlay();
+
+	/**
+	 * Queue a box.
+	 * @param rect left, top, right, bottom (pixels)
+	 * @param color RGBA, with alpha in 0-255
+	 * @param thickness width of the outline in pixels, or 0 to fill the box
+	 */
+	void AddBox( const float4& rect, const float4& color, float thickness=0.0f );
+
+	/**
+	 * Queue boxes in the format output by detectNet::Detect(), all of one color.
+	 * @param boundingBoxes numBoxes float4 (left, top, right, bottom) boxes in CPU-accessible memory
+	 */
+	void AddBoxes( const float* boundingBoxes, int numBoxes, const float4& color, float thickness=0.0f );
+
+	/**
+	 * Queue a string rendered with the font map of a cudaFont, with its top-left corner at (x, y).
+	 * Labels from one font can be queued at a time (until Render()).
+	 * @param scale size of the text relative to the font's cells
+	 * @param background color of a box filled behind the text, or alpha 0 for none
+	 */
+	bool AddText( cudaFont* font, const char* str, int x, int y, const float4& color=make_float4(0.0f, 0.0f, 0.0f, 255.0f),
+			    float scale=1.0f, const float4& background=make_float4(0.0f, 0.0f, 0.0f, 0.0f) );
+
+	/**
+	 * Draw the queued primitives over an image and clear the queue.  If the output is a different
+	 * image than the input, the input is copied to it first.  Returns after the launch, the next
+	 * Render() waits for it to complete before refilling the buffers.
+	 */
+	bool Render( float4* input, float4* output, uint32_t width, uint32_t height );
+
+	/**
+	 * Discard the queued primitives.
+	 */
+	void Clear();
+
+	/**
+	 * Number of queued primitives.
+	 */
+	inline uint32_t GetNumPrimitives() const		{ return mPrimitives.size(); }
+
+protected:
+	cudaOverlay();
+
+	bool init( uint32_t maxPrimitives );
+	bool reserve( void** cpu, void** gpu, size_t* capacity, size_t size );
+	void bin( uint32_t index, uint32_t width, uint32_t height );
+
+	std::vector<overlayPrimitive> mPrimitives;
+	std::vector<uint2>            mBinned;		// (tile, primitive) pairs, in the order primitives were added
+	std::vector<uint32_t>         mTileCount;
+
+	overlayPrimitive* mPrimitivesCPU;
+	overlayPrimitive* mPrimitivesGPU;
+	int4*             mTilesCPU;
+	int4*             mTilesGPU;
+	uint32_t*         mIndicesCPU;
+	uint32_t*         mIndicesGPU;
+
+	size_t mPrimitivesSize;
+	size_t mTilesSize;
+	size_t mIndicesSize;
+
+	cudaFont*   mFont;
+	cudaEvent_t mRendered;
+};
+
 
 /**
- * cudaRectOutlineOverlay
+ * Blend filled rectangles over an image (every pixel is tested against every box).
+ * @see cudaOverlay for drawing outlines and many boxes efficiently.
  * @ingroup util
  */
 cudaError_t cudaRectOutlineOverlay( float4* input, float4* output, uint32_t width, uint32_t height, float4* boundingBoxes, int numBoxes, const float4& color );
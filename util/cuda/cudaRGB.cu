@@ -44,3 +44,92 @@ cudaError_t cudaRGBToRGBAf( uchar3* srcDev, float4* destDev, size_t width, size_
 	return CUDA(cudaGetLastError());
 }
 
+//-------------------------------------------------------------------------------------------------------------------------
+
+template<imageFormat format>
+__global__ void PackedToRGBAf(uint8_t* srcImage, int srcPitch,
+                              float4* dstImage,
+                              uint32_t width,   uint32_t height)
+{
+    const int x = (blockIdx.x * blockDim.x) + threadIdx.x;
+    const int y = (blockIdx.y * blockDim.y) + threadIdx.y;
+
+    if (x >= width || y >= height)
+        return;
+
+	const float3 px = imageFormatLoadRGB<format>(srcImage + y * srcPitch + x * imageFormatChannels(format));
+	
+	dstImage[y * width + x] = make_float4(px.x, px.y, px.z, 255.0f);
+}
+
+cudaError_t cudaPackedToRGBAf( void* srcDev, imageFormat format, size_t srcPitch, float4* destDev, size_t width, size_t height )
+{
+	if( !srcDev || !destDev )
+		return cudaErrorInvalidDevicePointer;
+
+	if( width == 0 || height == 0 )
+		return cudaErrorInvalidValue;
+
+	if( srcPitch == 0 )
+		srcPitch = width * imageFormatChannels(format);
+
+	const dim3 blockDim(8,8,1);
+	const dim3 gridDim(iDivUp(width,blockDim.x), iDivUp(height,blockDim.y), 1);
+
+	switch(format)
+	{
+		case FORMAT_RGB8:  PackedToRGBAf<FORMAT_RGB8><<<gridDim, blockDim>>>((uint8_t*)srcDev, srcPitch, destDev, width, height);  break;
+		case FORMAT_BGR8:  PackedToRGBAf<FORMAT_BGR8><<<gridDim, blockDim>>>((uint8_t*)srcDev, srcPitch, destDev, width, height);  break;
+		case FORMAT_RGBA8: PackedToRGBAf<FORMAT_RGBA8><<<gridDim, blockDim>>>((uint8_t*)srcDev, srcPitch, destDev, width, height); break;
+		case FORMAT_BGRA8: PackedToRGBAf<FORMAT_BGRA8><<<gridDim, blockDim>>>((uint8_t*)srcDev, srcPitch, destDev, width, height); break;
+		case FORMAT_GRAY8: PackedToRGBAf<FORMAT_GRAY8><<<gridDim, blockDim>>>((uint8_t*)srcDev, srcPitch, destDev, width, height); break;
+		default:		   return cudaErrorInvalidValue;
+	}
+	
+	return CUDA(cudaGetLastError());
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+
+template<imageFormat format>
+__global__ void PackedToRGBA8(uint8_t* srcImage, int srcPitch,
+                              uchar4* dstImage,
+                              uint32_t width,   uint32_t height)
+{
+    const int x = (blockIdx.x * blockDim.x) + threadIdx.x;
+    const int y = (blockIdx.y * blockDim.y) + threadIdx.y;
+
+    if (x >= width || y >= height)
+        return;
+
+	const float3 px = imageFormatLoadRGB<format>(srcImage + y * srcPitch + x * imageFormatChannels(format));
+	
+	dstImage[y * width + x] = make_uchar4(px.x, px.y, px.z, 255);
+}
+
+cudaError_t cudaPackedToRGBA8( void* srcDev, imageFormat format, size_t srcPitch, uchar4* destDev, size_t width, size_t height )
+{
+	if( !srcDev || !destDev )
+		return cudaErrorInvalidDevicePointer;
+
+	if( width == 0 || height == 0 )
+		return cudaErrorInvalidValue;
+
+	if( srcPitch == 0 )
+		srcPitch = width * imageFormatChannels(format);
+
+	const dim3 blockDim(8,8,1);
+	const dim3 gridDim(iDivUp(width,blockDim.x), iDivUp(height,blockDim.y), 1);
+
+	switch(format)
+	{
+		case FORMAT_RGB8:  PackedToRGBA8<FORMAT_RGB8><<<gridDim, blockDim>>>((uint8_t*)srcDev, srcPitch, destDev, width, height);  break;
+		case FORMAT_BGR8:  PackedToRGBA8<FORMAT_BGR8><<<gridDim, blockDim>>>((uint8_t*)srcDev, srcPitch, destDev, width, height);  break;
+		case FORMAT_RGBA8: PackedToRGBA8<FORMAT_RGBA8><<<gridDim, blockDim>>>((uint8_t*)srcDev, srcPitch, destDev, width, height); break;
+		case FORMAT_BGRA8: PackedToRGBA8<FORMAT_BGRA8><<<gridDim, blockDim>>>((uint8_t*)srcDev, srcPitch, destDev, width, height); break;
+		case FORMAT_GRAY8: PackedToRGBA8<FORMAT_GRAY8><<<gridDim, blockDim>>>((uint8_t*)srcDev, srcPitch, destDev, width, height); break;
+		default:		   return cudaErrorInvalidValue;
+	}
+	
+	return CUDA(cudaGetLastError());
+}
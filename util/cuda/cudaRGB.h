@@ -7,6 +7,7 @@
 
 
 #include "cudaUtility.h"
+#include "imageFormat.h"
 #include <stdint.h>
 
 
@@ -17,4 +18,20 @@
 cudaError_t cudaRGBToRGBAf( uchar3* input, float4* output, size_t width, size_t height );
 
 
+/**
+ * Convert a packed 8-bit image in any imageFormat (e.g. BGR from OpenCV) to 32-bit floating-point RGBA
+ * @param inputPitch size in bytes of each row of the input (0 if the rows are tightly packed)
+ * @ingroup util
+ */
+cudaError_t cudaPackedToRGBAf( void* input, imageFormat format, size_t inputPitch, float4* output, size_t width, size_t height );
+
+
+/**
+ * Convert a packed 8-bit image in any imageFormat to 8-bit RGBA (e.g. straight into an RGBA8 texture for display)
+ * @param inputPitch size in bytes of each row of the input (0 if the rows are tightly packed)
+ * @ingroup util
+ */
+cudaError_t cudaPackedToRGBA8( void* input, imageFormat format, size_t inputPitch, uchar4* output, size_t width, size_t height );
+
+
 #endif
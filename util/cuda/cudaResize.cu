@@ -71,6 +71,133 @@ cudaError_t cudaResizeRGBA( float4* input,  size_t inputWidth, size_t inputHeigh
 }
 
 
+//-----------------------------------------------------------------------------------
+// pitched / ROI / filtered resize
+//-----------------------------------------------------------------------------------
 
+// resizeCheckROI
+static bool resizeCheckROI( const int4& roi, size_t inputWidth, size_t inputHeight )
+{
+	return roi.x >= 0 && roi.y >= 0 && roi.z > 0 && roi.w > 0 &&
+		  roi.x + roi.z <= (int)inputWidth && roi.y + roi.w <= (int)inputHeight;
+}
+
+
+// gpuResizeROI
+template<typename T, resizeFilter filter>
+__global__ void gpuResizeROI( T* input, size_t inputPitch, int4 roi, float2 scale, T* output, size_t outputPitch, int oWidth, int oHeight )
+{
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if( x >= oWidth || y >= oHeight )
+		return;
+
+	resizeRow(output, outputPitch, y)[x] = resizeSample(input, inputPitch, roi, scale, x, y, filter);
+}
+
+
+// launchResizeROI
+template<typename T>
+static cudaError_t launchResizeROI( T* input,  size_t inputPitch,  size_t inputWidth,  size_t inputHeight,
+						      T* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
+						      resizeFilter filter, const int4* roi )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( inputWidth == 0 || outputWidth == 0 || inputHeight == 0 || outputHeight == 0 )
+		return cudaErrorInvalidValue;
+
+	const int4 region = (roi != NULL) ? *roi : make_int4(0, 0, inputWidth, inputHeight);
+
+	if( !resizeCheckROI(region, inputWidth, inputHeight) )
+		return cudaErrorInvalidValue;
+
+	const float2 scale = make_float2( float(region.z) / float(outputWidth),
+							    float(region.w) / float(outputHeight) );
+
+	// launch kernel
+	const dim3 blockDim(32, 8);
+	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
+
+	#define launchFilter(f) gpuResizeROI<T, f><<<gridDim, blockDim>>>(input, inputPitch, region, scale, output, outputPitch, outputWidth, outputHeight)
+
+	switch(filter)
+	{
+		case RESIZE_NEAREST:	launchFilter(RESIZE_NEAREST); break;
+		case RESIZE_LINEAR:		launchFilter(RESIZE_LINEAR);  break;
+		case RESIZE_AREA:		launchFilter(RESIZE_AREA);    break;
+		default:				return cudaErrorInvalidValue;
+	}
+
+	#undef launchFilter
+
+	return CUDA(cudaGetLastError());
+}
 
 
+// cudaResize
+cudaError_t cudaResize( float* input,  size_t inputPitch,  size_t inputWidth,  size_t inputHeight,
+				    float* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
+				    resizeFilter filter, const int4* roi )
+{
+	return launchResizeROI<float>(input, inputPitch, inputWidth, inputHeight, output, outputPitch, outputWidth, outputHeight, filter, roi);
+}
+
+
+// cudaResizeRGBA
+cudaError_t cudaResizeRGBA( float4* input,  size_t inputPitch,  size_t inputWidth,  size_t inputHeight,
+				        float4* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
+				        resizeFilter filter, const int4* roi )
+{
+	return launchResizeROI<float4>(input, inputPitch, inputWidth, inputHeight, output, outputPitch, outputWidth, outputHeight, filter, roi);
+}
+
+
+// gpuResizeBatch
+template<resizeFilter filter>
+__global__ void gpuResizeBatch( resizeROI* rois )
+{
+	const resizeROI r = rois[blockIdx.z];
+
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if( x >= (int)r.outputWidth || y >= (int)r.outputHeight )
+		return;
+
+	const float2 scale = make_float2( float(r.roi.z) / float(r.outputWidth),
+							    float(r.roi.w) / float(r.outputHeight) );
+
+	resizeRow(r.output, r.outputPitch, y)[x] = resizeSample(r.input, r.inputPitch, r.roi, scale, x, y, filter);
+}
+
+
+// cudaResizeBatchRGBA
+cudaError_t cudaResizeBatchRGBA( resizeROI* rois, uint32_t count, uint32_t maxOutputWidth, uint32_t maxOutputHeight, resizeFilter filter )
+{
+	if( !rois )
+		return cudaErrorInvalidDevicePointer;
+
+	if( count == 0 )
+		return cudaSuccess;
+
+	if( maxOutputWidth == 0 || maxOutputHeight == 0 )
+		return cudaErrorInvalidValue;
+
+	// launch kernel, with the regions along z
+	const dim3 blockDim(32, 8);
+	const dim3 gridDim(iDivUp(maxOutputWidth,blockDim.x), iDivUp(maxOutputHeight,blockDim.y), count);
+
+	switch(filter)
+	{
+		case RESIZE_NEAREST:	gpuResizeBatch<RESIZE_NEAREST><<<gridDim, blockDim>>>(rois); break;
+		case RESIZE_LINEAR:		gpuResizeBatch<RESIZE_LINEAR><<<gridDim, blockDim>>>(rois);  break;
+		case RESIZE_AREA:		gpuResizeBatch<RESIZE_AREA><<<gridDim, blockDim>>>(rois);    break;
+		default:				return cudaErrorInvalidValue;
+	}
+
+	return CUDA(cudaGetLastError());
+}
+
@@ -8,6 +8,8 @@
 
 #include "cudaUtility.h"
 
+#include <math.h>
+
 
 /**
  * Function for increasing or decreasing the size of an image on the GPU.
@@ -25,7 +27,207 @@ cudaError_t cudaResizeRGBA( float4* input,  size_t inputWidth,  size_t inputHeig
 				        float4* output, size_t outputWidth, size_t outputHeight );
 
 
-						
+/**
+ * Filtering used by the resize functions.
+ * @ingroup util
+ */
+enum resizeFilter
+{
+	RESIZE_NEAREST = 0,	/**< nearest neighbor (like cudaResize()) */
+	RESIZE_LINEAR,		/**< bilinear interpolation between the four nearest pixels */
+	RESIZE_AREA		/**< average of the input pixels each output pixel covers (bilinear along an axis that's enlarged) */
+};
+
+
+/**
+ * Resize a single-channel float image (or a region of it), with any row pitch.
+ * @param inputPitch size of each input row in bytes
+ * @param outputPitch size of each output row in bytes
+ * @param roi optional x, y, width, height of a crop of the input to resize (NULL for the whole image)
+ * @ingroup util
+ */
+cudaError_t cudaResize( float* input,  size_t inputPitch,  size_t inputWidth,  size_t inputHeight,
+				    float* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
+				    resizeFilter filter, const int4* roi=NULL );
+
+
+/**
+ * Resize a float4 RGBA image (or a region of it), with any row pitch.
+ * @see cudaResize() for the parameters.
+ * @ingroup util
+ */
+cudaError_t cudaResizeRGBA( float4* input,  size_t inputPitch,  size_t inputWidth,  size_t inputHeight,
+				        float4* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
+				        resizeFilter filter, const int4* roi=NULL );
+
+
+/**
+ * One crop-and-resize of a batch, from a region of an input image into an output image.
+ * @ingroup util
+ */
+struct resizeROI
+{
+	float4*  input;		/**< float4 RGBA input image in CUDA memory */
+	size_t   inputPitch;	/**< size of each input row in bytes */
+	int4     roi;			/**< x, y, width, height of the region to crop from the input */
+	float4*  output;		/**< float4 RGBA output image in CUDA memory */
+	size_t   outputPitch;	/**< size of each output row in bytes */
+	uint32_t outputWidth;
+	uint32_t outputHeight;
+};
+
+
+/**
+ * Crop and resize a batch of regions (e.g. every detection in a frame, or one from each camera)
+ * with one kernel launch.  The regions can come from different images and go to outputs of
+ * different sizes, up to maxOutputWidth x maxOutputHeight, which the launch is sized by.
+ * The regions aren't checked on the GPU, so they must lie within their input images.
+ * @param rois array of count regions in CUDA (i.e. mapped) memory
+ * @ingroup util
+ */
+cudaError_t cudaResizeBatchRGBA( resizeROI* rois, uint32_t count, uint32_t maxOutputWidth, uint32_t maxOutputHeight, resizeFilter filter );
+
+
+// row y of a pitched image
+template<typename T>
+inline __host__ __device__ T* resizeRow( T* image, size_t pitch, int y )			{ return (T*)((uint8_t*)image + y * pitch); }
+
+template<typename T>
+inline __host__ __device__ const T* resizeRow( const T* image, size_t pitch, int y )	{ return (const T*)((const uint8_t*)image + y * pitch); }
+
+// weighted sums of pixels
+inline __host__ __device__ void resizeZero( float& sum )						{ sum = 0.0f; }
+inline __host__ __device__ void resizeZero( float4& sum )						{ sum = make_float4(0.0f, 0.0f, 0.0f, 0.0f); }
+
+inline __host__ __device__ void resizeAccum( float& sum, float px, float w )			{ sum += px * w; }
+inline __host__ __device__ void resizeAccum( float4& sum, const float4& px, float w )	{ sum.x += px.x * w; sum.y += px.y * w; sum.z += px.z * w; sum.w += px.w * w; }
+
+inline __host__ __device__ void resizeScale( float& sum, float s )					{ sum *= s; }
+inline __host__ __device__ void resizeScale( float4& sum, float s )					{ sum.x *= s; sum.y *= s; sum.z *= s; sum.w *= s; }
+
+inline __host__ __device__ int resizeMin( int a, int b )							{ return (a < b) ? a : b; }
+
+
+/**
+ * The input pixels [first, last] along one axis that an output pixel is made from.
+ * For area filtering they're weighted by how much of each the output pixel covers,
+ * otherwise by their distance from the sample position (bilinear).
+ */
+struct resizeSpan
+{
+	int   first;
+	int   last;
+	float begin;	/**< start of the area, or the sample position (bilinear) */
+	float end;		/**< end of the area (unused for bilinear) */
+	bool  area;
+};
+
+inline __host__ __device__ resizeSpan resizeAxis( int i, float scale, int size, bool area )
+{
+	resizeSpan span;
+
+	span.area = area;
+
+	if( area )
+	{
+		span.begin = i * scale;
+		span.end   = span.begin + scale;
+		span.first = span.begin;
+		span.last  = resizeMin(ceilf(span.end), size) - 1;
+	}
+	else
+	{
+		// between the pixel centers
+		span.begin = fminf(fmaxf((i + 0.5f) * scale - 0.5f, 0.0f), size - 1);
+		span.end   = span.begin;
+		span.first = span.begin;
+		span.last  = resizeMin(span.first + 1, size - 1);
+	}
+
+	return span;
+}
+
+inline __host__ __device__ float resizeWeight( const resizeSpan& span, int i )
+{
+	if( span.area )
+		return fminf(i + 1, span.end) - fmaxf(i, span.begin);
+
+	return 1.0f - fabsf(i - span.begin);
+}
+
+
+/**
+ * Sample output pixel (x, y) of a region resized by scale (the ratio of the region's size to the
+ * output size).  Shared by the kernels and the CPU versions.
+ * @ingroup util
+ */
+template<typename T>
+inline __host__ __device__ T resizeSample( const T* input, size_t inputPitch, const int4& roi, const float2& scale, int x, int y, resizeFilter filter )
+{
+	if( filter == RESIZE_NEAREST )
+	{
+		const int sx = resizeMin(x * scale.x, roi.z - 1);
+		const int sy = resizeMin(y * scale.y, roi.w - 1);
+
+		return resizeRow(input, inputPitch, roi.y + sy)[roi.x + sx];
+	}
+
+	T sum;
+	resizeZero(sum);
+
+	// area filtering only applies to the axes that are shrunk, so e.g. a tall narrow
+	// crop resized to a square is averaged vertically and interpolated horizontally
+	const bool areaX = (filter == RESIZE_AREA && scale.x >= 1.0f);
+	const bool areaY = (filter == RESIZE_AREA && scale.y >= 1.0f);
+
+	if( areaX || areaY )
+	{
+		const resizeSpan sx = resizeAxis(x, scale.x, roi.z, areaX);
+		const resizeSpan sy = resizeAxis(y, scale.y, roi.w, areaY);
+
+		float weights = 0.0f;
+
+		for( int iy=sy.first; iy <= sy.last; iy++ )
+		{
+			const T*    row = resizeRow(input, inputPitch, roi.y + iy) + roi.x;
+			const float wy  = resizeWeight(sy, iy);
+
+			for( int ix=sx.first; ix <= sx.last; ix++ )
+			{
+				const float w = resizeWeight(sx, ix) * wy;
+
+				resizeAccum(sum, row[ix], w);
+				weights += w;
+			}
+		}
+
+		resizeScale(sum, 1.0f / weights);
+		return sum;
+	}
+
+	// bilinear, between the pixel centers
+	const float fx = fminf(fmaxf((x + 0.5f) * scale.x - 0.5f, 0.0f), roi.z - 1);
+	const float fy = fminf(fmaxf((y + 0.5f) * scale.y - 0.5f, 0.0f), roi.w - 1);
+
+	const int x0 = fx;
+	const int y0 = fy;
+	const int x1 = resizeMin(x0 + 1, roi.z - 1);
+	const int y1 = resizeMin(y0 + 1, roi.w - 1);
+
+	const float wx = fx - x0;
+	const float wy = fy - y0;
+
+	const T* row0 = resizeRow(input, inputPitch, roi.y + y0) + roi.x;
+	const T* row1 = resizeRow(input, inputPitch, roi.y + y1) + roi.x;
+
+	resizeAccum(sum, row0[x0], (1.0f - wx) * (1.0f - wy));
+	resizeAccum(sum, row0[x1], wx * (1.0f - wy));
+	resizeAccum(sum, row1[x0], (1.0f - wx) * wy);
+	resizeAccum(sum, row1[x1], wx * wy);
+
+	return sum;
+}
+
 
 #endif
 
@@ -3,102 +3,111 @@
  */
 
 #include "cudaYUV.h"
+#include "cudaColorspace.h"
 
 
-inline __device__ __host__ float clamp(float f, float a, float b)
+//-----------------------------------------------------------------------------------
+// YUYV/UYVY to RGBA
+//-----------------------------------------------------------------------------------
+
+// gpuYUYVVector (each thread converts 16 pixels, read as two 16-byte vectors of 4 macropixels)
+//   YUYV [ Y0 | U0 | Y1 | V0 ]
+//   UYVY [ U0 | Y0 | V0 | Y1 ]
+template<imageFormat inputFormat, imageFormat outputFormat>
+__global__ void gpuYUYVVector( colorPlanes input, colorPlanes output, int width, int height, colorConversion cc )
 {
-    return fmaxf(a, fminf(f, b));
-}
+	const int x = (blockIdx.x * blockDim.x + threadIdx.x) * COLOR_VECTOR_PIXELS;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
 
+	if( x >= width || y >= height )
+		return;
 
-/* From RGB to YUV
+	if( x + COLOR_VECTOR_PIXELS > width )
+	{
+		// the last few columns of a width that isn't a multiple of the vector
+		for( int i=x; i < width; i++ )
+			colorStore<outputFormat>(output, i, y, colorYUVToRGB(colorLoad<inputFormat>(input, i, y), cc), cc);
 
-   Y = 0.299R + 0.587G + 0.114B
-   U = 0.492 (B-Y)
-   V = 0.877 (R-Y)
+		return;
+	}
 
-   It can also be represented as:
+	const uint4* src = (const uint4*)(input.ptr[0] + y * input.pitch[0] + x * 2);
 
-   Y =  0.299R + 0.587G + 0.114B
-   U = -0.147R - 0.289G + 0.436B
-   V =  0.615R - 0.515G - 0.100B
+	const int Y = (inputFormat == FORMAT_YUYV) ? 0 : 1;
+	const int U = (inputFormat == FORMAT_YUYV) ? 1 : 0;
 
-   From YUV to RGB
+	#pragma unroll
+	for( int n=0; n < 2; n++ )
+	{
+		const uint4 macroPx = src[n];
 
-   R = Y + 1.140V
-   G = Y - 0.395U - 0.581V
-   B = Y + 2.032U
- */
+		#pragma unroll
+		for( int h=0; h < 2; h++ )
+		{
+			float4 px[4];
 
-struct __align__(8) uchar8
-{
-   uint8_t a0, a1, a2, a3, a4, a5, a6, a7;
-};
-static __host__ __device__ __forceinline__ uchar8 make_uchar8(uint8_t a0, uint8_t a1, uint8_t a2, uint8_t a3, uint8_t a4, uint8_t a5, uint8_t a6, uint8_t a7)
+			#pragma unroll
+			for( int i=0; i < 4; i++ )
+			{
+				const int m = h * 8 + (i / 2) * 4;	// the macropixel's first byte
+				px[i] = colorYUVToRGB(make_float4(colorVectorByte(macroPx, m + Y + (i & 1) * 2), colorVectorByte(macroPx, m + U), colorVectorByte(macroPx, m + U + 2), 255.0f), cc);
+			}
+
+			colorStoreVector<outputFormat>(output, x + n * 8 + h * 4, y, px, cc);
+		}
+	}
+}
+
+
+// launchYUYVVector
+template<imageFormat inputFormat>
+static void launchYUYVVector( const colorPlanes& input, const colorPlanes& output, imageFormat outputFormat,
+					     uint32_t width, uint32_t height, const colorConversion& cc, cudaStream_t stream )
 {
-   uchar8 val = {a0, a1, a2, a3, a4, a5, a6, a7};
-   return val;
+	const dim3 blockDim(8, 8);
+	const dim3 gridDim(iDivUp(width, blockDim.x * COLOR_VECTOR_PIXELS), iDivUp(height, blockDim.y));
+
+	switch(outputFormat)
+	{
+		case FORMAT_RGBA8:	gpuYUYVVector<inputFormat, FORMAT_RGBA8><<<gridDim, blockDim, 0, stream>>>(input, output, width, height, cc); break;
+		case FORMAT_BGRA8:	gpuYUYVVector<inputFormat, FORMAT_BGRA8><<<gridDim, blockDim, 0, stream>>>(input, output, width, height, cc); break;
+		case FORMAT_RGBA32F:	gpuYUYVVector<inputFormat, FORMAT_RGBA32F><<<gridDim, blockDim, 0, stream>>>(input, output, width, height, cc); break;
+		default:			break;
+	}
 }
 
 
-//-----------------------------------------------------------------------------------
-// YUYV/UYVY to RGBA
-//-----------------------------------------------------------------------------------
-template <bool formatUYVY>
-__global__ void yuyvToRgba( uchar4* src, int srcAlignedWidth, uchar8* dst, int dstAlignedWidth, int width, int height )
+// cudaConvertYUYVVector
+cudaError_t cudaConvertYUYVVector( const colorPlanes& input, imageFormat inputFormat, const colorPlanes& output, imageFormat outputFormat,
+						     uint32_t width, uint32_t height, const colorConversion& cc, cudaStream_t stream )
 {
-	const int x = blockIdx.x * blockDim.x + threadIdx.x;
-	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+	if( outputFormat != FORMAT_RGBA8 && outputFormat != FORMAT_BGRA8 && outputFormat != FORMAT_RGBA32F )
+		return cudaErrorInvalidValue;
 
-	if( x >= srcAlignedWidth || y >= height )
-		return;
+	if( inputFormat == FORMAT_YUYV )
+		launchYUYVVector<FORMAT_YUYV>(input, output, outputFormat, width, height, cc, stream);
+	else if( inputFormat == FORMAT_UYVY )
+		launchYUYVVector<FORMAT_UYVY>(input, output, outputFormat, width, height, cc, stream);
+	else
+		return cudaErrorInvalidValue;
 
-	const uchar4 macroPx = src[y * srcAlignedWidth + x];
+	return CUDA(cudaGetLastError());
+}
 
-	// Y0 is the brightness of pixel 0, Y1 the brightness of pixel 1.
-	// U0 and V0 is the color of both pixels.
-	// UYVY [ U0 | Y0 | V0 | Y1 ] 
-	// YUYV [ Y0 | U0 | Y1 | V0 ]
-	const float y0 = formatUYVY ? macroPx.y : macroPx.x;
-	const float y1 = formatUYVY ? macroPx.w : macroPx.z; 
-	const float u = (formatUYVY ? macroPx.x : macroPx.y) - 128.0f;
-	const float v = (formatUYVY ? macroPx.z : macroPx.w) - 128.0f;
-
-	const float4 px0 = make_float4( y0 + 1.4065f * v,
-							  y0 - 0.3455f * u - 0.7169f * v,
-							  y0 + 1.7790f * u, 255.0f );
-
-	const float4 px1 = make_float4( y1 + 1.4065f * v,
-							  y1 - 0.3455f * u - 0.7169f * v,
-							  y1 + 1.7790f * u, 255.0f );
-
-	dst[y * dstAlignedWidth + x] = make_uchar8( clamp(px0.x, 0.0f, 255.0f), 
-									    clamp(px0.y, 0.0f, 255.0f),
-									    clamp(px0.z, 0.0f, 255.0f),
-									    clamp(px0.w, 0.0f, 255.0f),
-									    clamp(px1.x, 0.0f, 255.0f),
-									    clamp(px1.y, 0.0f, 255.0f),
-									    clamp(px1.z, 0.0f, 255.0f),
-									    clamp(px1.w, 0.0f, 255.0f) );
-} 
 
-template<bool formatUYVY>
-cudaError_t launchYUYV( uchar2* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height)
+// convertYUYV
+static cudaError_t convertYUYV( uchar2* input, imageFormat inputFormat, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height )
 {
 	if( !input || !inputPitch || !output || !outputPitch || !width || !height )
 		return cudaErrorInvalidValue;
 
-	const dim3 block(8,8);
-	const dim3 grid(iDivUp(width/2, block.x), iDivUp(height, block.y));
+	colorPlanes inputPlanes;
+	colorPlanes outputPlanes;
 
-	const int srcAlignedWidth = inputPitch / sizeof(uchar4);	// normally would be uchar2, but we're doubling up pixels
-	const int dstAlignedWidth = outputPitch / sizeof(uchar8);	// normally would be uchar4 ^^^
-
-	//printf("yuyvToRgba %zu %zu %i %i %i %i %i\n", width, height, (int)formatUYVY, srcAlignedWidth, dstAlignedWidth, grid.x, grid.y);
+	colorPlanesInit(input, inputFormat, width, height, &inputPlanes, inputPitch);
+	colorPlanesInit(output, FORMAT_RGBA8, width, height, &outputPlanes, outputPitch);
 
-	yuyvToRgba<formatUYVY><<<grid, block>>>((uchar4*)input, srcAlignedWidth, (uchar8*)output, dstAlignedWidth, width, height);
-
-	return CUDA(cudaGetLastError());
+	return cudaConvertColorPlanes(inputPlanes, inputFormat, outputPlanes, FORMAT_RGBA8, width, height, colorConversionInit(COLORSPACE_BT601_FULL), NULL);
 }
 
 
@@ -109,7 +118,7 @@ cudaError_t cudaUYVYToRGBA( uchar2* input, uchar4* output, size_t width, size_t
 
 cudaError_t cudaUYVYToRGBA( uchar2* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height )
 {
-	return launchYUYV<true>(input, inputPitch, output, outputPitch, width, height);
+	return convertYUYV(input, FORMAT_UYVY, inputPitch, output, outputPitch, width, height);
 }
 
 cudaError_t cudaYUYVToRGBA( uchar2* input, uchar4* output, size_t width, size_t height )
@@ -119,7 +128,7 @@ cudaError_t cudaYUYVToRGBA( uchar2* input, uchar4* output, size_t width, size_t
 
 cudaError_t cudaYUYVToRGBA( uchar2* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height )
 {
-	return launchYUYV<false>(input, inputPitch, output, outputPitch, width, height);
+	return convertYUYV(input, FORMAT_YUYV, inputPitch, output, outputPitch, width, height);
 }
 
 
@@ -49,6 +49,7 @@ cudaError_t cudaRGBAToYV12( uchar4* input, size_t inputPitch, uint8_t* output, s
 
 /**
  * Convert a UYVY 422 packed image into RGBA uchar4.
+ * The colors are BT.601 full range, use cudaConvertColor() for the other color spaces.
  */
 cudaError_t cudaUYVYToRGBA( uchar2* input, uchar4* output, size_t width, size_t height );
 
@@ -59,6 +60,7 @@ cudaError_t cudaUYVYToRGBA( uchar2* input, size_t inputPitch, uchar4* output, si
 
 /**
  * Convert a YUYV 422 packed image into RGBA uchar4.
+ * The colors are BT.601 full range, use cudaConvertColor() for the other color spaces.
  */
 cudaError_t cudaYUYVToRGBA( uchar2* input, uchar4* output, size_t width, size_t height );
 
@@ -110,6 +112,7 @@ cudaError_t cudaYUYVToGray( uchar2* input, size_t inputPitch, float* output, siz
 /**
  * Convert an NV12 texture (semi-planar 4:2:0) to ARGB uchar4 format.
  * NV12 = 8-bit Y plane followed by an interleaved U/V plane with 2x2 subsampling.
+ * The colors are BT.601 full range, use cudaConvertColor() for the other color spaces.
  */
 cudaError_t cudaNV12ToRGBA( uint8_t* input, size_t inputPitch, uchar4* output, size_t outputPitch, size_t width, size_t height );
 cudaError_t cudaNV12ToRGBA( uint8_t* input, uchar4* output, size_t width, size_t height );
@@ -117,15 +120,6 @@ cudaError_t cudaNV12ToRGBA( uint8_t* input, uchar4* output, size_t width, size_t
 cudaError_t cudaNV12ToRGBAf( uint8_t* input, size_t inputPitch, float4* output, size_t outputPitch, size_t width, size_t height );
 cudaError_t cudaNV12ToRGBAf( uint8_t* input, float4* output, size_t width, size_t height );
 
-/**
- * Setup NV12 color conversion constants.
- * cudaNV12SetupColorspace() isn't necessary for the user to call, it will be
- * called automatically by cudaNV12ToRGBA() with a hue of 0.0.
- * However if you want to setup custom constants (ie with a hue different than 0),
- * then you can call cudaNV12SetupColorspace() at any time, overriding the default.
- */
-cudaError_t cudaNV12SetupColorspace( float hue = 0.0f ); 
-
 ///@}
 
 #endif
@@ -0,0 +1,129 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __IMAGE_FORMAT_H_
+#define __IMAGE_FORMAT_H_
+
+
+#include "cudaUtility.h"
+#include <stdint.h>
+
+
+/**
+ * Layouts of images that can be passed to the networks and converters.  The packed 8-bit formats
+ * (one interleaved plane, 8 bits per channel) come first, followed by float4 RGBA and the YUV
+ * formats captured from cameras, which are stored with their planes back-to-back.
+ * @ingroup util
+ */
+enum imageFormat
+{
+	FORMAT_RGB8 = 0,	/**< uchar3 RGB */
+	FORMAT_BGR8,		/**< uchar3 BGR, the default layout of OpenCV's cv::Mat (CV_8UC3) */
+	FORMAT_RGBA8,		/**< uchar4 RGBA */
+	FORMAT_BGRA8,		/**< uchar4 BGRA */
+	FORMAT_GRAY8,		/**< single-channel luminance */
+	FORMAT_RGBA32F,		/**< float4 RGBA with pixel intensities 0-255, the layout the networks take */
+	FORMAT_NV12,		/**< YUV 4:2:0, Y plane followed by an interleaved U/V plane at half resolution */
+	FORMAT_I420,		/**< YUV 4:2:0, Y plane followed by U and V planes at half resolution */
+	FORMAT_YV12,		/**< YUV 4:2:0, Y plane followed by V and U planes at half resolution */
+	FORMAT_YUYV,		/**< YUV 4:2:2 packed, Y0 U Y1 V */
+	FORMAT_UYVY,		/**< YUV 4:2:2 packed, U Y0 V Y1 */
+	FORMAT_UNKNOWN
+};
+
+
+/**
+ * Number of bytes in each pixel of a packed 8-bit format (0 for the other formats)
+ * @ingroup util
+ */
+inline __host__ __device__ uint32_t imageFormatChannels( imageFormat format )
+{
+	switch(format)
+	{
+		case FORMAT_RGB8:
+		case FORMAT_BGR8:	return 3;
+		case FORMAT_RGBA8:
+		case FORMAT_BGRA8:	return 4;
+		case FORMAT_GRAY8:	return 1;
+		default:			return 0;
+	}
+}
+
+
+/**
+ * Name of the format, for logging
+ * @ingroup util
+ */
+inline const char* imageFormatToStr( imageFormat format )
+{
+	switch(format)
+	{
+		case FORMAT_RGB8:	return "rgb8";
+		case FORMAT_BGR8:	return "bgr8";
+		case FORMAT_RGBA8:	return "rgba8";
+		case FORMAT_BGRA8:	return "bgra8";
+		case FORMAT_GRAY8:	return "gray8";
+		case FORMAT_RGBA32F:	return "rgba32f";
+		case FORMAT_NV12:	return "nv12";
+		case FORMAT_I420:	return "i420";
+		case FORMAT_YV12:	return "yv12";
+		case FORMAT_YUYV:	return "yuyv";
+		case FORMAT_UYVY:	return "uyvy";
+		default:			return "unknown";
+	}
+}
+
+
+/**
+ * Is the format one of the YUV formats (as opposed to RGB or grayscale)
+ * @ingroup util
+ */
+inline __host__ __device__ bool imageFormatIsYUV( imageFormat format )
+{
+	return (format >= FORMAT_NV12 && format <= FORMAT_UYVY);
+}
+
+
+/**
+ * Size in bytes of a width x height image in the format, with tightly packed rows.
+ * The chroma planes of 4:2:0 formats are (width+1)/2 x (height+1)/2.
+ * @ingroup util
+ */
+inline size_t imageFormatSize( imageFormat format, size_t width, size_t height )
+{
+	const size_t chroma = ((width + 1) / 2) * ((height + 1) / 2);
+
+	switch(format)
+	{
+		case FORMAT_RGBA32F:	return width * height * sizeof(float4);
+		case FORMAT_NV12:
+		case FORMAT_I420:
+		case FORMAT_YV12:	return width * height + chroma * 2;
+		case FORMAT_YUYV:
+		case FORMAT_UYVY:	return ((width + 1) / 2) * 4 * height;
+		default:			return width * height * imageFormatChannels(format);
+	}
+}
+
+
+/**
+ * Read the pixel at px as floating-point RGB (0-255), the format being a compile-time
+ * constant so kernels can be instantiated once per format without branching per pixel.
+ * @ingroup util
+ */
+template<imageFormat format>
+inline __host__ __device__ float3 imageFormatLoadRGB( const uint8_t* px )
+{
+	switch(format)
+	{
+		case FORMAT_RGB8:
+		case FORMAT_RGBA8:	return make_float3(px[0], px[1], px[2]);
+		case FORMAT_BGR8:
+		case FORMAT_BGRA8:	return make_float3(px[2], px[1], px[0]);
+		default:			return make_float3(px[0], px[0], px[0]);
+	}
+}
+
+
+#endif
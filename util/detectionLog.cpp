@@ -0,0 +1,328 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "detectionLog.h"
+
+#include <string.h>
+
+
+#define DETECTION_LOG_MAGIC   0x474F4C44	// 'DLOG'
+#define DETECTION_LOG_VERSION 1
+
+// bytes per row, summed over the columns
+#define DETECTION_LOG_ROW_SIZE (sizeof(uint32_t) + sizeof(uint16_t) * 2 + sizeof(float) * 5)
+
+// larger blocks are taken to be corruption, rather than allocated
+#define DETECTION_LOG_MAX_BLOCK (16 * 1024 * 1024)
+
+// stdio buffer for the file, so blocks go out in large writes
+#define DETECTION_LOG_FILE_BUFFER (1024 * 1024)
+
+
+// the 16-byte header at the start of the file
+struct detectionLogHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t reserved[2];
+};
+
+
+// copy one field of every row into a column
+template<typename T>
+static inline uint8_t* packColumn( uint8_t* dst, const std::vector<detection>& rows, T detection::*field )
+{
+	T* column = (T*)dst;
+
+	for( size_t n=0; n < rows.size(); n++ )
+		column[n] = rows[n].*field;
+
+	return dst + sizeof(T) * rows.size();
+}
+
+
+// constructor
+detectionLog::detectionLog()
+{
+	mFile      = NULL;
+	mBlockSize = 0;
+	mCount     = 0;
+}
+
+
+// destructor
+detectionLog::~detectionLog()
+{
+	if( mFile != NULL )
+	{
+		Flush();
+		fclose(mFile);
+		mFile = NULL;
+	}
+}
+
+
+// Create
+detectionLog* detectionLog::Create( const char* filename, uint32_t blockSize )
+{
+	if( !filename )
+		return NULL;
+
+	detectionLog* log = new detectionLog();
+
+	if( !log )
+		return NULL;
+
+	log->mBlockSize = (blockSize > 0) ? blockSize : DETECTION_LOG_DEFAULT_BLOCK;
+	log->mFile      = fopen(filename, "wb");
+
+	if( !log->mFile )
+	{
+		printf(LOG_DETECTION "failed to create %s\n", filename);
+		delete log;
+		return NULL;
+	}
+
+	setvbuf(log->mFile, NULL, _IOFBF, DETECTION_LOG_FILE_BUFFER);
+
+	log->mRows.reserve(log->mBlockSize);
+	log->mBuffer.resize(sizeof(uint32_t) + log->mBlockSize * DETECTION_LOG_ROW_SIZE);
+
+	detectionLogHeader header;
+	memset(&header, 0, sizeof(detectionLogHeader));
+
+	header.magic   = DETECTION_LOG_MAGIC;
+	header.version = DETECTION_LOG_VERSION;
+
+	if( fwrite(&header, sizeof(detectionLogHeader), 1, log->mFile) != 1 )
+	{
+		printf(LOG_DETECTION "failed to write header to %s\n", filename);
+		delete log;
+		return NULL;
+	}
+
+	return log;
+}
+
+
+// Add
+bool detectionLog::Add( const detection& d )
+{
+	mRows.push_back(d);
+	mCount++;
+
+	if( mRows.size() >= mBlockSize )
+		return Flush();
+
+	return true;
+}
+
+
+// Add
+bool detectionLog::Add( uint32_t frame, uint16_t source, const float* boundingBoxes, const float* confidence, int numBoxes )
+{
+	if( !boundingBoxes && numBoxes > 0 )
+		return false;
+
+	bool result = true;
+
+	for( int n=0; n < numBoxes; n++ )
+	{
+		const float* bb = boundingBoxes + n * 4;
+
+		detection d;
+
+		d.frame      = frame;
+		d.source     = source;
+		d.classID    = (confidence != NULL) ? (uint16_t)confidence[n * 2 + 1] : 0;
+		d.confidence = (confidence != NULL) ? confidence[n * 2 + 0] : 0.0f;
+		d.left       = bb[0];
+		d.top        = bb[1];
+		d.right      = bb[2];
+		d.bottom     = bb[3];
+
+		if( !Add(d) )
+			result = false;
+	}
+
+	return result;
+}
+
+
+// Flush
+bool detectionLog::Flush()
+{
+	if( !mFile )
+		return false;
+
+	if( mRows.size() == 0 )
+		return true;
+
+	// lay out the block in columns
+	uint8_t* ptr = mBuffer.data();
+
+	*(uint32_t*)ptr = mRows.size();
+	ptr += sizeof(uint32_t);
+
+	ptr = packColumn(ptr, mRows, &detection::frame);
+	ptr = packColumn(ptr, mRows, &detection::source);
+	ptr = packColumn(ptr, mRows, &detection::classID);
+	ptr = packColumn(ptr, mRows, &detection::confidence);
+	ptr = packColumn(ptr, mRows, &detection::left);
+	ptr = packColumn(ptr, mRows, &detection::top);
+	ptr = packColumn(ptr, mRows, &detection::right);
+	ptr = packColumn(ptr, mRows, &detection::bottom);
+
+	const size_t size = ptr - mBuffer.data();
+
+	mRows.clear();
+
+	if( fwrite(mBuffer.data(), 1, size, mFile) != size )
+	{
+		printf(LOG_DETECTION "failed to write block of detections\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------
+// detectionLogReader
+//-----------------------------------------------------------------------------------
+
+// read one column of a block
+template<typename T>
+static inline bool readColumn( FILE* file, std::vector<T>& column, uint32_t count )
+{
+	column.resize(count);
+	return fread(column.data(), sizeof(T), count, file) == count;
+}
+
+
+// row
+detection detectionLogReader::block::row( size_t n ) const
+{
+	detection d;
+
+	d.frame      = frame[n];
+	d.source     = source[n];
+	d.classID    = classID[n];
+	d.confidence = confidence[n];
+	d.left       = left[n];
+	d.top        = top[n];
+	d.right      = right[n];
+	d.bottom     = bottom[n];
+
+	return d;
+}
+
+
+// constructor
+detectionLogReader::detectionLogReader()
+{
+	mFile    = NULL;
+	mCorrupt = false;
+}
+
+
+// destructor
+detectionLogReader::~detectionLogReader()
+{
+	if( mFile != NULL )
+	{
+		fclose(mFile);
+		mFile = NULL;
+	}
+}
+
+
+// Open
+detectionLogReader* detectionLogReader::Open( const char* filename )
+{
+	if( !filename )
+		return NULL;
+
+	detectionLogReader* reader = new detectionLogReader();
+
+	if( !reader )
+		return NULL;
+
+	reader->mFile = fopen(filename, "rb");
+
+	if( !reader->mFile )
+	{
+		printf(LOG_DETECTION "failed to open %s\n", filename);
+		delete reader;
+		return NULL;
+	}
+
+	setvbuf(reader->mFile, NULL, _IOFBF, DETECTION_LOG_FILE_BUFFER);
+
+	detectionLogHeader header;
+
+	if( fread(&header, sizeof(detectionLogHeader), 1, reader->mFile) != 1 || header.magic != DETECTION_LOG_MAGIC )
+	{
+		printf(LOG_DETECTION "%s is not a detection log\n", filename);
+		delete reader;
+		return NULL;
+	}
+
+	if( header.version != DETECTION_LOG_VERSION )
+	{
+		printf(LOG_DETECTION "%s has unsupported version %u\n", filename, header.version);
+		delete reader;
+		return NULL;
+	}
+
+	return reader;
+}
+
+
+// Read
+bool detectionLogReader::Read( block* b )
+{
+	if( !b || !mFile )
+		return false;
+
+	uint32_t count = 0;
+
+	if( fread(&count, sizeof(uint32_t), 1, mFile) != 1 )
+		return false;	// end of the file
+
+	if( count > DETECTION_LOG_MAX_BLOCK ||
+	    !readColumn(mFile, b->frame, count) ||
+	    !readColumn(mFile, b->source, count) ||
+	    !readColumn(mFile, b->classID, count) ||
+	    !readColumn(mFile, b->confidence, count) ||
+	    !readColumn(mFile, b->left, count) ||
+	    !readColumn(mFile, b->top, count) ||
+	    !readColumn(mFile, b->right, count) ||
+	    !readColumn(mFile, b->bottom, count) )
+	{
+		printf(LOG_DETECTION "block of %u detections is truncated or corrupt\n", count);
+		mCorrupt = true;
+		return false;
+	}
+
+	return true;
+}
+
+
+// ReadAll
+bool detectionLogReader::ReadAll( std::vector<detection>* detections )
+{
+	if( !detections )
+		return false;
+
+	block b;
+
+	while( Read(&b) )
+	{
+		for( size_t n=0; n < b.size(); n++ )
+			detections->push_back(b.row(n));
+	}
+
+	return !mCorrupt;
+}
@@ -0,0 +1,177 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __DETECTION_LOG_H_
+#define __DETECTION_LOG_H_
+
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+
+/**
+ * Prefix used for tagging printed log output
+ * @ingroup util
+ */
+#define LOG_DETECTION "[detectionLog]  "
+
+/**
+ * Default number of detections buffered before they're written out as a block.
+ * @ingroup util
+ */
+#define DETECTION_LOG_DEFAULT_BLOCK 4096
+
+
+/**
+ * A detected object, one row of a detectionLog.
+ * @ingroup util
+ */
+struct detection
+{
+	uint32_t frame;		/**< frame number in the video */
+	uint16_t source;		/**< which detector (or camera) it came from, defined by the application */
+	uint16_t classID;		/**< object class from the network */
+	float    confidence;	/**< coverage value from the network */
+	float    left;		/**< bounding box, in pixels */
+	float    top;
+	float    right;
+	float    bottom;
+};
+
+
+/**
+ * Writes detections to a compact binary file, stored column by column in blocks.
+ *
+ * The file starts with a 16-byte header (the magic 'DLOG', the format version, and two
+ * reserved words), followed by blocks of up to blockSize detections.  Each block is a
+ * 32-bit row count followed by the columns of those rows, one after the other:
+ *
+ *    uint32 frame[count]
+ *    uint16 source[count]
+ *    uint16 classID[count]
+ *    float  confidence[count]
+ *    float  left[count], top[count], right[count], bottom[count]
+ *
+ * Values are little-endian.  Rows are buffered in memory and written a block at a time,
+ * so logging a detection costs a few stores instead of formatting text.  Readers can load
+ * a block's columns straight into arrays, see detectionLogReader.
+ * @ingroup util
+ */
+class detectionLog
+{
+public:
+	/**
+	 * Create a new log file (replacing an existing one).
+	 * @param blockSize number of detections per block
+	 */
+	static detectionLog* Create( const char* filename, uint32_t blockSize=DETECTION_LOG_DEFAULT_BLOCK );
+
+	/**
+	 * Destroy (writing any buffered detections and closing the file)
+	 */
+	~detectionLog();
+
+	/**
+	 * Add a detection.
+	 * @returns false if a block couldn't be written
+	 */
+	bool Add( const detection& d );
+
+	/**
+	 * Add the output of detectNet::Detect() for one frame.
+	 * @param boundingBoxes numBoxes float4 (left, top, right, bottom) boxes
+	 * @param confidence optional numBoxes float2 (confidence, class) pairs
+	 * @returns false if a block couldn't be written
+	 */
+	bool Add( uint32_t frame, uint16_t source, const float* boundingBoxes, const float* confidence, int numBoxes );
+
+	/**
+	 * Write the buffered detections out as a (partial) block.
+	 */
+	bool Flush();
+
+	/**
+	 * Number of detections added to the log.
+	 */
+	inline uint64_t GetCount() const				{ return mCount; }
+
+protected:
+	detectionLog();
+
+	FILE*    mFile;
+	uint32_t mBlockSize;
+	uint64_t mCount;
+
+	std::vector<detection> mRows;	// the block being filled
+	std::vector<uint8_t>   mBuffer;	// the block laid out in columns
+};
+
+
+/**
+ * Reads the files written by detectionLog, a block at a time.
+ * @ingroup util
+ */
+class detectionLogReader
+{
+public:
+	/**
+	 * The columns of a block of detections.
+	 */
+	struct block
+	{
+		std::vector<uint32_t> frame;
+		std::vector<uint16_t> source;
+		std::vector<uint16_t> classID;
+		std::vector<float>    confidence;
+		std::vector<float>    left;
+		std::vector<float>    top;
+		std::vector<float>    right;
+		std::vector<float>    bottom;
+
+		inline size_t size() const				{ return frame.size(); }
+
+		/**
+		 * Gather row n back into a detection.
+		 */
+		detection row( size_t n ) const;
+	};
+
+	/**
+	 * Open a log file for reading.
+	 */
+	static detectionLogReader* Open( const char* filename );
+
+	/**
+	 * Destroy (closing the file)
+	 */
+	~detectionLogReader();
+
+	/**
+	 * Read the next block of detections.
+	 * @returns false at the end of the file, or if the file is truncated or corrupt
+	 */
+	bool Read( block* b );
+
+	/**
+	 * Read the remaining detections, appending them as rows.
+	 * @returns false if the file is truncated or corrupt
+	 */
+	bool ReadAll( std::vector<detection>* detections );
+
+	/**
+	 * Did the last Read() stop because of a truncated or corrupt file (instead of the end of it)?
+	 */
+	inline bool IsCorrupt() const					{ return mCorrupt; }
+
+protected:
+	detectionLogReader();
+
+	FILE* mFile;
+	bool  mCorrupt;
+};
+
+
+#endif
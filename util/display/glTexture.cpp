@@ -146,22 +146,34 @@ inline uint glTextureTypeSize( uint32_t format )
 // constructor
 glTexture::glTexture()
 {
-	mID     = 0;
-	mDMA    = 0;
-	mWidth  = 0;
-	mHeight = 0;
-	mFormat = 0;
-	mSize   = 0;
+	mID       = 0;
+	mDMAIndex = 0;
+	mWidth    = 0;
+	mHeight   = 0;
+	mFormat   = 0;
+	mSize     = 0;
 	
-	mInteropCUDA   = NULL;
 	mInteropHost   = NULL;
 	mInteropDevice = NULL;
+
+	for( uint32_t n=0; n < 2; n++ )
+	{
+		mDMA[n]         = 0;
+		mInteropCUDA[n] = NULL;
+	}
 }
 
 
 // destructor
 glTexture::~glTexture()
 {
+	for( uint32_t n=0; n < 2; n++ )
+	{
+		if( mInteropCUDA[n] != NULL )
+			CUDA(cudaGraphicsUnregisterResource(mInteropCUDA[n]));
+	}
+
+	GL(glDeleteBuffers(2, mDMA));
 	GL(glDeleteTextures(1, &mID));
 }
 	
@@ -208,17 +220,19 @@ bool glTexture::init( uint32_t width, uint32_t height, uint32_t format, void* da
 	GL_VERIFYN(glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, glTextureLayout(format), glTextureType(format), data));
 	GL(glBindTexture(GL_TEXTURE_2D, 0));
 	
-	// allocate DMA PBO
-	uint32_t dma = 0;
-	
-	GL(glGenBuffers(1, &dma));
-	GL(glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, dma));
-	GL(glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, size, NULL, GL_DYNAMIC_DRAW_ARB));
+	// allocate DMA PBOs, one being uploaded from while the other is written
+	GL(glGenBuffers(2, mDMA));
+
+	for( uint32_t n=0; n < 2; n++ )
+	{
+		GL(glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, mDMA[n]));
+		GL(glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, size, NULL, GL_STREAM_DRAW_ARB));
+	}
+
 	GL(glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0));
 	
 	
 	mID     = id;
-	mDMA    = dma;
 	mWidth  = width;
 	mHeight = height;
 	mFormat = format;
@@ -230,23 +244,25 @@ bool glTexture::init( uint32_t width, uint32_t height, uint32_t format, void* da
 // MapCUDA
 void* glTexture::MapCUDA()
 {
-	if( !mInteropCUDA )
+	cudaGraphicsResource*& interop = mInteropCUDA[mDMAIndex];
+
+	if( !interop )
 	{
-		if( CUDA_FAILED(cudaGraphicsGLRegisterBuffer(&mInteropCUDA, mDMA, cudaGraphicsRegisterFlagsWriteDiscard)) )
+		if( CUDA_FAILED(cudaGraphicsGLRegisterBuffer(&interop, mDMA[mDMAIndex], cudaGraphicsRegisterFlagsWriteDiscard)) )
 			return NULL;
 
-		printf( "[cuda]   registered %u byte openGL texture for interop access (%ux%u)\n", mSize, mWidth, mHeight);
+		printf( "[cuda]   registered %u byte openGL texture for interop access (%ux%u, PBO %u)\n", mSize, mWidth, mHeight, mDMAIndex);
 	}
 	
-	if( CUDA_FAILED(cudaGraphicsMapResources(1, &mInteropCUDA)) )
+	if( CUDA_FAILED(cudaGraphicsMapResources(1, &interop)) )
 		return NULL;
 	
 	void*  devPtr     = NULL;
 	size_t mappedSize = 0;
 
-	if( CUDA_FAILED(cudaGraphicsResourceGetMappedPointer(&devPtr, &mappedSize, mInteropCUDA)) )
+	if( CUDA_FAILED(cudaGraphicsResourceGetMappedPointer(&devPtr, &mappedSize, interop)) )
 	{
-		CUDA(cudaGraphicsUnmapResources(1, &mInteropCUDA));
+		CUDA(cudaGraphicsUnmapResources(1, &interop));
 		return NULL;
 	}
 	
@@ -260,19 +276,24 @@ void* glTexture::MapCUDA()
 // Unmap
 void glTexture::Unmap()
 {
-	if( !mInteropCUDA )
+	if( !mInteropCUDA[mDMAIndex] )
 		return;
 		
-	CUDA(cudaGraphicsUnmapResources(1, &mInteropCUDA));
+	// unmapping orders the CUDA work before the GL commands that use the PBO
+	CUDA(cudaGraphicsUnmapResources(1, &mInteropCUDA[mDMAIndex]));
 	
+	// the upload from the PBO is a DMA queued behind the draws, it doesn't block
 	GL(glEnable(GL_TEXTURE_2D));
 	GL(glBindTexture(GL_TEXTURE_2D, mID));
-	GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, mDMA));
+	GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, mDMA[mDMAIndex]));
 	GL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, mWidth, mHeight, glTextureLayout(mFormat), glTextureType(mFormat), NULL));
 	
 	GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0));
 	GL(glBindTexture(GL_TEXTURE_2D, 0));
 	GL(glDisable(GL_TEXTURE_2D));
+
+	// write the next frame into the other PBO while this one is uploading
+	mDMAIndex = (mDMAIndex + 1) % 2;
 }
 
 
@@ -284,7 +305,7 @@ bool glTexture::UploadCPU( void* data )
 	GL(glActiveTextureARB(GL_TEXTURE0_ARB));
 	GL(glBindTexture(GL_TEXTURE_2D, mID));
 	GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
-	GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, mDMA));
+	GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, mDMA[mDMAIndex]));
 
 	//GL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
 	//GL(glPixelStorei(GL_UNPACK_ROW_LENGTH, img->GetWidth()));
@@ -315,6 +336,8 @@ bool glTexture::UploadCPU( void* data )
 	GL(glBindTexture(GL_TEXTURE_2D, 0));
 	GL(glDisable(GL_TEXTURE_2D));
 
+	mDMAIndex = (mDMAIndex + 1) % 2;
+
 	/*if( !mInteropHost || !mInteropDevice )
 	{
 		if( !cudaAllocMapped(&mInteropHost, &mInteropDevice, mSize) )
@@ -12,6 +12,9 @@
 
 /**
  * OpenGL texture
+ *
+ * Uploads go through two pixel buffer objects (PBOs) used in turn:  while the texture
+ * is being updated from one of them, the next frame can be written into the other.
  */
 class glTexture
 {
@@ -29,7 +32,15 @@ public:
 	inline uint32_t GetFormat() const	{ return mFormat; }
 	inline uint32_t GetSize() const	{ return mSize; }
 	
+	/**
+	 * Map the next PBO for CUDA to write a frame into (GetSize() bytes, in the texture's format).
+	 */
 	void* MapCUDA();
+
+	/**
+	 * Unmap the PBO and start updating the texture from it (asynchronously, the
+	 * following MapCUDA() returns the other PBO so it doesn't wait on the upload).
+	 */
 	void  Unmap();
 	
 	bool UploadCPU( void* data );
@@ -39,13 +50,14 @@ private:
 	bool init(uint32_t width, uint32_t height, uint32_t format, void* data);
 	
 	uint32_t mID;
-	uint32_t mDMA;
+	uint32_t mDMA[2];		// double-buffered PBOs
+	uint32_t mDMAIndex;		// the PBO that's written next
 	uint32_t mWidth;
 	uint32_t mHeight;
 	uint32_t mFormat;
 	uint32_t mSize;
 	
-	cudaGraphicsResource* mInteropCUDA;
+	cudaGraphicsResource* mInteropCUDA[2];
 	void* mInteropHost;
 	void* mInteropDevice;
 };
@@ -0,0 +1,286 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "framePipeline.h"
+
+#include <stdio.h>
+#include <chrono>
+
+
+// constructor
+framePipeline::framePipeline()
+{
+	mNumSlots   = 0;
+	mQueueDepth = 0;
+	mTrace      = NULL;
+	mRunning    = false;
+	mStop       = false;
+
+	for( uint32_t n=0; n < NUM_STAGES; n++ )
+	{
+		mTraceStages[n] = 0;
+		mFrames[n].store(0);
+		mDropped[n].store(0);
+	}
+}
+
+
+// destructor
+framePipeline::~framePipeline()
+{
+	Stop();
+}
+
+
+// Create
+framePipeline* framePipeline::Create( const CaptureFunc& capture, const StageFunc& inference, const StageFunc& present, uint32_t queueDepth )
+{
+	if( !capture || !inference || !present )
+		return NULL;
+
+	framePipeline* pipeline = new framePipeline();
+
+	if( !pipeline )
+		return NULL;
+
+	if( queueDepth == 0 )
+		queueDepth = 1;
+
+	pipeline->mCapture    = capture;
+	pipeline->mInference  = inference;
+	pipeline->mPresent    = present;
+	pipeline->mQueueDepth = queueDepth;
+
+	// one frame in each stage, plus the ones waiting between them,
+	// so that capture always has a free slot to write into
+	pipeline->mNumSlots = NUM_STAGES + (NUM_STAGES - 1) * queueDepth;
+	pipeline->mStamps.resize(pipeline->mNumSlots);
+
+	for( uint32_t n=0; n < pipeline->mNumSlots; n++ )
+	{
+		pipeline->mStamps[n].sequence  = 0;
+		pipeline->mStamps[n].timestamp = 0;
+	}
+
+	return pipeline;
+}
+
+
+// Start
+bool framePipeline::Start()
+{
+	if( mRunning )
+		return true;
+
+	mFree.clear();
+
+	for( uint32_t n=0; n < mNumSlots; n++ )
+		mFree.push_back(mNumSlots - n - 1);
+
+	mStop    = false;
+	mRunning = true;
+
+	mCaptureThread   = std::thread(&framePipeline::captureThread, this);
+	mInferenceThread = std::thread(&framePipeline::inferenceThread, this);
+
+	return true;
+}
+
+
+// Stop
+void framePipeline::Stop()
+{
+	if( !mRunning )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+
+	for( uint32_t n=0; n < NUM_STAGES; n++ )
+		mEvents[n].notify_all();
+
+	mCaptureThread.join();
+	mInferenceThread.join();
+
+	for( uint32_t n=0; n < NUM_STAGES; n++ )
+		mQueues[n].clear();
+
+	mRunning = false;
+}
+
+
+// SetTrace
+void framePipeline::SetTrace( latencyTrace* trace )
+{
+	mTrace = trace;
+
+	if( !trace )
+		return;
+
+	mTraceStages[CAPTURE]   = trace->AddStage("capture");
+	mTraceStages[INFERENCE] = trace->AddStage("inference");
+	mTraceStages[PRESENT]   = trace->AddStage("present");
+}
+
+
+// acquireFree
+int framePipeline::acquireFree()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	// there's always one, since each stage holds at most one slot and the queues are bounded
+	if( mFree.size() == 0 )
+		return -1;
+
+	const uint32_t slot = mFree.back();
+	mFree.pop_back();
+	return slot;
+}
+
+
+// release
+void framePipeline::release( uint32_t slot )
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mFree.push_back(slot);
+}
+
+
+// push
+void framePipeline::push( Stage stage, uint32_t slot )
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		std::deque<uint32_t>& queue = mQueues[stage];
+
+		// the stage is behind, so drop the oldest frame waiting for it
+		if( queue.size() >= mQueueDepth )
+		{
+			mFree.push_back(queue.front());
+			queue.pop_front();
+			mDropped[stage]++;
+		}
+
+		queue.push_back(slot);
+	}
+
+	mEvents[stage].notify_one();
+}
+
+
+// popLatest
+int framePipeline::popLatest( Stage stage, unsigned long timeout )
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	std::deque<uint32_t>& queue = mQueues[stage];
+
+	auto pred = [&]{ return queue.size() > 0 || mStop; };
+
+	if( timeout == ULONG_MAX )
+		mEvents[stage].wait(lock, pred);
+	else if( !mEvents[stage].wait_for(lock, std::chrono::milliseconds(timeout), pred) )
+		return -1;
+
+	if( queue.size() == 0 )
+		return -1;
+
+	// take the newest frame, and skip over any older ones
+	const uint32_t slot = queue.back();
+	queue.pop_back();
+
+	while( queue.size() > 0 )
+	{
+		mFree.push_back(queue.front());
+		queue.pop_front();
+		mDropped[stage]++;
+	}
+
+	return slot;
+}
+
+
+// mark
+void framePipeline::mark( Stage stage, uint32_t slot )
+{
+	mFrames[stage]++;
+
+	if( mTrace != NULL )
+		mTrace->Mark(mStamps[slot], mTraceStages[stage]);
+}
+
+
+// captureThread
+void framePipeline::captureThread()
+{
+	while( !mStop )
+	{
+		const int slot = acquireFree();
+
+		if( slot < 0 )
+		{
+			printf("framePipeline -- no free frame slots for capture\n");
+			break;
+		}
+
+		frameStamp stamp;
+
+		stamp.sequence  = mFrames[CAPTURE].load();
+		stamp.timestamp = traceTime();
+
+		if( !mCapture(slot, &stamp) )
+		{
+			release(slot);
+			continue;
+		}
+
+		mStamps[slot] = stamp;
+		mark(CAPTURE, slot);
+		push(INFERENCE, slot);
+	}
+}
+
+
+// inferenceThread
+void framePipeline::inferenceThread()
+{
+	while( !mStop )
+	{
+		const int slot = popLatest(INFERENCE, 100);
+
+		if( slot < 0 )
+			continue;
+
+		if( !mInference(slot, mStamps[slot]) )
+		{
+			release(slot);
+			continue;
+		}
+
+		mark(INFERENCE, slot);
+		push(PRESENT, slot);
+	}
+}
+
+
+// Present
+bool framePipeline::Present( unsigned long timeout )
+{
+	if( !mRunning )
+		return false;
+
+	const int slot = popLatest(PRESENT, timeout);
+
+	if( slot < 0 )
+		return false;
+
+	const bool result = mPresent(slot, mStamps[slot]);
+
+	if( result )
+		mark(PRESENT, slot);
+
+	release(slot);
+	return result;
+}
@@ -0,0 +1,152 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __FRAME_PIPELINE_H_
+#define __FRAME_PIPELINE_H_
+
+
+#include "latencyTrace.h"
+
+#include <stdint.h>
+#include <limits.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <vector>
+
+
+/**
+ * Runs the capture, inference and presentation of a live video stream as separate stages,
+ * so the throughput is that of the slowest stage instead of the sum of all of them.
+ *
+ * Capture and inference each get their own thread, while presentation runs on the thread
+ * calling Present() (which is usually the one that owns the OpenGL context).  The stages are
+ * connected by bounded queues where the latest frame wins:  when a stage falls behind, the
+ * older frames waiting for it are dropped.
+ *
+ * Frames are passed between the stages as slot indices, which the application uses to index
+ * its own per-frame buffers (allocate GetNumSlots() of them before calling Start()).  A slot
+ * is only ever used by one stage at a time.
+ * @ingroup util
+ */
+class framePipeline
+{
+public:
+	/**
+	 * Stages of the pipeline.
+	 */
+	enum Stage
+	{
+		CAPTURE = 0,
+		INFERENCE,
+		PRESENT,
+		NUM_STAGES
+	};
+
+	/**
+	 * Fills a slot with the next frame, blocking until one is available (or a timeout expires).
+	 * @returns false if no frame was captured
+	 */
+	typedef std::function<bool( uint32_t slot, frameStamp* stamp )> CaptureFunc;
+
+	/**
+	 * Processes the frame in a slot.
+	 * @returns false to drop the frame
+	 */
+	typedef std::function<bool( uint32_t slot, const frameStamp& stamp )> StageFunc;
+
+	/**
+	 * Create a new pipeline.
+	 * @param queueDepth the number of frames that can wait between each of the stages
+	 */
+	static framePipeline* Create( const CaptureFunc& capture, const StageFunc& inference,
+						     const StageFunc& present, uint32_t queueDepth=1 );
+
+	/**
+	 * Destroy (stopping the pipeline if needed)
+	 */
+	~framePipeline();
+
+	/**
+	 * Launch the capture and inference threads.
+	 */
+	bool Start();
+
+	/**
+	 * Stop the capture and inference threads, dropping any frames that are queued.
+	 */
+	void Stop();
+
+	/**
+	 * Run the presentation stage on the calling thread for the newest frame out of inference.
+	 * @param timeout milliseconds to wait for a frame (ULONG_MAX to wait forever)
+	 * @returns false if the timeout expired or the frame was dropped
+	 */
+	bool Present( unsigned long timeout=ULONG_MAX );
+
+	/**
+	 * Record the time that frames finish each stage to a trace (adds the stages to it).
+	 */
+	void SetTrace( latencyTrace* trace );
+
+	/**
+	 * Number of slots the application needs buffers for.
+	 */
+	inline uint32_t GetNumSlots() const				{ return mNumSlots; }
+
+	/**
+	 * Number of frames that have finished a stage.
+	 */
+	inline uint64_t GetFrames( Stage stage ) const		{ return mFrames[stage].load(); }
+
+	/**
+	 * Number of frames that were superseded while waiting for a stage.
+	 */
+	inline uint64_t GetDropped( Stage stage ) const		{ return mDropped[stage].load(); }
+
+protected:
+	framePipeline();
+
+	void captureThread();
+	void inferenceThread();
+
+	int  acquireFree();
+	void release( uint32_t slot );
+	void push( Stage stage, uint32_t slot );
+	int  popLatest( Stage stage, unsigned long timeout );
+	void mark( Stage stage, uint32_t slot );
+
+	CaptureFunc mCapture;
+	StageFunc   mInference;
+	StageFunc   mPresent;
+
+	uint32_t mNumSlots;
+	uint32_t mQueueDepth;
+
+	std::vector<frameStamp> mStamps;
+	std::vector<uint32_t>   mFree;
+	std::deque<uint32_t>    mQueues[NUM_STAGES];	// frames waiting for each stage (CAPTURE is unused)
+
+	std::mutex mMutex;
+	std::condition_variable mEvents[NUM_STAGES];
+
+	std::thread mCaptureThread;
+	std::thread mInferenceThread;
+
+	latencyTrace* mTrace;
+	uint32_t mTraceStages[NUM_STAGES];
+
+	std::atomic<uint64_t> mFrames[NUM_STAGES];
+	std::atomic<uint64_t> mDropped[NUM_STAGES];
+
+	bool mRunning;
+	std::atomic<bool> mStop;
+};
+
+
+#endif
@@ -0,0 +1,320 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "frameRing.h"
+
+#include <stdio.h>
+#include <chrono>
+
+
+// constructor
+frameRing::indexQueue::indexQueue()
+{
+	mCells = NULL;
+	mMask  = 0;
+
+	mEnqueue.store(0);
+	mDequeue.store(0);
+}
+
+
+// destructor
+frameRing::indexQueue::~indexQueue()
+{
+	delete[] mCells;
+}
+
+
+// init
+bool frameRing::indexQueue::init( uint32_t capacity )
+{
+	// round up to a power-of-two so positions wrap with a mask
+	uint64_t size = 2;
+
+	while( size < capacity )
+		size <<= 1;
+
+	mCells = new cell[size];
+
+	if( !mCells )
+		return false;
+
+	for( uint64_t n=0; n < size; n++ )
+		mCells[n].seq.store(n, std::memory_order_relaxed);
+
+	mMask = size - 1;
+	return true;
+}
+
+
+// push
+bool frameRing::indexQueue::push( uint32_t value )
+{
+	cell* c = NULL;
+	uint64_t pos = mEnqueue.load(std::memory_order_relaxed);
+
+	while(true)
+	{
+		c = &mCells[pos & mMask];
+
+		const uint64_t seq  = c->seq.load(std::memory_order_acquire);
+		const int64_t  diff = (int64_t)seq - (int64_t)pos;
+
+		if( diff == 0 )
+		{
+			if( mEnqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+				break;
+		}
+		else if( diff < 0 )
+			return false;	// full
+		else
+			pos = mEnqueue.load(std::memory_order_relaxed);
+	}
+
+	c->value = value;
+	c->seq.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+
+// pop
+bool frameRing::indexQueue::pop( uint32_t* value )
+{
+	cell* c = NULL;
+	uint64_t pos = mDequeue.load(std::memory_order_relaxed);
+
+	while(true)
+	{
+		c = &mCells[pos & mMask];
+
+		const uint64_t seq  = c->seq.load(std::memory_order_acquire);
+		const int64_t  diff = (int64_t)seq - (int64_t)(pos + 1);
+
+		if( diff == 0 )
+		{
+			if( mDequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+				break;
+		}
+		else if( diff < 0 )
+			return false;	// empty
+		else
+			pos = mDequeue.load(std::memory_order_relaxed);
+	}
+
+	*value = c->value;
+	c->seq.store(pos + mMask + 1, std::memory_order_release);
+	return true;
+}
+
+
+// constructor
+frameRing::frameRing()
+{
+	mSequence = NULL;
+	mNumSlots = 0;
+	mPolicy   = DROP_OLDEST;
+
+	mPublished.store(0);
+	mDropped.store(0);
+	mSkipped.store(0);
+	mWaiters.store(0);
+}
+
+
+// destructor
+frameRing::~frameRing()
+{
+	delete[] mSequence;
+}
+
+
+// Create
+frameRing* frameRing::Create( uint32_t numSlots, Policy policy )
+{
+	if( numSlots == 0 )
+		return NULL;
+
+	frameRing* ring = new frameRing();
+
+	if( !ring )
+		return NULL;
+
+	ring->mNumSlots = numSlots;
+	ring->mPolicy   = policy;
+	ring->mSequence = new uint64_t[numSlots];
+
+	if( !ring->mSequence || !ring->mFree.init(numSlots) || !ring->mReady.init(numSlots) )
+	{
+		printf("frameRing -- failed to allocate %u slots\n", numSlots);
+		delete ring;
+		return NULL;
+	}
+
+	// all the slots start out free
+	for( uint32_t n=0; n < numSlots; n++ )
+	{
+		ring->mSequence[n] = 0;
+		ring->mFree.push(n);
+	}
+
+	return ring;
+}
+
+
+// wait
+bool frameRing::wait( std::condition_variable& event, indexQueue& queue, uint32_t* slot, unsigned long timeout )
+{
+	if( queue.pop(slot) )
+		return true;
+
+	if( timeout == 0 )
+		return false;
+
+	// notify() only takes the mutex when there are waiters, so register first
+	// and then check the queue again under the lock so a push can't be missed.
+	// The fence pairs with the one in notify(), so that either the re-check sees
+	// the push, or the pusher sees this waiter (a store followed by a load to
+	// another location can otherwise be reordered, on both sides)
+	mWaiters++;
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	bool result = false;
+
+	{
+		std::unique_lock<std::mutex> lock(mWaitMutex);
+		auto pred = [&]{ return queue.pop(slot); };
+
+		if( timeout == ULONG_MAX )
+		{
+			event.wait(lock, pred);
+			result = true;
+		}
+		else
+			result = event.wait_for(lock, std::chrono::milliseconds(timeout), pred);
+	}
+
+	mWaiters--;
+	return result;
+}
+
+
+// notify
+void frameRing::notify( std::condition_variable& event )
+{
+	// order the caller's push before the check for waiters (see wait())
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if( mWaiters.load() == 0 )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mWaitMutex);
+	}
+
+	event.notify_all();
+}
+
+
+// AcquireWrite
+int frameRing::AcquireWrite( unsigned long timeout )
+{
+	uint32_t slot = 0;
+
+	if( mFree.pop(&slot) )
+		return slot;
+
+	if( mPolicy == DROP_OLDEST )
+	{
+		// steal the oldest frame that hasn't been consumed yet
+		if( mReady.pop(&slot) )
+		{
+			mDropped++;
+			return slot;
+		}
+	}
+	else if( mPolicy == BLOCK )
+	{
+		if( wait(mFreeEvent, mFree, &slot, timeout) )
+			return slot;
+	}
+
+	// every slot is held by the consumers (or the policy is DROP_NEWEST)
+	mDropped++;
+	return -1;
+}
+
+
+// Publish
+void frameRing::Publish( int slot )
+{
+	if( slot < 0 || (uint32_t)slot >= mNumSlots )
+		return;
+
+	mSequence[slot] = mPublished++;
+	mReady.push(slot);
+	notify(mReadyEvent);
+}
+
+
+// Cancel
+void frameRing::Cancel( int slot )
+{
+	Release(slot);
+}
+
+
+// Acquire
+int frameRing::Acquire( unsigned long timeout )
+{
+	uint32_t slot = 0;
+
+	if( !wait(mReadyEvent, mReady, &slot, timeout) )
+		return -1;
+
+	return slot;
+}
+
+
+// AcquireLatest
+int frameRing::AcquireLatest( unsigned long timeout )
+{
+	uint32_t slot = 0;
+
+	if( !wait(mReadyEvent, mReady, &slot, timeout) )
+		return -1;
+
+	// skip ahead to the newest frame, giving the older ones back
+	uint32_t newer = 0;
+
+	while( mReady.pop(&newer) )
+	{
+		Release(slot);
+		mSkipped++;
+		slot = newer;
+	}
+
+	return slot;
+}
+
+
+// Release
+void frameRing::Release( int slot )
+{
+	if( slot < 0 || (uint32_t)slot >= mNumSlots )
+		return;
+
+	mFree.push(slot);
+	notify(mFreeEvent);
+}
+
+
+// Skip
+void frameRing::Skip( int slot )
+{
+	if( slot < 0 || (uint32_t)slot >= mNumSlots )
+		return;
+
+	mSkipped++;
+	Release(slot);
+}
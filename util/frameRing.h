@@ -0,0 +1,178 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __FRAME_RING_H_
+#define __FRAME_RING_H_
+
+
+#include <stdint.h>
+#include <limits.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+
+/**
+ * Lock-free ring of frame slots shared between a producer (i.e. a camera's capture thread)
+ * and one or more consumers.  The ring only tracks slot indices, the frame data itself
+ * lives in the caller's buffers indexed by slot.
+ *
+ * Every slot is owned by exactly one party at a time:  the producer claims a free slot with
+ * AcquireWrite(), fills it and hands it over with Publish().  A consumer takes a published
+ * slot with Acquire() or AcquireLatest() and gives it back with Release().  A slot is never
+ * written while a consumer holds it, so buffers can't be torn by the producer.
+ *
+ * Enqueueing and dequeueing don't take any locks, a mutex is only used for sleeping
+ * when there's nothing to acquire (and only if somebody is actually waiting).
+ * @ingroup util
+ */
+class frameRing
+{
+public:
+	/**
+	 * What AcquireWrite() does when there are no free slots.
+	 */
+	enum Policy
+	{
+		DROP_OLDEST,	/**< reclaim the oldest published frame that no consumer has taken yet */
+		DROP_NEWEST,	/**< fail, so the incoming frame gets discarded */
+		BLOCK		/**< wait for a consumer to release a slot */
+	};
+
+	/**
+	 * Create a new ring.
+	 * @param numSlots number of frame slots
+	 * @param policy what to do when the producer runs out of free slots
+	 */
+	static frameRing* Create( uint32_t numSlots, Policy policy=DROP_OLDEST );
+
+	/**
+	 * Destroy
+	 */
+	~frameRing();
+
+	/**
+	 * Claim a slot for the producer to write the next frame into.
+	 * @param timeout milliseconds to wait with the BLOCK policy (ULONG_MAX to wait forever)
+	 * @returns the slot index, or -1 if the incoming frame has to be dropped
+	 */
+	int AcquireWrite( unsigned long timeout=ULONG_MAX );
+
+	/**
+	 * Hand a slot from AcquireWrite() over to the consumers, assigning it the next sequence number.
+	 */
+	void Publish( int slot );
+
+	/**
+	 * Return a slot from AcquireWrite() without publishing it.
+	 */
+	void Cancel( int slot );
+
+	/**
+	 * Take the oldest published frame.
+	 * @param timeout milliseconds to wait for a frame (ULONG_MAX to wait forever)
+	 * @returns the slot index, or -1 if the timeout expired
+	 */
+	int Acquire( unsigned long timeout=ULONG_MAX );
+
+	/**
+	 * Take the newest published frame, releasing any older ones that are still queued.
+	 * @returns the slot index, or -1 if the timeout expired
+	 */
+	int AcquireLatest( unsigned long timeout=ULONG_MAX );
+
+	/**
+	 * Give a slot from Acquire() or AcquireLatest() back to the producer.
+	 */
+	void Release( int slot );
+
+	/**
+	 * Give back a slot from Acquire() that was passed over for a newer frame (counted by GetSkipped()),
+	 * for consumers that need to clean up a slot before it's freed instead of using AcquireLatest().
+	 */
+	void Skip( int slot );
+
+	/**
+	 * Sequence number the frame in a slot was published with (starting from 0).
+	 */
+	inline uint64_t GetSequence( int slot ) const	{ return mSequence[slot]; }
+
+	/**
+	 * Number of slots in the ring.
+	 */
+	inline uint32_t GetNumSlots() const			{ return mNumSlots; }
+
+	/**
+	 * The policy for when there are no free slots.
+	 */
+	inline Policy GetPolicy() const			{ return mPolicy; }
+
+	/**
+	 * Number of frames published so far.
+	 */
+	inline uint64_t GetPublished() const		{ return mPublished.load(); }
+
+	/**
+	 * Number of frames lost by the producer (reclaimed by DROP_OLDEST, or never written).
+	 */
+	inline uint64_t GetDropped() const			{ return mDropped.load(); }
+
+	/**
+	 * Number of published frames that AcquireLatest() skipped over.
+	 */
+	inline uint64_t GetSkipped() const			{ return mSkipped.load(); }
+
+protected:
+	frameRing();
+
+	/*
+	 * bounded MPMC queue of slot indices (Vyukov)
+	 */
+	class indexQueue
+	{
+	public:
+		indexQueue();
+		~indexQueue();
+
+		bool init( uint32_t capacity );
+		bool push( uint32_t value );
+		bool pop( uint32_t* value );
+
+	private:
+		struct cell
+		{
+			std::atomic<uint64_t> seq;
+			uint32_t value;
+		};
+
+		cell*    mCells;
+		uint64_t mMask;
+
+		std::atomic<uint64_t> mEnqueue;
+		std::atomic<uint64_t> mDequeue;
+	};
+
+	bool wait( std::condition_variable& event, indexQueue& queue, uint32_t* slot, unsigned long timeout );
+	void notify( std::condition_variable& event );
+
+	indexQueue mFree;
+	indexQueue mReady;
+
+	uint64_t* mSequence;
+	uint32_t  mNumSlots;
+	Policy    mPolicy;
+
+	std::atomic<uint64_t> mPublished;
+	std::atomic<uint64_t> mDropped;
+	std::atomic<uint64_t> mSkipped;
+	std::atomic<uint32_t> mWaiters;
+
+	std::mutex mWaitMutex;
+	std::condition_variable mReadyEvent;
+	std::condition_variable mFreeEvent;
+};
+
+
+#endif
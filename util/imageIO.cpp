@@ -0,0 +1,773 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "imageIO.h"
+#include "threadPool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <setjmp.h>
+
+#include <mutex>
+#include <condition_variable>
+
+#ifdef HAS_QT
+#include <QImage>
+#endif
+
+#ifdef HAS_LIBJPEG
+#include <jpeglib.h>
+#endif
+
+#ifdef HAS_LIBPNG
+#include <png.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGE_IO_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define IMAGE_IO_SSE
+#endif
+
+
+#define LOG_IMAGE_IO "[imageIO] "
+
+
+//-----------------------------------------------------------------------------------
+// threading
+//-----------------------------------------------------------------------------------
+static threadPool* gImagePool    = NULL;
+static uint32_t    gImageThreads = 1;
+static std::mutex  gImageMutex;
+
+
+// setImageThreads
+void setImageThreads( uint32_t numThreads )
+{
+	if( numThreads == 0 )
+		numThreads = threadPool::GetNumCores();
+
+	std::lock_guard<std::mutex> lock(gImageMutex);
+
+	if( numThreads == gImageThreads )
+		return;
+
+	if( gImagePool != NULL )
+	{
+		delete gImagePool;
+		gImagePool = NULL;
+	}
+
+	gImageThreads = numThreads;
+}
+
+
+// getImageThreads
+uint32_t getImageThreads()
+{
+	return gImageThreads;
+}
+
+
+// imageParallelRows
+void imageParallelRows( int rows, const std::function<void(int, int)>& func )
+{
+	const int numChunks = (rows < (int)gImageThreads) ? rows : gImageThreads;
+
+	if( numChunks <= 1 )
+	{
+		func(0, rows);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(gImageMutex);
+
+		if( !gImagePool )
+			gImagePool = threadPool::Create(gImageThreads - 1);	// the calling thread processes a chunk too
+	}
+
+	const int chunkRows = (rows + numChunks - 1) / numChunks;
+
+	std::mutex mutex;
+	std::condition_variable event;
+	int remaining = numChunks - 1;
+
+	for( int n=1; n < numChunks; n++ )
+	{
+		const int rowBegin = n * chunkRows;
+		const int rowEnd   = (rowBegin + chunkRows < rows) ? rowBegin + chunkRows : rows;
+
+		gImagePool->Enqueue([&, rowBegin, rowEnd]()
+		{
+			if( rowBegin < rowEnd )
+				func(rowBegin, rowEnd);
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if( --remaining == 0 )
+				event.notify_one();
+		});
+	}
+
+	func(0, chunkRows);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	event.wait(lock, [&]{ return remaining == 0; });
+}
+
+
+//-----------------------------------------------------------------------------------
+// row conversion
+//-----------------------------------------------------------------------------------
+
+// convertRowRGBA8ToFloat4
+void convertRowRGBA8ToFloat4( const uint8_t* input, float4* output, int width )
+{
+	int x = 0;
+	float* out = (float*)output;
+
+#if defined(IMAGE_IO_NEON)
+	for( ; x + 4 <= width; x += 4 )
+	{
+		const uint8x16_t px = vld1q_u8(input + x * 4);
+		const uint16x8_t lo = vmovl_u8(vget_low_u8(px));
+		const uint16x8_t hi = vmovl_u8(vget_high_u8(px));
+
+		vst1q_f32(out + x * 4 + 0,  vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))));
+		vst1q_f32(out + x * 4 + 4,  vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))));
+		vst1q_f32(out + x * 4 + 8,  vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))));
+		vst1q_f32(out + x * 4 + 12, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))));
+	}
+#elif defined(IMAGE_IO_SSE)
+	const __m128i zero = _mm_setzero_si128();
+
+	for( ; x + 4 <= width; x += 4 )
+	{
+		const __m128i px = _mm_loadu_si128((const __m128i*)(input + x * 4));
+		const __m128i lo = _mm_unpacklo_epi8(px, zero);
+		const __m128i hi = _mm_unpackhi_epi8(px, zero);
+
+		_mm_storeu_ps(out + x * 4 + 0,  _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+		_mm_storeu_ps(out + x * 4 + 4,  _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+		_mm_storeu_ps(out + x * 4 + 8,  _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+		_mm_storeu_ps(out + x * 4 + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+	}
+#endif
+
+	for( ; x < width; x++ )
+		output[x] = make_float4(input[x*4+0], input[x*4+1], input[x*4+2], input[x*4+3]);
+}
+
+
+// convertRowRGBA8ToPlanar
+void convertRowRGBA8ToPlanar( const uint8_t* input, float* r, float* g, float* b, int width, const float3& mean )
+{
+	int x = 0;
+
+#if defined(IMAGE_IO_NEON)
+	const float32x4_t meanR = vdupq_n_f32(mean.x);
+	const float32x4_t meanG = vdupq_n_f32(mean.y);
+	const float32x4_t meanB = vdupq_n_f32(mean.z);
+
+	for( ; x + 8 <= width; x += 8 )
+	{
+		const uint8x8x4_t px = vld4_u8(input + x * 4);	// deinterleaves the channels
+
+		const uint16x8_t pr = vmovl_u8(px.val[0]);
+		const uint16x8_t pg = vmovl_u8(px.val[1]);
+		const uint16x8_t pb = vmovl_u8(px.val[2]);
+
+		vst1q_f32(r + x + 0, vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(pr))),  meanR));
+		vst1q_f32(r + x + 4, vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(pr))), meanR));
+		vst1q_f32(g + x + 0, vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(pg))),  meanG));
+		vst1q_f32(g + x + 4, vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(pg))), meanG));
+		vst1q_f32(b + x + 0, vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(pb))),  meanB));
+		vst1q_f32(b + x + 4, vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(pb))), meanB));
+	}
+#elif defined(IMAGE_IO_SSE)
+	const __m128i zero  = _mm_setzero_si128();
+	const __m128  meanR = _mm_set1_ps(mean.x);
+	const __m128  meanG = _mm_set1_ps(mean.y);
+	const __m128  meanB = _mm_set1_ps(mean.z);
+
+	for( ; x + 4 <= width; x += 4 )
+	{
+		const __m128i px = _mm_loadu_si128((const __m128i*)(input + x * 4));
+		const __m128i lo = _mm_unpacklo_epi8(px, zero);
+		const __m128i hi = _mm_unpackhi_epi8(px, zero);
+
+		__m128 p0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+		__m128 p1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+		__m128 p2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+		__m128 p3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+
+		_MM_TRANSPOSE4_PS(p0, p1, p2, p3);	// p0-p2 now hold the R, G, B channels of the 4 pixels
+
+		_mm_storeu_ps(r + x, _mm_sub_ps(p0, meanR));
+		_mm_storeu_ps(g + x, _mm_sub_ps(p1, meanG));
+		_mm_storeu_ps(b + x, _mm_sub_ps(p2, meanB));
+	}
+#endif
+
+	for( ; x < width; x++ )
+	{
+		r[x] = float(input[x*4+0]) - mean.x;
+		g[x] = float(input[x*4+1]) - mean.y;
+		b[x] = float(input[x*4+2]) - mean.z;
+	}
+}
+
+
+// convertRowFloat4ToRGB8
+void convertRowFloat4ToRGB8( const float4* input, uint8_t* output, int width, float scale )
+{
+	int x = 0;
+
+#if defined(IMAGE_IO_NEON)
+	const float32x4_t vscale = vdupq_n_f32(scale);
+	const float32x4_t vmin   = vdupq_n_f32(0.0f);
+	const float32x4_t vmax   = vdupq_n_f32(255.0f);
+
+	for( ; x + 8 <= width; x += 8 )
+	{
+		const float32x4x4_t p0 = vld4q_f32((const float*)(input + x));		// pixels 0-3, deinterleaved
+		const float32x4x4_t p1 = vld4q_f32((const float*)(input + x + 4));	// pixels 4-7, deinterleaved
+
+		uint8x8x3_t px;
+
+		for( int c=0; c < 3; c++ )
+		{
+			const uint32x4_t lo = vcvtq_u32_f32(vminq_f32(vmaxq_f32(vmulq_f32(p0.val[c], vscale), vmin), vmax));
+			const uint32x4_t hi = vcvtq_u32_f32(vminq_f32(vmaxq_f32(vmulq_f32(p1.val[c], vscale), vmin), vmax));
+
+			px.val[c] = vmovn_u16(vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+		}
+
+		vst3_u8(output + x * 3, px);
+	}
+#elif defined(IMAGE_IO_SSE)
+	const __m128 vscale = _mm_set1_ps(scale);
+	const __m128 vmin   = _mm_setzero_ps();
+	const __m128 vmax   = _mm_set1_ps(255.0f);
+
+	const float* in = (const float*)input;
+
+	for( ; x + 4 <= width; x += 4 )
+	{
+		const __m128i p0 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + x * 4 + 0),  vscale), vmin), vmax));
+		const __m128i p1 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + x * 4 + 4),  vscale), vmin), vmax));
+		const __m128i p2 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + x * 4 + 8),  vscale), vmin), vmax));
+		const __m128i p3 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + x * 4 + 12), vscale), vmin), vmax));
+
+		uint8_t rgba[16] __attribute__((aligned(16)));
+		_mm_store_si128((__m128i*)rgba, _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3)));
+
+		uint8_t* out = output + x * 3;
+
+		for( int n=0; n < 4; n++ )
+		{
+			out[n*3+0] = rgba[n*4+0];
+			out[n*3+1] = rgba[n*4+1];
+			out[n*3+2] = rgba[n*4+2];
+		}
+	}
+#endif
+
+	for( ; x < width; x++ )
+	{
+		const float px[] = { input[x].x * scale, input[x].y * scale, input[x].z * scale };
+
+		for( int c=0; c < 3; c++ )
+			output[x*3+c] = (px[c] <= 0.0f) ? 0 : (px[c] >= 255.0f) ? 255 : (uint8_t)px[c];
+	}
+}
+
+
+//-----------------------------------------------------------------------------------
+// JPEG
+//-----------------------------------------------------------------------------------
+#ifdef HAS_LIBJPEG
+
+struct jpegErrorMgr
+{
+	struct jpeg_error_mgr pub;
+	jmp_buf jump;
+};
+
+
+// jpegErrorExit
+static void jpegErrorExit( j_common_ptr cinfo )
+{
+	char msg[JMSG_LENGTH_MAX];
+	(*cinfo->err->format_message)(cinfo, msg);
+	printf(LOG_IMAGE_IO "libjpeg error:  %s\n", msg);
+
+	longjmp(((jpegErrorMgr*)cinfo->err)->jump, 1);
+}
+
+
+// decodeJPEG
+static bool decodeJPEG( FILE* file, uint8_t** rgba, int* width, int* height )
+{
+	struct jpeg_decompress_struct cinfo;
+	struct jpegErrorMgr jerr;
+
+	uint8_t* volatile pixels = NULL;
+	uint8_t* volatile rowBuffer = NULL;
+
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = jpegErrorExit;
+
+	if( setjmp(jerr.jump) )
+	{
+		jpeg_destroy_decompress(&cinfo);
+		free(pixels);
+		free(rowBuffer);
+		return false;
+	}
+
+	jpeg_create_decompress(&cinfo);
+	jpeg_stdio_src(&cinfo, file);
+	jpeg_read_header(&cinfo, TRUE);
+
+#ifdef JCS_EXTENSIONS
+	cinfo.out_color_space = JCS_EXT_RGBA;	// libjpeg-turbo can decode straight to RGBA
+#else
+	cinfo.out_color_space = JCS_RGB;
+#endif
+
+	jpeg_start_decompress(&cinfo);
+
+	const uint32_t imgWidth  = cinfo.output_width;
+	const uint32_t imgHeight = cinfo.output_height;
+
+	pixels = (uint8_t*)malloc(imgWidth * imgHeight * 4);
+
+#ifdef JCS_EXTENSIONS
+	if( !pixels )
+#else
+	rowBuffer = (uint8_t*)malloc(imgWidth * 3);
+
+	if( !pixels || !rowBuffer )
+#endif
+	{
+		printf(LOG_IMAGE_IO "failed to allocate %ux%u image\n", imgWidth, imgHeight);
+		jpeg_destroy_decompress(&cinfo);
+		free(pixels);
+		free(rowBuffer);
+		return false;
+	}
+
+	while( cinfo.output_scanline < imgHeight )
+	{
+		uint8_t* dst = pixels + cinfo.output_scanline * imgWidth * 4;
+
+#ifdef JCS_EXTENSIONS
+		JSAMPROW row = dst;
+		jpeg_read_scanlines(&cinfo, &row, 1);
+#else
+		JSAMPROW row = rowBuffer;
+		jpeg_read_scanlines(&cinfo, &row, 1);
+
+		for( uint32_t x=0; x < imgWidth; x++ )
+		{
+			dst[x*4+0] = rowBuffer[x*3+0];
+			dst[x*4+1] = rowBuffer[x*3+1];
+			dst[x*4+2] = rowBuffer[x*3+2];
+			dst[x*4+3] = 255;
+		}
+#endif
+	}
+
+	jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+	free(rowBuffer);
+
+	*rgba   = pixels;
+	*width  = imgWidth;
+	*height = imgHeight;
+	return true;
+}
+
+
+// encodeJPEG
+static bool encodeJPEG( FILE* file, const uint8_t* pixels, int width, int height, int channels, int quality )
+{
+	struct jpeg_compress_struct cinfo;
+	struct jpegErrorMgr jerr;
+
+	uint8_t* volatile rowBuffer = NULL;
+
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = jpegErrorExit;
+
+	if( setjmp(jerr.jump) )
+	{
+		jpeg_destroy_compress(&cinfo);
+		free(rowBuffer);
+		return false;
+	}
+
+	jpeg_create_compress(&cinfo);
+	jpeg_stdio_dest(&cinfo, file);
+
+	cinfo.image_width      = width;
+	cinfo.image_height     = height;
+	cinfo.input_components = (channels == 1) ? 1 : 3;
+	cinfo.in_color_space   = (channels == 1) ? JCS_GRAYSCALE : JCS_RGB;
+
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, quality, TRUE);
+	jpeg_start_compress(&cinfo, TRUE);
+
+	if( channels == 4 )
+		rowBuffer = (uint8_t*)malloc(width * 3);
+
+	while( cinfo.next_scanline < cinfo.image_height )
+	{
+		const uint8_t* src = pixels + cinfo.next_scanline * width * channels;
+		JSAMPROW row = (JSAMPROW)src;
+
+		if( rowBuffer != NULL )
+		{
+			for( int x=0; x < width; x++ )
+			{
+				rowBuffer[x*3+0] = src[x*4+0];
+				rowBuffer[x*3+1] = src[x*4+1];
+				rowBuffer[x*3+2] = src[x*4+2];
+			}
+
+			row = rowBuffer;
+		}
+
+		jpeg_write_scanlines(&cinfo, &row, 1);
+	}
+
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+	free(rowBuffer);
+	return true;
+}
+
+#endif
+
+
+//-----------------------------------------------------------------------------------
+// PNG
+//-----------------------------------------------------------------------------------
+#ifdef HAS_LIBPNG
+
+// decodePNG
+static bool decodePNG( FILE* file, uint8_t** rgba, int* width, int* height )
+{
+	png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+
+	if( !png )
+		return false;
+
+	png_infop info = png_create_info_struct(png);
+
+	if( !info )
+	{
+		png_destroy_read_struct(&png, NULL, NULL);
+		return false;
+	}
+
+	uint8_t*   volatile pixels = NULL;
+	png_bytep* volatile rows   = NULL;
+
+	if( setjmp(png_jmpbuf(png)) )
+	{
+		png_destroy_read_struct(&png, &info, NULL);
+		free(pixels);
+		free(rows);
+		return false;
+	}
+
+	png_init_io(png, file);
+	png_read_info(png, info);
+
+	const uint32_t imgWidth  = png_get_image_width(png, info);
+	const uint32_t imgHeight = png_get_image_height(png, info);
+	const int      colorType = png_get_color_type(png, info);
+	const int      bitDepth  = png_get_bit_depth(png, info);
+
+	// expand everything to 8-bit RGBA
+	if( bitDepth == 16 )
+		png_set_strip_16(png);
+
+	if( colorType == PNG_COLOR_TYPE_PALETTE )
+		png_set_palette_to_rgb(png);
+
+	if( colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8 )
+		png_set_expand_gray_1_2_4_to_8(png);
+
+	if( png_get_valid(png, info, PNG_INFO_tRNS) )
+		png_set_tRNS_to_alpha(png);
+
+	if( colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA )
+		png_set_gray_to_rgb(png);
+
+	if( !(colorType & PNG_COLOR_MASK_ALPHA) && !png_get_valid(png, info, PNG_INFO_tRNS) )
+		png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+
+	png_set_interlace_handling(png);
+	png_read_update_info(png, info);
+
+	pixels = (uint8_t*)malloc(imgWidth * imgHeight * 4);
+	rows   = (png_bytep*)malloc(imgHeight * sizeof(png_bytep));
+
+	if( !pixels || !rows )
+	{
+		printf(LOG_IMAGE_IO "failed to allocate %ux%u image\n", imgWidth, imgHeight);
+		png_destroy_read_struct(&png, &info, NULL);
+		free(pixels);
+		free(rows);
+		return false;
+	}
+
+	for( uint32_t y=0; y < imgHeight; y++ )
+		rows[y] = pixels + y * imgWidth * 4;
+
+	png_read_image(png, rows);
+	png_read_end(png, NULL);
+	png_destroy_read_struct(&png, &info, NULL);
+	free(rows);
+
+	*rgba   = pixels;
+	*width  = imgWidth;
+	*height = imgHeight;
+	return true;
+}
+
+
+// encodePNG
+static bool encodePNG( FILE* file, const uint8_t* pixels, int width, int height, int channels )
+{
+	png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+
+	if( !png )
+		return false;
+
+	png_infop info = png_create_info_struct(png);
+
+	if( !info )
+	{
+		png_destroy_write_struct(&png, NULL);
+		return false;
+	}
+
+	if( setjmp(png_jmpbuf(png)) )
+	{
+		png_destroy_write_struct(&png, &info);
+		return false;
+	}
+
+	const int colorType = (channels == 1) ? PNG_COLOR_TYPE_GRAY :
+					  (channels == 3) ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGB_ALPHA;
+
+	png_init_io(png, file);
+	png_set_IHDR(png, info, width, height, 8, colorType, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	png_write_info(png, info);
+
+	for( int y=0; y < height; y++ )
+		png_write_row(png, (png_bytep)(pixels + y * width * channels));
+
+	png_write_end(png, NULL);
+	png_destroy_write_struct(&png, &info);
+	return true;
+}
+
+#endif
+
+
+//-----------------------------------------------------------------------------------
+// decode / encode
+//-----------------------------------------------------------------------------------
+
+// decodeImageQt
+#ifndef HAS_QT
+bool decodeImageQt( const char* filename, uint8_t** /*rgba*/, int* /*width*/, int* /*height*/ )
+{
+	printf(LOG_IMAGE_IO "can't decode %s, the format is unsupported without Qt\n", filename);
+	return false;
+}
+#else
+bool decodeImageQt( const char* filename, uint8_t** rgba, int* width, int* height )
+{
+	QImage qImg;
+
+	if( !qImg.load(filename) )
+		return false;
+
+	if( qImg.format() != QImage::Format_ARGB32 )
+		qImg = qImg.convertToFormat(QImage::Format_ARGB32);
+
+	const int imgWidth  = qImg.width();
+	const int imgHeight = qImg.height();
+
+	uint8_t* pixels = (uint8_t*)malloc(imgWidth * imgHeight * 4);
+
+	if( !pixels )
+		return false;
+
+	imageParallelRows(imgHeight, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+		{
+			const QRgb* src = (const QRgb*)qImg.constScanLine(y);
+			uint8_t*    dst = pixels + y * imgWidth * 4;
+
+			for( int x=0; x < imgWidth; x++ )
+			{
+				dst[x*4+0] = qRed(src[x]);
+				dst[x*4+1] = qGreen(src[x]);
+				dst[x*4+2] = qBlue(src[x]);
+				dst[x*4+3] = qAlpha(src[x]);
+			}
+		}
+	});
+
+	*rgba   = pixels;
+	*width  = imgWidth;
+	*height = imgHeight;
+	return true;
+}
+#endif
+
+
+// decodeImage
+bool decodeImage( const char* filename, uint8_t** rgba, int* width, int* height )
+{
+	if( !filename || !rgba || !width || !height )
+		return false;
+
+	FILE* file = fopen(filename, "rb");
+
+	if( !file )
+	{
+		printf(LOG_IMAGE_IO "failed to open %s\n", filename);
+		return false;
+	}
+
+	// detect the format from the file signature, not the extension
+	uint8_t magic[8];
+	const size_t magicSize = fread(magic, 1, sizeof(magic), file);
+	rewind(file);
+
+	bool result = false;
+
+#ifdef HAS_LIBJPEG
+	if( magicSize >= 3 && magic[0] == 0xFF && magic[1] == 0xD8 && magic[2] == 0xFF )
+		result = decodeJPEG(file, rgba, width, height);
+#endif
+
+#ifdef HAS_LIBPNG
+	if( magicSize >= 8 && png_sig_cmp(magic, 0, 8) == 0 )
+		result = decodePNG(file, rgba, width, height);
+#endif
+
+	fclose(file);
+
+	if( result )
+		return true;
+
+	// unsupported format, or the direct decoder rejected the file
+	return decodeImageQt(filename, rgba, width, height);
+}
+
+
+// encodeImage
+bool encodeImage( const char* filename, const uint8_t* pixels, int width, int height, int channels, int quality )
+{
+	if( !filename || !pixels || width <= 0 || height <= 0 )
+		return false;
+
+	if( channels != 1 && channels != 3 && channels != 4 )
+	{
+		printf(LOG_IMAGE_IO "unsupported number of channels (%i) for %s\n", channels, filename);
+		return false;
+	}
+
+	const char* ext = strrchr(filename, '.');
+
+	const bool isJPEG = ext != NULL && (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0);
+	const bool isPNG  = ext != NULL && strcasecmp(ext, ".png") == 0;
+
+#if defined(HAS_LIBJPEG) || defined(HAS_LIBPNG)
+	bool direct = false;
+
+#ifdef HAS_LIBJPEG
+	direct |= isJPEG;
+#endif
+#ifdef HAS_LIBPNG
+	direct |= isPNG;
+#endif
+
+	if( direct )
+	{
+		FILE* file = fopen(filename, "wb");
+
+		if( !file )
+		{
+			printf(LOG_IMAGE_IO "failed to open %s for writing\n", filename);
+			return false;
+		}
+
+		bool result = false;
+
+#ifdef HAS_LIBJPEG
+		if( isJPEG )
+			result = encodeJPEG(file, pixels, width, height, channels, quality);
+#endif
+#ifdef HAS_LIBPNG
+		if( isPNG )
+			result = encodePNG(file, pixels, width, height, channels);
+#endif
+
+		fclose(file);
+		return result;
+	}
+#endif
+
+	// other formats are saved through Qt
+#ifndef HAS_QT
+	printf(LOG_IMAGE_IO "can't encode %s, the format is unsupported without Qt\n", filename);
+	return false;
+#else
+	QImage qImg(width, height, (channels == 1) ? QImage::Format_Indexed8 :
+						  (channels == 3) ? QImage::Format_RGB32 : QImage::Format_ARGB32);
+
+	if( channels == 1 )
+	{
+		qImg.setColorCount(256);
+
+		for( int n=0; n < 256; n++ )
+			qImg.setColor(n, qRgb(n, n, n));
+	}
+
+	for( int y=0; y < height; y++ )
+	{
+		const uint8_t* src = pixels + y * width * channels;
+
+		if( channels == 1 )
+		{
+			memcpy(qImg.scanLine(y), src, width);
+			continue;
+		}
+
+		QRgb* dst = (QRgb*)qImg.scanLine(y);
+
+		for( int x=0; x < width; x++ )
+			dst[x] = qRgba(src[x*channels+0], src[x*channels+1], src[x*channels+2], (channels == 4) ? src[x*4+3] : 255);
+	}
+
+	return qImg.save(filename, NULL, isJPEG ? quality : -1);
+#endif
+}
@@ -0,0 +1,99 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __IMAGE_IO_H_
+#define __IMAGE_IO_H_
+
+
+#include "cudaUtility.h"
+
+#include <stdint.h>
+#include <functional>
+
+
+/**
+ * Decode an image file into a tightly-packed 8-bit RGBA buffer.
+ * JPEG and PNG files are decoded directly with libjpeg(-turbo) and libpng when available,
+ * other formats fall back to QImage (if built with Qt).  The buffer is allocated with malloc() and should be
+ * released by the caller with free().
+ *
+ * @param filename Path to the image file on disk.
+ * @param rgba Pointer that receives the decoded RGBA8 pixels (width * height * 4 bytes).
+ * @param width Receives the width of the image in pixels.
+ * @param height Receives the height of the image in pixels.
+ *
+ * @ingroup util
+ */
+bool decodeImage( const char* filename, uint8_t** rgba, int* width, int* height );
+
+
+/**
+ * Decode an image file through QImage into a tightly-packed 8-bit RGBA buffer.
+ * This is the reference path used for formats without a direct decoder, and fails if built without Qt.
+ * @ingroup util
+ */
+bool decodeImageQt( const char* filename, uint8_t** rgba, int* width, int* height );
+
+
+/**
+ * Encode a tightly-packed 8-bit image to disk.  The format is selected from the file extension,
+ * with JPEG and PNG written directly through libjpeg/libpng when available and other formats through QImage (if built with Qt).
+ *
+ * @param channels number of interleaved channels (1 for grayscale, 3 for RGB, 4 for RGBA)
+ * @param quality JPEG quality (1-100), ignored for other formats
+ *
+ * @ingroup util
+ */
+bool encodeImage( const char* filename, const uint8_t* pixels, int width, int height, int channels, int quality=95 );
+
+
+/**
+ * Set the number of threads used to split image conversion loops across rows.
+ * The default of 1 runs the conversion on the calling thread, which is preferable
+ * when images are already being loaded from multiple threads (like segnet-batch).
+ * @param numThreads number of threads, or 0 for the number of CPU cores.
+ * @ingroup util
+ */
+void setImageThreads( uint32_t numThreads );
+
+
+/**
+ * Retrieve the number of threads used for image conversion.
+ * @ingroup util
+ */
+uint32_t getImageThreads();
+
+
+/**
+ * Run func(rowBegin, rowEnd) over the rows of an image, split across the image threads.
+ * Blocks until all of the rows have been processed.
+ * @ingroup util
+ */
+void imageParallelRows( int rows, const std::function<void(int, int)>& func );
+
+
+/**
+ * Convert a row of RGBA8 pixels to float4 (0-255 range), using NEON/SSE when available.
+ * @ingroup util
+ */
+void convertRowRGBA8ToFloat4( const uint8_t* input, float4* output, int width );
+
+
+/**
+ * Convert a row of RGBA8 pixels to band-sequential float planes with mean subtraction,
+ * such that r[x] = R - mean.x, g[x] = G - mean.y, b[x] = B - mean.z.  Alpha is discarded.
+ * @ingroup util
+ */
+void convertRowRGBA8ToPlanar( const uint8_t* input, float* r, float* g, float* b, int width, const float3& mean );
+
+
+/**
+ * Convert a row of float4 pixels to packed RGB8, multiplying by scale and
+ * clamping to 0-255.  Alpha is discarded.
+ * @ingroup util
+ */
+void convertRowFloat4ToRGB8( const float4* input, uint8_t* output, int width, float scale );
+
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "latencyTrace.h"
+
+#include <algorithm>
+
+
+// constructor
+latencyTrace::latencyTrace()
+{
+	mFile   = NULL;
+	mWindow = 0;
+}
+
+
+// destructor
+latencyTrace::~latencyTrace()
+{
+	if( mFile != NULL )
+	{
+		fclose(mFile);
+		mFile = NULL;
+	}
+}
+
+
+// Create
+latencyTrace* latencyTrace::Create( const char* filename, uint32_t window )
+{
+	latencyTrace* trace = new latencyTrace();
+
+	if( !trace )
+		return NULL;
+
+	trace->mWindow = (window > 0) ? window : 1;
+
+	if( filename != NULL )
+	{
+		trace->mFile = fopen(filename, "w");
+
+		if( !trace->mFile )
+		{
+			printf(LOG_TRACE "failed to open '%s' for writing\n", filename);
+			delete trace;
+			return NULL;
+		}
+
+		fprintf(trace->mFile, "sequence,stage,capture_ns,time_ns,latency_us\n");
+		printf(LOG_TRACE "recording latency samples to '%s'\n", filename);
+	}
+
+	return trace;
+}
+
+
+// AddStage
+uint32_t latencyTrace::AddStage( const char* name )
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	stage s;
+
+	s.name  = (name != NULL) ? name : "";
+	s.count = 0;
+	s.samples.reserve(mWindow);
+
+	mStages.push_back(s);
+	return mStages.size() - 1;
+}
+
+
+// Mark
+void latencyTrace::Mark( const frameStamp& frame, uint32_t index, uint64_t time )
+{
+	if( time == 0 )
+		time = traceTime();
+
+	// frames captured after the mark would be a clock mismatch, count them as 0
+	const uint64_t latency = (time > frame.timestamp) ? time - frame.timestamp : 0;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if( index >= mStages.size() )
+		return;
+
+	stage& s = mStages[index];
+
+	if( s.samples.size() < mWindow )
+		s.samples.push_back(latency);
+	else
+		s.samples[s.count % mWindow] = latency;
+
+	s.count++;
+
+	if( mFile != NULL )
+		fprintf(mFile, "%llu,%s,%llu,%llu,%.1f\n", (unsigned long long)frame.sequence, s.name.c_str(),
+			   (unsigned long long)frame.timestamp, (unsigned long long)time, latency / 1000.0);
+}
+
+
+// percentile of sorted samples
+static uint64_t percentileSorted( const std::vector<uint64_t>& sorted, float percentile )
+{
+	if( percentile <= 0.0f )
+		return sorted.front();
+
+	if( percentile >= 100.0f )
+		return sorted.back();
+
+	// nearest-rank
+	const size_t rank = (size_t)((percentile / 100.0f) * sorted.size() + 0.5f);
+	return sorted[(rank > 0) ? rank - 1 : 0];
+}
+
+
+// GetPercentile
+bool latencyTrace::GetPercentile( uint32_t index, float percentile, uint64_t* latency )
+{
+	if( !latency )
+		return false;
+
+	std::vector<uint64_t> sorted;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if( index >= mStages.size() || mStages[index].samples.size() == 0 )
+			return false;
+
+		sorted = mStages[index].samples;
+	}
+
+	std::sort(sorted.begin(), sorted.end());
+	*latency = percentileSorted(sorted, percentile);
+	return true;
+}
+
+
+// Report
+void latencyTrace::Report()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	printf(LOG_TRACE "latency since capture (ms), over the last %u frames\n", mWindow);
+	printf(LOG_TRACE "%-16s %8s %8s %8s %8s %10s\n", "stage", "p50", "p90", "p99", "max", "frames");
+
+	std::vector<uint64_t> sorted;
+
+	for( size_t n=0; n < mStages.size(); n++ )
+	{
+		const stage& s = mStages[n];
+
+		if( s.samples.size() == 0 )
+		{
+			printf(LOG_TRACE "%-16s %8s %8s %8s %8s %10llu\n", s.name.c_str(), "-", "-", "-", "-", 0ULL);
+			continue;
+		}
+
+		sorted = s.samples;
+		std::sort(sorted.begin(), sorted.end());
+
+		printf(LOG_TRACE "%-16s %8.2f %8.2f %8.2f %8.2f %10llu\n", s.name.c_str(),
+			  percentileSorted(sorted, 50.0f) / 1000000.0,
+			  percentileSorted(sorted, 90.0f) / 1000000.0,
+			  percentileSorted(sorted, 99.0f) / 1000000.0,
+			  sorted.back() / 1000000.0, (unsigned long long)s.count);
+	}
+
+	if( mFile != NULL )
+		fflush(mFile);
+}
+
+
+// Reset
+void latencyTrace::Reset()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for( size_t n=0; n < mStages.size(); n++ )
+	{
+		mStages[n].samples.clear();
+		mStages[n].count = 0;
+	}
+}
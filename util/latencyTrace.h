@@ -0,0 +1,124 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __LATENCY_TRACE_H_
+#define __LATENCY_TRACE_H_
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/**
+ * Prefix used for tagging printed log output
+ * @ingroup util
+ */
+#define LOG_TRACE "[trace]  "
+
+
+/**
+ * Retrieve the current time in nanoseconds from CLOCK_MONOTONIC,
+ * which is the clock that frame capture timestamps are in.
+ * @ingroup util
+ */
+inline uint64_t traceTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+/**
+ * Identifies a captured frame as it moves through conversion, inference and display.
+ * @ingroup util
+ */
+struct frameStamp
+{
+	uint64_t sequence;	/**< frame number from the camera, starting at 0 */
+	uint64_t timestamp;	/**< when the sensor/driver captured the frame (nanoseconds, CLOCK_MONOTONIC) */
+};
+
+
+/**
+ * Records when frames reach each stage of processing, relative to when they were
+ * captured, and reports the latency percentiles (i.e. glass-to-result latency).
+ * Optionally every sample is also written to a CSV file for offline analysis.
+ *
+ * Mark() can be called from any thread.
+ * @ingroup util
+ */
+class latencyTrace
+{
+public:
+	/**
+	 * Create a new trace.
+	 * @param filename optional CSV file to record each sample to (NULL to only keep statistics)
+	 * @param window number of recent samples per stage that the percentiles are computed over
+	 */
+	static latencyTrace* Create( const char* filename=NULL, uint32_t window=4096 );
+
+	/**
+	 * Destroy (closing the CSV file)
+	 */
+	~latencyTrace();
+
+	/**
+	 * Add a named stage to the trace, returning the index to pass to Mark().
+	 */
+	uint32_t AddStage( const char* name );
+
+	/**
+	 * Record that a frame has reached a stage.
+	 * @param time when it got there, or 0 for now
+	 */
+	void Mark( const frameStamp& frame, uint32_t stage, uint64_t time=0 );
+
+	/**
+	 * Compute a latency percentile for a stage over the recent samples.
+	 * @param percentile from 0 to 100
+	 * @param latency the latency in nanoseconds
+	 * @returns false if the stage hasn't recorded any samples
+	 */
+	bool GetPercentile( uint32_t stage, float percentile, uint64_t* latency );
+
+	/**
+	 * Print the p50/p90/p99/max latency of each stage.
+	 */
+	void Report();
+
+	/**
+	 * Clear the recorded statistics.
+	 */
+	void Reset();
+
+	/**
+	 * Number of stages.
+	 */
+	inline uint32_t GetNumStages() const		{ return mStages.size(); }
+
+protected:
+	latencyTrace();
+
+	struct stage
+	{
+		std::string name;
+		std::vector<uint64_t> samples;	// ring of the most recent latencies
+		uint64_t count;
+	};
+
+	std::vector<stage> mStages;
+	std::mutex mMutex;
+
+	FILE*    mFile;
+	uint32_t mWindow;
+};
+
+
+#endif
@@ -1,14 +1,71 @@
 /*
  * http://github.com/dusty-nv/jetson-inference
  */
- 
+
 #include "loadImage.h"
-#include "cudaMappedMemory.h"
+#include "imageIO.h"
+#include "cudaMappedPool.h"
+
+#include <stdlib.h>
+
+
+
+// loadImagePixels (decode to RGBA8, and rescale if a size was requested)
+static uint8_t* loadImagePixels( const char* filename, int* width, int* height )
+{
+	uint8_t* pixels = NULL;
+
+	int imgWidth  = 0;
+	int imgHeight = 0;
 
-#include <QImage>
+	if( !decodeImage(filename, &pixels, &imgWidth, &imgHeight) )
+	{
+		printf("failed to load image %s\n", filename);
+		return NULL;
+	}
 
+	if( *width != 0 && *height != 0 && (*width != imgWidth || *height != imgHeight) )
+	{
+		// nearest-neighbor resampling, same as QImage::scaled() with the default Qt::FastTransformation
+		const int dstWidth  = *width;
+		const int dstHeight = *height;
 
+		uint8_t* scaled = (uint8_t*)malloc(dstWidth * dstHeight * 4);
+
+		if( !scaled )
+		{
+			printf("failed to allocate %ix%i image for %s\n", dstWidth, dstHeight, filename);
+			free(pixels);
+			return NULL;
+		}
 
+		imageParallelRows(dstHeight, [&](int rowBegin, int rowEnd)
+		{
+			for( int y=rowBegin; y < rowEnd; y++ )
+			{
+				const uint32_t* src = (const uint32_t*)(pixels + ((y * imgHeight) / dstHeight) * imgWidth * 4);
+				uint32_t*       dst = (uint32_t*)(scaled + y * dstWidth * 4);
+
+				for( int x=0; x < dstWidth; x++ )
+					dst[x] = src[(x * imgWidth) / dstWidth];
+			}
+		});
+
+		free(pixels);
+
+		pixels    = scaled;
+		imgWidth  = dstWidth;
+		imgHeight = dstHeight;
+	}
+
+	*width  = imgWidth;
+	*height = imgHeight;
+
+	return pixels;
+}
+
+
+// saveImageRGBA
 bool saveImageRGBA( const char* filename, float4* cpu, int width, int height, float max_pixel )
 {
 	if( !filename || !cpu || !width || !height )
@@ -16,30 +73,54 @@ bool saveImageRGBA( const char* filename, float4* cpu, int width, int height, fl
 		printf("saveImageRGBA - invalid parameter\n");
 		return false;
 	}
-	
+
 	const float scale = 255.0f / max_pixel;
-	QImage img(width, height, QImage::Format_RGB32);
+	uint8_t* rgb = (uint8_t*)malloc(width * height * 3);
 
-	for( int y=0; y < height; y++ )
+	if( !rgb )
 	{
-		for( int x=0; x < width; x++ )
-		{
-			const float4 px = cpu[y * width + x];
-			//printf("%03u %03u   %f\n", x, y, normPx);
-			img.setPixel(x, y, qRgb(px.x * scale, px.y * scale, px.z * scale));
-		}
+		printf("failed to allocate %ix%i output image for %s\n", width, height, filename);
+		return false;
 	}
 
+	imageParallelRows(height, [&](int rowBegin, int rowEnd)
+	{
+		for( int y=rowBegin; y < rowEnd; y++ )
+			convertRowFloat4ToRGB8(cpu + y * width, rgb + y * width * 3, width, scale);
+	});
+
 
 	/*
 	 * save file
 	 */
-	if( !img.save(filename/*, "PNG", 100*/) )
+	const bool result = encodeImage(filename, rgb, width, height, 3);
+	free(rgb);
+
+	if( !result )
+	{
+		printf("failed to save %ix%i output image to %s\n", width, height, filename);
+		return false;
+	}
+
+	return true;
+}
+
+
+// saveImageGray
+bool saveImageGray( const char* filename, uint8_t* cpu, int width, int height )
+{
+	if( !filename || !cpu || !width || !height )
+	{
+		printf("saveImageGray - invalid parameter\n");
+		return false;
+	}
+
+	if( !encodeImage(filename, cpu, width, height, 1) )
 	{
 		printf("failed to save %ix%i output image to %s\n", width, height, filename);
 		return false;
 	}
-	
+
 	return true;
 }
 
@@ -52,168 +133,117 @@ bool loadImageRGBA( const char* filename, float4** cpu, float4** gpu, int* width
 		printf("loadImageRGBA - invalid parameter\n");
 		return false;
 	}
-	
+
 	// load original image
-	QImage qImg;
+	int imgWidth  = *width;
+	int imgHeight = *height;
 
-	if( !qImg.load(filename) )
-	{
-		printf("failed to load image %s\n", filename);
+	uint8_t* pixels = loadImagePixels(filename, &imgWidth, &imgHeight);
+
+	if( !pixels )
 		return false;
-	}
 
-	if( *width != 0 && *height != 0 )
-		qImg = qImg.scaled(*width, *height, Qt::IgnoreAspectRatio);
-	
-	const uint32_t imgWidth  = qImg.width();
-	const uint32_t imgHeight = qImg.height();
-	const uint32_t imgPixels = imgWidth * imgHeight;
-	const size_t   imgSize   = imgWidth * imgHeight * sizeof(float) * 4;
+	const size_t imgSize = imgWidth * imgHeight * sizeof(float) * 4;
 
-	printf("loaded image  %s  (%u x %u)  %zu bytes\n", filename, imgWidth, imgHeight, imgSize);
+	printf("loaded image  %s  (%i x %i)  %zu bytes\n", filename, imgWidth, imgHeight, imgSize);
 
 	// allocate buffer for the image
-	if( !cudaAllocMapped((void**)cpu, (void**)gpu, imgSize) )
+	if( !cudaAllocMappedPool((void**)cpu, (void**)gpu, imgSize) )
 	{
 		printf(LOG_CUDA "failed to allocated %zu bytes for image %s\n", imgSize, filename);
+		free(pixels);
 		return false;
 	}
 
 	float4* cpuPtr = *cpu;
-	
-	for( uint32_t y=0; y < imgHeight; y++ )
+
+	imageParallelRows(imgHeight, [&](int rowBegin, int rowEnd)
 	{
-		for( uint32_t x=0; x < imgWidth; x++ )
-		{
-			const QRgb rgb  = qImg.pixel(x,y);
-			const float4 px = make_float4(float(qRed(rgb)), 
-										  float(qGreen(rgb)), 
-										  float(qBlue(rgb)),
-										  float(qAlpha(rgb)));
-			
-			cpuPtr[y*imgWidth+x] = px;
-		}
-	}
-	
+		for( int y=rowBegin; y < rowEnd; y++ )
+			convertRowRGBA8ToFloat4(pixels + y * imgWidth * 4, cpuPtr + y * imgWidth, imgWidth);
+	});
+
+	free(pixels);
+
 	*width  = imgWidth;
-	*height = imgHeight;	
+	*height = imgHeight;
 	return true;
 }
 
 
-// loadImageRGB
-bool loadImageRGB( const char* filename, float3** cpu, float3** gpu, int* width, int* height, const float3& mean )
+// loadImagePlanar
+static bool loadImagePlanar( const char* filename, float3** cpu, float3** gpu, int* width, int* height, const float3& mean, bool bgr )
 {
-	if( !filename || !cpu || !gpu || !width || !height )
-	{
-		printf("loadImageRGB - invalid parameter\n");
-		return false;
-	}
-	
 	// load original image
-	QImage qImg;
+	int imgWidth  = *width;
+	int imgHeight = *height;
 
-	if( !qImg.load(filename) )
-	{
-		printf("failed to load image %s\n", filename);
+	uint8_t* pixels = loadImagePixels(filename, &imgWidth, &imgHeight);
+
+	if( !pixels )
 		return false;
-	}
 
-	if( *width != 0 && *height != 0 )
-		qImg = qImg.scaled(*width, *height, Qt::IgnoreAspectRatio);
-	
-	const uint32_t imgWidth  = qImg.width();
-	const uint32_t imgHeight = qImg.height();
 	const uint32_t imgPixels = imgWidth * imgHeight;
 	const size_t   imgSize   = imgWidth * imgHeight * sizeof(float) * 3;
 
-	printf("loaded image  %s  (%u x %u)  %zu bytes\n", filename, imgWidth, imgHeight, imgSize);
+	printf("loaded image  %s  (%i x %i)  %zu bytes\n", filename, imgWidth, imgHeight, imgSize);
 
 	// allocate buffer for the image
-	if( !cudaAllocMapped((void**)cpu, (void**)gpu, imgSize) )
+	if( !cudaAllocMappedPool((void**)cpu, (void**)gpu, imgSize) )
 	{
 		printf(LOG_CUDA "failed to allocated %zu bytes for image %s\n", imgSize, filename);
+		free(pixels);
 		return false;
 	}
 
+	// note:  caffe/GIE is band-sequential (as opposed to the typical Band Interleaved by Pixel)
 	float* cpuPtr = (float*)*cpu;
-	
-	for( uint32_t y=0; y < imgHeight; y++ )
+
+	float* planes[] = { cpuPtr, cpuPtr + imgPixels, cpuPtr + imgPixels * 2 };
+
+	imageParallelRows(imgHeight, [&](int rowBegin, int rowEnd)
 	{
-		for( uint32_t x=0; x < imgWidth; x++ )
+		for( int y=rowBegin; y < rowEnd; y++ )
 		{
-			const QRgb rgb  = qImg.pixel(x,y);
-			const float mul = 1.0f; 	//1.0f / 255.0f;
-			const float3 px = make_float3((float(qRed(rgb))   - mean.x) * mul, 
-										  (float(qGreen(rgb)) - mean.y) * mul, 
-										  (float(qBlue(rgb))  - mean.z) * mul );
-			
-			// note:  caffe/GIE is band-sequential (as opposed to the typical Band Interleaved by Pixel)
-			cpuPtr[imgPixels * 0 + y * imgWidth + x] = px.x; 
-			cpuPtr[imgPixels * 1 + y * imgWidth + x] = px.y; 
-			cpuPtr[imgPixels * 2 + y * imgWidth + x] = px.z; 
+			const uint8_t* row = pixels + y * imgWidth * 4;
+			const uint32_t offset = y * imgWidth;
+
+			if( bgr )
+				convertRowRGBA8ToPlanar(row, planes[2] + offset, planes[1] + offset, planes[0] + offset, imgWidth, make_float3(mean.z, mean.y, mean.x));
+			else
+				convertRowRGBA8ToPlanar(row, planes[0] + offset, planes[1] + offset, planes[2] + offset, imgWidth, mean);
 		}
-	}
-		
+	});
+
+	free(pixels);
+
 	*width  = imgWidth;
 	*height = imgHeight;
 	return true;
 }
 
 
-// loadImageBGR
-bool loadImageBGR( const char* filename, float3** cpu, float3** gpu, int* width, int* height, const float3& mean )
+// loadImageRGB
+bool loadImageRGB( const char* filename, float3** cpu, float3** gpu, int* width, int* height, const float3& mean )
 {
 	if( !filename || !cpu || !gpu || !width || !height )
 	{
 		printf("loadImageRGB - invalid parameter\n");
 		return false;
 	}
-	
-	// load original image
-	QImage qImg;
 
-	if( !qImg.load(filename) )
-	{
-		printf("failed to load image %s\n", filename);
-		return false;
-	}
-
-	if( *width != 0 && *height != 0 )
-		qImg = qImg.scaled(*width, *height, Qt::IgnoreAspectRatio);
-	
-	const uint32_t imgWidth  = qImg.width();
-	const uint32_t imgHeight = qImg.height();
-	const uint32_t imgPixels = imgWidth * imgHeight;
-	const size_t   imgSize   = imgWidth * imgHeight * sizeof(float) * 3;
+	return loadImagePlanar(filename, cpu, gpu, width, height, mean, false);
+}
 
-	printf("loaded image  %s  (%u x %u)  %zu bytes\n", filename, imgWidth, imgHeight, imgSize);
 
-	// allocate buffer for the image
-	if( !cudaAllocMapped((void**)cpu, (void**)gpu, imgSize) )
+// loadImageBGR
+bool loadImageBGR( const char* filename, float3** cpu, float3** gpu, int* width, int* height, const float3& mean )
+{
+	if( !filename || !cpu || !gpu || !width || !height )
 	{
-		printf(LOG_CUDA "failed to allocated %zu bytes for image %s\n", imgSize, filename);
+		printf("loadImageBGR - invalid parameter\n");
 		return false;
 	}
 
-	float* cpuPtr = (float*)*cpu;
-	
-	for( uint32_t y=0; y < imgHeight; y++ )
-	{
-		for( uint32_t x=0; x < imgWidth; x++ )
-		{
-			const QRgb rgb  = qImg.pixel(x,y);
-			const float mul = 1.0f; 	//1.0f / 255.0f;
-			const float3 px = make_float3((float(qBlue(rgb))  - mean.x) * mul, 
-										  (float(qGreen(rgb)) - mean.y) * mul, 
-										  (float(qRed(rgb))   - mean.z) * mul );
-			
-			// note:  caffe/GIE is band-sequential (as opposed to the typical Band Interleaved by Pixel)
-			cpuPtr[imgPixels * 0 + y * imgWidth + x] = px.x; 
-			cpuPtr[imgPixels * 1 + y * imgWidth + x] = px.y; 
-			cpuPtr[imgPixels * 2 + y * imgWidth + x] = px.z; 
-		}
-	}
-			
-	return true;
-}
\ No newline at end of file
+	return loadImagePlanar(filename, cpu, gpu, width, height, mean, true);
+}
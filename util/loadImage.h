@@ -6,12 +6,13 @@
 #define __IMAGE_LOADER_H_
 
 
-#include "cudaUtility.h"
+#include "cudaMappedPool.h"
 
 
 /**
  * Load a color image from disk into CUDA memory with alpha.
- * This function loads the image into shared CPU/GPU memory, using the functions from cudaMappedMemory.h
+ * This function loads the image into shared CPU/GPU memory allocated from cudaMappedPool::Default(),
+ * which should be released with cudaFreeMappedPool() when no longer needed.
  *
  * @param filename Path to the image file on disk.
  * @param cpu Pointer to CPU buffer allocated containing the image.
@@ -31,9 +32,18 @@ bool loadImageRGBA( const char* filename, float4** cpu, float4** gpu, int* width
 bool saveImageRGBA( const char* filename, float4* cpu, int width, int height, float max_pixel=255.0f );
 
 
+/**
+ * Save an 8-bit single-channel image to disk, such as a segmentation class mask.
+ * The pixel values are written unmodified as grayscale intensities.
+ * @ingroup util
+ */
+bool saveImageGray( const char* filename, uint8_t* cpu, int width, int height );
+
+
 /**
  * Load a color image from disk into CUDA memory.
- * This function loads the image into shared CPU/GPU memory, using the functions from cudaMappedMemory.h
+ * This function loads the image into shared CPU/GPU memory allocated from cudaMappedPool::Default(),
+ * which should be released with cudaFreeMappedPool() when no longer needed.
  *
  * @param filename Path to the image file on disk.
  * @param cpu Pointer to CPU buffer allocated containing the image.
@@ -48,7 +58,8 @@ bool loadImageRGB( const char* filename, float3** cpu, float3** gpu, int* width,
 
 /**
  * Load a color image from disk into CUDA memory.
- * This function loads the image into shared CPU/GPU memory, using the functions from cudaMappedMemory.h
+ * This function loads the image into shared CPU/GPU memory allocated from cudaMappedPool::Default(),
+ * which should be released with cudaFreeMappedPool() when no longer needed.
  *
  * @param filename Path to the image file on disk.
  * @param cpu Pointer to CPU buffer allocated containing the image.
@@ -0,0 +1,110 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#include "threadPool.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+
+// constructor
+threadPool::threadPool()
+{
+	mActive   = 0;
+	mShutdown = false;
+}
+
+
+// destructor
+threadPool::~threadPool()
+{
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mShutdown = true;
+	}
+
+	mJobEvent.notify_all();
+
+	for( size_t n=0; n < mThreads.size(); n++ )
+		mThreads[n].join();
+}
+
+
+// GetNumCores
+uint32_t threadPool::GetNumCores()
+{
+	const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return (cores > 0) ? cores : 1;
+}
+
+
+// Create
+threadPool* threadPool::Create( uint32_t numThreads )
+{
+	if( numThreads == 0 )
+		numThreads = GetNumCores();
+
+	threadPool* pool = new threadPool();
+
+	if( !pool )
+		return NULL;
+
+	for( uint32_t n=0; n < numThreads; n++ )
+		pool->mThreads.push_back(std::thread(&threadPool::run, pool));
+
+	return pool;
+}
+
+
+// Enqueue
+void threadPool::Enqueue( const std::function<void()>& job )
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJobs.push(job);
+	}
+
+	mJobEvent.notify_one();
+}
+
+
+// Wait
+void threadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mIdleEvent.wait(lock, [this]{ return mJobs.empty() && mActive == 0; });
+}
+
+
+// run
+void threadPool::run()
+{
+	while( true )
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mJobEvent.wait(lock, [this]{ return mShutdown || !mJobs.empty(); });
+
+			if( mJobs.empty() )
+				return;		// shutting down with nothing left to do
+
+			job = mJobs.front();
+			mJobs.pop();
+			mActive++;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mActive--;
+		}
+
+		mIdleEvent.notify_all();
+	}
+}
@@ -0,0 +1,75 @@
+/*
+ * http://github.com/dusty-nv/jetson-inference
+ */
+
+#ifndef __THREAD_POOL_H_
+#define __THREAD_POOL_H_
+
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <queue>
+#include <vector>
+
+
+/**
+ * Fixed-size pool of worker threads that execute queued jobs in FIFO order.
+ * Used for offloading CPU-bound work (like image decode/encode) from the inference thread.
+ * @ingroup util
+ */
+class threadPool
+{
+public:
+	/**
+	 * Create a new pool of worker threads.
+	 * @param numThreads number of workers to launch (0 to use the number of CPU cores)
+	 */
+	static threadPool* Create( uint32_t numThreads=0 );
+
+	/**
+	 * Destroy the pool, after waiting for any queued jobs to finish.
+	 */
+	~threadPool();
+
+	/**
+	 * Add a job to the queue, which will be run by the next available worker.
+	 */
+	void Enqueue( const std::function<void()>& job );
+
+	/**
+	 * Block until all queued jobs have finished executing.
+	 */
+	void Wait();
+
+	/**
+	 * Retrieve the number of worker threads in the pool.
+	 */
+	inline uint32_t GetNumThreads() const			{ return mThreads.size(); }
+
+	/**
+	 * Retrieve the number of CPU cores available on the system.
+	 */
+	static uint32_t GetNumCores();
+
+protected:
+	threadPool();
+
+	void run();
+
+	std::vector<std::thread> mThreads;
+	std::queue< std::function<void()> > mJobs;
+
+	std::mutex mMutex;
+	std::condition_variable mJobEvent;
+	std::condition_variable mIdleEvent;
+
+	uint32_t mActive;
+	bool     mShutdown;
+};
+
+
+#endif